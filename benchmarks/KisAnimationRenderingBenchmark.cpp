@@ -11,11 +11,86 @@
 #include <testutil.h>
 #include "kis_time_span.h"
 #include "dialogs/KisAsyncAnimationFramesSaveDialog.h"
+#include "dialogs/KisAsyncAnimationFramesStreamDialog.h"
+#include "animation/KisAnimationFrameStream.h"
 #include "kis_image_animation_interface.h"
 #include "KisPart.h"
 #include "KisDocument.h"
 #include "kis_image.h"
 #include "kis_image_config.h"
+#include "KisAsyncAnimationRendererBase.h"
+#include "KisAsyncAnimationClonesRegenerator.h"
+#include "KisFrameCacheStore.h"
+#include "kis_update_info.h"
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+#include "KoColorSpaceRegistry.h"
+
+#include <QEventLoop>
+#include <QStandardPaths>
+
+/**
+ * A headless stand-in for KisAsyncAnimationCacheRenderer: converts the
+ * frame into texture tiles the same way the frame cache does and puts
+ * them into KisFrameCacheStore
+ */
+class CacheStoreRenderer : public KisAsyncAnimationRendererBase
+{
+    Q_OBJECT
+
+public:
+    CacheStoreRenderer(KisFrameCacheStore *store)
+        : m_store(store),
+          m_pool(m_poolRegistry.getPool(256, 256))
+    {
+        m_updateInfoBuilder.setTextureInfoPool(m_pool);
+
+        const KoColorSpace *dstColorSpace = KoColorSpaceRegistry::instance()->rgb8();
+        m_updateInfoBuilder.setConversionOptions(
+            ConversionOptions(dstColorSpace,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags()));
+
+        m_updateInfoBuilder.setTextureBorder(8);
+        m_updateInfoBuilder.setEffectiveTextureSize(QSize(256 - 16, 256 - 16));
+
+        connect(this, SIGNAL(sigCompleteRegenerationInternal(int)), SLOT(slotCompleteRegenerationInternal(int)), Qt::QueuedConnection);
+    }
+
+protected:
+    void frameCompletedCallback(int frame, const KisRegion &requestedRegion) override {
+        KisImageSP image = requestedImage();
+        if (!image) return;
+
+        m_imageBounds = image->bounds();
+        m_info = m_updateInfoBuilder.buildUpdateInfo(requestedRegion.boundingRect(), image, true);
+        emit sigCompleteRegenerationInternal(frame);
+    }
+
+    void frameCancelledCallback(int frame, CancelReason cancelReason) override {
+        notifyFrameCancelled(frame, cancelReason);
+    }
+
+Q_SIGNALS:
+    void sigCompleteRegenerationInternal(int frame);
+
+private Q_SLOTS:
+    void slotCompleteRegenerationInternal(int frame) {
+        if (!isActive()) return;
+
+        m_store->saveFrame(frame, m_info, m_imageBounds);
+        m_info.clear();
+        notifyFrameCompleted(frame);
+    }
+
+private:
+    KisFrameCacheStore *m_store;
+    KisOpenGLUpdateInfoBuilder m_updateInfoBuilder;
+    KisTextureTileInfoPoolRegistry m_poolRegistry;
+    KisTextureTileInfoPoolSP m_pool;
+    KisOpenGLUpdateInfoSP m_info;
+    QRect m_imageBounds;
+};
 
 namespace {
 void removeTempFiles(const QString &filesMask)
@@ -55,6 +130,59 @@ void runRenderingTest(KisImageSP image, int numCores, int numClones)
 }
 
 
+void runStreamingTest(KisImageSP image, const QString &encoderPath, int numCores, int numClones)
+{
+    {
+        KisImageConfig cfg(false);
+        cfg.setMaxNumberOfThreads(numCores);
+        cfg.setFrameRenderingClones(numClones);
+    }
+
+    const KisTimeSpan range = image->animationInterface()->fullClipRange();
+
+    // the stand-in encoder just swallows the raw frames
+    KisAnimationFrameStream stream(encoderPath, QStringList(), range.start(), qMax(2, numClones));
+
+    KisAsyncAnimationFramesStreamDialog dlg(image, range, &stream);
+    dlg.setBatchMode(true);
+
+    KisAsyncAnimationFramesStreamDialog::Result result = dlg.regenerateRange(0);
+    QCOMPARE(result, KisAsyncAnimationFramesStreamDialog::RenderComplete);
+}
+
+void runCacheRegenerationTest(KisImageSP image, int numCores, int numClones)
+{
+    {
+        KisImageConfig cfg(false);
+        cfg.setMaxNumberOfThreads(numCores);
+    }
+
+    QList<int> frames;
+    const KisTimeSpan range = image->animationInterface()->fullClipRange();
+    for (int frame = range.start(); frame <= range.end(); frame++) {
+        frames << frame;
+    }
+
+    KisFrameCacheStore store;
+    KisAsyncAnimationClonesRegenerator regenerator([&store] () { return new CacheStoreRenderer(&store); });
+    regenerator.setMaxClones(numClones);
+
+    QEventLoop loop;
+    QObject::connect(&regenerator, SIGNAL(sigBatchCompleted()), &loop, SLOT(quit()));
+    QObject::connect(&regenerator, SIGNAL(sigBatchCancelled()), &loop, SLOT(quit()));
+
+    while (!frames.isEmpty()) {
+        const int numStartedFrames = regenerator.regenerate(image, frames);
+        QVERIFY(numStartedFrames > 0);
+
+        loop.exec();
+
+        for (int i = 0; i < numStartedFrames; i++) {
+            QVERIFY(store.hasFrame(frames.takeFirst()));
+        }
+    }
+}
+
 }
 
 
@@ -97,4 +225,71 @@ void KisAnimationRenderingBenchmark::testCacheRendering()
     }
 }
 
+void KisAnimationRenderingBenchmark::testStreamingRendering()
+{
+    const QString encoderPath = QStandardPaths::findExecutable("cat");
+    if (encoderPath.isEmpty()) {
+        QSKIP("No stand-in encoder executable (cat) found");
+    }
+
+    const QString fileName = TestUtil::fetchDataFileLazy("miloor_turntable_002.kra", true);
+    QVERIFY(QFileInfo(fileName).exists());
+
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    bool loadingResult = doc->loadNativeFormat(fileName);
+    QVERIFY(loadingResult);
+
+
+    doc->image()->barrierLock();
+    doc->image()->unlock();
+
+
+    for (int numCores = 1; numCores <= QThread::idealThreadCount(); numCores++) {
+        const int numClones = qMax(1, numCores / 2);
+
+        QElapsedTimer timer;
+        timer.start();
+        runRenderingTest(doc->image(), numCores, numClones);
+        const qint64 savingTime = timer.elapsed();
+
+        timer.restart();
+        runStreamingTest(doc->image(), encoderPath, numCores, numClones);
+        const qint64 streamingTime = timer.elapsed();
+
+        qDebug() << "Cores:" << numCores << "Clones:" << numClones
+                 << "Saving time:" << savingTime << "Streaming time:" << streamingTime;
+    }
+}
+
+void KisAnimationRenderingBenchmark::testCacheRegeneration()
+{
+    const QString fileName = TestUtil::fetchDataFileLazy("miloor_turntable_002.kra", true);
+    QVERIFY(QFileInfo(fileName).exists());
+
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    bool loadingResult = doc->loadNativeFormat(fileName);
+    QVERIFY(loadingResult);
+
+
+    doc->image()->barrierLock();
+    doc->image()->unlock();
+
+    const int numCores = QThread::idealThreadCount();
+
+    for (int numClones = 1; numClones <= numCores; numClones *= 2) {
+        QElapsedTimer timer;
+        timer.start();
+
+        runCacheRegenerationTest(doc->image(), numCores, numClones);
+
+        qDebug() << "Cores:" << numCores << "Clones:" << numClones << "Time:" << timer.elapsed();
+    }
+}
+
 SIMPLE_TEST_MAIN(KisAnimationRenderingBenchmark)
+
+#include "KisAnimationRenderingBenchmark.moc"
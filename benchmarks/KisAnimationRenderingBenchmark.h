@@ -14,6 +14,8 @@ class KisAnimationRenderingBenchmark : public QObject
     Q_OBJECT
 private Q_SLOTS:
    void testCacheRendering();
+   void testStreamingRendering();
+   void testCacheRegeneration();
 };
 
 #endif // KISANIMATIONRENDERINGBENCHMARK_H
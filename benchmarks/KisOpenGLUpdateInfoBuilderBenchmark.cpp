@@ -0,0 +1,80 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisOpenGLUpdateInfoBuilderBenchmark.h"
+
+#include <simpletest.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_update_info.h"
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+
+namespace {
+
+const int IMAGE_WIDTH = 4000;
+const int IMAGE_HEIGHT = 3000;
+
+/**
+ * Builds the update info for the entire image, the same way the canvas
+ * does after a filter is applied or an action undone
+ */
+void runBenchmark(const KoColorSpace *srcColorSpace, bool concurrent)
+{
+    const QRect bounds(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(srcColorSpace);
+    for (int i = 0; i < 32; i++) {
+        const QRect rc(i * IMAGE_WIDTH / 32, (i * 397) % IMAGE_HEIGHT, IMAGE_WIDTH / 8, IMAGE_HEIGHT / 4);
+        dev->fill(rc & bounds, KoColor(QColor::fromHsv(i * 11, 220, 240), srcColorSpace));
+    }
+
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(256, 256);
+
+    KisOpenGLUpdateInfoBuilder builder;
+    builder.setTextureInfoPool(pool);
+    builder.setConversionOptions(
+        ConversionOptions(KoColorSpaceRegistry::instance()->rgb8(),
+                          KoColorConversionTransformation::internalRenderingIntent(),
+                          KoColorConversionTransformation::internalConversionFlags()));
+    builder.setTextureBorder(8);
+    builder.setEffectiveTextureSize(QSize(256 - 16, 256 - 16));
+    builder.setConcurrentBuildEnabled(concurrent);
+
+    QBENCHMARK {
+        KisOpenGLUpdateInfoSP info = builder.buildUpdateInfo(bounds, dev, bounds, 0, true);
+        Q_UNUSED(info);
+    }
+}
+
+}
+
+void KisOpenGLUpdateInfoBuilderBenchmark::benchmarkRgb8Sequential()
+{
+    runBenchmark(KoColorSpaceRegistry::instance()->rgb8(), false);
+}
+
+void KisOpenGLUpdateInfoBuilderBenchmark::benchmarkRgb8Concurrent()
+{
+    runBenchmark(KoColorSpaceRegistry::instance()->rgb8(), true);
+}
+
+void KisOpenGLUpdateInfoBuilderBenchmark::benchmarkRgb16Sequential()
+{
+    runBenchmark(KoColorSpaceRegistry::instance()->rgb16(), false);
+}
+
+void KisOpenGLUpdateInfoBuilderBenchmark::benchmarkRgb16Concurrent()
+{
+    runBenchmark(KoColorSpaceRegistry::instance()->rgb16(), true);
+}
+
+SIMPLE_TEST_MAIN(KisOpenGLUpdateInfoBuilderBenchmark)
@@ -0,0 +1,24 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISOPENGLUPDATEINFOBUILDERBENCHMARK_H
+#define KISOPENGLUPDATEINFOBUILDERBENCHMARK_H
+
+#include <QObject>
+
+class KisOpenGLUpdateInfoBuilderBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchmarkRgb8Sequential();
+    void benchmarkRgb8Concurrent();
+
+    void benchmarkRgb16Sequential();
+    void benchmarkRgb16Concurrent();
+};
+
+#endif // KISOPENGLUPDATEINFOBUILDERBENCHMARK_H
@@ -0,0 +1,114 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_exact_bounds_benchmark.h"
+
+#include <simpletest.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "KisTileBoundsSummary.h"
+
+const int IMAGE_WIDTH = 20000;
+const int IMAGE_HEIGHT = 20000;
+const int NUM_DABS = 200;
+const int DAB_SIZE = 40;
+
+void KisExactBoundsBenchmark::initTestCase()
+{
+    m_colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    m_dev = new KisPaintDevice(m_colorSpace);
+
+    /**
+     * A sparse device: a few hundreds of small dabs scattered over
+     * a 20k canvas, like a sketch layer of a big image
+     */
+    KoColor color(Qt::black, m_colorSpace);
+
+    for (int i = 0; i < NUM_DABS; i++) {
+        const QRect dabRect((i * 7919) % (IMAGE_WIDTH - DAB_SIZE),
+                            (i * 104729) % (IMAGE_HEIGHT - DAB_SIZE),
+                            DAB_SIZE, DAB_SIZE);
+
+        m_dev->fill(dabRect, color);
+        m_expectedBounds |= dabRect;
+    }
+
+    QCOMPARE(m_dev->exactBounds(), m_expectedBounds);
+}
+
+void KisExactBoundsBenchmark::benchmarkExactBoundsFromScratch()
+{
+    QRect bounds;
+
+    QBENCHMARK {
+        KisTileBoundsSummary summary;
+        bounds = summary.exactBounds(m_dev, KisTileBoundsSummary::TransparentPixelsAreEmpty);
+    }
+
+    QCOMPARE(bounds, m_expectedBounds);
+}
+
+void KisExactBoundsBenchmark::benchmarkExactBoundsUnchanged()
+{
+    QRect bounds;
+
+    QBENCHMARK {
+        // invalidate the cache
+        m_dev->setDirty();
+        bounds = m_dev->exactBounds();
+    }
+
+    QCOMPARE(bounds, m_expectedBounds);
+}
+
+void KisExactBoundsBenchmark::benchmarkExactBoundsAfterInnerStroke()
+{
+    const QRect strokeRect(IMAGE_WIDTH / 2, IMAGE_HEIGHT / 2, 200, 200);
+    KoColor color(Qt::red, m_colorSpace);
+
+    QRect bounds;
+
+    QBENCHMARK {
+        m_dev->fill(strokeRect, color);
+        bounds = m_dev->exactBounds();
+    }
+
+    QCOMPARE(bounds, m_expectedBounds | strokeRect);
+}
+
+void KisExactBoundsBenchmark::benchmarkExactBoundsAfterEdgeStroke()
+{
+    const QRect strokeRect(m_expectedBounds.x(), m_expectedBounds.center().y(), 200, 200);
+    KoColor color(Qt::red, m_colorSpace);
+
+    QRect bounds;
+
+    QBENCHMARK {
+        m_dev->fill(strokeRect, color);
+        bounds = m_dev->exactBounds();
+    }
+
+    QCOMPARE(bounds, m_expectedBounds | strokeRect);
+}
+
+void KisExactBoundsBenchmark::benchmarkNonDefaultPixelArea()
+{
+    QRect area;
+
+    QBENCHMARK {
+        m_dev->setDirty();
+        area = m_dev->nonDefaultPixelArea();
+    }
+
+    QVERIFY(area.contains(m_expectedBounds));
+}
+
+SIMPLE_TEST_MAIN(KisExactBoundsBenchmark)
@@ -0,0 +1,34 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_EXACT_BOUNDS_BENCHMARK_H
+#define KIS_EXACT_BOUNDS_BENCHMARK_H
+
+#include <simpletest.h>
+#include "kis_paint_device.h"
+
+class KoColorSpace;
+
+class KisExactBoundsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    const KoColorSpace *m_colorSpace;
+    KisPaintDeviceSP m_dev;
+    QRect m_expectedBounds;
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkExactBoundsFromScratch();
+    void benchmarkExactBoundsUnchanged();
+    void benchmarkExactBoundsAfterInnerStroke();
+    void benchmarkExactBoundsAfterEdgeStroke();
+    void benchmarkNonDefaultPixelArea();
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_lazy_brush_benchmark.h"
+
+#include <simpletest.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_fill_painter.h"
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_sequential_iterator.h"
+#include "lazybrush/kis_lazy_fill_tools.h"
+#include "lazybrush/kis_multiway_cut.h"
+
+namespace {
+
+struct LineArtPage {
+    QRect rect;
+    KisPaintDeviceSP heightMap;
+    QVector<KisPaintDeviceSP> keyStrokes;
+    QVector<KoColor> colors;
+};
+
+/**
+ * Generates a comic-like page: a grid of panels with thick borders and
+ * some thinner strokes inside, every panel having a few key strokes
+ */
+LineArtPage createLineArtPage(int size)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *alpha8 = KoColorSpaceRegistry::instance()->alpha8();
+
+    LineArtPage page;
+    page.rect = QRect(0, 0, size, size);
+
+    KisPaintDeviceSP lineArt = new KisPaintDevice(cs);
+    KisFillPainter gc(lineArt);
+    gc.setPaintColor(KoColor(Qt::black, cs));
+
+    const int numPanels = 3;
+    const int panelSize = size / numPanels;
+    const int border = qMax(4, size / 128);
+
+    QVector<QRect> panels;
+
+    for (int row = 0; row < numPanels; row++) {
+        for (int col = 0; col < numPanels; col++) {
+            const QRect panel(col * panelSize + border, row * panelSize + border,
+                              panelSize - 2 * border, panelSize - 2 * border);
+            panels << panel;
+
+            QPainterPath path;
+            path.addRect(panel);
+            path.moveTo(panel.topLeft() + QPoint(panel.width() / 4, 0));
+            path.cubicTo(panel.center() - QPoint(panel.width() / 3, 0),
+                         panel.center() + QPoint(0, panel.height() / 3),
+                         panel.bottomRight() - QPoint(0, panel.height() / 4));
+
+            gc.drawPainterPath(path, QPen(Qt::white, border));
+        }
+    }
+
+    page.heightMap = KisPainter::convertToAlphaAsAlpha(lineArt);
+    KisLazyFillTools::normalizeAndInvertAlpha8Device(page.heightMap, page.rect);
+
+    const QVector<QColor> panelColors({Qt::red, Qt::green, Qt::blue, Qt::yellow});
+
+    for (int i = 0; i < panelColors.size(); i++) {
+        KisPaintDeviceSP stroke = new KisPaintDevice(alpha8);
+
+        for (int j = i; j < panels.size(); j += panelColors.size()) {
+            const QRect &panel = panels[j];
+            const int markSize = panel.width() / 10;
+            stroke->fill(QRect(panel.topLeft() + QPoint(2 * border, panel.height() - 2 * border - markSize),
+                               QSize(markSize, markSize)),
+                         KoColor(Qt::black, alpha8));
+            stroke->fill(QRect(panel.topRight() + QPoint(-2 * border - markSize, 2 * border),
+                               QSize(markSize, markSize)),
+                         KoColor(Qt::black, alpha8));
+        }
+
+        page.keyStrokes << stroke;
+        page.colors << KoColor(panelColors[i], cs);
+    }
+
+    // the gutters between the panels are the transparent background
+    KisPaintDeviceSP background = new KisPaintDevice(alpha8);
+    background->fill(QRect(0, 0, size, border / 2), KoColor(Qt::black, alpha8));
+    page.keyStrokes << background;
+    page.colors << KoColor(Qt::transparent, cs);
+
+    return page;
+}
+
+KisPaintDeviceSP runCut(const LineArtPage &page, int coarseToFineFactor,
+                        KisLazyFillTools::CutStatistics *statistics)
+{
+    KisPaintDeviceSP result = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+
+    KisMultiwayCut cut(page.heightMap, result, page.rect);
+    cut.setCoarseToFineFactor(coarseToFineFactor);
+
+    for (int i = 0; i < page.keyStrokes.size(); i++) {
+        cut.addKeyStroke(new KisPaintDevice(*page.keyStrokes[i]), page.colors[i]);
+    }
+
+    cut.run();
+    *statistics = cut.statistics();
+
+    return result;
+}
+
+qreal agreement(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rc)
+{
+    KisSequentialConstIterator it1(dev1, rc);
+    KisSequentialConstIterator it2(dev2, rc);
+
+    const int pixelSize = dev1->pixelSize();
+    qint64 numEqualPixels = 0;
+
+    while (it1.nextPixel() && it2.nextPixel()) {
+        if (!memcmp(it1.rawDataConst(), it2.rawDataConst(), pixelSize)) {
+            numEqualPixels++;
+        }
+    }
+
+    return qreal(numEqualPixels) / (qint64(rc.width()) * rc.height());
+}
+
+void reportStatistics(const char *name, const KisLazyFillTools::CutStatistics &statistics)
+{
+    // every vertex of the graph costs about 100 bytes in the max-flow solver
+    qDebug() << name
+             << "graphs:" << statistics.numGraphs
+             << "total vertices:" << statistics.numGraphVertices
+             << "largest graph:" << statistics.maxGraphVertices
+             << "(~" << statistics.maxGraphVertices * 100 / (1 << 20) << "MiB)";
+}
+
+}
+
+void KisLazyBrushBenchmark::benchmarkMultiwayCut_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("512") << 512;
+    QTest::newRow("1024") << 1024;
+}
+
+void KisLazyBrushBenchmark::benchmarkMultiwayCut()
+{
+    QFETCH(int, size);
+
+    const LineArtPage page = createLineArtPage(size);
+
+    KisLazyFillTools::CutStatistics statistics;
+
+    QBENCHMARK_ONCE {
+        runCut(page, 1, &statistics);
+    }
+
+    reportStatistics("full", statistics);
+}
+
+void KisLazyBrushBenchmark::benchmarkMultiwayCutCoarseToFine_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("factor");
+
+    QTest::newRow("512, 2x") << 512 << 2;
+    QTest::newRow("512, 4x") << 512 << 4;
+    QTest::newRow("1024, 4x") << 1024 << 4;
+    QTest::newRow("1024, 8x") << 1024 << 8;
+}
+
+void KisLazyBrushBenchmark::benchmarkMultiwayCutCoarseToFine()
+{
+    QFETCH(int, size);
+    QFETCH(int, factor);
+
+    const LineArtPage page = createLineArtPage(size);
+
+    KisLazyFillTools::CutStatistics statistics;
+    KisPaintDeviceSP result;
+
+    QBENCHMARK_ONCE {
+        result = runCut(page, factor, &statistics);
+    }
+
+    reportStatistics("coarse-to-fine", statistics);
+
+    KisLazyFillTools::CutStatistics fullStatistics;
+    KisPaintDeviceSP reference = runCut(page, 1, &fullStatistics);
+
+    qDebug() << "agreement with the full solver:" << agreement(reference, result, page.rect);
+}
+
+SIMPLE_TEST_MAIN(KisLazyBrushBenchmark)
@@ -0,0 +1,26 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LAZY_BRUSH_BENCHMARK_H
+#define KIS_LAZY_BRUSH_BENCHMARK_H
+
+#include <simpletest.h>
+
+#include <kis_types.h>
+
+class KisLazyBrushBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchmarkMultiwayCut_data();
+    void benchmarkMultiwayCut();
+
+    void benchmarkMultiwayCutCoarseToFine_data();
+    void benchmarkMultiwayCutCoarseToFine();
+};
+
+#endif // KIS_LAZY_BRUSH_BENCHMARK_H
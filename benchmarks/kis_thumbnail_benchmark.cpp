@@ -9,6 +9,7 @@
 
 #include <simpletest.h>
 #include <QImage>
+#include <QtConcurrent>
 #include "kis_iterator_ng.h"
 
 #include "kis_paint_device.h"
@@ -26,6 +27,7 @@
 
 
 #include <cmath>
+#include <functional>
 
 #define SAVE_OUTPUT
 
@@ -145,5 +147,76 @@ void KisThumbnailBenchmark::benchmarkCreateThumbnailHiQcreateThumbOversample4x()
     image.save("createThumbnailHiQcreateThumbOversample4x.png");
 }
 
+void KisThumbnailBenchmark::benchmarkCreateThumbnailIncremental()
+{
+    QImage image;
+    KoColor color(Qt::red, m_colorSpace);
+
+    // generate the initial thumbnail outside the benchmark loop
+    image = m_dev->createThumbnail(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, OVERSAMPLE);
+
+    int i = 0;
+    QBENCHMARK{
+        // a small stroke-like change, only a few thumbnail pixels depend on it
+        m_dev->fill(QRect(100 + 10 * (i % 100), 100, 50, 50), color);
+        image = m_dev->createThumbnail(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, OVERSAMPLE);
+        i++;
+    }
+
+    image.save("createThumbnailIncremental.png");
+}
+
+namespace {
+QVector<KisPaintDeviceSP> createLayerDevices(const KoColorSpace *cs)
+{
+    const int numLayers = 32;
+    const int layerWidth = 1000;
+    const int layerHeight = 1000;
+
+    QVector<KisPaintDeviceSP> devices;
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintDeviceSP dev = new KisPaintDevice(cs);
+        KoColor color(QColor::fromHsv(i * 360 / numLayers, 255, 255), cs);
+        dev->fill(QRect(i * 10, i * 10, layerWidth, layerHeight), color);
+        devices << dev;
+    }
+
+    return devices;
+}
+}
+
+void KisThumbnailBenchmark::benchmarkCreateThumbnailsManyLayers()
+{
+    QVector<KisPaintDeviceSP> devices = createLayerDevices(m_colorSpace);
+
+    int i = 0;
+    QBENCHMARK{
+        // alternate the size to avoid hitting the thumbnail cache
+        const int size = THUMBNAIL_WIDTH + (i++ & 1);
+
+        Q_FOREACH (KisPaintDeviceSP dev, devices) {
+            dev->createThumbnail(size, size, Qt::KeepAspectRatio, OVERSAMPLE);
+        }
+    }
+}
+
+void KisThumbnailBenchmark::benchmarkCreateThumbnailsManyLayersConcurrent()
+{
+    QVector<KisPaintDeviceSP> devices = createLayerDevices(m_colorSpace);
+
+    int i = 0;
+    QBENCHMARK{
+        // alternate the size to avoid hitting the thumbnail cache
+        const int size = THUMBNAIL_WIDTH + (i++ & 1);
+
+        std::function<QImage (KisPaintDeviceSP)> createFunc =
+            [size] (KisPaintDeviceSP dev) {
+                return dev->createThumbnail(size, size, Qt::KeepAspectRatio, OVERSAMPLE);
+            };
+
+        QtConcurrent::blockingMapped<QVector<QImage>>(devices, createFunc);
+    }
+}
 
 SIMPLE_TEST_MAIN(KisThumbnailBenchmark)
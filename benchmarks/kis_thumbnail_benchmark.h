@@ -37,6 +37,10 @@ private Q_SLOTS:
     void benchmarkCreateThumbnailHiQcreateThumbOversample3x();
     void benchmarkCreateThumbnailHiQcreateThumbOversample4x();
 
+    void benchmarkCreateThumbnailIncremental();
+    void benchmarkCreateThumbnailsManyLayers();
+    void benchmarkCreateThumbnailsManyLayersConcurrent();
+
 };
 
 
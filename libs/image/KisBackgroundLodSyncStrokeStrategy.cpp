@@ -0,0 +1,116 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBackgroundLodSyncStrokeStrategy.h"
+
+#include <kis_image.h>
+#include <kundo2magicstring.h>
+#include "krita_utils.h"
+#include "kis_layer_utils.h"
+#include "kis_pointer_utils.h"
+#include "KisRunnableStrokeJobUtils.h"
+
+struct KisBackgroundLodSyncStrokeStrategy::Private
+{
+    KisImageWSP image;
+    int levelOfDetail = 0;
+    bool releaseOtherLevels = false;
+    std::function<void()> syncFinishedCallback;
+};
+
+KisBackgroundLodSyncStrokeStrategy::KisBackgroundLodSyncStrokeStrategy(KisImageWSP image, int levelOfDetail, bool releaseOtherLevels)
+    : KisRunnableBasedStrokeStrategy(QLatin1String("BackgroundLodSyncStroke"), kundo2_i18n("Instant Preview")),
+      m_d(new Private)
+{
+    m_d->image = image;
+    m_d->levelOfDetail = levelOfDetail;
+    m_d->releaseOtherLevels = releaseOtherLevels;
+
+    /**
+     * The dirty regions are calculated in the init job, so nobody
+     * should be writing into the devices at that moment
+     */
+    enableJob(KisSimpleStrokeStrategy::JOB_INIT, true, KisStrokeJobData::BARRIER, KisStrokeJobData::EXCLUSIVE);
+    enableJob(KisSimpleStrokeStrategy::JOB_DOSTROKE);
+    enableJob(KisSimpleStrokeStrategy::JOB_FINISH);
+
+    setRequestsOtherStrokesToEnd(false);
+    setClearsRedoOnStart(false);
+    // a pure release of the pyramids is cheap and should not be skipped
+    setCanForgetAboutMe(levelOfDetail > 0);
+}
+
+KisBackgroundLodSyncStrokeStrategy::~KisBackgroundLodSyncStrokeStrategy()
+{
+}
+
+void KisBackgroundLodSyncStrokeStrategy::setSyncFinishedCallback(std::function<void()> callback)
+{
+    m_d->syncFinishedCallback = callback;
+}
+
+void KisBackgroundLodSyncStrokeStrategy::initStrokeCallback()
+{
+    KisImageSP image = m_d->image;
+    if (!image) return;
+
+    QVector<KisStrokeJobData *> jobs;
+    createJobsData(jobs, image->root(), m_d->levelOfDetail, m_d->releaseOtherLevels);
+    addMutatedJobs(jobs);
+}
+
+void KisBackgroundLodSyncStrokeStrategy::finishStrokeCallback()
+{
+    if (m_d->syncFinishedCallback) {
+        m_d->syncFinishedCallback();
+    }
+}
+
+void KisBackgroundLodSyncStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &jobs, KisNodeSP imageRoot, int levelOfDetail, bool releaseOtherLevels)
+{
+    using KisLayerUtils::recursiveApplyNodes;
+    using KritaUtils::splitRegionIntoPatches;
+    using KritaUtils::optimalPatchSize;
+
+    KisPaintDeviceList deviceList;
+
+    recursiveApplyNodes(imageRoot,
+        [&deviceList](KisNodeSP node) {
+             deviceList << node->getLodCapableDevices();
+        });
+
+    KritaUtils::makeContainerUnique(deviceList);
+
+    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
+        if (releaseOtherLevels) {
+            device->releaseLodPyramid(levelOfDetail);
+        }
+
+        if (levelOfDetail <= 0) continue;
+
+        KisRegion region;
+        QSharedPointer<KisPaintDevice::LodDataStruct> data(device->createLodDataStruct(levelOfDetail, &region));
+
+        if (region.isEmpty()) {
+            device->commitLodDataStruct(data.data());
+            continue;
+        }
+
+        Q_FOREACH (const QRect &rc, splitRegionIntoPatches(region, optimalPatchSize())) {
+            KritaUtils::addJobConcurrent(jobs, [data, device, rc] () mutable {
+                device->updateLodDataStruct(data.data(), rc);
+            });
+        }
+
+        /**
+         * If the stroke is cancelled before this point, the level is
+         * not committed and its tiles will be reported as dirty again
+         */
+        KritaUtils::addJobSequential(jobs, [data, device] () mutable {
+            device->commitLodDataStruct(data.data());
+        });
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBACKGROUNDLODSYNCSTROKESTRATEGY_H
+#define KISBACKGROUNDLODSYNCSTROKESTRATEGY_H
+
+#include "kritaimage_export.h"
+#include <KisRunnableBasedStrokeStrategy.h>
+
+#include <QScopedPointer>
+#include <functional>
+
+/**
+ * A forgettable stroke that brings the LoD pyramids of all the
+ * LoD-capable devices of the image up to date (\see
+ * KisPaintDevice::createLodDataStruct(int, KisRegion*)). It is started in the idle
+ * time, so that the blocking KisSyncLodCacheStrokeStrategy, that runs
+ * when the next LoD stroke starts, has to process only the residual
+ * dirty tiles.
+ *
+ * The stroke doesn't touch the LoD planes of the devices, so it can
+ * be safely run (and cancelled) as a usual legacy stroke.
+ *
+ * If \p releaseOtherLevels is set, the stroke also drops all the other
+ * levels of the pyramids. Passing zero \p levelOfDetail with it releases
+ * the pyramids completely.
+ */
+class KRITAIMAGE_EXPORT KisBackgroundLodSyncStrokeStrategy : public KisRunnableBasedStrokeStrategy
+{
+public:
+    KisBackgroundLodSyncStrokeStrategy(KisImageWSP image, int levelOfDetail, bool releaseOtherLevels = false);
+    ~KisBackgroundLodSyncStrokeStrategy() override;
+
+    /**
+     * Sets a callback that is called when all the pyramids have been
+     * synchronized. It is not called if the stroke is cancelled.
+     */
+    void setSyncFinishedCallback(std::function<void()> callback);
+
+    static void createJobsData(QVector<KisStrokeJobData *> &jobs, KisNodeSP imageRoot, int levelOfDetail, bool releaseOtherLevels = false);
+
+private:
+    void initStrokeCallback() override;
+    void finishStrokeCallback() override;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISBACKGROUNDLODSYNCSTROKESTRATEGY_H
@@ -0,0 +1,325 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisChannelStatistics.h"
+
+#include <functional>
+#include <limits>
+
+#include <KoConfig.h>
+
+#ifdef HAVE_OPENEXR
+#include <half.h>
+#endif
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <KoChannelInfo.h>
+#include <KoColorConversionTransformation.h>
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include "kis_assert.h"
+#include "kis_paint_device.h"
+#include "tiles3/kis_tile.h"
+
+
+namespace {
+
+typedef double (*PtrToDouble)(const quint8*, int);
+
+template<typename T>
+double toDouble(const quint8 *data, int channelpos)
+{
+    return double(*reinterpret_cast<const T*>(data + channelpos));
+}
+
+/**
+ * How to read the values of a channel and the range
+ * the histogram bins are spread over
+ */
+struct ChannelFormat {
+    PtrToDouble toDouble = 0;
+    int pos = 0;
+    qreal rangeStart = 0.0;
+    qreal rangeEnd = 1.0;
+};
+
+template<typename T>
+ChannelFormat integerFormat(int pos)
+{
+    return ChannelFormat{toDouble<T>, pos,
+                         qreal(std::numeric_limits<T>::min()),
+                         qreal(std::numeric_limits<T>::max())};
+}
+
+template<typename T>
+ChannelFormat floatFormat(int pos)
+{
+    return ChannelFormat{toDouble<T>, pos, 0.0, 1.0};
+}
+
+ChannelFormat channelFormat(const KoChannelInfo *channel)
+{
+    const int pos = channel->pos();
+
+    switch (channel->channelValueType()) {
+    case KoChannelInfo::UINT8:
+        return integerFormat<quint8>(pos);
+    case KoChannelInfo::UINT16:
+        return integerFormat<quint16>(pos);
+    case KoChannelInfo::UINT32:
+        return integerFormat<quint32>(pos);
+    case KoChannelInfo::INT8:
+        return integerFormat<qint8>(pos);
+    case KoChannelInfo::INT16:
+        return integerFormat<qint16>(pos);
+#ifdef HAVE_OPENEXR
+    case KoChannelInfo::FLOAT16:
+        return floatFormat<half>(pos);
+#endif
+    case KoChannelInfo::FLOAT32:
+        return floatFormat<float>(pos);
+    case KoChannelInfo::FLOAT64:
+        return floatFormat<double>(pos);
+    default:
+        break;
+    }
+
+    return ChannelFormat();
+}
+
+struct ChannelAccumulator {
+    qreal minimum = std::numeric_limits<qreal>::max();
+    qreal maximum = std::numeric_limits<qreal>::lowest();
+    qreal sum = 0.0;
+    qreal sumOfSquares = 0.0;
+    QVector<quint32> bins;
+};
+
+struct TileJob {
+    QRect rect;
+    QVector<ChannelAccumulator> channels;
+};
+
+inline qint32 divideRoundDown(qint32 x, qint32 y)
+{
+    return x >= 0 ? x / y : -(((-x - 1) / y) + 1);
+}
+
+void processTile(TileJob &job,
+                 const KisPaintDevice *device,
+                 const KoColorSpace *colorSpace,
+                 const QVector<ChannelFormat> &formats)
+{
+    const KoColorSpace *srcColorSpace = device->colorSpace();
+    const int numPixels = job.rect.width() * job.rect.height();
+
+    QVector<quint8> buffer(numPixels * srcColorSpace->pixelSize());
+    device->readBytes(buffer.data(), job.rect);
+
+    const quint8 *pixels = buffer.constData();
+
+    QVector<quint8> convertedBuffer;
+    if (*colorSpace != *srcColorSpace) {
+        convertedBuffer.resize(numPixels * colorSpace->pixelSize());
+        srcColorSpace->convertPixelsTo(buffer.constData(), convertedBuffer.data(),
+                                       colorSpace, numPixels,
+                                       KoColorConversionTransformation::internalRenderingIntent(),
+                                       KoColorConversionTransformation::internalConversionFlags());
+        pixels = convertedBuffer.constData();
+    }
+
+    const int pixelSize = colorSpace->pixelSize();
+
+    job.channels.resize(formats.size());
+
+    for (int ch = 0; ch < formats.size(); ch++) {
+        const ChannelFormat &format = formats[ch];
+        ChannelAccumulator &acc = job.channels[ch];
+
+        acc.bins.fill(0, KisChannelStatistics::NumBins);
+        if (!format.toDouble) continue;
+
+        const qreal scale = (KisChannelStatistics::NumBins - 1) / (format.rangeEnd - format.rangeStart);
+
+        const quint8 *pixel = pixels;
+        for (int i = 0; i < numPixels; i++, pixel += pixelSize) {
+            const qreal value = format.toDouble(pixel, format.pos);
+
+            acc.minimum = qMin(acc.minimum, value);
+            acc.maximum = qMax(acc.maximum, value);
+            acc.sum += value;
+            acc.sumOfSquares += value * value;
+
+            const int bin = qBound(0, qRound((value - format.rangeStart) * scale), KisChannelStatistics::NumBins - 1);
+            acc.bins[bin]++;
+        }
+    }
+}
+
+}
+
+KisChannelStatisticsSP KisChannelStatistics::calculate(const KisPaintDevice *device,
+                                                       const QRect &rect,
+                                                       const KoColorSpace *colorSpace,
+                                                       KoUpdater *progressUpdater)
+{
+    if (!colorSpace) {
+        colorSpace = device->colorSpace();
+    }
+
+    const QList<KoChannelInfo*> channels = colorSpace->channels();
+
+    QVector<ChannelFormat> formats;
+    Q_FOREACH (const KoChannelInfo *channel, channels) {
+        formats << channelFormat(channel);
+    }
+
+    /**
+     * Split the rect by the tiles of the device, so that every job
+     * reads as few tiles as possible
+     */
+    QVector<TileJob> jobs;
+
+    if (!rect.isEmpty()) {
+        const QPoint offset(device->x(), device->y());
+        const QRect dataRect = rect.translated(-offset);
+
+        const qint32 firstCol = divideRoundDown(dataRect.left(), KisTileData::WIDTH);
+        const qint32 lastCol = divideRoundDown(dataRect.right(), KisTileData::WIDTH);
+        const qint32 firstRow = divideRoundDown(dataRect.top(), KisTileData::HEIGHT);
+        const qint32 lastRow = divideRoundDown(dataRect.bottom(), KisTileData::HEIGHT);
+
+        for (qint32 row = firstRow; row <= lastRow; row++) {
+            for (qint32 col = firstCol; col <= lastCol; col++) {
+                const QRect tileRect(col * KisTileData::WIDTH, row * KisTileData::HEIGHT,
+                                     KisTileData::WIDTH, KisTileData::HEIGHT);
+                jobs << TileJob{(tileRect & dataRect).translated(offset), QVector<ChannelAccumulator>()};
+            }
+        }
+    }
+
+    std::function<void(TileJob&)> processFunc =
+        [device, colorSpace, formats] (TileJob &job) {
+            processTile(job, device, colorSpace, formats);
+        };
+
+    if (!progressUpdater) {
+        QtConcurrent::blockingMap(jobs, processFunc);
+    } else {
+        /**
+         * Process the tiles in batches of a few tiles per thread to be
+         * able to report the progress in between
+         */
+        const int batchSize = qMax(1, QThread::idealThreadCount()) * 4;
+
+        progressUpdater->setRange(0, jobs.size());
+        progressUpdater->setValue(0);
+
+        for (int i = 0; i < jobs.size(); i += batchSize) {
+            const int batchEnd = qMin(i + batchSize, jobs.size());
+            QtConcurrent::blockingMap(jobs.begin() + i, jobs.begin() + batchEnd, processFunc);
+            progressUpdater->setValue(batchEnd);
+        }
+    }
+
+    QSharedPointer<KisChannelStatistics> statistics(new KisChannelStatistics());
+    statistics->m_pixelCount = rect.isEmpty() ? 0 : quint64(rect.width()) * rect.height();
+    statistics->m_channels.resize(formats.size());
+
+    for (int ch = 0; ch < formats.size(); ch++) {
+        ChannelData &data = statistics->m_channels[ch];
+        data.bins.fill(0, NumBins);
+
+        if (!formats[ch].toDouble || jobs.isEmpty()) continue;
+
+        data.rangeStart = formats[ch].rangeStart;
+        data.rangeEnd = formats[ch].rangeEnd;
+        data.minimum = std::numeric_limits<qreal>::max();
+        data.maximum = std::numeric_limits<qreal>::lowest();
+
+        Q_FOREACH (const TileJob &job, jobs) {
+            const ChannelAccumulator &acc = job.channels[ch];
+
+            data.minimum = qMin(data.minimum, acc.minimum);
+            data.maximum = qMax(data.maximum, acc.maximum);
+            data.sum += acc.sum;
+            data.sumOfSquares += acc.sumOfSquares;
+
+            for (int i = 0; i < NumBins; i++) {
+                data.bins[i] += acc.bins[i];
+            }
+        }
+    }
+
+    return statistics;
+}
+
+int KisChannelStatistics::channelCount() const
+{
+    return m_channels.size();
+}
+
+quint64 KisChannelStatistics::pixelCount() const
+{
+    return m_pixelCount;
+}
+
+qreal KisChannelStatistics::minimum(int channel) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(channel >= 0 && channel < m_channels.size(), 0.0);
+    return m_channels[channel].minimum;
+}
+
+qreal KisChannelStatistics::maximum(int channel) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(channel >= 0 && channel < m_channels.size(), 0.0);
+    return m_channels[channel].maximum;
+}
+
+qreal KisChannelStatistics::mean(int channel) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(channel >= 0 && channel < m_channels.size(), 0.0);
+    return m_pixelCount ? m_channels[channel].sum / m_pixelCount : 0.0;
+}
+
+qreal KisChannelStatistics::variance(int channel) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(channel >= 0 && channel < m_channels.size(), 0.0);
+    if (!m_pixelCount) return 0.0;
+
+    const qreal channelMean = mean(channel);
+    return qMax(0.0, m_channels[channel].sumOfSquares / m_pixelCount - channelMean * channelMean);
+}
+
+qreal KisChannelStatistics::percentile(int channel, qreal fraction) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(channel >= 0 && channel < m_channels.size(), 0.0);
+    if (!m_pixelCount) return 0.0;
+
+    const ChannelData &data = m_channels[channel];
+    const qreal binWidth = (data.rangeEnd - data.rangeStart) / (NumBins - 1);
+    const qreal target = qBound(0.0, fraction, 1.0) * m_pixelCount;
+
+    quint64 count = 0;
+    for (int i = 0; i < NumBins; i++) {
+        count += data.bins[i];
+
+        if (count > 0 && count >= target) {
+            return qBound(data.minimum, data.rangeStart + i * binWidth, data.maximum);
+        }
+    }
+
+    return data.maximum;
+}
+
+QVector<quint32> KisChannelStatistics::histogram(int channel) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(channel >= 0 && channel < m_channels.size(), QVector<quint32>());
+    return m_channels[channel].bins;
+}
@@ -0,0 +1,99 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISCHANNELSTATISTICS_H
+#define KISCHANNELSTATISTICS_H
+
+#include <QSharedPointer>
+#include <QRect>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class KoColorSpace;
+
+/**
+ * KisChannelStatistics keeps the per-channel statistics of an area of
+ * a paint device: minimum, maximum, mean and variance of the values of
+ * every channel, and a histogram to look up the percentiles.
+ *
+ * All the statistics are gathered in a single pass over the pixels.
+ * The area is split by the tiles of the device and the tiles are
+ * processed concurrently.
+ *
+ * The channels are numbered in the order of KoColorSpace::channels().
+ * The values are in the native units of the channel, e.g. 0...65535 for
+ * 16-bit integer channels. The channels of unsupported types report
+ * zeros.
+ *
+ * Use KisPaintDevice::channelStatistics() to get the statistics cached
+ * until the next change of the device.
+ */
+class KRITAIMAGE_EXPORT KisChannelStatistics
+{
+public:
+    static const int NumBins = 256;
+
+public:
+    /**
+     * Gathers the statistics of \p rect of \p device. If \p colorSpace
+     * is set, the pixels are converted into it first.
+     *
+     * If \p progressUpdater is set, the progress is reported every time
+     * a batch of tiles is finished.
+     */
+    static KisChannelStatisticsSP calculate(const KisPaintDevice *device,
+                                            const QRect &rect,
+                                            const KoColorSpace *colorSpace = 0,
+                                            KoUpdater *progressUpdater = 0);
+
+    int channelCount() const;
+    quint64 pixelCount() const;
+
+    qreal minimum(int channel) const;
+    qreal maximum(int channel) const;
+    qreal mean(int channel) const;
+
+    /**
+     * The variance of the population, i.e. the mean of the squared
+     * differences from the mean
+     */
+    qreal variance(int channel) const;
+
+    /**
+     * Returns the value below which \p fraction of the values of the
+     * channel fall. The value is looked up in the histogram, so it is
+     * precise up to the width of a bin.
+     */
+    qreal percentile(int channel, qreal fraction) const;
+
+    /**
+     * The histogram of the channel. The bins are spread evenly over the
+     * range of the channel type, [0...1] for floating point channels.
+     */
+    QVector<quint32> histogram(int channel) const;
+
+private:
+    struct ChannelData {
+        qreal minimum = 0.0;
+        qreal maximum = 0.0;
+        qreal sum = 0.0;
+        qreal sumOfSquares = 0.0;
+
+        qreal rangeStart = 0.0;
+        qreal rangeEnd = 1.0;
+        QVector<quint32> bins;
+    };
+
+    KisChannelStatistics() = default;
+
+private:
+    QVector<ChannelData> m_channels;
+    quint64 m_pixelCount = 0;
+};
+
+#endif // KISCHANNELSTATISTICS_H
@@ -11,6 +11,7 @@ KisRecycleProjectionsJob::KisRecycleProjectionsJob(KisSafeNodeProjectionStoreBas
     : m_projectionStore(projectionStore)
 {
     setExclusive(true);
+    setPriority(KisStrokeJobData::BACKGROUND);
 }
 
 bool KisRecycleProjectionsJob::overrides(const KisSpontaneousJob *_otherJob)
@@ -0,0 +1,356 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisThumbnailDownscaler.h"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+#include <QSet>
+#include <QtMath>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoMixColorsOp.h>
+
+#include "kis_datamanager.h"
+#include "kis_paint_device.h"
+#include "kis_random_accessor_ng.h"
+#include "kis_shared_ptr.h"
+#include "tiles3/kis_tile.h"
+
+
+namespace {
+
+/**
+ * The first source coordinate of the bin of thumbnail pixel \p x.
+ * The formula must stay in sync with the one of the old point
+ * sampler, otherwise the thumbnails would shift by one pixel.
+ */
+inline int binStart(int x, int srcOrigin, int srcLength, int dstLength)
+{
+    return srcOrigin + int(qint64(x) * srcLength / dstLength);
+}
+
+/**
+ * The source positions sampled for every thumbnail pixel along one axis,
+ * stored as `count, pos0, pos1, ...` for each pixel of [start, start + length)
+ */
+QVector<int> samplePositions(int start, int length, int srcOrigin, int srcLength, int dstLength, int samples)
+{
+    QVector<int> result;
+    result.reserve(length * (samples + 1));
+
+    for (int x = start; x < start + length; x++) {
+        const int b0 = binStart(x, srcOrigin, srcLength, dstLength);
+        const int b1 = qMax(b0 + 1, binStart(x + 1, srcOrigin, srcLength, dstLength));
+        const int binSize = b1 - b0;
+        const int numSamples = qMin(samples, binSize);
+
+        result << numSamples;
+        for (int i = 0; i < numSamples; i++) {
+            result << b0 + i * binSize / numSamples;
+        }
+    }
+
+    return result;
+}
+
+void downscaleRect(const KisPaintDevice *src, KisPaintDeviceSP dst,
+                   const QRect &srcRect, const QSize &size, int samples,
+                   const QRect &rc)
+{
+    const int pixelSize = src->pixelSize();
+    const KoMixColorsOp *mixOp = src->colorSpace()->mixColorsOp();
+
+    const QVector<int> columns = samplePositions(rc.x(), rc.width(), srcRect.x(), srcRect.width(), size.width(), samples);
+    const QVector<int> rows = samplePositions(rc.y(), rc.height(), srcRect.y(), srcRect.height(), size.height(), samples);
+
+    const int blockSize = samples * samples * pixelSize;
+    QVector<quint8> blocks(rc.width() * blockSize);
+    QVector<quint8> dstRow(rc.width() * pixelSize);
+    QVector<int> numBlockPixels(rc.width());
+
+    KisRandomConstAccessorSP srcIt = src->createRandomConstAccessorNG();
+
+    const int *rowPtr = rows.constData();
+
+    for (int y = rc.y(); y <= rc.bottom(); y++) {
+        const int numRows = *rowPtr++;
+
+        std::fill(numBlockPixels.begin(), numBlockPixels.end(), 0);
+
+        /**
+         * Gather the samples of every bin into a continuous block, so that
+         * they could be passed to the mixColorsOp in one go. The samples
+         * are read row by row, so the accessor moves across the tiles in
+         * the same order they are stored in.
+         */
+        for (int j = 0; j < numRows; j++) {
+            const int srcY = *rowPtr++;
+            const int *columnPtr = columns.constData();
+
+            for (int i = 0; i < rc.width(); i++) {
+                const int numColumns = *columnPtr++;
+                quint8 *blockPtr = blocks.data() + i * blockSize + numBlockPixels[i] * pixelSize;
+
+                for (int k = 0; k < numColumns; k++) {
+                    srcIt->moveTo(*columnPtr++, srcY);
+                    memcpy(blockPtr, srcIt->rawDataConst(), pixelSize);
+                    blockPtr += pixelSize;
+                }
+
+                numBlockPixels[i] += numColumns;
+            }
+        }
+
+        for (int i = 0; i < rc.width(); i++) {
+            const quint8 *blockPtr = blocks.constData() + i * blockSize;
+            quint8 *dstPtr = dstRow.data() + i * pixelSize;
+
+            if (numBlockPixels[i] == 1) {
+                memcpy(dstPtr, blockPtr, pixelSize);
+            } else {
+                mixOp->mixColors(blockPtr, numBlockPixels[i], dstPtr);
+            }
+        }
+
+        dst->writeBytes(dstRow.constData(), rc.x(), y, rc.width(), 1);
+    }
+}
+
+int samplesForOversample(qreal oversample)
+{
+    /**
+     * More than 16x16 samples per pixel is not really visible
+     * in a thumbnail, but makes it very slow to generate.
+     */
+    return qBound(1, qCeil(oversample), 16);
+}
+
+}
+
+struct KisThumbnailDownscaler::Private
+{
+    /**
+     * The number of the thumbnails kept for incremental updates. Several
+     * views usually ask for the thumbnails of the same device in different
+     * sizes, e.g. the layers docker and the overview.
+     */
+    static const int maxCachedThumbnails = 4;
+
+    struct Thumbnail {
+        KisPaintDeviceSP device;
+        QRect srcRect;
+        QSize size;
+        int samples = 0;
+
+        /**
+         * The state of the source at the moment of the last update. If
+         * any of these change, the thumbnail is regenerated from scratch.
+         */
+        KisWeakSharedPtr<KisDataManager> sourceDataManager;
+        const KoColorSpace *sourceColorSpace = 0;
+        QPoint sourceOffset;
+        KoColor sourceDefaultPixel;
+
+        int writeEpoch = 0;
+        QSet<quint64> tiles;
+    };
+
+    QMutex mutex;
+
+    // the most recently used thumbnail goes first
+    QList<Thumbnail> thumbnails;
+
+    Thumbnail takeThumbnail(const QRect &srcRect, const QSize &size, int samples);
+};
+
+KisThumbnailDownscaler::Private::Thumbnail
+KisThumbnailDownscaler::Private::takeThumbnail(const QRect &srcRect, const QSize &size, int samples)
+{
+    for (int i = 0; i < thumbnails.size(); i++) {
+        const Thumbnail &thumbnail = thumbnails[i];
+
+        if (thumbnail.srcRect == srcRect &&
+            thumbnail.size == size &&
+            thumbnail.samples == samples) {
+
+            return thumbnails.takeAt(i);
+        }
+    }
+
+    return Thumbnail();
+}
+
+KisThumbnailDownscaler::KisThumbnailDownscaler()
+    : m_d(new Private)
+{
+}
+
+KisThumbnailDownscaler::~KisThumbnailDownscaler()
+{
+}
+
+QSize KisThumbnailDownscaler::thumbnailSize(const QRect &srcRect, const QSize &size)
+{
+    QSize result = size;
+
+    if (result.width() > srcRect.width() || result.height() > srcRect.height()) {
+        result.scale(srcRect.size(), Qt::KeepAspectRatio);
+    }
+
+    if (!result.width() && result.height()) {
+        result.setWidth(1);
+    }
+
+    if (result.width() && !result.height()) {
+        result.setHeight(1);
+    }
+
+    return result;
+}
+
+QRect KisThumbnailDownscaler::mapToThumbnail(const QRect &rc, const QRect &srcRect, const QSize &size)
+{
+    const QRect srcChangedRect = rc & srcRect;
+    if (srcChangedRect.isEmpty() || size.isEmpty()) return QRect();
+
+    // the last thumbnail pixel whose bin starts at or before the source position
+    auto toThumbnail = [] (int pos, int srcOrigin, int srcLength, int dstLength) {
+        return int((qint64(pos - srcOrigin + 1) * dstLength - 1) / srcLength);
+    };
+
+    const QRect result(QPoint(toThumbnail(srcChangedRect.left(), srcRect.x(), srcRect.width(), size.width()),
+                              toThumbnail(srcChangedRect.top(), srcRect.y(), srcRect.height(), size.height())),
+                       QPoint(toThumbnail(srcChangedRect.right(), srcRect.x(), srcRect.width(), size.width()),
+                              toThumbnail(srcChangedRect.bottom(), srcRect.y(), srcRect.height(), size.height())));
+
+    // a pixel of margin covers the rounding in the bin boundaries
+    return result.adjusted(-1, -1, 1, 1) & QRect(QPoint(), size);
+}
+
+KisPaintDeviceSP KisThumbnailDownscaler::downscale(const KisPaintDevice *src, const QRect &srcRect,
+                                                   const QSize &size, qreal oversample,
+                                                   const QRect &outputRect)
+{
+    KisPaintDeviceSP thumbnail = new KisPaintDevice(src->colorSpace());
+
+    if (srcRect.isEmpty() || size.isEmpty()) {
+        return thumbnail;
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_NOOP(size.width() <= srcRect.width() && size.height() <= srcRect.height());
+
+    QRect rc(QPoint(), size);
+    if (outputRect.isValid()) {
+        rc &= outputRect;
+    }
+
+    if (!rc.isEmpty()) {
+        downscaleRect(src, thumbnail, srcRect, size, samplesForOversample(oversample), rc);
+    }
+
+    return thumbnail;
+}
+
+KisPaintDeviceSP KisThumbnailDownscaler::thumbnailDevice(const KisPaintDevice *src, const QRect &srcRect, const QSize &size, qreal oversample)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    const int samples = samplesForOversample(oversample);
+
+    KisDataManagerSP dataManager = src->dataManager();
+    const QPoint offset(src->x(), src->y());
+    const KoColor defaultPixel = src->defaultPixel();
+
+    Private::Thumbnail thumbnail = m_d->takeThumbnail(srcRect, size, samples);
+
+    const bool canUpdateIncrementally =
+        thumbnail.device &&
+        thumbnail.sourceDataManager.isValid() &&
+        thumbnail.sourceDataManager == dataManager.data() &&
+        thumbnail.sourceColorSpace == src->colorSpace() &&
+        thumbnail.sourceOffset == offset &&
+        thumbnail.sourceDefaultPixel == defaultPixel;
+
+    /**
+     * Advance the epoch before reading the source, so that everything
+     * written during the update would be reported by the next call.
+     */
+    const int lastWriteEpoch = thumbnail.writeEpoch;
+    thumbnail.writeEpoch = KisTile::advanceWriteEpoch();
+
+    QSet<quint64> tiles;
+    QVector<QRect> changedTiles;
+    dataManager->collectChangedTiles(canUpdateIncrementally ? lastWriteEpoch : thumbnail.writeEpoch,
+                                     &tiles, &changedTiles);
+
+    if (!canUpdateIncrementally) {
+        thumbnail.device = downscale(src, srcRect, size, oversample);
+        thumbnail.srcRect = srcRect;
+        thumbnail.size = size;
+        thumbnail.samples = samples;
+        thumbnail.sourceDataManager = dataManager;
+        thumbnail.sourceColorSpace = src->colorSpace();
+        thumbnail.sourceOffset = offset;
+        thumbnail.sourceDefaultPixel = defaultPixel;
+    } else {
+        // the tiles removed since the last update have become transparent
+        for (auto it = thumbnail.tiles.constBegin(); it != thumbnail.tiles.constEnd(); ++it) {
+            if (!tiles.contains(*it)) {
+                changedTiles << KisDataManager::tileRectFromKey(*it);
+            }
+        }
+
+        QRegion dirtyRegion;
+        Q_FOREACH (const QRect &rc, changedTiles) {
+            const QRect thumbnailRect = mapToThumbnail(rc.translated(offset), srcRect, size);
+            if (!thumbnailRect.isEmpty()) {
+                dirtyRegion += thumbnailRect;
+            }
+        }
+
+        for (auto it = dirtyRegion.begin(); it != dirtyRegion.end(); ++it) {
+            downscaleRect(src, thumbnail.device, srcRect, size, samples, *it);
+        }
+    }
+
+    thumbnail.tiles = tiles;
+
+    KisPaintDeviceSP result = new KisPaintDevice(*thumbnail.device);
+
+    m_d->thumbnails.prepend(thumbnail);
+    while (m_d->thumbnails.size() > Private::maxCachedThumbnails) {
+        m_d->thumbnails.removeLast();
+    }
+
+    return result;
+}
+
+QImage KisThumbnailDownscaler::createThumbnail(const KisPaintDevice *src, qint32 w, qint32 h, qreal oversample,
+                                               KoColorConversionTransformation::Intent renderingIntent,
+                                               KoColorConversionTransformation::ConversionFlags conversionFlags)
+{
+    return createThumbnail(src, src->extent(), w, h, oversample, renderingIntent, conversionFlags);
+}
+
+QImage KisThumbnailDownscaler::createThumbnail(const KisPaintDevice *src, const QRect &srcRect,
+                                               qint32 w, qint32 h, qreal oversample,
+                                               KoColorConversionTransformation::Intent renderingIntent,
+                                               KoColorConversionTransformation::ConversionFlags conversionFlags)
+{
+    const QSize size = thumbnailSize(srcRect, QSize(w, h));
+
+    KisPaintDeviceSP thumbnail =
+        srcRect.isEmpty() || size.isEmpty() ?
+            new KisPaintDevice(src->colorSpace()) :
+            thumbnailDevice(src, srcRect, size, oversample);
+
+    return thumbnail->convertToQImage(KoColorSpaceRegistry::instance()->rgb8()->profile(), 0, 0, w, h, renderingIntent, conversionFlags);
+}
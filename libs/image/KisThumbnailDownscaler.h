@@ -0,0 +1,96 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTHUMBNAILDOWNSCALER_H
+#define KISTHUMBNAILDOWNSCALER_H
+
+#include <QScopedPointer>
+#include <QImage>
+
+#include <KoColorConversionTransformation.h>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * KisThumbnailDownscaler generates thumbnails of paint devices.
+ *
+ * Every pixel of the thumbnail corresponds to a rectangular bin of
+ * the source rect. The pixel is calculated as an average of up to
+ * `ceil(oversample)` x `ceil(oversample)` source pixels evenly
+ * distributed inside the bin (the average is done by the mixColorsOp
+ * of the color space, so it is alpha-weighted and works for any
+ * color space). With oversample equal to 1 it degrades into plain
+ * point sampling, which produces exactly the same result as the old
+ * per-pixel sampler of KisPaintDevice.
+ *
+ * Since every thumbnail pixel depends on its own bin only, the object
+ * can keep the last generated thumbnails and, on the next request,
+ * regenerate only the pixels covering the tiles that have been
+ * written since then (see KisTile::writeEpoch()). A few thumbnails
+ * of different source rects and sizes are kept at once.
+ */
+class KRITAIMAGE_EXPORT KisThumbnailDownscaler
+{
+public:
+    KisThumbnailDownscaler();
+    ~KisThumbnailDownscaler();
+
+    /**
+     * Returns the thumbnail of the whole extent of \p src as a QImage
+     * in sRGB. The thumbnail is updated incrementally if one of the
+     * recent calls used the same parameters and the same data manager.
+     *
+     * The function is thread-safe, but it is the caller's duty to make
+     * sure \p src doesn't change its data manager while the call is
+     * in progress.
+     */
+    QImage createThumbnail(const KisPaintDevice *src, qint32 w, qint32 h, qreal oversample,
+                           KoColorConversionTransformation::Intent renderingIntent,
+                           KoColorConversionTransformation::ConversionFlags conversionFlags);
+
+    /**
+     * Same as above, but for \p srcRect of \p src
+     */
+    QImage createThumbnail(const KisPaintDevice *src, const QRect &srcRect,
+                           qint32 w, qint32 h, qreal oversample,
+                           KoColorConversionTransformation::Intent renderingIntent,
+                           KoColorConversionTransformation::ConversionFlags conversionFlags);
+
+    /**
+     * Same as above, but returns a paint device in the color space of
+     * \p src. The device has the size returned by thumbnailSize().
+     */
+    KisPaintDeviceSP thumbnailDevice(const KisPaintDevice *src, const QRect &srcRect, const QSize &size, qreal oversample);
+
+    /**
+     * Shrinks \p size to fit into \p srcRect (thumbnails are never
+     * upscaled) and makes sure none of the dimensions is zero.
+     */
+    static QSize thumbnailSize(const QRect &srcRect, const QSize &size);
+
+    /**
+     * Downscales \p srcRect of \p src into a new device of size \p size.
+     * Only \p outputRect of the thumbnail is calculated if it is valid.
+     * \p size should already be fitted with thumbnailSize().
+     */
+    static KisPaintDeviceSP downscale(const KisPaintDevice *src, const QRect &srcRect,
+                                      const QSize &size, qreal oversample,
+                                      const QRect &outputRect = QRect());
+
+    /**
+     * Returns the rect of the thumbnail that depends on \p rc of the source
+     */
+    static QRect mapToThumbnail(const QRect &rc, const QRect &srcRect, const QSize &size);
+
+private:
+    Q_DISABLE_COPY(KisThumbnailDownscaler)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISTHUMBNAILDOWNSCALER_H
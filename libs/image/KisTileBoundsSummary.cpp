@@ -0,0 +1,280 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTileBoundsSummary.h"
+
+#include <algorithm>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceConstants.h>
+
+#include "kis_datamanager.h"
+#include "kis_paint_device.h"
+#include "kis_shared_ptr.h"
+#include "tiles3/kis_tile.h"
+
+
+namespace {
+
+struct TransparentPixelOp {
+    TransparentPixelOp(const KoColorSpace *colorSpace)
+        : m_colorSpace(colorSpace)
+    {
+    }
+
+    bool isPixelEmpty(const quint8 *pixelData) const {
+        return m_colorSpace->opacityU8(pixelData) == OPACITY_TRANSPARENT_U8;
+    }
+
+private:
+    const KoColorSpace *m_colorSpace;
+};
+
+struct DefaultPixelOp {
+    DefaultPixelOp(int pixelSize, const quint8 *defaultPixel)
+        : m_pixelSize(pixelSize),
+          m_defaultPixel(defaultPixel)
+    {
+    }
+
+    bool isPixelEmpty(const quint8 *pixelData) const {
+        return memcmp(m_defaultPixel, pixelData, m_pixelSize) == 0;
+    }
+
+private:
+    int m_pixelSize;
+    const quint8 *m_defaultPixel;
+};
+
+/**
+ * Returns the bounding rect of non-empty pixels of the tile in
+ * the coordinates of the tile
+ */
+template <class ComparePixelOp>
+QRect tileContentRect(const quint8 *data, int pixelSize, const ComparePixelOp &compareOp)
+{
+    const int rowStride = KisTileData::WIDTH * pixelSize;
+
+    auto isEmpty = [&] (int x, int y) {
+        return compareOp.isPixelEmpty(data + y * rowStride + x * pixelSize);
+    };
+
+    auto isRowEmpty = [&] (int y) {
+        for (int x = 0; x < KisTileData::WIDTH; x++) {
+            if (!isEmpty(x, y)) return false;
+        }
+        return true;
+    };
+
+    auto isColumnEmpty = [&] (int x, int top, int bottom) {
+        for (int y = top; y <= bottom; y++) {
+            if (!isEmpty(x, y)) return false;
+        }
+        return true;
+    };
+
+    int top = 0;
+    while (top < KisTileData::HEIGHT && isRowEmpty(top)) top++;
+
+    if (top >= KisTileData::HEIGHT) return QRect();
+
+    int bottom = KisTileData::HEIGHT - 1;
+    while (bottom > top && isRowEmpty(bottom)) bottom--;
+
+    int left = 0;
+    while (isColumnEmpty(left, top, bottom)) left++;
+
+    int right = KisTileData::WIDTH - 1;
+    while (right > left && isColumnEmpty(right, top, bottom)) right--;
+
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+inline qint32 tileColumn(quint64 key)
+{
+    return qint32(quint32(key >> 32));
+}
+
+inline qint32 tileRow(quint64 key)
+{
+    return qint32(quint32(key & 0xFFFFFFFF));
+}
+
+}
+
+struct KisTileBoundsSummary::Private
+{
+    QMutex mutex;
+
+    /**
+     * The state of the source at the moment of the last update. If
+     * any of these change, all the summaries are recalculated.
+     */
+    KisWeakSharedPtr<KisDataManager> sourceDataManager;
+    KoColor sourceDefaultPixel;
+    EmptyPixelCriterion criterion = TransparentPixelsAreEmpty;
+
+    int writeEpoch = 0;
+    QSet<quint64> tiles;
+
+    /**
+     * The bounding rects of non-empty pixels of the tiles
+     * in the coordinates of the data manager
+     */
+    QHash<quint64, QRect> summaries;
+};
+
+KisTileBoundsSummary::KisTileBoundsSummary()
+    : m_d(new Private)
+{
+}
+
+KisTileBoundsSummary::~KisTileBoundsSummary()
+{
+}
+
+QRect KisTileBoundsSummary::exactBounds(const KisPaintDevice *device, EmptyPixelCriterion criterion)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    KisDataManagerSP dataManager = device->dataManager();
+    const KoColor defaultPixel = device->defaultPixel();
+
+    const bool canUpdateIncrementally =
+        m_d->sourceDataManager.isValid() &&
+        m_d->sourceDataManager == dataManager.data() &&
+        m_d->sourceDefaultPixel == defaultPixel &&
+        m_d->criterion == criterion;
+
+    /**
+     * Advance the epoch before reading the source, so that everything
+     * written during the update would be reported by the next call.
+     */
+    const int lastWriteEpoch = m_d->writeEpoch;
+    m_d->writeEpoch = KisTile::advanceWriteEpoch();
+
+    QSet<quint64> tiles;
+    QVector<QRect> changedTiles;
+    dataManager->collectChangedTiles(canUpdateIncrementally ? lastWriteEpoch : m_d->writeEpoch,
+                                     &tiles, &changedTiles);
+
+    if (!canUpdateIncrementally) {
+        m_d->summaries.clear();
+        m_d->sourceDataManager = dataManager;
+        m_d->sourceDefaultPixel = defaultPixel;
+        m_d->criterion = criterion;
+    } else {
+        for (auto it = m_d->tiles.constBegin(); it != m_d->tiles.constEnd(); ++it) {
+            if (!tiles.contains(*it)) {
+                m_d->summaries.remove(*it);
+            }
+        }
+
+        Q_FOREACH (const QRect &rc, changedTiles) {
+            m_d->summaries.remove(KisDataManager::tileKey(rc.x() / KisTileData::WIDTH,
+                                                          rc.y() / KisTileData::HEIGHT));
+        }
+    }
+
+    m_d->tiles = tiles;
+
+    if (tiles.isEmpty()) return QRect();
+
+    const int pixelSize = device->pixelSize();
+    const TransparentPixelOp transparentOp(device->colorSpace());
+    const DefaultPixelOp defaultOp(pixelSize, defaultPixel.data());
+
+    /**
+     * The tiles filled with a single color share the same tile data,
+     * so there is no need to scan each of them
+     */
+    QHash<KisTileData*, QRect> tileDataSummaries;
+
+    auto summary = [&] (quint64 key) {
+        auto it = m_d->summaries.find(key);
+        if (it != m_d->summaries.end()) return *it;
+
+        const qint32 col = tileColumn(key);
+        const qint32 row = tileRow(key);
+
+        KisTileSP tile = dataManager->getTile(col, row, false);
+
+        QRect rc;
+
+        auto dataIt = tileDataSummaries.find(tile->tileData());
+        if (dataIt != tileDataSummaries.end()) {
+            rc = *dataIt;
+        } else {
+            tile->lockForRead();
+            rc = criterion == TransparentPixelsAreEmpty ?
+                tileContentRect(tile->data(), pixelSize, transparentOp) :
+                tileContentRect(tile->data(), pixelSize, defaultOp);
+            tile->unlockForRead();
+
+            tileDataSummaries.insert(tile->tileData(), rc);
+        }
+
+        if (!rc.isEmpty()) {
+            rc.translate(col * KisTileData::WIDTH, row * KisTileData::HEIGHT);
+        }
+
+        m_d->summaries.insert(key, rc);
+        return rc;
+    };
+
+    QVector<quint64> keysByRow = tiles.values().toVector();
+    std::sort(keysByRow.begin(), keysByRow.end(),
+              [] (quint64 a, quint64 b) {
+                  return tileRow(a) < tileRow(b) ||
+                      (tileRow(a) == tileRow(b) && tileColumn(a) < tileColumn(b));
+              });
+
+    QVector<quint64> keysByColumn = keysByRow;
+    std::sort(keysByColumn.begin(), keysByColumn.end(),
+              [] (quint64 a, quint64 b) {
+                  return tileColumn(a) < tileColumn(b) ||
+                      (tileColumn(a) == tileColumn(b) && tileRow(a) < tileRow(b));
+              });
+
+    /**
+     * Walks through the lines of tiles (rows or columns) in the
+     * given order and unites the summaries of the first line that
+     * has any non-empty tiles
+     */
+    auto firstNonEmptyLine = [&summary] (auto begin, auto end, auto lineOf) {
+        QRect result;
+
+        for (auto it = begin; it != end;) {
+            const qint32 line = lineOf(*it);
+
+            for (; it != end && lineOf(*it) == line; ++it) {
+                result |= summary(*it);
+            }
+
+            if (!result.isEmpty()) break;
+        }
+
+        return result;
+    };
+
+    const QRect topLine = firstNonEmptyLine(keysByRow.constBegin(), keysByRow.constEnd(), tileRow);
+    if (topLine.isEmpty()) return QRect();
+
+    const QRect bottomLine = firstNonEmptyLine(keysByRow.crbegin(), keysByRow.crend(), tileRow);
+    const QRect leftLine = firstNonEmptyLine(keysByColumn.constBegin(), keysByColumn.constEnd(), tileColumn);
+    const QRect rightLine = firstNonEmptyLine(keysByColumn.crbegin(), keysByColumn.crend(), tileColumn);
+
+    const QRect bounds(QPoint(leftLine.left(), topLine.top()),
+                       QPoint(rightLine.right(), bottomLine.bottom()));
+
+    return bounds.translated(device->x(), device->y());
+}
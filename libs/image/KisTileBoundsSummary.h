@@ -0,0 +1,62 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILEBOUNDSSUMMARY_H
+#define KISTILEBOUNDSSUMMARY_H
+
+#include <QScopedPointer>
+#include <QRect>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * KisTileBoundsSummary calculates the exact bounds of a paint device
+ * using per-tile summaries.
+ *
+ * The summary of a tile is the bounding rect of its non-empty pixels
+ * (an empty rect means the tile is uniformly empty). The exact bounds
+ * of the device are found by walking the tile rows and columns from
+ * the edges of the extent inwards: the tiles lying inside the bounds
+ * are never read.
+ *
+ * The summaries are kept between the calls. A summary is recalculated
+ * only when its tile has been written since the previous call (see
+ * KisTile::writeEpoch()), so the bounds of a big device after a small
+ * stroke are found without reading any pixels at all, unless the stroke
+ * touched the edge tiles.
+ */
+class KRITAIMAGE_EXPORT KisTileBoundsSummary
+{
+public:
+    enum EmptyPixelCriterion {
+        TransparentPixelsAreEmpty, ///< the pixels with zero opacity are empty
+        DefaultPixelsAreEmpty      ///< the pixels equal to the default pixel are empty
+    };
+
+public:
+    KisTileBoundsSummary();
+    ~KisTileBoundsSummary();
+
+    /**
+     * Returns the bounding rect of all non-empty pixels of \p device.
+     * The result is exactly the same as the one of the pixel scan of
+     * the device's extent.
+     *
+     * The function is thread-safe, but it is the caller's duty to make
+     * sure \p device doesn't change its data manager while the call is
+     * in progress. The device must not be in the wrap-around mode.
+     */
+    QRect exactBounds(const KisPaintDevice *device, EmptyPixelCriterion criterion);
+
+private:
+    Q_DISABLE_COPY(KisTileBoundsSummary)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISTILEBOUNDSSUMMARY_H
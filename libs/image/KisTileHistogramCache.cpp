@@ -0,0 +1,384 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTileHistogramCache.h"
+
+#include <functional>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QtConcurrent>
+
+#include <KoColor.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpace.h>
+
+#include "kis_assert.h"
+#include "kis_datamanager.h"
+#include "kis_paint_device.h"
+#include "kis_shared_ptr.h"
+#include "tiles3/kis_tile.h"
+
+
+namespace {
+
+const int numBins = 256;
+
+/**
+ * A tile has only 4096 pixels, so 16-bit counters are enough
+ */
+typedef QVector<quint16> TileBins;
+
+struct TileJob {
+    quint64 key;
+    QRect rect; // the part of the tile to count, in data manager coordinates
+    KisTileSP tile;
+    TileBins bins;
+};
+
+inline qint32 divideRoundDown(qint32 x, qint32 y)
+{
+    return x >= 0 ? x / y : -(((-x - 1) / y) + 1);
+}
+
+inline int greatestCommonDivisor(int a, int b)
+{
+    while (b) {
+        const int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+/**
+ * The phase of the samples is shifted by this factor on every row, so
+ * that the samples don't line up into the columns aligned to the tile
+ * grid. The factor is coprime to \p step, so every phase is used, and
+ * it is close to the golden section of the step, so that the phases of
+ * the consecutive rows are spread evenly.
+ */
+int rowPhaseFactor(int step)
+{
+    int factor = qMax(1, qRound(0.618 * step));
+    while (greatestCommonDivisor(factor, step) != 1) {
+        factor++;
+    }
+    return factor;
+}
+
+/**
+ * Calls \p func for the offset of every sampled pixel of \p rc inside
+ * the tile. The pixels are sampled by their position inside the tile,
+ * so the samples don't depend on the other tiles.
+ */
+template <class Func>
+inline void forEachSample(const QRect &tileRect, const QRect &rc, int step, Func func)
+{
+    const int left = rc.left() - tileRect.left();
+    const int right = rc.right() - tileRect.left();
+    const int phaseFactor = rowPhaseFactor(step);
+
+    for (int y = rc.top() - tileRect.top(); y <= rc.bottom() - tileRect.top(); y++) {
+        const int rowStart = y * KisTileData::WIDTH;
+        const int phase = (y * phaseFactor) % step;
+        const int firstX = left + ((phase - left) % step + step) % step;
+
+        for (int x = firstX; x <= right; x += step) {
+            func(rowStart + x);
+        }
+    }
+}
+
+int numSamples(const QRect &tileRect, const QRect &rc, int step)
+{
+    const int left = rc.left() - tileRect.left();
+    const int right = rc.right() - tileRect.left();
+    const int phaseFactor = rowPhaseFactor(step);
+
+    int result = 0;
+
+    for (int y = rc.top() - tileRect.top(); y <= rc.bottom() - tileRect.top(); y++) {
+        const int phase = (y * phaseFactor) % step;
+        const int firstX = left + ((phase - left) % step + step) % step;
+
+        if (firstX <= right) {
+            result += (right - firstX) / step + 1;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Bins the 8-bit pixels of a tile. Flat areas produce long runs of
+ * equal values, so the consecutive increments would hit the same bin
+ * and wait for each other. The samples are therefore spread over two
+ * sets of bins that are merged at the end. Every set gets at most half
+ * of the 4096 pixels, so the merged counters still fit into 16 bits.
+ *
+ * The channel count is a template parameter for the most common
+ * four-channel color spaces, so that the inner loop is unrolled. Zero
+ * means the count is taken from \p runtimeNumChannels.
+ */
+template <int staticNumChannels>
+void binTile8(TileJob &job, const quint8 *data, int pixelSize, int runtimeNumChannels, const QRect &tileRect, int step)
+{
+    const int numChannels = staticNumChannels > 0 ? staticNumChannels : runtimeNumChannels;
+
+    TileBins secondBins(job.bins.size(), 0);
+    quint16 *binSets[2] = {job.bins.data(), secondBins.data()};
+    int currentSet = 0;
+
+    forEachSample(tileRect, job.rect, step,
+        [&] (int index) {
+            const quint8 *pixel = data + index * pixelSize;
+            quint16 *bins = binSets[currentSet];
+            currentSet ^= 1;
+
+            for (int ch = 0; ch < numChannels; ch++) {
+                bins[ch * numBins + pixel[ch]]++;
+            }
+        });
+
+    quint16 *bins = binSets[0];
+    for (int i = 0; i < secondBins.size(); i++) {
+        bins[i] += secondBins[i];
+    }
+}
+
+void binTile(TileJob &job, int step, const KoColorSpace *colorSpace)
+{
+    const int pixelSize = colorSpace->pixelSize();
+    const int numChannels = colorSpace->channelCount();
+    const QRect tileRect = KisDataManager::tileRectFromKey(job.key);
+
+    job.bins.fill(0, numChannels * numBins);
+    quint16 *bins = job.bins.data();
+
+    job.tile->lockForRead();
+    const quint8 *data = job.tile->data();
+
+    if (colorSpace->colorDepthId() == Integer8BitsColorDepthID) {
+        if (numChannels == 4) {
+            binTile8<4>(job, data, pixelSize, numChannels, tileRect, step);
+        } else {
+            binTile8<0>(job, data, pixelSize, numChannels, tileRect, step);
+        }
+    } else {
+        forEachSample(tileRect, job.rect, step,
+            [=] (int index) {
+                const quint8 *pixel = data + index * pixelSize;
+                for (int ch = 0; ch < numChannels; ch++) {
+                    bins[ch * numBins + colorSpace->scaleToU8(pixel, ch)]++;
+                }
+            });
+    }
+
+    job.tile->unlockForRead();
+    job.tile.clear();
+}
+
+}
+
+struct KisTileHistogramCache::Private
+{
+    QMutex mutex;
+
+    /**
+     * The state of the source at the moment of the last update. If
+     * any of these change, all the tiles are binned from scratch.
+     */
+    KisWeakSharedPtr<KisDataManager> sourceDataManager;
+    const KoColorSpace *sourceColorSpace = 0;
+    QRect sourceRect; // in data manager coordinates
+    int sampleStep = 1;
+
+    int writeEpoch = 0;
+    QSet<quint64> tiles;
+    QHash<quint64, TileBins> tileBins;
+
+    /**
+     * The sum of all the tile histograms
+     */
+    QVector<quint64> totalBins;
+
+    void addTileBins(const TileBins &bins) {
+        for (int i = 0; i < bins.size(); i++) {
+            totalBins[i] += bins[i];
+        }
+    }
+
+    void removeTileBins(const TileBins &bins) {
+        for (int i = 0; i < bins.size(); i++) {
+            totalBins[i] -= bins[i];
+        }
+    }
+};
+
+KisTileHistogramCache::KisTileHistogramCache()
+    : m_d(new Private)
+{
+}
+
+KisTileHistogramCache::~KisTileHistogramCache()
+{
+}
+
+QVector<QVector<quint32>> KisTileHistogramCache::histogram(const KisPaintDevice *device, const QRect &rect, int sampleStep)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    KIS_SAFE_ASSERT_RECOVER(sampleStep > 0) { sampleStep = 1; }
+
+    KisDataManagerSP dataManager = device->dataManager();
+    const KoColorSpace *colorSpace = device->colorSpace();
+    const int numChannels = colorSpace->channelCount();
+    const QRect dataRect = rect.translated(-device->x(), -device->y());
+
+    const bool canUpdateIncrementally =
+        m_d->sourceDataManager.isValid() &&
+        m_d->sourceDataManager == dataManager.data() &&
+        m_d->sourceColorSpace == colorSpace &&
+        m_d->sourceRect == dataRect &&
+        m_d->sampleStep == sampleStep;
+
+    /**
+     * Advance the epoch before reading the source, so that everything
+     * written during the update would be reported by the next call.
+     */
+    const int lastWriteEpoch = m_d->writeEpoch;
+    m_d->writeEpoch = KisTile::advanceWriteEpoch();
+
+    QSet<quint64> tiles;
+    QVector<QRect> changedTiles;
+    dataManager->collectChangedTiles(canUpdateIncrementally ? lastWriteEpoch : m_d->writeEpoch,
+                                     &tiles, &changedTiles);
+
+    QSet<quint64> dirtyTiles;
+
+    if (!canUpdateIncrementally) {
+        m_d->tileBins.clear();
+        m_d->totalBins.fill(0, numChannels * numBins);
+        m_d->sourceDataManager = dataManager;
+        m_d->sourceColorSpace = colorSpace;
+        m_d->sourceRect = dataRect;
+        m_d->sampleStep = sampleStep;
+        dirtyTiles = tiles;
+    } else {
+        for (auto it = m_d->tiles.constBegin(); it != m_d->tiles.constEnd(); ++it) {
+            if (!tiles.contains(*it)) {
+                dirtyTiles << *it;
+            }
+        }
+
+        Q_FOREACH (const QRect &rc, changedTiles) {
+            dirtyTiles << KisDataManager::tileKey(rc.x() / KisTileData::WIDTH,
+                                                  rc.y() / KisTileData::HEIGHT);
+        }
+    }
+
+    m_d->tiles = tiles;
+
+    QVector<TileJob> jobs;
+
+    /**
+     * The tiles filled with a single color share the same tile data,
+     * so there is no need to bin each of them
+     */
+    QHash<KisTileData*, int> jobsByTileData;
+    QVector<QPair<quint64, int>> sharedJobs;
+
+    Q_FOREACH (quint64 key, dirtyTiles) {
+        auto it = m_d->tileBins.find(key);
+        if (it != m_d->tileBins.end()) {
+            m_d->removeTileBins(*it);
+            m_d->tileBins.erase(it);
+        }
+
+        if (!tiles.contains(key)) continue;
+
+        const QRect tileRect = KisDataManager::tileRectFromKey(key);
+        const QRect rc = tileRect & dataRect;
+        if (rc.isEmpty()) continue;
+
+        const qint32 col = tileRect.x() / KisTileData::WIDTH;
+        const qint32 row = tileRect.y() / KisTileData::HEIGHT;
+        KisTileSP tile = dataManager->getTile(col, row, false);
+
+        if (rc == tileRect) {
+            auto dataIt = jobsByTileData.constFind(tile->tileData());
+            if (dataIt != jobsByTileData.constEnd()) {
+                sharedJobs << qMakePair(key, *dataIt);
+                continue;
+            }
+            jobsByTileData.insert(tile->tileData(), jobs.size());
+        }
+
+        jobs << TileJob{key, rc, tile, TileBins()};
+    }
+
+    std::function<void(TileJob&)> binFunc =
+        [sampleStep, colorSpace] (TileJob &job) {
+            binTile(job, sampleStep, colorSpace);
+        };
+
+    QtConcurrent::blockingMap(jobs, binFunc);
+
+    Q_FOREACH (const TileJob &job, jobs) {
+        m_d->tileBins.insert(job.key, job.bins);
+        m_d->addTileBins(job.bins);
+    }
+
+    typedef QPair<quint64, int> SharedJob;
+    Q_FOREACH (const SharedJob &sharedJob, sharedJobs) {
+        const TileBins &bins = jobs[sharedJob.second].bins;
+        m_d->tileBins.insert(sharedJob.first, bins);
+        m_d->addTileBins(bins);
+    }
+
+    QVector<QVector<quint32>> result(numChannels);
+    for (int ch = 0; ch < numChannels; ch++) {
+        result[ch].resize(numBins);
+        for (int i = 0; i < numBins; i++) {
+            result[ch][i] = m_d->totalBins[ch * numBins + i];
+        }
+    }
+
+    if (dataRect.isEmpty()) return result;
+
+    /**
+     * The area not covered by the tiles is filled with the default
+     * pixel. It is sampled the same way as if there were tiles.
+     */
+    quint64 numDefaultPixels = 0;
+
+    const qint32 firstCol = divideRoundDown(dataRect.left(), KisTileData::WIDTH);
+    const qint32 lastCol = divideRoundDown(dataRect.right(), KisTileData::WIDTH);
+    const qint32 firstRow = divideRoundDown(dataRect.top(), KisTileData::HEIGHT);
+    const qint32 lastRow = divideRoundDown(dataRect.bottom(), KisTileData::HEIGHT);
+
+    for (qint32 row = firstRow; row <= lastRow; row++) {
+        for (qint32 col = firstCol; col <= lastCol; col++) {
+            const quint64 key = KisDataManager::tileKey(col, row);
+            if (tiles.contains(key)) continue;
+
+            const QRect tileRect = KisDataManager::tileRectFromKey(key);
+            numDefaultPixels += numSamples(tileRect, tileRect & dataRect, sampleStep);
+        }
+    }
+
+    if (numDefaultPixels) {
+        const KoColor defaultPixel = device->defaultPixel();
+        for (int ch = 0; ch < numChannels; ch++) {
+            result[ch][colorSpace->scaleToU8(defaultPixel.data(), ch)] += numDefaultPixels;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILEHISTOGRAMCACHE_H
+#define KISTILEHISTOGRAMCACHE_H
+
+#include <QScopedPointer>
+#include <QRect>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * KisTileHistogramCache calculates the per-channel histograms of a
+ * paint device tile by tile.
+ *
+ * Every tile gets its own small histogram, the tiles are binned
+ * concurrently. The histogram of the whole device is kept as a sum
+ * of the tile histograms.
+ *
+ * The tile histograms are kept between the calls. On the next request
+ * only the tiles that have been written since then (see
+ * KisTile::writeEpoch()) are binned again: their old histograms are
+ * subtracted from the sum and the new ones are added, so the update
+ * after a small stroke costs only a few tiles.
+ *
+ * Every histogram has 256 bins, the channel values are scaled with
+ * KoColorSpace::scaleToU8(). For 8-bit color spaces the pixel values
+ * are read directly, without any virtual calls.
+ */
+class KRITAIMAGE_EXPORT KisTileHistogramCache
+{
+public:
+    KisTileHistogramCache();
+    ~KisTileHistogramCache();
+
+    /**
+     * Returns the histograms of all the channels of \p device inside
+     * \p rect. The channels are numbered the same way as in
+     * KoColorSpace::scaleToU8().
+     *
+     * If \p sampleStep is greater than one, only every sampleStep'th
+     * pixel of every row of a tile is counted, with the phase shifted
+     * from row to row, so that the samples don't form columns aligned
+     * to the tile grid. Changing the rect or the step
+     * makes all the tiles to be binned again.
+     *
+     * The function is thread-safe, but it is the caller's duty to make
+     * sure \p device doesn't change its data manager while the call is
+     * in progress.
+     */
+    QVector<QVector<quint32>> histogram(const KisPaintDevice *device, const QRect &rect, int sampleStep = 1);
+
+private:
+    Q_DISABLE_COPY(KisTileHistogramCache)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISTILEHISTOGRAMCACHE_H
@@ -0,0 +1,391 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTiledOutlineGenerator.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QtConcurrent>
+
+#include "kis_assert.h"
+#include "kis_datamanager.h"
+#include "kis_paint_device.h"
+#include "kis_shared_ptr.h"
+#include "tiles3/kis_tile.h"
+
+
+namespace {
+
+/**
+ * The edges are oriented so that the selected pixel is always on the
+ * left-hand side of the edge. The values define the order in which
+ * KisOutlineGenerator checks the edges of a pixel.
+ */
+enum EdgeType {
+    TopEdge = 0,    // goes west
+    LeftEdge = 1,   // goes south
+    BottomEdge = 2, // goes east
+    RightEdge = 3   // goes north
+};
+
+/**
+ * A run of collinear edges of one tile. (x, y) is the topmost-leftmost
+ * pixel the run belongs to, it defines the order in which the polygons
+ * are discovered by the raster scan.
+ */
+struct Fragment {
+    QPoint start;
+    QPoint end;
+    int x;
+    int y;
+    EdgeType edge;
+};
+
+typedef QVector<Fragment> Fragments;
+
+inline QPoint edgeDirection(EdgeType edge)
+{
+    switch (edge) {
+    case TopEdge:
+        return QPoint(-1, 0);
+    case LeftEdge:
+        return QPoint(0, 1);
+    case BottomEdge:
+        return QPoint(1, 0);
+    case RightEdge:
+        break;
+    }
+    return QPoint(0, -1);
+}
+
+inline quint64 pointKey(const QPoint &pt)
+{
+    return (quint64(quint32(pt.x())) << 32) | quint32(pt.y());
+}
+
+inline bool discoveredBefore(const Fragment &a, const Fragment &b)
+{
+    return a.y < b.y ||
+        (a.y == b.y && (a.x < b.x ||
+                        (a.x == b.x && a.edge < b.edge)));
+}
+
+/**
+ * Finds the edge runs of the pixels of \p tileRect. The pixels
+ * outside the tile are read as well, since they define which edges
+ * of the border pixels belong to the outline.
+ */
+Fragments traceTile(const KisPaintDevice *device, const QRect &tileRect, quint8 unselectedValue)
+{
+    Fragments fragments;
+
+    const QRect readRect = tileRect.adjusted(-1, -1, 1, 1);
+    const int stride = readRect.width();
+
+    QVector<quint8> buffer(readRect.width() * readRect.height());
+    device->readBytes(buffer.data(), readRect);
+
+    const quint8 *pixels = buffer.constData() + stride + 1;
+
+    auto isSelected = [pixels, stride, unselectedValue] (int x, int y) {
+        return pixels[y * stride + x] != unselectedValue;
+    };
+
+    const int x0 = tileRect.x();
+    const int y0 = tileRect.y();
+    const int width = tileRect.width();
+    const int height = tileRect.height();
+
+    for (int y = 0; y < height; y++) {
+        int topRunStart = -1;
+        int bottomRunStart = -1;
+
+        for (int x = 0; x <= width; x++) {
+            const bool selected = x < width && isSelected(x, y);
+            const bool hasTop = selected && !isSelected(x, y - 1);
+            const bool hasBottom = selected && !isSelected(x, y + 1);
+
+            if (hasTop && topRunStart < 0) {
+                topRunStart = x;
+            } else if (!hasTop && topRunStart >= 0) {
+                fragments << Fragment{QPoint(x0 + x, y0 + y), QPoint(x0 + topRunStart, y0 + y),
+                                      x0 + topRunStart, y0 + y, TopEdge};
+                topRunStart = -1;
+            }
+
+            if (hasBottom && bottomRunStart < 0) {
+                bottomRunStart = x;
+            } else if (!hasBottom && bottomRunStart >= 0) {
+                fragments << Fragment{QPoint(x0 + bottomRunStart, y0 + y + 1), QPoint(x0 + x, y0 + y + 1),
+                                      x0 + bottomRunStart, y0 + y, BottomEdge};
+                bottomRunStart = -1;
+            }
+        }
+    }
+
+    for (int x = 0; x < width; x++) {
+        int leftRunStart = -1;
+        int rightRunStart = -1;
+
+        for (int y = 0; y <= height; y++) {
+            const bool selected = y < height && isSelected(x, y);
+            const bool hasLeft = selected && !isSelected(x - 1, y);
+            const bool hasRight = selected && !isSelected(x + 1, y);
+
+            if (hasLeft && leftRunStart < 0) {
+                leftRunStart = y;
+            } else if (!hasLeft && leftRunStart >= 0) {
+                fragments << Fragment{QPoint(x0 + x, y0 + leftRunStart), QPoint(x0 + x, y0 + y),
+                                      x0 + x, y0 + leftRunStart, LeftEdge};
+                leftRunStart = -1;
+            }
+
+            if (hasRight && rightRunStart < 0) {
+                rightRunStart = y;
+            } else if (!hasRight && rightRunStart >= 0) {
+                fragments << Fragment{QPoint(x0 + x + 1, y0 + y), QPoint(x0 + x + 1, y0 + rightRunStart),
+                                      x0 + x, y0 + rightRunStart, RightEdge};
+                rightRunStart = -1;
+            }
+        }
+    }
+
+    return fragments;
+}
+
+/**
+ * Stitches the fragments into closed polygons. The polygons are
+ * generated in the same order and with the same starting points as
+ * KisOutlineGenerator does, so the two generators are interchangeable.
+ */
+QVector<QPolygon> stitchFragments(const Fragments &fragments)
+{
+    QVector<QPolygon> polygons;
+
+    QMultiHash<quint64, int> fragmentsByStart;
+    fragmentsByStart.reserve(fragments.size());
+
+    QVector<int> order(fragments.size());
+    for (int i = 0; i < fragments.size(); i++) {
+        fragmentsByStart.insert(pointKey(fragments[i].start), i);
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(),
+              [&fragments] (int a, int b) {
+                  return discoveredBefore(fragments[a], fragments[b]);
+              });
+
+    QVector<bool> used(fragments.size(), false);
+    QVector<int> loop;
+
+    Q_FOREACH (int first, order) {
+        if (used[first]) continue;
+
+        loop.clear();
+        loop << first;
+        used[first] = true;
+
+        int current = first;
+
+        forever {
+            const QPoint currentDirection = edgeDirection(fragments[current].edge);
+            const QPoint rightTurn(-currentDirection.y(), currentDirection.x());
+
+            int next = -1;
+
+            /**
+             * Two outgoing edges can start at the same point only when
+             * two pixels touch diagonally. Like KisOutlineGenerator, we
+             * turn towards the other pixel then and join them into a
+             * single polygon.
+             */
+            auto it = fragmentsByStart.constFind(pointKey(fragments[current].end));
+            for (; it != fragmentsByStart.constEnd() && it.key() == pointKey(fragments[current].end); ++it) {
+                const int candidate = it.value();
+                if (used[candidate] && candidate != first) continue;
+
+                if (next < 0 || edgeDirection(fragments[candidate].edge) == rightTurn) {
+                    next = candidate;
+                }
+            }
+
+            KIS_SAFE_ASSERT_RECOVER(next >= 0) { break; }
+
+            if (next == first) break;
+
+            loop << next;
+            used[next] = true;
+            current = next;
+        }
+
+        /**
+         * Only the points where the direction changes are saved. The
+         * polygons starting at a bottom edge start at its beginning,
+         * all the others start at the corner following the first edge.
+         */
+        QPolygon polygon;
+        int firstCorner = -1;
+
+        for (int i = 1; i <= loop.size(); i++) {
+            const int index = i % loop.size();
+            const Fragment &fragment = fragments[loop[index]];
+            const Fragment &prevFragment = fragments[loop[i - 1]];
+
+            if (fragment.edge != prevFragment.edge) {
+                if (firstCorner < 0) {
+                    firstCorner = polygon.size();
+                }
+                polygon << fragment.start;
+            }
+        }
+
+        if (polygon.isEmpty()) continue;
+
+        if (fragments[first].edge == BottomEdge) {
+            std::rotate(polygon.begin(), polygon.end() - 1, polygon.end());
+        }
+
+        polygon << polygon.first();
+        polygons << polygon;
+    }
+
+    return polygons;
+}
+
+struct TileJob {
+    quint64 key;
+    QRect rect;
+    Fragments fragments;
+};
+
+}
+
+struct KisTiledOutlineGenerator::Private
+{
+    QMutex mutex;
+
+    /**
+     * The state of the source at the moment of the last update. If
+     * any of these change, all the tiles are traced from scratch.
+     */
+    KisWeakSharedPtr<KisDataManager> sourceDataManager;
+    QPoint sourceOffset;
+    quint8 unselectedValue = 0;
+
+    int writeEpoch = 0;
+    QSet<quint64> tiles;
+    QHash<quint64, Fragments> fragments;
+};
+
+KisTiledOutlineGenerator::KisTiledOutlineGenerator()
+    : m_d(new Private)
+{
+}
+
+KisTiledOutlineGenerator::~KisTiledOutlineGenerator()
+{
+}
+
+QVector<QPolygon> KisTiledOutlineGenerator::outline(const KisPaintDevice *device, quint8 unselectedValue)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(device->pixelSize() == 1, QVector<QPolygon>());
+
+    KisDataManagerSP dataManager = device->dataManager();
+    const QPoint offset(device->x(), device->y());
+
+    const bool canUpdateIncrementally =
+        m_d->sourceDataManager.isValid() &&
+        m_d->sourceDataManager == dataManager.data() &&
+        m_d->sourceOffset == offset &&
+        m_d->unselectedValue == unselectedValue;
+
+    /**
+     * Advance the epoch before reading the source, so that everything
+     * written during the update would be reported by the next call.
+     */
+    const int lastWriteEpoch = m_d->writeEpoch;
+    m_d->writeEpoch = KisTile::advanceWriteEpoch();
+
+    QSet<quint64> tiles;
+    QVector<QRect> changedTiles;
+    dataManager->collectChangedTiles(canUpdateIncrementally ? lastWriteEpoch : m_d->writeEpoch,
+                                     &tiles, &changedTiles);
+
+    QSet<quint64> dirtyTiles;
+
+    if (!canUpdateIncrementally) {
+        m_d->fragments.clear();
+        m_d->sourceDataManager = dataManager;
+        m_d->sourceOffset = offset;
+        m_d->unselectedValue = unselectedValue;
+        dirtyTiles = tiles;
+    } else {
+        // the tiles removed since the last update have become unselected
+        for (auto it = m_d->tiles.constBegin(); it != m_d->tiles.constEnd(); ++it) {
+            if (!tiles.contains(*it)) {
+                changedTiles << KisDataManager::tileRectFromKey(*it);
+            }
+        }
+
+        /**
+         * The edges of the border pixels of a tile depend on the pixels
+         * of the neighbouring tiles, so the neighbours are traced again
+         * as well.
+         */
+        Q_FOREACH (const QRect &rc, changedTiles) {
+            const qint32 col = rc.x() / KisTileData::WIDTH;
+            const qint32 row = rc.y() / KisTileData::HEIGHT;
+
+            dirtyTiles << KisDataManager::tileKey(col, row)
+                       << KisDataManager::tileKey(col - 1, row)
+                       << KisDataManager::tileKey(col + 1, row)
+                       << KisDataManager::tileKey(col, row - 1)
+                       << KisDataManager::tileKey(col, row + 1);
+        }
+    }
+
+    QVector<TileJob> jobs;
+
+    Q_FOREACH (quint64 key, dirtyTiles) {
+        if (tiles.contains(key)) {
+            jobs << TileJob{key, KisDataManager::tileRectFromKey(key).translated(offset), Fragments()};
+        } else {
+            m_d->fragments.remove(key);
+        }
+    }
+
+    std::function<void(TileJob&)> traceFunc =
+        [device, unselectedValue] (TileJob &job) {
+            job.fragments = traceTile(device, job.rect, unselectedValue);
+        };
+
+    QtConcurrent::blockingMap(jobs, traceFunc);
+
+    Q_FOREACH (const TileJob &job, jobs) {
+        if (job.fragments.isEmpty()) {
+            m_d->fragments.remove(job.key);
+        } else {
+            m_d->fragments.insert(job.key, job.fragments);
+        }
+    }
+
+    m_d->tiles = tiles;
+
+    Fragments allFragments;
+    for (auto it = m_d->fragments.constBegin(); it != m_d->fragments.constEnd(); ++it) {
+        allFragments += it.value();
+    }
+
+    return stitchFragments(allFragments);
+}
@@ -0,0 +1,61 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILEDOUTLINEGENERATOR_H
+#define KISTILEDOUTLINEGENERATOR_H
+
+#include <QScopedPointer>
+#include <QPolygon>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * KisTiledOutlineGenerator traces the outline of a selection-like
+ * (one byte per pixel) paint device tile by tile.
+ *
+ * For every tile of the device the generator finds the runs of pixel
+ * edges separating selected and unselected pixels. The tiles are
+ * processed concurrently, since every tile depends only on its own
+ * pixels and the one-pixel border around it. Then the fragments of all
+ * the tiles are stitched into closed polygons, merging the collinear
+ * fragments of the neighbouring tiles, so that only the corners of the
+ * outline get into the result.
+ *
+ * The fragments are cached between the calls. On the next request only
+ * the tiles that have been written since then (see KisTile::writeEpoch())
+ * and their direct neighbours are traced again.
+ *
+ * The result is exactly the same as the one of KisOutlineGenerator: the
+ * polygons come in the same order, start at the same points and
+ * diagonally touching pixels are joined into the same polygon.
+ */
+class KRITAIMAGE_EXPORT KisTiledOutlineGenerator
+{
+public:
+    KisTiledOutlineGenerator();
+    ~KisTiledOutlineGenerator();
+
+    /**
+     * Returns the outline of all the pixels of \p device not equal to
+     * \p unselectedValue. The default pixel of the device must be equal
+     * to \p unselectedValue, otherwise the outline would be infinite.
+     *
+     * The function is thread-safe, but it is the caller's duty to make
+     * sure \p device doesn't change its data manager while the call is
+     * in progress.
+     */
+    QVector<QPolygon> outline(const KisPaintDevice *device, quint8 unselectedValue);
+
+private:
+    Q_DISABLE_COPY(KisTiledOutlineGenerator)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISTILEDOUTLINEGENERATOR_H
@@ -188,12 +188,10 @@ QVector<QPointF> KisCageTransformWorker::Private::calculateTransformedPoints()
 {
     cage.generateTransformedCageNormals(transfCage);
 
+    QVector<QPointF> transformedPoints = cage.transformedPoints(transfCage);
     const int numValidPoints = validPoints.size();
-    QVector<QPointF> transformedPoints(numValidPoints);
 
     for (int i = 0; i < numValidPoints; i++) {
-        transformedPoints[i] = cage.transformedPoint(i, transfCage);
-
         if (qIsNaN(transformedPoints[i].x()) ||
             qIsNaN(transformedPoints[i].y())) {
             warnKrita << "WARNING: One grid point has been removed from consideration" << validPoints[i];
@@ -356,7 +354,7 @@ void KisCageTransformWorker::run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP ds
 
     GridIterationTools::PaintDevicePolygonOp polygonOp(srcDevice, tempDevice);
     Private::MapIndexesOp indexesOp(m_d.data());
-    GridIterationTools::iterateThroughGrid
+    GridIterationTools::iterateThroughGridConcurrently
         <GridIterationTools::IncompletePolygonPolicy>(polygonOp, indexesOp,
                                                       m_d->gridSize,
                                                       m_d->validPoints,
@@ -418,7 +416,7 @@ QImage KisCageTransformWorker::runOnQImage(QPointF *newOffset)
 
     GridIterationTools::QImagePolygonOp polygonOp(m_d->srcImage, tempImage, m_d->srcImageOffset, dstQImageOffset);
     Private::MapIndexesOp indexesOp(m_d.data());
-    GridIterationTools::iterateThroughGrid
+    GridIterationTools::iterateThroughGridConcurrently
         <GridIterationTools::IncompletePolygonPolicy>(polygonOp, indexesOp,
                                                       m_d->gridSize,
                                                       m_d->validPoints,
@@ -7,7 +7,12 @@
 #include "kis_green_coordinates_math.h"
 
 #include <cmath>
+#include <functional>
+
+#include <QtConcurrent>
+
 #include <kis_global.h>
+#include <kis_assert.h>
 #include <kis_algebra_2d.h>
 using namespace KisAlgebra2D;
 
@@ -19,25 +24,29 @@ using namespace KisAlgebra2D;
  * http://www.math.tau.ac.il/~lipmanya/GC/gc.htm
  */
 
-struct PrecalculatedCoords
-{
-    QVector<qreal> psi; // for each edge
-    QVector<qreal> phi; // for each vertex
-};
-
-
 struct Q_DECL_HIDDEN KisGreenCoordinatesMath::Private
 {
-    Private () : transformedCageDirection(0) {}
+    Private () : numCagePoints(0), transformedCageDirection(0) {}
+
+    int numCagePoints;
 
     QVector<qreal> originalCageEdgeSizes;
-    QVector<QPointF> transformedCageNormals;
+    QVector<qreal> transformedCageNormalsX;
+    QVector<qreal> transformedCageNormalsY;
     int transformedCageDirection;
 
-    QVector<PrecalculatedCoords> precalculatedCoords;
+    /**
+     * The coordinates of all the points are stored in two flat
+     * arrays, numCagePoints values per point: psi for each edge and
+     * phi for each vertex. The evaluation loop reads them contiguously,
+     * so the compiler can vectorize it.
+     */
+    QVector<qreal> psi;
+    QVector<qreal> phi;
 
     void precalculateOnePoint(const QVector<QPointF> &originalCage,
-                              PrecalculatedCoords *coords,
+                              qreal *psi,
+                              qreal *phi,
                               const QPointF &pt,
                               int polygonDirection);
 
@@ -48,6 +57,10 @@ struct Q_DECL_HIDDEN KisGreenCoordinatesMath::Private
                                     qreal *vertex1_phi,
                                     qreal *vertex2_phi,
                                     int polygonDirection);
+
+    inline QPointF transformOnePoint(int pointIndex,
+                                     const qreal *cageX,
+                                     const qreal *cageY) const;
 };
 
 inline void KisGreenCoordinatesMath::
@@ -89,7 +102,8 @@ Private::precalculateOneEdge(const QPointF &pt,
 }
 
 void KisGreenCoordinatesMath::Private::precalculateOnePoint(const QVector<QPointF> &originalCage,
-                                                            PrecalculatedCoords *coords,
+                                                            qreal *psi,
+                                                            qreal *phi,
                                                             const QPointF &pt,
                                                             int polygonDirection)
 {
@@ -105,13 +119,73 @@ void KisGreenCoordinatesMath::Private::precalculateOnePoint(const QVector<QPoint
         precalculateOneEdge(pt,
                             originalCage[startIndex],
                             originalCage[endIndex],
-                            &coords->psi[startIndex],
-                            &coords->phi[startIndex],
-                            &coords->phi[endIndex],
+                            &psi[startIndex],
+                            &phi[startIndex],
+                            &phi[endIndex],
                             polygonDirection);
     }
 }
 
+inline QPointF KisGreenCoordinatesMath::Private::transformOnePoint(int pointIndex,
+                                                                  const qreal *cageX,
+                                                                  const qreal *cageY) const
+{
+    const qreal *pointPsi = psi.constData() + pointIndex * numCagePoints;
+    const qreal *pointPhi = phi.constData() + pointIndex * numCagePoints;
+    const qreal *normalsX = transformedCageNormalsX.constData();
+    const qreal *normalsY = transformedCageNormalsY.constData();
+
+    /**
+     * Without -ffast-math the compiler is not allowed to reorder
+     * the sums, so we keep four independent partial sums ourselves
+     */
+    qreal x[4] = {0, 0, 0, 0};
+    qreal y[4] = {0, 0, 0, 0};
+
+    int i = 0;
+
+    for (; i + 4 <= numCagePoints; i += 4) {
+        for (int j = 0; j < 4; j++) {
+            x[j] += pointPhi[i + j] * cageX[i + j] + pointPsi[i + j] * normalsX[i + j];
+            y[j] += pointPhi[i + j] * cageY[i + j] + pointPsi[i + j] * normalsY[i + j];
+        }
+    }
+
+    for (; i < numCagePoints; i++) {
+        x[0] += pointPhi[i] * cageX[i] + pointPsi[i] * normalsX[i];
+        y[0] += pointPhi[i] * cageY[i] + pointPsi[i] * normalsY[i];
+    }
+
+    return QPointF((x[0] + x[1]) + (x[2] + x[3]),
+                   (y[0] + y[1]) + (y[2] + y[3]));
+}
+
+/**
+ * Splits [0, numPoints) into chunks big enough to be worth
+ * a separate job of the thread pool
+ */
+static QVector<QPair<int, int>> splitIntoChunks(int numPoints)
+{
+    const int chunkSize = 256;
+
+    QVector<QPair<int, int>> chunks;
+    for (int i = 0; i < numPoints; i += chunkSize) {
+        chunks << qMakePair(i, qMin(i + chunkSize, numPoints));
+    }
+    return chunks;
+}
+
+static void splitCage(const QVector<QPointF> &cage, QVector<qreal> *cageX, QVector<qreal> *cageY)
+{
+    cageX->resize(cage.size());
+    cageY->resize(cage.size());
+
+    for (int i = 0; i < cage.size(); i++) {
+        (*cageX)[i] = cage[i].x();
+        (*cageY)[i] = cage[i].y();
+    }
+}
+
 KisGreenCoordinatesMath::KisGreenCoordinatesMath()
     : m_d(new Private())
 {
@@ -137,17 +211,32 @@ void KisGreenCoordinatesMath::precalculateGreenCoordinates(const QVector<QPointF
             norm(originalCage[endIndex] - originalCage[startIndex]);
     }
 
-    m_d->precalculatedCoords.resize(numPoints);
+    m_d->numCagePoints = numCagePoints;
 
-    for (int i = 0; i < numPoints; i++) {
-        m_d->precalculatedCoords[i].psi.resize(numCagePoints);
-        m_d->precalculatedCoords[i].phi.resize(numCagePoints);
+    // phi values are accumulated, so they must start from zero
+    m_d->psi.fill(0.0, numPoints * numCagePoints);
+    m_d->phi.fill(0.0, numPoints * numCagePoints);
 
-        m_d->precalculateOnePoint(originalCage,
-                                  &m_d->precalculatedCoords[i],
-                                  points[i],
-                                  cageDirection);
-    }
+    /**
+     * Every point is independent from the others and writes
+     * only its own part of the arrays
+     */
+    qreal *psi = m_d->psi.data();
+    qreal *phi = m_d->phi.data();
+
+    std::function<void (const QPair<int, int> &)> processChunk =
+        [&] (const QPair<int, int> &chunk) {
+            for (int i = chunk.first; i < chunk.second; i++) {
+                m_d->precalculateOnePoint(originalCage,
+                                          psi + i * numCagePoints,
+                                          phi + i * numCagePoints,
+                                          points[i],
+                                          cageDirection);
+            }
+        };
+
+    QVector<QPair<int, int>> chunks = splitIntoChunks(numPoints);
+    QtConcurrent::blockingMap(chunks, processChunk);
 }
 
 void KisGreenCoordinatesMath::generateTransformedCageNormals(const QVector<QPointF> &transformedCage)
@@ -155,7 +244,8 @@ void KisGreenCoordinatesMath::generateTransformedCageNormals(const QVector<QPoin
     m_d->transformedCageDirection = polygonDirection(transformedCage);
 
     const int numCagePoints = transformedCage.size();
-    m_d->transformedCageNormals.resize(numCagePoints);
+    m_d->transformedCageNormalsX.resize(numCagePoints);
+    m_d->transformedCageNormalsY.resize(numCagePoints);
 
     for (int i = 1; i <= numCagePoints; i++) {
         int endIndex = i != numCagePoints ? i : 0;
@@ -167,25 +257,47 @@ void KisGreenCoordinatesMath::generateTransformedCageNormals(const QVector<QPoin
         qreal scaleCoeff =
             norm(transformedEdge) / m_d->originalCageEdgeSizes[startIndex];
 
-        m_d->transformedCageNormals[startIndex] =
+        const QPointF normal =
             scaleCoeff * inwardUnitNormal(transformedEdge, m_d->transformedCageDirection);
+
+        m_d->transformedCageNormalsX[startIndex] = normal.x();
+        m_d->transformedCageNormalsY[startIndex] = normal.y();
     }
 }
 
 QPointF KisGreenCoordinatesMath::transformedPoint(int pointIndex, const QVector<QPointF> &transformedCage)
 {
-    QPointF result;
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(transformedCage.size() == m_d->numCagePoints, QPointF());
 
-    const int numCagePoints = transformedCage.size();
+    QVector<qreal> cageX;
+    QVector<qreal> cageY;
+    splitCage(transformedCage, &cageX, &cageY);
 
+    return m_d->transformOnePoint(pointIndex, cageX.constData(), cageY.constData());
+}
 
-    PrecalculatedCoords *coords = &m_d->precalculatedCoords[pointIndex];
+QVector<QPointF> KisGreenCoordinatesMath::transformedPoints(const QVector<QPointF> &transformedCage)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(transformedCage.size() == m_d->numCagePoints, QVector<QPointF>());
 
-    for (int i = 0; i < numCagePoints; i++) {
-        result += coords->phi[i] * transformedCage[i];
-        result += coords->psi[i] * m_d->transformedCageNormals[i];
-    }
+    const int numPoints = m_d->numCagePoints > 0 ? m_d->psi.size() / m_d->numCagePoints : 0;
+    QVector<QPointF> result(numPoints);
+
+    QVector<qreal> cageX;
+    QVector<qreal> cageY;
+    splitCage(transformedCage, &cageX, &cageY);
+
+    QPointF *resultPtr = result.data();
+
+    std::function<void (const QPair<int, int> &)> processChunk =
+        [&] (const QPair<int, int> &chunk) {
+            for (int i = chunk.first; i < chunk.second; i++) {
+                resultPtr[i] = m_d->transformOnePoint(i, cageX.constData(), cageY.constData());
+            }
+        };
+
+    QVector<QPair<int, int>> chunks = splitIntoChunks(numPoints);
+    QtConcurrent::blockingMap(chunks, processChunk);
 
     return result;
 }
-
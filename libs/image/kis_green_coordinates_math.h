@@ -39,6 +39,13 @@ public:
      */
     QPointF transformedPoint(int pointIndex, const QVector<QPointF> &transformedCage);
 
+    /**
+     * Transform all the points passed to precalculateGreenCoordinates().
+     * The points are processed concurrently, which is much faster than
+     * calling transformedPoint() for every point.
+     */
+    QVector<QPointF> transformedPoints(const QVector<QPointF> &transformedCage);
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
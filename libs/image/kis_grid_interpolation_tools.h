@@ -9,14 +9,20 @@
 
 #include <limits>
 #include <algorithm>
+#include <functional>
+#include <numeric>
 
 #include <QImage>
+#include <QMap>
+#include <QtConcurrent>
+#include <QtMath>
 
 #include "kis_algebra_2d.h"
 #include "kis_four_point_interpolator_forward.h"
 #include "kis_four_point_interpolator_backward.h"
 #include "kis_iterator_ng.h"
 #include "kis_random_sub_accessor.h"
+#include "tiles3/kis_tile_data_interface.h"
 
 //#define DEBUG_PAINTING_POLYGONS
 
@@ -173,6 +179,9 @@ struct PaintDevicePolygonOp
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
         QRect boundRect = clipDstPolygon.boundingRect().toAlignedRect();
+        if (m_clipRect.isValid()) {
+            boundRect &= m_clipRect;
+        }
         if (boundRect.isEmpty()) return;
 
         KisSequentialIterator dstIt(m_dstDev, boundRect);
@@ -230,8 +239,27 @@ struct PaintDevicePolygonOp
 
     }
 
+    /**
+     * Limits all the writes to \p rc of the destination device
+     */
+    void setClipRect(const QRect &rc) {
+        m_clipRect = rc;
+    }
+
+    /**
+     * The origin of the tile rows of the destination device
+     */
+    int bandGridOrigin() const {
+        return m_dstDev->y();
+    }
+
+    bool supportsConcurrentRendering() const {
+        return true;
+    }
+
     KisPaintDeviceSP m_srcDev;
     KisPaintDeviceSP m_dstDev;
+    QRect m_clipRect;
 };
 
 struct QImagePolygonOp
@@ -245,6 +273,18 @@ struct QImagePolygonOp
           m_srcImageRect(m_srcImage.rect()),
           m_dstImageRect(m_dstImage.rect())
     {
+        /**
+         * Detach the destination image right here. QImage::setPixel()
+         * touches the shared data of the image, so the pixels are written
+         * through the raw pointer when the image is rendered by several
+         * threads at once.
+         */
+        if (m_dstImage.format() == QImage::Format_ARGB32 ||
+            m_dstImage.format() == QImage::Format_ARGB32_Premultiplied) {
+
+            m_dstBits = m_dstImage.bits();
+            m_dstBytesPerLine = m_dstImage.bytesPerLine();
+        }
     }
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon) {
@@ -253,6 +293,9 @@ struct QImagePolygonOp
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
         QRect boundRect = clipDstPolygon.boundingRect().toAlignedRect();
+        if (m_clipRect.isValid()) {
+            boundRect &= m_clipRect;
+        }
         KisFourPointInterpolatorBackward interp(srcPolygon, dstPolygon);
 
         for (int y = boundRect.top(); y <= boundRect.bottom(); y++) {
@@ -277,7 +320,12 @@ struct QImagePolygonOp
                     if (!m_dstImageRect.contains(srcPointI)) continue;
                     if (!m_srcImageRect.contains(dstPointI)) continue;
 
-                    m_dstImage.setPixel(srcPointI, m_srcImage.pixel(dstPointI));
+                    if (m_dstBits) {
+                        reinterpret_cast<QRgb*>(m_dstBits + srcPointI.y() * m_dstBytesPerLine)[srcPointI.x()] =
+                            m_srcImage.pixel(dstPointI);
+                    } else {
+                        m_dstImage.setPixel(srcPointI, m_srcImage.pixel(dstPointI));
+                    }
                 }
             }
         }
@@ -297,6 +345,25 @@ struct QImagePolygonOp
 
     }
 
+    /**
+     * Limits all the writes to \p rc (in the coordinates of the
+     * destination polygons)
+     */
+    void setClipRect(const QRect &rc) {
+        m_clipRect = rc;
+    }
+
+    /**
+     * Rows of the image never share any data, so any origin will do
+     */
+    int bandGridOrigin() const {
+        return 0;
+    }
+
+    bool supportsConcurrentRendering() const {
+        return m_dstBits;
+    }
+
     const QImage &m_srcImage;
     QImage &m_dstImage;
     QPointF m_srcImageOffset;
@@ -304,6 +371,10 @@ struct QImagePolygonOp
 
     QRect m_srcImageRect;
     QRect m_dstImageRect;
+    QRect m_clipRect;
+
+    uchar *m_dstBits = 0;
+    int m_dstBytesPerLine = 0;
 };
 
 /*************************************************************/
@@ -341,13 +412,10 @@ inline int pointToIndex(const QPoint &cellPt, const QSize &gridSize)
 namespace Private {
     inline QPoint pointPolygonIndexToColRow(QPoint baseColRow, int index)
     {
-        static QVector<QPoint> pointOffsets;
-        if (pointOffsets.isEmpty()) {
-            pointOffsets << QPoint(0,0);
-            pointOffsets << QPoint(1,0);
-            pointOffsets << QPoint(1,1);
-            pointOffsets << QPoint(0,1);
-        }
+        // a plain array, since the function may be called from several threads
+        static const QPoint pointOffsets[] = {
+            QPoint(0,0), QPoint(1,0), QPoint(1,1), QPoint(0,1)
+        };
 
         return baseColRow + pointOffsets[index];
     }
@@ -595,6 +663,44 @@ inline void adjustAlignedPolygon(QPolygonF &polygon)
     polygon[3] += p3;
 }
 
+template <template <class PolygonOp, class IndexesOp> class IncompletePolygonPolicy,
+          class PolygonOp,
+          class IndexesOp>
+inline void processGridCell(int col, int row,
+                            PolygonOp &polygonOp,
+                            IndexesOp &indexesOp,
+                            const QVector<QPointF> &originalPoints,
+                            const QVector<QPointF> &transformedPoints)
+{
+    int numExistingPoints = 0;
+
+    QVector<int> polygonPoints = indexesOp.calculateMappedIndexes(col, row, &numExistingPoints);
+
+    if (!IncompletePolygonPolicy<PolygonOp, IndexesOp>::
+         tryProcessPolygon(col, row,
+                           numExistingPoints,
+                           polygonOp,
+                           indexesOp,
+                           polygonPoints,
+                           originalPoints,
+                           transformedPoints)) {
+
+        QPolygonF srcPolygon;
+        QPolygonF dstPolygon;
+
+        for (int i = 0; i < 4; i++) {
+            const int index = polygonPoints[i];
+            srcPolygon << originalPoints[index];
+            dstPolygon << transformedPoints[index];
+        }
+
+        adjustAlignedPolygon(srcPolygon);
+        adjustAlignedPolygon(dstPolygon);
+
+        polygonOp(srcPolygon, dstPolygon);
+    }
+}
+
 template <template <class PolygonOp, class IndexesOp> class IncompletePolygonPolicy,
           class PolygonOp,
           class IndexesOp>
@@ -604,39 +710,225 @@ void iterateThroughGrid(PolygonOp &polygonOp,
                         const QVector<QPointF> &originalPoints,
                         const QVector<QPointF> &transformedPoints)
 {
-    QVector<int> polygonPoints(4);
-
     for (int row = 0; row < gridSize.height() - 1; row++) {
         for (int col = 0; col < gridSize.width() - 1; col++) {
-            int numExistingPoints = 0;
-
-            polygonPoints = indexesOp.calculateMappedIndexes(col, row, &numExistingPoints);
-
-            if (!IncompletePolygonPolicy<PolygonOp, IndexesOp>::
-                 tryProcessPolygon(col, row,
-                                   numExistingPoints,
-                                   polygonOp,
-                                   indexesOp,
-                                   polygonPoints,
-                                   originalPoints,
-                                   transformedPoints)) {
-
-                QPolygonF srcPolygon;
-                QPolygonF dstPolygon;
-
-                for (int i = 0; i < 4; i++) {
-                    const int index = polygonPoints[i];
-                    srcPolygon << originalPoints[index];
-                    dstPolygon << transformedPoints[index];
-                }
+            processGridCell<IncompletePolygonPolicy>(col, row,
+                                                     polygonOp, indexesOp,
+                                                     originalPoints,
+                                                     transformedPoints);
+        }
+    }
+}
+
+/*************************************************************/
+/*      Concurrent iteration                                 */
+/*************************************************************/
 
-                adjustAlignedPolygon(srcPolygon);
-                adjustAlignedPolygon(dstPolygon);
+/**
+ * A polygon op that renders nothing, but only accumulates the
+ * destination bounds of the polygons passed to it
+ */
+struct PolygonBoundsOp
+{
+    void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon) {
+        this->operator() (srcPolygon, dstPolygon, dstPolygon);
+    }
 
-                polygonOp(srcPolygon, dstPolygon);
-            }
+    void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
+        Q_UNUSED(srcPolygon);
+        Q_UNUSED(dstPolygon);
+        m_bounds |= clipDstPolygon.boundingRect().toAlignedRect();
+    }
+
+    QRect m_bounds;
+};
+
+/**
+ * Renders all the cells of a grid of size \p gridSize. \p cellOp should
+ * be callable as `cellOp(col, row, op)` for any polygon op and pass the
+ * polygons of the cell into \p op.
+ *
+ * The cells of the grid may overlap in the destination, and the one
+ * rendered last wins. So the destination is split into horizontal bands
+ * aligned to the tile rows of the destination of \p polygonOp. Every
+ * cell is put into all the bands its bounds cover, and then the bands
+ * are rendered on the global thread pool, each one by its own copy of
+ * \p polygonOp clipped to the band. Every band renders its cells in the
+ * order of the sequential iteration and owns its pixels exclusively,
+ * so the result is exactly the same as the one of the sequential
+ * iteration.
+ *
+ * If \p clipRect is valid, only the part of the destination inside
+ * it is rendered, the cells not intersecting it are skipped.
+ */
+template <class PolygonOp, class CellOp>
+void processCellsConcurrently(PolygonOp &polygonOp, const QSize &gridSize, CellOp cellOp,
+                              const QRect &clipRect = QRect())
+{
+    struct Band {
+        QRect rect;
+        QVector<int> cells;
+    };
+
+    const int numColumns = gridSize.width() - 1;
+    const int numCells = numColumns * (gridSize.height() - 1);
+
+    if (numCells <= 0) return;
+
+    if (!polygonOp.supportsConcurrentRendering()) {
+        PolygonOp clippedOp(polygonOp);
+        clippedOp.setClipRect(clipRect);
+
+        for (int i = 0; i < numCells; i++) {
+            cellOp(i % numColumns, i / numColumns, clippedOp);
+        }
+        return;
+    }
+
+    const int bandHeight = KisTileData::HEIGHT;
+    const int gridOrigin = polygonOp.bandGridOrigin();
+
+    QMap<int, Band> bandsMap;
+
+    for (int i = 0; i < numCells; i++) {
+        PolygonBoundsOp boundsOp;
+        cellOp(i % numColumns, i / numColumns, boundsOp);
+
+        const QRect bounds =
+            clipRect.isValid() ? boundsOp.m_bounds & clipRect : boundsOp.m_bounds;
+        if (bounds.isEmpty()) continue;
+
+        const int firstBand = qFloor(qreal(bounds.top() - gridOrigin) / bandHeight);
+        const int lastBand = qFloor(qreal(bounds.bottom() - gridOrigin) / bandHeight);
+
+        for (int band = firstBand; band <= lastBand; band++) {
+            const QRect bandRows(bounds.left(), gridOrigin + band * bandHeight,
+                                 bounds.width(), bandHeight);
+
+            Band &b = bandsMap[band];
+            b.rect |= bounds & bandRows;
+            b.cells.append(i);
         }
     }
+
+    QVector<Band> bands = QVector<Band>::fromList(bandsMap.values());
+
+    std::function<void (const Band &)> processBand =
+        [&] (const Band &band) {
+            PolygonOp bandOp(polygonOp);
+            bandOp.setClipRect(band.rect);
+
+            Q_FOREACH (int i, band.cells) {
+                cellOp(i % numColumns, i / numColumns, bandOp);
+            }
+        };
+
+    if (bands.size() > 1) {
+        QtConcurrent::blockingMap(bands, processBand);
+    } else {
+        std::for_each(bands.begin(), bands.end(), processBand);
+    }
+}
+
+/**
+ * Same as iterateThroughGrid(), but renders the grid concurrently
+ * (see processCellsConcurrently()). \p indexesOp may be called from
+ * several threads at once. If \p clipRect is valid, only that part
+ * of the destination is rendered.
+ */
+template <template <class PolygonOp, class IndexesOp> class IncompletePolygonPolicy,
+          class PolygonOp,
+          class IndexesOp>
+void iterateThroughGridConcurrently(PolygonOp &polygonOp,
+                                    IndexesOp &indexesOp,
+                                    const QSize &gridSize,
+                                    const QVector<QPointF> &originalPoints,
+                                    const QVector<QPointF> &transformedPoints,
+                                    const QRect &clipRect = QRect())
+{
+    processCellsConcurrently(polygonOp, gridSize,
+        [&] (int col, int row, auto &op) {
+            processGridCell<IncompletePolygonPolicy>(col, row,
+                                                     op, indexesOp,
+                                                     originalPoints,
+                                                     transformedPoints);
+        },
+        clipRect);
+}
+
+/**
+ * Same as processGrid() with a forward transform, but the grid points
+ * are transformed and the cells are rendered concurrently.
+ * \p transformOp may be called from several threads at once.
+ */
+template <class PolygonOp, class ForwardTransform>
+void processGridConcurrently(PolygonOp &polygonOp, ForwardTransform &transformOp,
+                             const QRect &srcBounds, const int pixelPrecision)
+{
+    if (srcBounds.isEmpty()) return;
+
+    struct PointsCollectorOp {
+        inline void processPoint(int col, int row,
+                                 int prevCol, int prevRow,
+                                 int colIndex, int rowIndex) {
+            Q_UNUSED(prevCol);
+            Q_UNUSED(prevRow);
+            Q_UNUSED(colIndex);
+            Q_UNUSED(rowIndex);
+
+            m_points << QPointF(col, row);
+        }
+
+        inline void nextLine() {
+        }
+
+        QVector<QPointF> m_points;
+    };
+
+    const QSize gridSize = calcGridSize(srcBounds, pixelPrecision);
+
+    PointsCollectorOp pointsOp;
+    processGrid(pointsOp, srcBounds, pixelPrecision);
+
+    const QVector<QPointF> &srcPoints = pointsOp.m_points;
+    KIS_SAFE_ASSERT_RECOVER_RETURN(srcPoints.size() == gridSize.width() * gridSize.height());
+
+    QVector<QPointF> dstPoints(srcPoints.size());
+    QPointF *dstPointsPtr = dstPoints.data();
+
+    QVector<int> rows(gridSize.height());
+    std::iota(rows.begin(), rows.end(), 0);
+
+    std::function<void (int)> transformRow =
+        [&] (int row) {
+            const int rowStart = row * gridSize.width();
+
+            for (int i = rowStart; i < rowStart + gridSize.width(); i++) {
+                dstPointsPtr[i] = transformOp(srcPoints[i]);
+            }
+        };
+
+    QtConcurrent::blockingMap(rows, transformRow);
+
+    /**
+     * The polygons are built exactly the same way as CellOp does it,
+     * so the result is the same as the one of processGrid()
+     */
+    processCellsConcurrently(polygonOp, gridSize,
+        [&] (int col, int row, auto &op) {
+            const int tl = pointToIndex(QPoint(col, row), gridSize);
+            const int tr = tl + 1;
+            const int bl = tl + gridSize.width();
+            const int br = bl + 1;
+
+            QPolygonF srcPolygon;
+            srcPolygon << srcPoints[tl] << srcPoints[tr] << srcPoints[br] << srcPoints[bl];
+
+            QPolygonF dstPolygon;
+            dstPolygon << dstPoints[tl] << dstPoints[tr] << dstPoints[br] << dstPoints[bl];
+
+            op(srcPolygon, dstPolygon);
+        });
 }
 
 }
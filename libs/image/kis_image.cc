@@ -80,6 +80,8 @@
 
 #include "kis_suspend_projection_updates_stroke_strategy.h"
 #include "kis_sync_lod_cache_stroke_strategy.h"
+#include "KisBackgroundLodSyncStrokeStrategy.h"
+#include "tiles3/kis_tile_data_store.h"
 
 #include "kis_projection_updates_filter.h"
 
@@ -231,6 +233,12 @@ public:
 
     bool wrapAroundModePermitted = false;
 
+    /**
+     * Set when the LoD pyramids may have been created, so that they
+     * could be released when instant preview is switched off
+     */
+    bool lodPyramidsInUse = false;
+
     QScopedPointer<KisUndoStore> undoStore;
     KisLegacyUndoAdapter legacyUndoAdapter;
     KisPostExecutionUndoAdapter postExecutionUndoAdapter;
@@ -2186,6 +2194,11 @@ bool KisImage::hasUpdatesRunning() const
     return m_d->scheduler.hasUpdatesRunning();
 }
 
+void KisImage::setCanvasViewportRect(const void *canvasId, const QRect &imageRect)
+{
+    m_d->scheduler.setViewportRect(canvasId, imageRect);
+}
+
 KisProjectionUpdatesFilterCookie KisImage::addProjectionUpdatesFilter(KisProjectionUpdatesFilterSP filter)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(filter, KisProjectionUpdatesFilterCookie());
@@ -2499,6 +2512,54 @@ void KisImage::explicitRegenerateLevelOfDetail()
     }
 }
 
+void KisImage::requestBackgroundLodSync()
+{
+    const KisLodPreferences pref = m_d->scheduler.lodPreferences();
+
+    if (!pref.lodSupported() || !pref.lodPreferred() ||
+        pref.desiredLevelOfDetail() <= 0) {
+
+        if (m_d->lodPyramidsInUse) {
+            m_d->lodPyramidsInUse = false;
+
+            KisStrokeId id = startStroke(new KisBackgroundLodSyncStrokeStrategy(KisImageWSP(this), 0, true));
+            endStroke(id);
+        }
+
+        return;
+    }
+
+    m_d->lodPyramidsInUse = true;
+
+    if (!m_d->scheduler.lodPyramidsNeedSynchronization()) return;
+
+    /**
+     * When the tiles don't fit into the memory anymore, keep only
+     * the level of the pyramids that is actually going to be used
+     */
+    const bool releaseOtherLevels =
+        KisTileDataStore::instance()->memoryMetric() >
+        MiB_TO_METRIC(qint64(KisImageConfig(true).tilesSoftLimit()));
+
+    /**
+     * The sync stroke is forgettable, so it doesn't bump the sequence
+     * number itself. If the image is changed while the stroke is running,
+     * the pyramids will still be reported as dirty after it finishes.
+     */
+    const int changeSeqNo = m_d->scheduler.lodPyramidsChangeSeqNo();
+
+    KisBackgroundLodSyncStrokeStrategy *strategy =
+        new KisBackgroundLodSyncStrokeStrategy(KisImageWSP(this), pref.desiredLevelOfDetail(), releaseOtherLevels);
+
+    strategy->setSyncFinishedCallback(
+        [this, changeSeqNo] () {
+            m_d->scheduler.notifyLodPyramidsSynchronized(changeSeqNo);
+        });
+
+    KisStrokeId id = startStroke(strategy);
+    endStroke(id);
+}
+
 void KisImage::setLodPreferences(const KisLodPreferences &value)
 {
     m_d->scheduler.setLodPreferences(value);
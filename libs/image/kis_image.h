@@ -743,6 +743,17 @@ public Q_SLOTS:
      */
     void explicitRegenerateLevelOfDetail();
 
+    /**
+     * Starts a forgettable stroke that updates the LoD pyramids of all
+     * the devices in the image at tile granularity, without touching
+     * the LoD planes. This way the synchronization that happens when
+     * the next LoD stroke starts has to process only the tiles changed
+     * after this call. The call does nothing if the image hasn't been
+     * changed since the last successful background sync. If LoD mode has been switched off, the call
+     * releases the pyramids instead.
+     */
+    void requestBackgroundLodSync();
+
 public:
 
     /**
@@ -1163,6 +1174,14 @@ public Q_SLOTS:
      */
     bool hasUpdatesRunning() const override;
 
+    /**
+     * Tells the image which part of it (in image pixels) is currently
+     * visible on the canvas \p canvasId. The projection updates of the
+     * visible areas are scheduled before all the other updates. An empty
+     * rect means the canvas doesn't show the image anymore.
+     */
+    void setCanvasViewportRect(const void *canvasId, const QRect &imageRect);
+
     /**
      * This method is called by the UI (*not* by the creator of the
      * stroke) when it thinks the current stroke should undo its last
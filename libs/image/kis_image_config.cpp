@@ -136,6 +136,17 @@ void KisImageConfig::setSchedulerBalancingRatio(qreal value)
     m_config.writeEntry("schedulerBalancingRatio", value);
 }
 
+bool KisImageConfig::prioritizeVisibleUpdates(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("prioritizeVisibleUpdates", true) : true;
+}
+
+void KisImageConfig::setPrioritizeVisibleUpdates(bool value)
+{
+    m_config.writeEntry("prioritizeVisibleUpdates", value);
+}
+
 int KisImageConfig::maxSwapSize(bool requestDefault) const
 {
     return !requestDefault ?
@@ -212,6 +223,39 @@ void KisImageConfig::setMemorySoftLimitPercent(qreal value)
     m_config.writeEntry("memorySoftLimitPercent", value);
 }
 
+bool KisImageConfig::compressUndoHistory(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("compressUndoHistory", true) : true;
+}
+
+void KisImageConfig::setCompressUndoHistory(bool value)
+{
+    m_config.writeEntry("compressUndoHistory", value);
+}
+
+bool KisImageConfig::swapUndoHistory(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("swapUndoHistory", true) : true;
+}
+
+void KisImageConfig::setSwapUndoHistory(bool value)
+{
+    m_config.writeEntry("swapUndoHistory", value);
+}
+
+bool KisImageConfig::compactSolidTiles(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("compactSolidTiles", true) : true;
+}
+
+void KisImageConfig::setCompactSolidTiles(bool value)
+{
+    m_config.writeEntry("compactSolidTiles", value);
+}
+
 qreal KisImageConfig::memoryPoolLimitPercent(bool requestDefault) const
 {
     return !requestDefault ?
@@ -530,6 +574,17 @@ void KisImageConfig::setUseLodForColorizeMask(bool value)
     m_config.writeEntry("useLodForColorizeMask", value);
 }
 
+bool KisImageConfig::useFastColorizeMaskFill(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("useFastColorizeMaskFill", false) : false;
+}
+
+void KisImageConfig::setUseFastColorizeMaskFill(bool value)
+{
+    m_config.writeEntry("useFastColorizeMaskFill", value);
+}
+
 int KisImageConfig::maxNumberOfThreads(bool defaultValue) const
 {
     return (defaultValue ? QThread::idealThreadCount() : m_config.readEntry("maxNumberOfThreads", QThread::idealThreadCount()));
@@ -617,6 +672,26 @@ void KisImageConfig::setAnimationCacheFrameSizeLimit(int value)
     m_config.writeEntry("animationCacheFrameSizeLimit", value);
 }
 
+int KisImageConfig::animationCacheMemoryLimit(bool defaultValue) const
+{
+    return defaultValue ? 0 : m_config.readEntry("animationCacheMemoryLimit", 0);
+}
+
+void KisImageConfig::setAnimationCacheMemoryLimit(int value)
+{
+    m_config.writeEntry("animationCacheMemoryLimit", value);
+}
+
+int KisImageConfig::animationCacheDiskLimit(bool defaultValue) const
+{
+    return defaultValue ? 0 : m_config.readEntry("animationCacheDiskLimit", 0);
+}
+
+void KisImageConfig::setAnimationCacheDiskLimit(int value)
+{
+    m_config.writeEntry("animationCacheDiskLimit", value);
+}
+
 bool KisImageConfig::useAnimationCacheRegionOfInterest(bool defaultValue) const
 {
     return defaultValue ? true : m_config.readEntry("useAnimationCacheRegionOfInterest", true);
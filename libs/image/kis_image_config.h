@@ -37,6 +37,9 @@ public:
     qreal schedulerBalancingRatio() const;
     void setSchedulerBalancingRatio(qreal value);
 
+    bool prioritizeVisibleUpdates(bool requestDefault = false) const;
+    void setPrioritizeVisibleUpdates(bool value);
+
     int maxSwapSize(bool requestDefault = false) const;
     void setMaxSwapSize(int value);
 
@@ -57,6 +60,27 @@ public:
     void setMemorySoftLimitPercent(qreal value);
     void setMemoryPoolLimitPercent(qreal value);
 
+    /**
+     * When enabled, the tiles of the undo history that were not accessed
+     * for a while are compressed in memory by the swapper thread
+     */
+    bool compressUndoHistory(bool requestDefault = false) const;
+    void setCompressUndoHistory(bool value);
+
+    /**
+     * When enabled, the undo history exceeding tilesSoftLimit() is
+     * moved into the swap file, the oldest revisions first
+     */
+    bool swapUndoHistory(bool requestDefault = false) const;
+    void setSwapUndoHistory(bool value);
+
+    /**
+     * When enabled, the tiles filled with a single color are compacted
+     * by the swapper thread into a single pixel
+     */
+    bool compactSolidTiles(bool requestDefault = false) const;
+    void setCompactSolidTiles(bool value);
+
     static int totalRAM(); // MiB
 
     /**
@@ -102,6 +126,15 @@ public:
     bool useLodForColorizeMask(bool requestDefault = false) const;
     void setUseLodForColorizeMask(bool value);
 
+    /**
+     * When enabled, colorize masks are filled with the tiled flood and
+     * refill only the basins reachable from the changed key strokes. It
+     * is faster, but the borders of the basins on plateaus may differ
+     * by a few pixels from the ones of the exact fill.
+     */
+    bool useFastColorizeMaskFill(bool requestDefault = false) const;
+    void setUseFastColorizeMaskFill(bool value);
+
     int maxNumberOfThreads(bool defaultValue = false) const;
     void setMaxNumberOfThreads(int value);
 
@@ -126,6 +159,23 @@ public:
     int animationCacheFrameSizeLimit(bool defaultValue = false) const;
     void setAnimationCacheFrameSizeLimit(int value);
 
+    /**
+     * @return the amount of RAM (in MiB) the on-disk animation cache
+     *         may use for keeping compressed frames before spilling
+     *         them to disk. Zero (the default) means that all the
+     *         frames are written to disk right away.
+     */
+    int animationCacheMemoryLimit(bool defaultValue = false) const;
+    void setAnimationCacheMemoryLimit(int value);
+
+    /**
+     * @return the maximum size (in MiB) of the on-disk animation cache,
+     *         zero means unlimited. When the limit is exceeded, the
+     *         frames farthest from the current time are evicted.
+     */
+    int animationCacheDiskLimit(bool defaultValue = false) const;
+    void setAnimationCacheDiskLimit(int value);
+
     bool useAnimationCacheRegionOfInterest(bool defaultValue = false) const;
     void setUseAnimationCacheRegionOfInterest(bool value);
 
@@ -32,7 +32,20 @@ struct Q_DECL_HIDDEN KisLiquifyTransformWorker::Private
     int pixelPrecision;
     QSize gridSize;
 
+    /**
+     * The area of the destination space covered by the cells whose
+     * points have been changed since the last resetDirtyRect()
+     */
+    QRectF dirtyRect;
+    bool fullyDirty = false;
+
     void preparePoints();
+    void markPointChanged(int index, const QPointF &oldPt);
+    void mapPointsToThumb(const QTransform &imageToThumbTransform,
+                          QVector<QPointF> *originalPointsLocal,
+                          QVector<QPointF> *transformedPointsLocal,
+                          QRectF *dstBounds,
+                          const QRectF &srcBounds) const;
 
     struct MapIndexesOp;
 
@@ -161,6 +174,27 @@ void KisLiquifyTransformWorker::Private::preparePoints()
     transformedPoints = pointsOp.m_points;
 }
 
+void KisLiquifyTransformWorker::Private::markPointChanged(int index, const QPointF &oldPt)
+{
+    /**
+     * The old and new polygons of every cell touching the point lie
+     * inside the bounds of the old position of the point and the
+     * current positions of its neighbours (the changed neighbours
+     * add their old positions themselves)
+     */
+    KisAlgebra2D::accumulateBounds(oldPt, &dirtyRect);
+
+    const int col = index % gridSize.width();
+    const int row = index / gridSize.width();
+
+    for (int y = qMax(0, row - 1); y <= qMin(gridSize.height() - 1, row + 1); y++) {
+        for (int x = qMax(0, col - 1); x <= qMin(gridSize.width() - 1, col + 1); x++) {
+            KisAlgebra2D::accumulateBounds(transformedPoints[GridIterationTools::pointToIndex(QPoint(x, y), gridSize)],
+                                           &dirtyRect);
+        }
+    }
+}
+
 void KisLiquifyTransformWorker::translate(const QPointF &offset)
 {
     QVector<QPointF>::iterator it = m_d->transformedPoints.begin();
@@ -174,6 +208,8 @@ void KisLiquifyTransformWorker::translate(const QPointF &offset)
         *it += offset;
         *refIt += offset;
     }
+
+    m_d->fullyDirty = true;
 }
 
 void KisLiquifyTransformWorker::translateDstSpace(const QPointF &offset)
@@ -184,6 +220,8 @@ void KisLiquifyTransformWorker::translateDstSpace(const QPointF &offset)
     for (; it != end; ++it) {
         *it += offset;
     }
+
+    m_d->fullyDirty = true;
 }
 
 void KisLiquifyTransformWorker::undoPoints(const QPointF &base,
@@ -211,7 +249,10 @@ void KisLiquifyTransformWorker::undoPoints(const QPointF &base,
 
         qreal lambda = exp(-0.5 * pow2(dist / sigma));
         lambda *= amount;
+
+        const QPointF oldPt = *it;
         *it = *refIt * lambda + *it * (1.0 - lambda);
+        m_d->markPointChanged(it - m_d->transformedPoints.begin(), oldPt);
     }
 }
 
@@ -236,7 +277,10 @@ processTransformedPixelsBuildUp(ProcessOp op,
         if (dist > maxDist) continue;
 
         const qreal lambda = exp(-0.5 * pow2(dist / sigma));
+
+        const QPointF oldPt = *it;
         *it = op(*it, base, diff, lambda);
+        markPointChanged(it - transformedPoints.begin(), oldPt);
     }
 }
 
@@ -269,7 +313,9 @@ processTransformedPixelsWash(ProcessOp op,
         QPointF dstPt = op(*refIt, base, diff, lambda);
 
         if (kisDistance(dstPt, *refIt) > kisDistance(*it, *refIt)) {
+            const QPointF oldPt = *it;
             *it = (1.0 - flow) * (*it) + flow * dstPt;
+            markPointChanged(it - transformedPoints.begin(), oldPt);
         }
     }
 }
@@ -399,10 +445,45 @@ void KisLiquifyTransformWorker::run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP
 
     PaintDevicePolygonOp polygonOp(srcDevice, dstDevice);
     RegularGridIndexesOp indexesOp(m_d->gridSize);
-    iterateThroughGrid<AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
-                                                    m_d->gridSize,
-                                                    m_d->originalPoints,
-                                                    m_d->transformedPoints);
+    iterateThroughGridConcurrently<AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
+                                                                m_d->gridSize,
+                                                                m_d->originalPoints,
+                                                                m_d->transformedPoints);
+}
+
+void KisLiquifyTransformWorker::run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice, const QRect &dstRect)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(*srcDevice->colorSpace() == *dstDevice->colorSpace());
+
+    if (dstRect.isEmpty()) return;
+
+    dstDevice->clear(dstRect);
+
+    using namespace GridIterationTools;
+
+    PaintDevicePolygonOp polygonOp(srcDevice, dstDevice);
+    RegularGridIndexesOp indexesOp(m_d->gridSize);
+    iterateThroughGridConcurrently<AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
+                                                                m_d->gridSize,
+                                                                m_d->originalPoints,
+                                                                m_d->transformedPoints,
+                                                                dstRect);
+}
+
+QRect KisLiquifyTransformWorker::dirtyRect() const
+{
+    return m_d->dirtyRect.toAlignedRect();
+}
+
+bool KisLiquifyTransformWorker::isFullyDirty() const
+{
+    return m_d->fullyDirty;
+}
+
+void KisLiquifyTransformWorker::resetDirtyRect()
+{
+    m_d->dirtyRect = QRectF();
+    m_d->fullyDirty = false;
 }
 
 QRect KisLiquifyTransformWorker::approxChangeRect(const QRect &rc)
@@ -445,6 +526,8 @@ void KisLiquifyTransformWorker::transformSrcAndDst(const QTransform &t)
     for (auto it = m_d->transformedPoints.begin(); it != m_d->transformedPoints.end(); ++it) {
         *it = t.map(*it);
     }
+
+    m_d->fullyDirty = true;
 }
 
 #include <functional>
@@ -460,6 +543,31 @@ PointMapFunction bindPointMapTransform(const QTransform &transform) {
     return std::bind(static_cast<MapFuncType>(&QTransform::map), &transform, _1);
 }
 
+void KisLiquifyTransformWorker::Private::mapPointsToThumb(const QTransform &imageToThumbTransform,
+                                                         QVector<QPointF> *originalPointsLocal,
+                                                         QVector<QPointF> *transformedPointsLocal,
+                                                         QRectF *dstBounds,
+                                                         const QRectF &srcBounds) const
+{
+    *originalPointsLocal = originalPoints;
+    *transformedPointsLocal = transformedPoints;
+
+    PointMapFunction mapFunc = bindPointMapTransform(imageToThumbTransform);
+
+    std::transform(originalPointsLocal->begin(), originalPointsLocal->end(),
+                   originalPointsLocal->begin(), mapFunc);
+
+    std::transform(transformedPointsLocal->begin(), transformedPointsLocal->end(),
+                   transformedPointsLocal->begin(), mapFunc);
+
+    *dstBounds = QRectF();
+    Q_FOREACH (const QPointF &pt, *transformedPointsLocal) {
+        KisAlgebra2D::accumulateBounds(pt, dstBounds);
+    }
+
+    *dstBounds |= srcBounds;
+}
+
 QImage KisLiquifyTransformWorker::runOnQImage(const QImage &srcImage,
                                               const QPointF &srcImageOffset,
                                               const QTransform &imageToThumbTransform,
@@ -477,24 +585,13 @@ QImage KisLiquifyTransformWorker::runOnQImage(const QImage &srcImage,
         return QImage();
     }
 
-    QVector<QPointF> originalPointsLocal(m_d->originalPoints);
-    QVector<QPointF> transformedPointsLocal(m_d->transformedPoints);
-
-    PointMapFunction mapFunc = bindPointMapTransform(imageToThumbTransform);
-
-    std::transform(originalPointsLocal.begin(), originalPointsLocal.end(),
-                   originalPointsLocal.begin(), mapFunc);
-
-    std::transform(transformedPointsLocal.begin(), transformedPointsLocal.end(),
-                   transformedPointsLocal.begin(), mapFunc);
-
+    QVector<QPointF> originalPointsLocal;
+    QVector<QPointF> transformedPointsLocal;
     QRectF dstBounds;
-    Q_FOREACH (const QPointF &pt, transformedPointsLocal) {
-        KisAlgebra2D::accumulateBounds(pt, &dstBounds);
-    }
 
-    const QRectF srcBounds(srcImageOffset, srcImage.size());
-    dstBounds |= srcBounds;
+    m_d->mapPointsToThumb(imageToThumbTransform,
+                          &originalPointsLocal, &transformedPointsLocal,
+                          &dstBounds, QRectF(srcImageOffset, srcImage.size()));
 
     QPointF dstQImageOffset = dstBounds.topLeft();
     *newOffset = dstQImageOffset;
@@ -506,7 +603,7 @@ QImage KisLiquifyTransformWorker::runOnQImage(const QImage &srcImage,
 
     GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage, srcImageOffset, dstQImageOffset);
     GridIterationTools::RegularGridIndexesOp indexesOp(m_d->gridSize);
-    GridIterationTools::iterateThroughGrid
+    GridIterationTools::iterateThroughGridConcurrently
         <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
                                                           m_d->gridSize,
                                                           originalPointsLocal,
@@ -514,6 +611,73 @@ QImage KisLiquifyTransformWorker::runOnQImage(const QImage &srcImage,
     return dstImage;
 }
 
+bool KisLiquifyTransformWorker::updateQImage(const QImage &srcImage,
+                                             const QPointF &srcImageOffset,
+                                             const QTransform &imageToThumbTransform,
+                                             const QRect &dirtyRect,
+                                             QImage *dstImage,
+                                             const QPointF &dstImageOffset)
+{
+    KIS_ASSERT_RECOVER(m_d->originalPoints.size() == m_d->transformedPoints.size()) {
+        return false;
+    }
+
+    KIS_ASSERT_RECOVER(!srcImage.isNull() && srcImage.format() == QImage::Format_ARGB32) {
+        return false;
+    }
+
+    if (dstImage->format() != srcImage.format()) return false;
+
+    QVector<QPointF> originalPointsLocal;
+    QVector<QPointF> transformedPointsLocal;
+    QRectF dstBounds;
+
+    m_d->mapPointsToThumb(imageToThumbTransform,
+                          &originalPointsLocal, &transformedPointsLocal,
+                          &dstBounds, QRectF(srcImageOffset, srcImage.size()));
+
+    /**
+     * If the bounds of the grid have changed, the image has to be
+     * reallocated with a different offset, so the pixels would be
+     * sampled differently. Let the caller render it from scratch.
+     */
+    if (dstBounds.topLeft() != dstImageOffset ||
+        dstBounds.toAlignedRect().size() != dstImage->size()) {
+
+        return false;
+    }
+
+    if (dirtyRect.isEmpty()) return true;
+
+    // a pixel of margin covers the rounding of the polygons' bounds
+    const QRect thumbDirtyRect =
+        imageToThumbTransform.mapRect(QRectF(dirtyRect)).toAlignedRect().adjusted(-1, -1, 1, 1);
+
+    /**
+     * QImagePolygonOp writes the integer point of the destination space
+     * into the pixel it is rounded to after subtracting the offset, so
+     * clear exactly the pixels the dirty rect maps to
+     */
+    const QRect imageDirtyRect =
+        QRect((QPointF(thumbDirtyRect.topLeft()) - dstImageOffset).toPoint(),
+              (QPointF(thumbDirtyRect.bottomRight()) - dstImageOffset).toPoint()) & dstImage->rect();
+
+    for (int y = imageDirtyRect.top(); y <= imageDirtyRect.bottom(); y++) {
+        QRgb *line = reinterpret_cast<QRgb*>(dstImage->scanLine(y));
+        std::fill(line + imageDirtyRect.left(), line + imageDirtyRect.right() + 1, 0);
+    }
+
+    GridIterationTools::QImagePolygonOp polygonOp(srcImage, *dstImage, srcImageOffset, dstImageOffset);
+    GridIterationTools::RegularGridIndexesOp indexesOp(m_d->gridSize);
+    GridIterationTools::iterateThroughGridConcurrently
+        <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
+                                                          m_d->gridSize,
+                                                          originalPointsLocal,
+                                                          transformedPointsLocal,
+                                                          thumbDirtyRect);
+    return true;
+}
+
 void KisLiquifyTransformWorker::toXML(QDomElement *e) const
 {
     QDomDocument doc = e->ownerDocument();
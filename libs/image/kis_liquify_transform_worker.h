@@ -64,11 +64,50 @@ public:
     QVector<QPointF>& transformedPoints();
 
     void run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice);
+
+    /**
+     * Re-renders only \p dstRect of \p dstDevice. The rest of the
+     * device is expected to be rendered by a previous run() with the
+     * same source.
+     */
+    void run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice, const QRect &dstRect);
+
     QImage runOnQImage(const QImage &srcImage,
                        const QPointF &srcImageOffset,
                        const QTransform &imageToThumbTransform,
                        QPointF *newOffset);
 
+    /**
+     * Re-renders \p dirtyRect (in image coordinates) of \p dstImage,
+     * which has been generated by runOnQImage() with the same source
+     * image and transform and placed at \p dstImageOffset.
+     *
+     * Returns false if the image cannot be updated in place, because
+     * the bounds of the transformed grid have changed. In such a case
+     * the image should be regenerated with runOnQImage().
+     */
+    bool updateQImage(const QImage &srcImage,
+                      const QPointF &srcImageOffset,
+                      const QTransform &imageToThumbTransform,
+                      const QRect &dirtyRect,
+                      QImage *dstImage,
+                      const QPointF &dstImageOffset);
+
+    /**
+     * The rect of the destination space affected by the changes
+     * of the points since the last call to resetDirtyRect(). It
+     * covers both old and new positions of all the changed cells.
+     */
+    QRect dirtyRect() const;
+
+    /**
+     * True if the whole grid has been moved since the last call to
+     * resetDirtyRect(), so dirtyRect() is meaningless.
+     */
+    bool isFullyDirty() const;
+
+    void resetDirtyRect();
+
     void toXML(QDomElement *e) const;
     static KisLiquifyTransformWorker* fromXML(const QDomElement &e);
 
@@ -9,6 +9,8 @@
 #include <QGlobalStatic>
 #include <QApplication>
 
+#include <atomic>
+
 #include "kis_image.h"
 #include "kis_image_config.h"
 #include "kis_signal_compressor.h"
@@ -25,6 +27,7 @@ struct Q_DECL_HIDDEN KisMemoryStatisticsServer::Private
     }
 
     KisSignalCompressor updateCompressor;
+    std::atomic<qint64> animationCacheSize {0};
 };
 
 
@@ -141,10 +144,14 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.totalMemorySize = tileStats.totalMemorySize;
     stats.realMemorySize = tileStats.realMemorySize;
     stats.historicalMemorySize = tileStats.historicalMemorySize;
+    stats.historicalCompressedSize = tileStats.historicalCompressedSize;
+    stats.historicalSwapSize = tileStats.historicalSwapSize;
     stats.poolSize = tileStats.poolSize;
 
     stats.swapSize = tileStats.swapSize;
 
+    stats.animationCacheSize = m_d->animationCacheSize;
+
     KisImageConfig cfg(true);
 
     stats.tilesHardLimit = cfg.tilesHardLimit() * MiB;
@@ -155,6 +162,11 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     return stats;
 }
 
+void KisMemoryStatisticsServer::addAnimationCacheMemory(qint64 delta)
+{
+    m_d->animationCacheSize += delta;
+}
+
 void KisMemoryStatisticsServer::tryForceUpdateMemoryStatisticsWhileIdle()
 {
     KisTileDataStore::instance()->tryForceUpdateMemoryStatisticsWhileIdle();
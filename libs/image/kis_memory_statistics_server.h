@@ -30,10 +30,14 @@ public:
               totalMemorySize(0),
               realMemorySize(0),
               historicalMemorySize(0),
+              historicalCompressedSize(0),
+              historicalSwapSize(0),
               poolSize(0),
 
               swapSize(0),
 
+              animationCacheSize(0),
+
               totalMemoryLimit(0),
               tilesHardLimit(0),
               tilesSoftLimit(0),
@@ -48,11 +52,15 @@ public:
 
         qint64 totalMemorySize;
         qint64 realMemorySize;
-        qint64 historicalMemorySize;
+        qint64 historicalMemorySize; // uncompressed undo data in memory
+        qint64 historicalCompressedSize; // undo data compressed in memory
+        qint64 historicalSwapSize; // undo data in the swap file (uncompressed size)
         qint64 poolSize;
 
         qint64 swapSize;
 
+        qint64 animationCacheSize; // animation frames kept in RAM outside of the tiles engine
+
         qint64 totalMemoryLimit;
         qint64 tilesHardLimit;
         qint64 tilesSoftLimit;
@@ -68,6 +76,13 @@ public:
 
     Statistics fetchMemoryStatistics(KisImageSP image) const;
 
+    /**
+     * The animation frame cache keeps some of its frames in RAM without
+     * using the tiles engine. It reports the change of that amount via
+     * this call. Thread-safe.
+     */
+    void addAnimationCacheMemory(qint64 delta);
+
 public Q_SLOTS:
     void notifyImageChanged();
     void tryForceUpdateMemoryStatisticsWhileIdle();
@@ -13,6 +13,8 @@
 #include <QImage>
 #include <QList>
 #include <QHash>
+#include <QMap>
+#include <QSet>
 #include <QIODevice>
 #include <qmath.h>
 #include <KisRegion.h>
@@ -43,6 +45,7 @@
 #include "tiles3/kis_hline_iterator.h"
 #include "tiles3/kis_vline_iterator.h"
 #include "tiles3/kis_random_accessor.h"
+#include "tiles3/kis_tile.h"
 
 #include "kis_default_bounds.h"
 
@@ -54,8 +57,7 @@
 #include "kis_paint_device_data.h"
 #include "kis_paint_device_frames_interface.h"
 
-#include "kis_transform_worker.h"
-#include "kis_filter_strategy.h"
+#include "KisThumbnailDownscaler.h"
 #include "krita_utils.h"
 
 
@@ -418,9 +420,34 @@ public:
 
     struct LodDataStructImpl;
     LodDataStruct* createLodDataStruct(int lod);
+    LodDataStruct* createLodDataStruct(int lod, KisRegion *syncRegion);
+    KisPaintDeviceSP createLodPyramidClone(int maxLod, int *lod) const;
+    void releaseLodPyramid(int keptLod);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
     KisRegion regionForLodSyncing() const;
+    KisRegion regionForLodSyncing(int lod) const;
+
+    struct LodPyramidLevel {
+        DataSP data;
+
+        /**
+         * The state of the source at the moment of the last sync. If any
+         * of these change, the level is regenerated from scratch.
+         */
+        KisWeakSharedPtr<KisDataManager> sourceDataManager;
+        const KoColorSpace *sourceColorSpace = 0;
+        QPoint sourceOffset;
+        QByteArray sourceDefaultPixel;
+
+        int syncedWriteEpoch = 0;
+        QSet<quint64> syncedTiles;
+        int generation = 0;
+    };
+
+    bool isLodPyramidLevelValid(const LodPyramidLevel &level, Data *srcData) const;
+    KisRegion changedRegionSinceSync(const LodPyramidLevel &level, Data *srcData, QSet<quint64> *tiles) const;
+    void commitLodDataStruct(LodDataStruct *dst);
 
     void updateLodDataManager(KisDataManager *srcDataManager,
                               KisDataManager *dstDataManager, const QPoint &srcOffset, const QPoint &dstOffset,
@@ -452,6 +479,13 @@ public:
             lodData += estimateDataSize(m_lodData.data());
         }
 
+        {
+            QMutexLocker l(&m_lodPyramidLock);
+            for (auto it = m_lodPyramid.constBegin(); it != m_lodPyramid.constEnd(); ++it) {
+                lodData += estimateDataSize(it->data.data());
+            }
+        }
+
         if (m_externalFrameData) {
             temporaryData += estimateDataSize(m_externalFrameData.data());
         }
@@ -599,6 +633,19 @@ private:
 
     FramesHash m_frames;
     int m_nextFreeFrameId;
+
+    /**
+     * Downscaled copies of the current frame, one per level of
+     * detail. The levels are kept between LoD syncs, so only the
+     * tiles changed since the previous sync have to be recalculated.
+     */
+    QMap<int, LodPyramidLevel> m_lodPyramid;
+
+    /**
+     * Guards m_lodPyramid: the memory statistics are collected while
+     * the sync strokes may be creating the levels
+     */
+    mutable QMutex m_lodPyramidLock;
 };
 
 const KisDefaultBoundsSP KisPaintDevice::Private::transitionalDefaultBounds = new KisDefaultBounds();
@@ -674,8 +721,17 @@ struct KisPaintDevice::Private::StrategyPolicy {
 };
 
 struct KisPaintDevice::Private::LodDataStructImpl : public KisPaintDevice::LodDataStruct {
-    LodDataStructImpl(Data *_lodData) : lodData(_lodData) {}
-    QScopedPointer<Data> lodData;
+    LodDataStructImpl(DataSP _lodData) : lodData(_lodData) {}
+    DataSP lodData;
+
+    /**
+     * The sync state of the pyramid level is committed only when the
+     * struct is uploaded, so a cancelled sync never leaves the level
+     * marked as up-to-date.
+     */
+    int levelGeneration = 0;
+    int writeEpoch = 0;
+    QSet<quint64> tiles;
 };
 
 KisRegion KisPaintDevice::Private::regionForLodSyncing() const
@@ -684,42 +740,183 @@ KisRegion KisPaintDevice::Private::regionForLodSyncing() const
     return srcData->dataManager()->region().translated(srcData->x(), srcData->y());
 }
 
+bool KisPaintDevice::Private::isLodPyramidLevelValid(const LodPyramidLevel &level, Data *srcData) const
+{
+    KisDataManager *srcDataManager = srcData->dataManager().data();
+
+    return level.data &&
+        level.sourceDataManager.isValid() &&
+        level.sourceDataManager == srcDataManager &&
+        level.sourceColorSpace == srcData->colorSpace() &&
+        level.sourceOffset == QPoint(srcData->x(), srcData->y()) &&
+        level.sourceDefaultPixel.size() == srcDataManager->pixelSize() &&
+        !memcmp(level.sourceDefaultPixel.constData(), srcDataManager->defaultPixel(), srcDataManager->pixelSize());
+}
+
+KisRegion KisPaintDevice::Private::changedRegionSinceSync(const LodPyramidLevel &level, Data *srcData, QSet<quint64> *tiles) const
+{
+    QVector<QRect> changedRects;
+    srcData->dataManager()->collectChangedTiles(level.syncedWriteEpoch, tiles, &changedRects);
+
+    // the tiles removed since the last sync have become transparent
+    for (auto it = level.syncedTiles.constBegin(); it != level.syncedTiles.constEnd(); ++it) {
+        if (!tiles->contains(*it)) {
+            changedRects << KisDataManager::tileRectFromKey(*it);
+        }
+    }
+
+    return KisRegion(std::move(changedRects)).translated(srcData->x(), srcData->y());
+}
+
+KisRegion KisPaintDevice::Private::regionForLodSyncing(int lod) const
+{
+    Data *srcData = currentNonLodData();
+
+    QMutexLocker l(&m_lodPyramidLock);
+
+    auto levelIt = m_lodPyramid.constFind(lod);
+    if (levelIt == m_lodPyramid.constEnd() || !isLodPyramidLevelValid(*levelIt, srcData)) {
+        return regionForLodSyncing();
+    }
+
+    QSet<quint64> tiles;
+    return changedRegionSinceSync(*levelIt, srcData, &tiles);
+}
+
 KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod)
 {
     KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
 
     Data *srcData = currentNonLodData();
 
-    Data *lodData = new Data(q, srcData, false);
-    LodDataStruct *lodStruct = new LodDataStructImpl(lodData);
+    DataSP lodData = toQShared(new Data(q, srcData, false));
 
-    int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
-    int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
+    lodData->prepareClone(srcData);
+
+    lodData->setLevelOfDetail(newLod);
+    lodData->setX(KisLodTransform::coordToLodCoord(srcData->x(), newLod));
+    lodData->setY(KisLodTransform::coordToLodCoord(srcData->y(), newLod));
 
     /**
-     * We compare color spaces as pure pointers, because they must be
-     * exactly the same, since they come from the common source.
+     * The struct doesn't belong to the pyramid, so committing
+     * it will be a noop
      */
-    if (lodData->levelOfDetail() != newLod ||
-        lodData->colorSpace() != srcData->colorSpace() ||
-        lodData->x() != expectedX ||
-        lodData->y() != expectedY) {
+    return new LodDataStructImpl(lodData);
+}
+
+KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod, KisRegion *syncRegion)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
+
+    Data *srcData = currentNonLodData();
+    KisDataManager *srcDataManager = srcData->dataManager().data();
+
+    QMutexLocker l(&m_lodPyramidLock);
+
+    LodPyramidLevel &level = m_lodPyramid[newLod];
+
+    if (!isLodPyramidLevelValid(level, srcData)) {
+        if (!level.data) {
+            level.data = toQShared(new Data(q, srcData, false));
+        }
 
+        DataSP lodData = level.data;
 
         lodData->prepareClone(srcData);
 
         lodData->setLevelOfDetail(newLod);
-        lodData->setX(expectedX);
-        lodData->setY(expectedY);
+        lodData->setX(KisLodTransform::coordToLodCoord(srcData->x(), newLod));
+        lodData->setY(KisLodTransform::coordToLodCoord(srcData->y(), newLod));
 
-        // FIXME: different kind of synchronization
+        level.sourceDataManager = srcData->dataManager();
+        level.sourceColorSpace = srcData->colorSpace();
+        level.sourceOffset = QPoint(srcData->x(), srcData->y());
+        level.sourceDefaultPixel = QByteArray(reinterpret_cast<const char*>(srcDataManager->defaultPixel()),
+                                              srcDataManager->pixelSize());
+
+        // the level is empty now, so every tile is dirty until the sync is committed
+        level.syncedWriteEpoch = 0;
+        level.syncedTiles.clear();
+        level.generation++;
     }
 
-    lodData->cache()->invalidate();
+    LodDataStructImpl *lodStruct = new LodDataStructImpl(level.data);
+    lodStruct->levelGeneration = level.generation;
+
+    /**
+     * The epoch is advanced before the changed tiles are collected, so
+     * everything written after the collection will be reported by the
+     * next sync of the level.
+     */
+    lodStruct->writeEpoch = KisTile::advanceWriteEpoch();
+    *syncRegion = changedRegionSinceSync(level, srcData, &lodStruct->tiles);
+
+    level.data->cache()->invalidate();
 
     return lodStruct;
 }
 
+KisPaintDeviceSP KisPaintDevice::Private::createLodPyramidClone(int maxLod, int *lod) const
+{
+    Data *srcData = currentNonLodData();
+
+    QMutexLocker l(&m_lodPyramidLock);
+
+    for (auto it = m_lodPyramid.constEnd(); it != m_lodPyramid.constBegin();) {
+        --it;
+
+        if (it.key() > maxLod || !isLodPyramidLevelValid(*it, srcData)) continue;
+
+        QSet<quint64> tiles;
+        if (!changedRegionSinceSync(*it, srcData, &tiles).isEmpty()) continue;
+
+        Data *levelData = it->data.data();
+
+        KisPaintDeviceSP dst = new KisPaintDevice(levelData->colorSpace());
+        dst->setDefaultPixel(KoColor(levelData->dataManager()->defaultPixel(), levelData->colorSpace()));
+        dst->setX(levelData->x());
+        dst->setY(levelData->y());
+        dst->dataManager()->bitBltRough(levelData->dataManager(), levelData->dataManager()->extent());
+
+        *lod = it.key();
+        return dst;
+    }
+
+    return 0;
+}
+
+void KisPaintDevice::Private::releaseLodPyramid(int keptLod)
+{
+    QMutexLocker l(&m_lodPyramidLock);
+
+    for (auto it = m_lodPyramid.begin(); it != m_lodPyramid.end();) {
+        if (it.key() != keptLod) {
+            it = m_lodPyramid.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void KisPaintDevice::Private::commitLodDataStruct(LodDataStruct *_dst)
+{
+    LodDataStructImpl *dst = dynamic_cast<LodDataStructImpl*>(_dst);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(dst);
+
+    QMutexLocker l(&m_lodPyramidLock);
+
+    auto it = m_lodPyramid.find(dst->lodData->levelOfDetail());
+    if (it == m_lodPyramid.end() ||
+        it->data != dst->lodData ||
+        it->generation != dst->levelGeneration) {
+
+        return;
+    }
+
+    it->syncedWriteEpoch = dst->writeEpoch;
+    it->syncedTiles = dst->tiles;
+}
+
 void KisPaintDevice::Private::updateLodDataManager(KisDataManager *srcDataManager,
                                                    KisDataManager *dstDataManager,
                                                    const QPoint &srcOffset,
@@ -852,6 +1049,8 @@ void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
     KIS_SAFE_ASSERT_RECOVER_RETURN(
         dst->lodData->levelOfDetail() == defaultBounds->currentLevelOfDetail());
 
+    commitLodDataStruct(dst);
+
     ensureLodDataPresent();
 
     m_lodData->prepareClone(dst->lodData.data());
@@ -1198,6 +1397,11 @@ int KisPaintDevice::sequenceNumber() const
     return m_d->cache()->sequenceNumber();
 }
 
+KisChannelStatisticsSP KisPaintDevice::channelStatistics(const QRect &rect, const KoColorSpace *colorSpace, KoUpdater *progressUpdater) const
+{
+    return m_d->cache()->channelStatistics(rect, colorSpace, progressUpdater);
+}
+
 void KisPaintDevice::estimateMemoryStats(qint64 &imageData, qint64 &temporaryData, qint64 &lodData) const
 {
     m_d->estimateMemoryStats(imageData, temporaryData, lodData);
@@ -1464,6 +1668,16 @@ QRect KisPaintDevice::calculateExactBounds(bool nonDefaultOnly) const
         }
     }
 
+    /**
+     * When the whole extent should be checked, the bounds can be found
+     * from the per-tile summaries, reading only the tiles changed since
+     * the last calculation. The wrapped accessors don't map to the tiles
+     * directly, so the wrap-around mode uses the pixel scan.
+     */
+    if (endRect.isEmpty() && !defaultBounds()->wrapAroundMode()) {
+        return m_d->cache()->calculateExactBoundsFromTiles(nonDefaultOnly);
+    }
+
     if (nonDefaultOnly) {
         const KoColor defaultPixel = this->defaultPixel();
         Impl::CheckNonDefault compareOp(pixelSize(), defaultPixel.data());
@@ -1699,26 +1913,6 @@ inline bool moveBy(KisSequentialConstIterator& iter, int numPixels)
     return true;
 }
 
-static KisPaintDeviceSP createThumbnailDeviceInternal(const KisPaintDevice* srcDev, qint32 srcX0, qint32 srcY0, qint32 srcWidth, qint32 srcHeight, qint32 w, qint32 h, QRect outputRect)
-{
-    KisPaintDeviceSP thumbnail = new KisPaintDevice(srcDev->colorSpace());
-    qint32 pixelSize = srcDev->pixelSize();
-
-    KisRandomConstAccessorSP srcIter = srcDev->createRandomConstAccessorNG();
-    KisRandomAccessorSP dstIter = thumbnail->createRandomAccessorNG();
-
-    for (qint32 y = outputRect.y(); y < outputRect.y() + outputRect.height(); ++y) {
-        qint32 iY = srcY0 + (y * srcHeight) / h;
-        for (qint32 x = outputRect.x(); x < outputRect.x() + outputRect.width(); ++x) {
-            qint32 iX = srcX0 + (x * srcWidth) / w;
-            srcIter->moveTo(iX, iY);
-            dstIter->moveTo(x,  y);
-            memcpy(dstIter->rawData(), srcIter->rawDataConst(), pixelSize);
-        }
-    }
-    return thumbnail;
-}
-
 QSize fixThumbnailSize(QSize size)
 {
     if (!size.width() && size.height()) {
@@ -1734,86 +1928,26 @@ QSize fixThumbnailSize(QSize size)
 
 KisPaintDeviceSP KisPaintDevice::createThumbnailDevice(qint32 w, qint32 h, QRect rect, QRect outputRect) const
 {
-    QSize thumbnailSize(w, h);
-
-    QRect imageRect = rect.isValid() ? rect : extent();
-
-    if ((thumbnailSize.width() > imageRect.width()) || (thumbnailSize.height() > imageRect.height())) {
-        thumbnailSize.scale(imageRect.size(), Qt::KeepAspectRatio);
-    }
-
-    thumbnailSize = fixThumbnailSize(thumbnailSize);
-
-    //can't create thumbnail for an empty device, e.g. layer thumbnail for empty image
-    if (imageRect.isEmpty() || thumbnailSize.isEmpty()) {
-        return new KisPaintDevice(colorSpace());
-    }
-
-    int srcWidth, srcHeight;
-    int srcX0, srcY0;
-    imageRect.getRect(&srcX0, &srcY0, &srcWidth, &srcHeight);
-
-    if (!outputRect.isValid()) {
-        outputRect = QRect(0, 0, w, h);
-    }
-
-    KisPaintDeviceSP thumbnail = createThumbnailDeviceInternal(this, imageRect.x(), imageRect.y(), imageRect.width(), imageRect.height(),
-                                 thumbnailSize.width(), thumbnailSize.height(), outputRect);
-
-    return thumbnail;
+    return createThumbnailDeviceOversampled(w, h, 1, rect, outputRect);
 }
 
 KisPaintDeviceSP KisPaintDevice::createThumbnailDeviceOversampled(qint32 w, qint32 h, qreal oversample, QRect rect,  QRect outputTileRect) const
 {
-    QSize thumbnailSize(w, h);
-    qreal oversampleAdjusted = qMax(oversample, 1.);
-    QSize thumbnailOversampledSize = oversampleAdjusted * thumbnailSize;
-
-    QRect outputRect;
-    QRect imageRect = rect.isValid() ? rect : extent();
-
-    qint32 hstart = thumbnailOversampledSize.height();
-
-    if ((thumbnailOversampledSize.width() > imageRect.width()) || (thumbnailOversampledSize.height() > imageRect.height())) {
-        thumbnailOversampledSize.scale(imageRect.size(), Qt::KeepAspectRatio);
-    }
-
-    thumbnailOversampledSize = fixThumbnailSize(thumbnailOversampledSize);
+    const QRect imageRect = rect.isValid() ? rect : extent();
+    const QSize thumbnailSize = KisThumbnailDownscaler::thumbnailSize(imageRect, QSize(w, h));
 
     //can't create thumbnail for an empty device, e.g. layer thumbnail for empty image
-    if (imageRect.isEmpty() || thumbnailSize.isEmpty() || thumbnailOversampledSize.isEmpty()) {
+    if (imageRect.isEmpty() || thumbnailSize.isEmpty()) {
         return new KisPaintDevice(colorSpace());
     }
 
-    oversampleAdjusted *= (hstart > 0) ? ((qreal)thumbnailOversampledSize.height() / hstart) : 1.; //readjusting oversample ratio, given that we had to adjust thumbnail size
-
-    outputRect = QRect(0, 0, thumbnailOversampledSize.width(), thumbnailOversampledSize.height());
-
-    if (outputTileRect.isValid()) {
-        //compensating output rectangle for oversampling
-        outputTileRect = QRect(oversampleAdjusted * outputTileRect.topLeft(), oversampleAdjusted * outputTileRect.bottomRight());
-        outputRect = outputRect.intersected(outputTileRect);
-    }
-
-    KisPaintDeviceSP thumbnail = createThumbnailDeviceInternal(this, imageRect.x(), imageRect.y(), imageRect.width(), imageRect.height(),
-                                 thumbnailOversampledSize.width(), thumbnailOversampledSize.height(), outputRect);
-
-    if (oversample != 1. && oversampleAdjusted != 1.) {
-        KoDummyUpdater updater;
-        KisTransformWorker worker(thumbnail, 1 / oversampleAdjusted, 1 / oversampleAdjusted, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
-                                  &updater, KisFilterStrategyRegistry::instance()->value("Bilinear"));
-        worker.run();
-    }
-    return thumbnail;
+    return KisThumbnailDownscaler::downscale(this, imageRect, thumbnailSize, oversample, outputTileRect);
 }
 
 QImage KisPaintDevice::createThumbnail(qint32 w, qint32 h, QRect rect, qreal oversample, KoColorConversionTransformation::Intent renderingIntent, KoColorConversionTransformation::ConversionFlags conversionFlags)
 {
-    QSize size = fixThumbnailSize(QSize(w, h));
-
-    KisPaintDeviceSP dev = createThumbnailDeviceOversampled(size.width(), size.height(), oversample, rect);
-    QImage thumbnail = dev->convertToQImage(KoColorSpaceRegistry::instance()->rgb8()->profile(), 0, 0, w, h, renderingIntent, conversionFlags);
-    return thumbnail;
+    const QRect imageRect = rect.isValid() ? rect : extent();
+    return m_d->cache()->createThumbnail(w, h, imageRect, oversample, renderingIntent, conversionFlags);
 }
 
 QImage KisPaintDevice::createThumbnail(qint32 w, qint32 h, qreal oversample, KoColorConversionTransformation::Intent renderingIntent, KoColorConversionTransformation::ConversionFlags conversionFlags)
@@ -2158,11 +2292,36 @@ KisRegion KisPaintDevice::regionForLodSyncing() const
     return m_d->regionForLodSyncing();
 }
 
+KisRegion KisPaintDevice::regionForLodSyncing(int lod) const
+{
+    return m_d->regionForLodSyncing(lod);
+}
+
+void KisPaintDevice::commitLodDataStruct(LodDataStruct *dst)
+{
+    m_d->commitLodDataStruct(dst);
+}
+
 KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod)
 {
     return m_d->createLodDataStruct(lod);
 }
 
+KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod, KisRegion *syncRegion)
+{
+    return m_d->createLodDataStruct(lod, syncRegion);
+}
+
+KisPaintDeviceSP KisPaintDevice::createLodPyramidClone(int maxLevelOfDetail, int *levelOfDetail) const
+{
+    return m_d->createLodPyramidClone(maxLevelOfDetail, levelOfDetail);
+}
+
+void KisPaintDevice::releaseLodPyramid(int keptLevelOfDetail)
+{
+    m_d->releaseLodPyramid(keptLevelOfDetail);
+}
+
 void KisPaintDevice::updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect)
 {
     m_d->updateLodDataStruct(dst, srcRect);
@@ -548,6 +548,13 @@ public:
      *
      */
     KisPaintDeviceSP createThumbnailDevice(qint32 w, qint32 h, QRect rect = QRect(), QRect outputRect = QRect()) const;
+
+    /**
+     * Same as createThumbnailDevice(), but every pixel of the thumbnail
+     * is an average of up to `ceil(oversample)` squared source pixels
+     * (see KisThumbnailDownscaler). \p outputRect is in the coordinates
+     * of the thumbnail.
+     */
     KisPaintDeviceSP createThumbnailDeviceOversampled(qint32 w, qint32 h, qreal oversample, QRect rect = QRect(),  QRect outputRect = QRect()) const;
 
     /**
@@ -568,6 +575,9 @@ public:
 
     /**
      * Cached version of createThumbnail(qint32 maxw, qint32 maxh, const KisSelection *selection, QRect rect)
+     *
+     * When the cache is invalidated, only the part of the thumbnail
+     * covering the tiles written since the previous call is regenerated.
      */
     QImage createThumbnail(qint32 maxw, qint32 maxh, qreal oversample = 1,
                            KoColorConversionTransformation::Intent renderingIntent = KoColorConversionTransformation::internalRenderingIntent(),
@@ -806,6 +816,19 @@ public:
      */
     int sequenceNumber() const;
 
+    /**
+     * \return the per-channel statistics of \p rect of the device,
+     *         with the pixels converted into \p colorSpace (if set).
+     *         The result is cached until the device is changed,
+     *         \see sequenceNumber()
+     *
+     * The progress of the calculation is reported to \p progressUpdater
+     * (if set). Nothing is reported when the cached result is reused.
+     */
+    KisChannelStatisticsSP channelStatistics(const QRect &rect,
+                                             const KoColorSpace *colorSpace = 0,
+                                             KoUpdater *progressUpdater = 0) const;
+
 
     void estimateMemoryStats(qint64 &imageData, qint64 &temporaryData, qint64 &lodData) const;
 
@@ -899,11 +922,66 @@ public:
         virtual ~LodDataStruct();
     };
 
+    /**
+     * The region that should be passed to updateLodDataStruct() to
+     * fully regenerate the level of detail plane
+     */
     KisRegion regionForLodSyncing() const;
+
+    /**
+     * The device keeps a persistent pyramid of downscaled copies of its
+     * current frame (one level per level of detail). This function
+     * returns the region changed since the previous sync of level \p lod
+     * (or the full region if the level is missing or outdated).
+     *
+     * The result is informational only: the region to sync should be
+     * taken from createLodDataStruct(lod, syncRegion), which calculates
+     * it atomically with the creation of the struct.
+     */
+    KisRegion regionForLodSyncing(int lod) const;
+
+    /**
+     * Creates a fresh empty level of detail plane. The whole
+     * regionForLodSyncing() should be passed to updateLodDataStruct()
+     */
     LodDataStruct* createLodDataStruct(int lod);
+
+    /**
+     * Creates a level of detail plane reusing the persistent pyramid
+     * level \p lod. \p syncRegion receives the region that has changed
+     * since the previous sync of the level, only this region should be
+     * passed to updateLodDataStruct().
+     */
+    LodDataStruct* createLodDataStruct(int lod, KisRegion *syncRegion);
+
+    /**
+     * Creates a rough clone of the coarsest level of the LoD pyramid that
+     * is not coarser than \p maxLevelOfDetail and is in sync with the
+     * device. The clone is in the coordinates of the level, the level
+     * itself is returned in \p levelOfDetail.
+     *
+     * \return null if there is no such level
+     */
+    KisPaintDeviceSP createLodPyramidClone(int maxLevelOfDetail, int *levelOfDetail) const;
+
+    /**
+     * Drops all the levels of the LoD pyramid except \p keptLevelOfDetail
+     * (or all of them if it is zero)
+     */
+    void releaseLodPyramid(int keptLevelOfDetail = 0);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
 
+    /**
+     * Marks the pyramid level of \p dst as synchronized with the device
+     * without uploading it into the level of detail plane. Should be
+     * called after the sync region returned by createLodDataStruct(lod,
+     * syncRegion) has been passed to updateLodDataStruct().
+     * uploadLodDataStruct() does that implicitly. Noop for the structs
+     * created by createLodDataStruct(lod).
+     */
+    void commitLodDataStruct(LodDataStruct *dst);
+
     void generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &originalRect, int lod);
 
     void setProjectionDevice(bool value);
@@ -8,7 +8,12 @@
 #define __KIS_PAINT_DEVICE_CACHE_H
 
 #include "kis_lock_free_cache.h"
+#include "KisThumbnailDownscaler.h"
+#include "KisTileBoundsSummary.h"
+#include "KisChannelStatistics.h"
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
 
 
 class KisPaintDeviceCache
@@ -69,6 +74,17 @@ public:
         return m_nonDefaultPixelAreaCache.getValue(m_paintDevice->defaultBounds()->wrapAroundMode());
     }
 
+    /**
+     * Calculates the exact bounds from the per-tile summaries, which
+     * survive the invalidation of the cache. Only the summaries of the
+     * tiles written since the previous call are recalculated.
+     */
+    QRect calculateExactBoundsFromTiles(bool nonDefaultOnly) {
+        return nonDefaultOnly ?
+            m_nonDefaultPixelAreaSummary.exactBounds(m_paintDevice, KisTileBoundsSummary::DefaultPixelsAreEmpty) :
+            m_exactBoundsSummary.exactBounds(m_paintDevice, KisTileBoundsSummary::TransparentPixelsAreEmpty);
+    }
+
     KisRegion region() {
         return m_regionCache.getValue(m_paintDevice->defaultBounds()->wrapAroundMode());
     }
@@ -89,17 +105,61 @@ public:
         }
 
         if (thumbnail.isNull()) {
-            thumbnail = m_paintDevice->createThumbnail(w, h, QRect(), oversample, renderingIntent, conversionFlags);
+            /**
+             * The downscaler keeps the previously generated thumbnail,
+             * so only the pixels covering the changed tiles are recalculated
+             */
+            thumbnail = m_thumbnailDownscaler.createThumbnail(m_paintDevice, w, h, oversample, renderingIntent, conversionFlags);
             cacheThumbnail(w, h, oversample, thumbnail);
         }
 
         return thumbnail;
     }
 
+    /**
+     * Thumbnails of a part of the device are not cached as images, but
+     * the downscaler still updates them incrementally
+     */
+    QImage createThumbnail(qint32 w, qint32 h, const QRect &rect, qreal oversample, KoColorConversionTransformation::Intent renderingIntent, KoColorConversionTransformation::ConversionFlags conversionFlags) {
+        return m_thumbnailDownscaler.createThumbnail(m_paintDevice, rect, w, h, oversample, renderingIntent, conversionFlags);
+    }
+
     int sequenceNumber() const {
         return m_sequenceNumber;
     }
 
+    /**
+     * The statistics are kept until the sequence number changes, so
+     * the filters asking for them several times (e.g. for the preview
+     * and for the actual application) don't rescan the device.
+     */
+    KisChannelStatisticsSP channelStatistics(const QRect &rect, const KoColorSpace *colorSpace, KoUpdater *progressUpdater) {
+        QMutexLocker l(&m_channelStatisticsLock);
+
+        if (!colorSpace) {
+            colorSpace = m_paintDevice->colorSpace();
+        }
+
+        /**
+         * Read the sequence number before the calculation, so that the
+         * changes made meanwhile would invalidate the result
+         */
+        const int sequenceNumber = m_sequenceNumber;
+
+        if (!m_channelStatistics ||
+            m_channelStatisticsSequenceNumber != sequenceNumber ||
+            m_channelStatisticsRect != rect ||
+            m_channelStatisticsColorSpace != colorSpace) {
+
+            m_channelStatistics = KisChannelStatistics::calculate(m_paintDevice, rect, colorSpace, progressUpdater);
+            m_channelStatisticsSequenceNumber = sequenceNumber;
+            m_channelStatisticsRect = rect;
+            m_channelStatisticsColorSpace = colorSpace;
+        }
+
+        return m_channelStatistics;
+    }
+
 private:
     inline QImage findThumbnail(qint32 w, qint32 h, qreal oversample) {
         QImage resultImage;
@@ -152,7 +212,16 @@ private:
 
     bool m_thumbnailsValid {false};
     QMap<int, QMap<int, QMap<qreal,QImage> > > m_thumbnails;
+    KisThumbnailDownscaler m_thumbnailDownscaler;
+    KisTileBoundsSummary m_exactBoundsSummary;
+    KisTileBoundsSummary m_nonDefaultPixelAreaSummary;
     QAtomicInt m_sequenceNumber;
+
+    QMutex m_channelStatisticsLock;
+    KisChannelStatisticsSP m_channelStatistics;
+    int m_channelStatisticsSequenceNumber {0};
+    QRect m_channelStatisticsRect;
+    const KoColorSpace *m_channelStatisticsColorSpace {0};
 };
 
 #endif /* __KIS_PAINT_DEVICE_CACHE_H */
@@ -11,14 +11,23 @@
 
 #include "kis_perspectivetransform_worker.h"
 
+#include <functional>
+
+#include <QMap>
 #include <QMatrix4x4>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QTransform>
 #include <QVector3D>
 #include <QPolygonF>
+#include <QtConcurrent>
+#include <QtMath>
 
 #include <KoUpdater.h>
 #include <KoColor.h>
 #include <KoCompositeOpRegistry.h>
+#include <KoColorSpace.h>
+#include <KoMixColorsOp.h>
 
 #include "kis_paint_device.h"
 #include "kis_perspective_math.h"
@@ -31,6 +40,7 @@
 #include "kis_painter.h"
 #include "kis_image.h"
 #include "kis_algebra_2d.h"
+#include "tiles3/kis_tile_data_interface.h"
 
 
 KisPerspectiveTransformWorker::KisPerspectiveTransformWorker(KisPaintDeviceSP dev, QPointF center, double aX, double aY, double distance, bool cropDst, KoUpdaterPtr progress)
@@ -143,6 +153,113 @@ struct NearestNeighbourWrapper
     int m_pixelSize;
 };
 
+/**
+ * Cubic convolution kernel with a = -0.5, the same one
+ * KisBicubicFilterStrategy uses for the affine transformations
+ */
+struct BicubicKernel
+{
+    static const int radius = 2;
+
+    static inline qreal valueAt(qreal t) {
+        t = qAbs(t);
+        if (t < 1.0) return (1.5 * t - 2.5) * t * t + 1.0;
+        if (t < 2.0) return ((-0.5 * t + 2.5) * t - 4.0) * t + 2.0;
+        return 0.0;
+    }
+};
+
+struct Lanczos3Kernel
+{
+    static const int radius = 3;
+
+    static inline qreal sinc(qreal x) {
+        x *= M_PI;
+        return x != 0.0 ? std::sin(x) / x : 1.0;
+    }
+
+    static inline qreal valueAt(qreal t) {
+        t = qAbs(t);
+        return t < 3.0 ? sinc(t) * sinc(t / 3.0) : 0.0;
+    }
+};
+
+/**
+ * Samples the source with a separable kernel. The source block covered
+ * by the kernel is copied row by row in runs of contiguous pixels of
+ * the tiles, and then mixed in one go by the mixColorsOp of the color
+ * space (like KisFilterWeightsApplicator does), so the wrapper works
+ * for any color space. The weights are normalized to 255, the negative
+ * lobes of the kernels are handled by the mixColorsOp.
+ */
+template <class Kernel>
+struct SeparableFilterWrapper
+{
+    static const int size = 2 * Kernel::radius;
+
+    SeparableFilterWrapper(KisPaintDeviceSP device)
+        : m_accessor(device->createRandomConstAccessorNG()),
+          m_mixOp(device->colorSpace()->mixColorsOp()),
+          m_pixelSize(device->pixelSize()),
+          m_block(size * size * m_pixelSize)
+    {
+    }
+
+    void samplePixel(const QPointF &pt, quint8 *dst) {
+        const int x0 = qFloor(pt.x()) - Kernel::radius + 1;
+        const int y0 = qFloor(pt.y()) - Kernel::radius + 1;
+
+        qreal wx[size];
+        qreal wy[size];
+        qreal sumX = 0.0;
+        qreal sumY = 0.0;
+
+        for (int i = 0; i < size; i++) {
+            wx[i] = Kernel::valueAt(pt.x() - (x0 + i));
+            wy[i] = Kernel::valueAt(pt.y() - (y0 + i));
+            sumX += wx[i];
+            sumY += wy[i];
+        }
+
+        const qreal norm = 255.0 / (sumX * sumY);
+
+        qint16 weights[size * size];
+        int weightSum = 0;
+
+        for (int j = 0; j < size; j++) {
+            for (int i = 0; i < size; i++) {
+                const qint16 w = qRound(wx[i] * wy[j] * norm);
+                weights[j * size + i] = w;
+                weightSum += w;
+            }
+        }
+
+        quint8 *blockPtr = m_block.data();
+
+        for (int j = 0; j < size; j++) {
+            for (int i = 0; i < size;) {
+                m_accessor->moveTo(x0 + i, y0 + j);
+                const int numPixels = qMin(size - i, m_accessor->numContiguousColumns(x0 + i));
+                const int numBytes = numPixels * m_pixelSize;
+
+                memcpy(blockPtr, m_accessor->oldRawData(), numBytes);
+                blockPtr += numBytes;
+                i += numPixels;
+            }
+        }
+
+        m_mixOp->mixColors(m_block.constData(), weights, size * size, dst, weightSum);
+    }
+
+    KisRandomConstAccessorSP m_accessor;
+    const KoMixColorsOp *m_mixOp;
+    const int m_pixelSize;
+    QVector<quint8> m_block;
+};
+
+using BicubicWrapper = SeparableFilterWrapper<BicubicKernel>;
+using Lanczos3Wrapper = SeparableFilterWrapper<Lanczos3Kernel>;
+
 template <class SrcAccessorWrapper>
 void KisPerspectiveTransformWorker::runImpl()
 {
@@ -167,34 +284,72 @@ void KisPerspectiveTransformWorker::runImpl()
 
     KIS_ASSERT_RECOVER_NOOP(!m_isIdentity);
 
-    KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, m_dstRegion.rectCount());
+    /**
+     * Every destination pixel is sampled independently, so we split the
+     * destination region into bands of tile rows and sample the bands in
+     * parallel. Every band writes into its own row of tiles.
+     */
+    const int bandSize = KisTileData::HEIGHT;
+    const int gridOrigin = m_dev->y();
 
-    SrcAccessorWrapper srcAcc(cloneDevice);
-    KisRandomAccessorSP accessor = m_dev->createRandomAccessorNG();
+    QMap<int, QVector<QRect>> bandsMap;
 
     Q_FOREACH (const QRect &rect, m_dstRegion.rects()) {
-        for (int y = rect.y(); y < rect.y() + rect.height(); ++y) {
-            for (int x = rect.x(); x < rect.x() + rect.width(); ++x) {
+        for (int y = rect.y(); y <= rect.bottom();) {
+            const int tileStart = gridOrigin + qFloor(qreal(y - gridOrigin) / bandSize) * bandSize;
+            const int bandEnd = qMin(rect.bottom() + 1, tileStart + bandSize);
+            bandsMap[tileStart] << QRect(rect.x(), y, rect.width(), bandEnd - y);
+            y = bandEnd;
+        }
+    }
 
-                QPointF dstPoint(x, y);
-                QPointF srcPoint = m_backwardTransform.map(dstPoint);
+    QVector<QVector<QRect>> bands = bandsMap.values().toVector();
 
-                if (m_srcRect.contains(srcPoint)) {
-                    accessor->moveTo(dstPoint.x(), dstPoint.y());
-                    srcAcc.samplePixel(srcPoint, accessor->rawData());
+    KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, bands.size());
+    QMutex progressMutex;
+
+    std::function<void (const QVector<QRect> &)> processBand =
+        [&] (const QVector<QRect> &rects) {
+            SrcAccessorWrapper srcAcc(cloneDevice);
+            KisRandomAccessorSP accessor = m_dev->createRandomAccessorNG();
+
+            Q_FOREACH (const QRect &rect, rects) {
+                for (int y = rect.y(); y < rect.y() + rect.height(); ++y) {
+                    for (int x = rect.x(); x < rect.x() + rect.width(); ++x) {
+
+                        QPointF dstPoint(x, y);
+                        QPointF srcPoint = m_backwardTransform.map(dstPoint);
+
+                        if (m_srcRect.contains(srcPoint)) {
+                            accessor->moveTo(dstPoint.x(), dstPoint.y());
+                            srcAcc.samplePixel(srcPoint, accessor->rawData());
+                        }
+                    }
                 }
             }
-        }
-        progressHelper.step();
-    }
+
+            QMutexLocker l(&progressMutex);
+            progressHelper.step();
+        };
+
+    QtConcurrent::blockingMap(bands, processBand);
 }
 
 void KisPerspectiveTransformWorker::run(SampleType sampleType)
 {
-    if (sampleType == Bilinear) {
-        runImpl<BilinearWrapper>();
-    } else {
+    switch (sampleType) {
+    case NearestNeighbour:
         runImpl<NearestNeighbourWrapper>();
+        break;
+    case Bilinear:
+        runImpl<BilinearWrapper>();
+        break;
+    case Bicubic:
+        runImpl<BicubicWrapper>();
+        break;
+    case Lanczos3:
+        runImpl<Lanczos3Wrapper>();
+        break;
     }
 }
 
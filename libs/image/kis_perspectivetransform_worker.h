@@ -27,7 +27,9 @@ public:
 
     enum SampleType {
         NearestNeighbour = 0,
-        Bilinear
+        Bilinear,
+        Bicubic,
+        Lanczos3
     };
 
     void run(SampleType sampleType = Bilinear);
@@ -26,9 +26,12 @@
 #include "kis_image.h"
 #include "kis_fill_painter.h"
 #include "kis_outline_generator.h"
+#include "KisTiledOutlineGenerator.h"
 #include <kis_iterator_ng.h>
 #include "kis_lod_transform.h"
 #include "kundo2command.h"
+#include "kis_datamanager.h"
+#include "tiles3/kis_tile.h"
 
 
 struct Q_DECL_HIDDEN KisPixelSelection::Private {
@@ -44,6 +47,8 @@ struct Q_DECL_HIDDEN KisPixelSelection::Private {
 
     QPoint lod0CachesOffset;
 
+    KisTiledOutlineGenerator outlineGenerator;
+
     void invalidateThumbnailImage() {
         thumbnailImageValid = false;
         thumbnailImage = QImage();
@@ -180,24 +185,227 @@ void KisPixelSelection::copyAlphaFrom(KisPaintDeviceSP src, const QRect &process
     m_d->invalidateThumbnailImage();
 }
 
-void KisPixelSelection::addSelection(KisPixelSelectionSP selection)
-{
-    QRect r = selection->selectedRect();
-    if (r.isEmpty()) return;
+namespace {
 
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-        do {
-            if (*src->oldRawData() + *dst->rawData() < MAX_SELECTED)
-                *dst->rawData() = *src->oldRawData() + *dst->rawData();
-            else
-                *dst->rawData() = MAX_SELECTED;
+struct AddSelectionOp {
+    static inline quint8 apply(quint8 dst, quint8 src) {
+        return qMin(int(dst) + src, int(MAX_SELECTED));
+    }
+};
+
+struct SubtractSelectionOp {
+    static inline quint8 apply(quint8 dst, quint8 src) {
+        return dst > src ? dst - src : MIN_SELECTED;
+    }
+};
 
+struct IntersectSelectionOp {
+    static inline quint8 apply(quint8 dst, quint8 src) {
+        return qMin(dst, src);
+    }
+};
+
+struct SymmetricDifferenceSelectionOp {
+    static inline quint8 apply(quint8 dst, quint8 src) {
+        return abs(dst - src);
+    }
+};
+
+template <class Op>
+void applySelectionOpPixelwise(KisPixelSelection *dstSelection, KisPixelSelectionSP srcSelection, const QRect &rc)
+{
+    KisHLineIteratorSP dst = dstSelection->createHLineIteratorNG(rc.x(), rc.y(), rc.width());
+    KisHLineConstIteratorSP src = srcSelection->createHLineConstIteratorNG(rc.x(), rc.y(), rc.width());
+    for (int i = 0; i < rc.height(); ++i) {
+        do {
+            *dst->rawData() = Op::apply(*dst->rawData(), *src->oldRawData());
         } while (src->nextPixel() && dst->nextPixel());
         dst->nextRow();
         src->nextRow();
     }
+}
+
+inline qint32 divideRoundDown(qint32 x, qint32 y)
+{
+    return x >= 0 ? x / y : -(((-x - 1) / y) + 1);
+}
+
+/**
+ * Returns the value of all the pixels of the tile if they are
+ * the same, or -1 otherwise
+ */
+int uniformTileValue(KisTileSP tile)
+{
+    const int numPixels = KisTileData::WIDTH * KisTileData::HEIGHT;
+
+    tile->lockForRead();
+    const quint8 *data = tile->data();
+    const int result = !memcmp(data, data + 1, numPixels - 1) ? *data : -1;
+    tile->unlockForRead();
+
+    return result;
+}
+
+enum UniformOperandAction {
+    UniformOperandKeepsDestination,
+    UniformOperandDefinesResult,
+    UniformOperandNeedsPixels
+};
+
+}
+
+template <class Op>
+void KisPixelSelection::applySelectionOp(KisPixelSelectionSP selection, const QRect &rc)
+{
+    if (selection.data() == this ||
+        !fastBitBltPossible(selection) ||
+        defaultBounds()->wrapAroundMode() ||
+        selection->defaultBounds()->wrapAroundMode()) {
+
+        applySelectionOpPixelwise<Op>(this, selection, rc);
+        return;
+    }
+
+    /**
+     * For every value of a uniform tile check whether the result
+     * of the operation depends on the pixels of the other operand
+     */
+    UniformOperandAction srcActions[256];
+    UniformOperandAction dstActions[256];
+
+    for (int value = 0; value < 256; value++) {
+        bool keepsDst = true;
+        bool constResult = true;
+        bool keepsDstFromDst = true;
+        bool copiesSrc = true;
+
+        for (int other = 0; other < 256; other++) {
+            keepsDst &= Op::apply(other, value) == other;
+            constResult &= Op::apply(other, value) == Op::apply(0, value);
+            keepsDstFromDst &= Op::apply(value, other) == value;
+            copiesSrc &= Op::apply(value, other) == other;
+        }
+
+        srcActions[value] =
+            keepsDst ? UniformOperandKeepsDestination :
+            constResult ? UniformOperandDefinesResult :
+            UniformOperandNeedsPixels;
+
+        dstActions[value] =
+            keepsDstFromDst ? UniformOperandKeepsDestination :
+            copiesSrc ? UniformOperandDefinesResult :
+            UniformOperandNeedsPixels;
+    }
+
+    KisDataManagerSP dstDataManager = dataManager();
+    KisDataManagerSP srcDataManager = selection->dataManager();
+
+    const QPoint offset(x(), y());
+    const QRect dataRect = rc.translated(-offset);
+
+    const qint32 firstColumn = divideRoundDown(dataRect.left(), KisTileData::WIDTH);
+    const qint32 lastColumn = divideRoundDown(dataRect.right(), KisTileData::WIDTH);
+    const qint32 firstRow = divideRoundDown(dataRect.top(), KisTileData::HEIGHT);
+    const qint32 lastRow = divideRoundDown(dataRect.bottom(), KisTileData::HEIGHT);
+
+    /**
+     * The tiles created by filling a rect share the same tile data, so
+     * their uniformity is checked only once. The source is not changed
+     * during the operation, so the cache is safe to use for it.
+     */
+    QHash<KisTileData*, int> srcUniformValues;
+
+    for (qint32 row = firstRow; row <= lastRow; ++row) {
+        /**
+         * The neighbouring tiles filled with the same value are filled
+         * in one go, so that they would share the same tile data
+         */
+        qint32 fillStart = 0;
+        qint32 fillLength = 0;
+        quint8 fillValue = 0;
+
+        auto flushFill = [&] () {
+            if (fillLength) {
+                fill(QRect(fillStart * KisTileData::WIDTH, row * KisTileData::HEIGHT,
+                           fillLength * KisTileData::WIDTH, KisTileData::HEIGHT).translated(offset),
+                     KoColor(&fillValue, colorSpace()));
+                fillLength = 0;
+            }
+        };
+
+        for (qint32 column = firstColumn; column <= lastColumn; ++column) {
+            const QRect tileRect(column * KisTileData::WIDTH, row * KisTileData::HEIGHT,
+                                 KisTileData::WIDTH, KisTileData::HEIGHT);
+
+            if (!dataRect.contains(tileRect)) {
+                flushFill();
+                applySelectionOpPixelwise<Op>(this, selection, (tileRect & dataRect).translated(offset));
+                continue;
+            }
+
+            KisTileSP srcTile = srcDataManager->getOldTile(column, row);
+            auto it = srcUniformValues.find(srcTile->tileData());
+            if (it == srcUniformValues.end()) {
+                it = srcUniformValues.insert(srcTile->tileData(), uniformTileValue(srcTile));
+            }
+            const int srcValue = *it;
+
+            const int dstValue = uniformTileValue(dstDataManager->getTile(column, row, false));
+
+            int resultValue = -1;
+            bool copySource = false;
+
+            if (srcValue >= 0 && dstValue >= 0) {
+                resultValue = Op::apply(dstValue, srcValue);
+                if (resultValue == dstValue) {
+                    flushFill();
+                    continue;
+                }
+            } else if (srcValue >= 0 && srcActions[srcValue] != UniformOperandNeedsPixels) {
+                if (srcActions[srcValue] == UniformOperandKeepsDestination) {
+                    flushFill();
+                    continue;
+                }
+                resultValue = Op::apply(MIN_SELECTED, srcValue);
+            } else if (dstValue >= 0 && dstActions[dstValue] != UniformOperandNeedsPixels) {
+                if (dstActions[dstValue] == UniformOperandKeepsDestination) {
+                    flushFill();
+                    continue;
+                }
+                copySource = true;
+            }
+
+            if (resultValue >= 0) {
+                if (fillLength && fillValue != resultValue) {
+                    flushFill();
+                }
+                if (!fillLength) {
+                    fillStart = column;
+                    fillValue = resultValue;
+                }
+                fillLength++;
+                continue;
+            }
+
+            flushFill();
+
+            if (copySource) {
+                fastBitBltOldData(selection, tileRect.translated(offset));
+            } else {
+                applySelectionOpPixelwise<Op>(this, selection, tileRect.translated(offset));
+            }
+        }
+
+        flushFill();
+    }
+}
+
+void KisPixelSelection::addSelection(KisPixelSelectionSP selection)
+{
+    QRect r = selection->selectedRect();
+    if (r.isEmpty()) return;
+
+    applySelectionOp<AddSelectionOp>(selection, r);
 
     const quint8 defPixel = qMax(*defaultPixel().data(), *selection->defaultPixel().data());
     setDefaultPixel(KoColor(&defPixel, colorSpace()));
@@ -216,20 +424,7 @@ void KisPixelSelection::subtractSelection(KisPixelSelectionSP selection)
     QRect r = selection->selectedRect();
     if (r.isEmpty()) return;
 
-
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-        do {
-            if (*dst->rawData() - *src->oldRawData() > MIN_SELECTED)
-                *dst->rawData() = *dst->rawData() - *src->oldRawData();
-            else
-                *dst->rawData() = MIN_SELECTED;
-
-        } while (src->nextPixel() && dst->nextPixel());
-        dst->nextRow();
-        src->nextRow();
-    }
+    applySelectionOp<SubtractSelectionOp>(selection, r);
 
     const quint8 defPixel = *selection->defaultPixel().data() > *defaultPixel().data()
                             ? MIN_SELECTED
@@ -253,15 +448,7 @@ void KisPixelSelection::intersectSelection(KisPixelSelectionSP selection)
         return;
     }
 
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-        do {
-            *dst->rawData() = qMin(*dst->rawData(), *src->oldRawData());
-        }  while (src->nextPixel() && dst->nextPixel());
-        dst->nextRow();
-        src->nextRow();
-    }
+    applySelectionOp<IntersectSelectionOp>(selection, r);
 
     const quint8 defPixel = qMin(*defaultPixel().data(), *selection->defaultPixel().data());
     setDefaultPixel(KoColor(&defPixel, colorSpace()));
@@ -283,17 +470,7 @@ void KisPixelSelection::symmetricdifferenceSelection(KisPixelSelectionSP selecti
     QRect r = selection->selectedRect().united(selectedRect());
     if (r.isEmpty()) return;
 
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-
-        do {
-            *dst->rawData() = abs(*dst->rawData() - *src->oldRawData());
-        }  while (src->nextPixel() && dst->nextPixel());
-
-        dst->nextRow();
-        src->nextRow();
-    }
+    applySelectionOp<SymmetricDifferenceSelectionOp>(selection, r);
 
     const quint8 defPixel = abs(*defaultPixel().data() - *selection->defaultPixel().data());
     setDefaultPixel(KoColor(&defPixel, colorSpace()));
@@ -408,6 +585,15 @@ QRect KisPixelSelection::selectedExactRect() const
 
 QVector<QPolygon> KisPixelSelection::outline() const
 {
+    /**
+     * With the transparent default pixel the outline can be traced
+     * tile by tile, reusing the fragments of the tiles that haven't
+     * changed since the previous call.
+     */
+    if (*defaultPixel().data() == MIN_SELECTED) {
+        return m_d->outlineGenerator.outline(this, MIN_SELECTED);
+    }
+
     QRect selectionExtent = selectedExactRect();
 
     /**
@@ -416,9 +602,7 @@ QVector<QPolygon> KisPixelSelection::outline() const
      * value sane we should limit the calculated area by the bounds of
      * the image.
      */
-    if (*defaultPixel().data() != MIN_SELECTED) {
-        selectionExtent &= defaultBounds()->bounds();
-    }
+    selectionExtent &= defaultBounds()->bounds();
 
     qint32 xOffset = selectionExtent.x();
     qint32 yOffset = selectionExtent.y();
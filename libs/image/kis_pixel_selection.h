@@ -151,6 +151,15 @@ private:
      */
     void symmetricdifferenceSelection(KisPixelSelectionSP selection);
 
+    /**
+     * Applies a per-pixel operation \p Op to \p rc of this selection
+     * using \p selection as the second operand. The tiles that are
+     * uniform in any of the selections are processed as a whole, without
+     * visiting their pixels.
+     */
+    template <class Op>
+    void applySelectionOp(KisPixelSelectionSP selection, const QRect &rc);
+
 private:
     // We don't want these methods to be used on selections:
     using KisPaintDevice::extent;
@@ -16,6 +16,7 @@ KisRecalculateGeneratorLayerJob::KisRecalculateGeneratorLayerJob(KisGeneratorLay
     : m_layer(layer)
 {
     setExclusive(true);
+    setPriority(KisStrokeJobData::BACKGROUND);
 }
 
 bool KisRecalculateGeneratorLayerJob::overrides(const KisSpontaneousJob *_otherJob)
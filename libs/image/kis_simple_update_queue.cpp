@@ -12,6 +12,8 @@
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
 #include "kis_spontaneous_job.h"
+#include "kis_lod_transform.h"
+#include "kis_update_time_monitor.h"
 
 
 //#define ENABLE_DEBUG_JOIN
@@ -42,7 +44,8 @@
 
 
 KisSimpleUpdateQueue::KisSimpleUpdateQueue()
-    : m_overrideLevelOfDetail(-1)
+    : m_overrideLevelOfDetail(-1),
+      m_prioritizeVisibleUpdates(true)
 {
     updateSettings();
 }
@@ -68,6 +71,8 @@ void KisSimpleUpdateQueue::updateSettings()
     m_maxCollectAlpha = config.maxCollectAlpha();
     m_maxMergeAlpha = config.maxMergeAlpha();
     m_maxMergeCollectAlpha = config.maxMergeCollectAlpha();
+
+    m_prioritizeVisibleUpdates = config.prioritizeVisibleUpdates();
 }
 
 int KisSimpleUpdateQueue::overrideLevelOfDetail() const
@@ -75,29 +80,49 @@ int KisSimpleUpdateQueue::overrideLevelOfDetail() const
     return m_overrideLevelOfDetail;
 }
 
-void KisSimpleUpdateQueue::processQueue(KisUpdaterContext &updaterContext)
+void KisSimpleUpdateQueue::setPriorityRects(const QVector<QRect> &rects)
+{
+    QMutexLocker locker(&m_lock);
+    m_priorityRects = rects;
+}
+
+void KisSimpleUpdateQueue::processQueue(KisUpdaterContext &updaterContext, bool interactiveJobsPending)
 {
     updaterContext.lock();
 
     while(updaterContext.hasSpareThread() &&
-          processOneJob(updaterContext));
+          processOneJob(updaterContext, interactiveJobsPending));
 
     updaterContext.unlock();
 }
 
-bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
+bool KisSimpleUpdateQueue::intersectsPriorityRects(KisBaseRectsWalkerSP walker) const
 {
-    QMutexLocker locker(&m_lock);
+    QRect rc = walker->requestedRect();
+
+    if (walker->levelOfDetail() > 0) {
+        rc = KisLodTransform::upscaledRect(rc, walker->levelOfDetail());
+    }
 
+    Q_FOREACH (const QRect &priorityRect, m_priorityRects) {
+        if (priorityRect.intersects(rc)) return true;
+    }
+
+    return false;
+}
+
+bool KisSimpleUpdateQueue::tryStartMergeJob(KisUpdaterContext &updaterContext, bool onlyPriorityJobs)
+{
     KisBaseRectsWalkerSP item;
     KisMutableWalkersListIterator iter(m_updatesList);
-    bool jobAdded = false;
 
     int currentLevelOfDetail = updaterContext.currentLevelOfDetail();
 
     while(iter.hasNext()) {
         item = iter.next();
 
+        if (onlyPriorityJobs && !intersectsPriorityRects(item)) continue;
+
         if ((currentLevelOfDetail < 0 || currentLevelOfDetail == item->levelOfDetail()) &&
             !item->checksumValid()) {
 
@@ -111,11 +136,34 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 
             updaterContext.addMergeJob(item);
             iter.remove();
-            jobAdded = true;
-            break;
+            return true;
         }
     }
 
+    return false;
+}
+
+bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext, bool interactiveJobsPending)
+{
+    QMutexLocker locker(&m_lock);
+
+    int currentLevelOfDetail = updaterContext.currentLevelOfDetail();
+
+    /**
+     * The updates of the visible part of the canvas go first, so that
+     * the user could see the result of a global operation (e.g. a
+     * filter applied to a huge layer) as soon as possible. The rest
+     * of the updates will use the threads that are left spare.
+     */
+    bool jobAdded =
+        m_prioritizeVisibleUpdates &&
+        !m_priorityRects.isEmpty() &&
+        tryStartMergeJob(updaterContext, true);
+
+    if (!jobAdded) {
+        jobAdded = tryStartMergeJob(updaterContext, false);
+    }
+
     if (jobAdded) return true;
 
     if (!m_spontaneousJobsList.isEmpty()) {
@@ -134,9 +182,22 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
         updaterContext.getJobsSnapshot(numMergeJobs, numStrokeJobs);
 
         KisSpontaneousJob *job = m_spontaneousJobsList.first();
-        if (!numMergeJobs && !numStrokeJobs &&
+
+        /**
+         * The background jobs are usually exclusive and long, so
+         * starting one of them would stall the stroke the user is
+         * painting right now. Running jobs cannot be interrupted, so
+         * the only thing we can do is to postpone them.
+         */
+        const bool postponedByInteractiveJobs =
+            interactiveJobsPending &&
+            job->priority() == KisStrokeJobData::BACKGROUND &&
+            !job->isDeadlineExpired();
+
+        if (!numMergeJobs && !numStrokeJobs && !postponedByInteractiveJobs &&
             (currentLevelOfDetail < 0 || currentLevelOfDetail == job->levelOfDetail())) {
 
+            KisUpdateTimeMonitor::instance()->reportJobDispatched(job->priority(), job->waitingTime());
             updaterContext.addSpontaneousJob(job);
             m_spontaneousJobsList.removeFirst();
             jobAdded = true;
@@ -25,7 +25,13 @@ public:
     KisSimpleUpdateQueue();
     virtual ~KisSimpleUpdateQueue();
 
-    void processQueue(KisUpdaterContext &updaterContext);
+    /**
+     * Starts as many jobs as there are spare threads in \p updaterContext.
+     * When \p interactiveJobsPending is true, the spontaneous jobs of
+     * BACKGROUND priority are not started unless their deadline has
+     * expired, so that they don't delay the interactive stroke.
+     */
+    void processQueue(KisUpdaterContext &updaterContext, bool interactiveJobsPending = false);
 
     void addUpdateJob(KisNodeSP node, const QVector<QRect> &rects, const QRect& cropRect, int levelOfDetail);
     void addUpdateJob(KisNodeSP node, const QRect &rc, const QRect& cropRect, int levelOfDetail);
@@ -46,10 +52,22 @@ public:
 
     int overrideLevelOfDetail() const;
 
+    /**
+     * Sets the areas of the image (in LoD0 coordinates) that are
+     * currently visible on the canvases. When the prioritization is
+     * enabled in the config, the updates intersecting these areas are
+     * started before all the other ones. The other updates are still
+     * executed, but only when no visible update can be started, so the
+     * queue becomes empty exactly when it did before.
+     */
+    void setPriorityRects(const QVector<QRect> &rects);
+
 protected:
     void addJob(KisNodeSP node, const QVector<QRect> &rects, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
 
-    bool processOneJob(KisUpdaterContext &updaterContext);
+    bool processOneJob(KisUpdaterContext &updaterContext, bool interactiveJobsPending);
+    bool tryStartMergeJob(KisUpdaterContext &updaterContext, bool onlyPriorityJobs);
+    bool intersectsPriorityRects(KisBaseRectsWalkerSP walker) const;
 
     bool trySplitJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
     bool tryMergeJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
@@ -94,6 +112,9 @@ protected:
     qreal m_maxMergeCollectAlpha;
 
     int m_overrideLevelOfDetail;
+
+    bool m_prioritizeVisibleUpdates;
+    QVector<QRect> m_priorityRects;
 };
 
 class KRITAIMAGE_EXPORT KisTestableSimpleUpdateQueue : public KisSimpleUpdateQueue
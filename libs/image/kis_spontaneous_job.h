@@ -7,7 +7,10 @@
 #ifndef __KIS_SPONTANEOUS_JOB_H
 #define __KIS_SPONTANEOUS_JOB_H
 
+#include <QElapsedTimer>
+
 #include "kis_runnable_with_debug_name.h"
+#include "kis_stroke_job_strategy.h"
 
 /**
  * This class represents a simple update just that should be
@@ -18,19 +21,60 @@
 class KRITAIMAGE_EXPORT KisSpontaneousJob : public KisRunnableWithDebugName
 {
 public:
+    KisSpontaneousJob() {
+        m_creationTime.start();
+    }
+
     virtual bool overrides(const KisSpontaneousJob *otherJob) = 0;
     virtual int levelOfDetail() const = 0;
     bool isExclusive() const {
         return m_isExclusive;
     }
 
+    /**
+     * \see KisStrokeJobData::priority()
+     */
+    KisStrokeJobData::Priority priority() const {
+        return m_priority;
+    }
+
+    /**
+     * \see KisStrokeJobData::deadlineHint()
+     */
+    int deadlineHint() const {
+        return m_deadlineHint;
+    }
+
+    bool isDeadlineExpired() const {
+        return m_deadlineHint >= 0 && m_creationTime.elapsed() >= m_deadlineHint;
+    }
+
+    qint64 waitingTime() const {
+        return m_creationTime.elapsed();
+    }
+
 protected:
     void setExclusive(bool value) {
         m_isExclusive = value;
     }
 
+    void setPriority(KisStrokeJobData::Priority value) {
+        if (value == KisStrokeJobData::BACKGROUND && m_deadlineHint < 0) {
+            m_deadlineHint = KisStrokeJobData::defaultBackgroundDeadlineHint;
+        }
+
+        m_priority = value;
+    }
+
+    void setDeadlineHint(int msec) {
+        m_deadlineHint = msec;
+    }
+
 private:
     bool m_isExclusive = false;
+    KisStrokeJobData::Priority m_priority = KisStrokeJobData::REGULAR;
+    int m_deadlineHint = -1;
+    QElapsedTimer m_creationTime;
 };
 
 #endif /* __KIS_SPONTANEOUS_JOB_H */
@@ -16,7 +16,8 @@ KisStroke::KisStroke(KisStrokeStrategy *strokeStrategy, Type type, int levelOfDe
       m_strokeSuspended(false),
       m_isCancelled(false),
       m_worksOnLevelOfDetail(levelOfDetail),
-      m_type(type)
+      m_type(type),
+      m_hasInteractiveJobs(false)
 {
     m_initStrategy.reset(m_strokeStrategy->createInitStrategy());
     m_dabStrategy.reset(m_strokeStrategy->createDabStrategy());
@@ -271,6 +272,19 @@ KisStrokeJobData::Sequentiality KisStroke::nextJobSequentiality() const
         m_jobsQueue.head()->sequentiality() : KisStrokeJobData::SEQUENTIAL;
 }
 
+KisStrokeJobData::Priority KisStroke::nextJobPriority() const
+{
+    if (m_jobsQueue.isEmpty()) return KisStrokeJobData::REGULAR;
+
+    KisStrokeJob *job = m_jobsQueue.head();
+    return job->isDeadlineExpired() ? KisStrokeJobData::INTERACTIVE : job->priority();
+}
+
+bool KisStroke::isInteractive() const
+{
+    return m_hasInteractiveJobs && (!m_strokeEnded || !m_jobsQueue.isEmpty());
+}
+
 int KisStroke::nextJobLevelOfDetail() const
 {
     return !m_jobsQueue.isEmpty() ?
@@ -286,6 +300,8 @@ void KisStroke::enqueue(KisStrokeJobStrategy *strategy,
         return;
     }
 
+    m_hasInteractiveJobs |= data && data->priority() == KisStrokeJobData::INTERACTIVE;
+
     m_jobsQueue.enqueue(new KisStrokeJob(strategy, data, worksOnLevelOfDetail(), true));
 }
 
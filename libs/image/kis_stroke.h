@@ -63,6 +63,19 @@ public:
 
     KisStrokeJobData::Sequentiality nextJobSequentiality() const;
 
+    /**
+     * The priority of the next job. The jobs whose deadline has expired
+     * are reported as INTERACTIVE.
+     */
+    KisStrokeJobData::Priority nextJobPriority() const;
+
+    /**
+     * Returns true if the stroke has received at least one INTERACTIVE
+     * job and the user may still add more, i.e. the stroke is either
+     * not ended or still has some jobs in its queue.
+     */
+    bool isInteractive() const;
+
     int nextJobLevelOfDetail() const;
 
     void setLodBuddy(KisStrokeSP buddy);
@@ -112,6 +125,7 @@ private:
     int m_worksOnLevelOfDetail;
     Type m_type;
     KisStrokeSP m_lodBuddy;
+    bool m_hasInteractiveJobs;
 };
 
 #endif /* __KIS_STROKE_H */
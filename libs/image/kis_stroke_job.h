@@ -65,6 +65,19 @@ public:
         return m_isOwnJob;
     }
 
+    KisStrokeJobData::Priority priority() const {
+        // Default value is 'REGULAR'
+        return m_dabData ? m_dabData->priority() : KisStrokeJobData::REGULAR;
+    }
+
+    bool isDeadlineExpired() const {
+        return m_dabData && m_dabData->isDeadlineExpired();
+    }
+
+    qint64 waitingTime() const {
+        return m_dabData ? m_dabData->waitingTime() : 0;
+    }
+
     QString debugName() const override {
         return m_dabStrategy->debugId();
     }
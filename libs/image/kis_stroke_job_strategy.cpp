@@ -10,19 +10,26 @@
 
 
 KisStrokeJobData::KisStrokeJobData(Sequentiality sequentiality,
-                                   Exclusivity exclusivity)
+                                   Exclusivity exclusivity,
+                                   Priority priority)
     : m_sequentiality(sequentiality),
       m_exclusivity(exclusivity),
       m_isCancellable(true),
-      m_levelOfDetailOverride(-1)
+      m_levelOfDetailOverride(-1),
+      m_priority(priority),
+      m_deadlineHint(priority == BACKGROUND ? defaultBackgroundDeadlineHint : -1)
 {
+    m_creationTime.start();
 }
 
 KisStrokeJobData::KisStrokeJobData(const KisStrokeJobData &rhs)
     : m_sequentiality(rhs.m_sequentiality),
       m_exclusivity(rhs.m_exclusivity),
       m_isCancellable(rhs.m_isCancellable),
-      m_levelOfDetailOverride(rhs.m_levelOfDetailOverride)
+      m_levelOfDetailOverride(rhs.m_levelOfDetailOverride),
+      m_priority(rhs.m_priority),
+      m_deadlineHint(rhs.m_deadlineHint),
+      m_creationTime(rhs.m_creationTime)
 {
 }
 
@@ -71,6 +78,40 @@ void KisStrokeJobData::setLevelOfDetailOverride(int value)
     m_levelOfDetailOverride = value;
 }
 
+KisStrokeJobData::Priority KisStrokeJobData::priority() const
+{
+    return m_priority;
+}
+
+void KisStrokeJobData::setPriority(Priority value)
+{
+    if (value == BACKGROUND && m_deadlineHint < 0) {
+        m_deadlineHint = defaultBackgroundDeadlineHint;
+    }
+
+    m_priority = value;
+}
+
+int KisStrokeJobData::deadlineHint() const
+{
+    return m_deadlineHint;
+}
+
+void KisStrokeJobData::setDeadlineHint(int msec)
+{
+    m_deadlineHint = msec;
+}
+
+bool KisStrokeJobData::isDeadlineExpired() const
+{
+    return m_deadlineHint >= 0 && m_creationTime.elapsed() >= m_deadlineHint;
+}
+
+qint64 KisStrokeJobData::waitingTime() const
+{
+    return m_creationTime.elapsed();
+}
+
 KisStrokeJobStrategy::KisStrokeJobStrategy()
 {
 }
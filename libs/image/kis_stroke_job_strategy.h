@@ -9,6 +9,7 @@
 
 #include "kritaimage_export.h"
 #include <QLatin1String>
+#include <QElapsedTimer>
 
 
 class KRITAIMAGE_EXPORT KisStrokeJobData
@@ -26,9 +27,31 @@ public:
         EXCLUSIVE
     };
 
+    /**
+     * The urgency of the job. The scheduler starts INTERACTIVE jobs
+     * (e.g. the dabs of a brush stroke the user is drawing right now)
+     * before all the other work, and doesn't start BACKGROUND jobs
+     * while there is any interactive work pending. Since the running
+     * jobs cannot be interrupted, the priority affects only the order
+     * in which the jobs are started.
+     */
+    enum Priority {
+        INTERACTIVE,
+        REGULAR,
+        BACKGROUND
+    };
+
+    /**
+     * The deadline (in milliseconds) BACKGROUND jobs get unless it is
+     * set explicitly with setDeadlineHint(), so that they are not
+     * postponed forever while the user keeps painting
+     */
+    static const int defaultBackgroundDeadlineHint = 1000;
+
 public:
     KisStrokeJobData(Sequentiality sequentiality = SEQUENTIAL,
-                     Exclusivity exclusivity = NORMAL);
+                     Exclusivity exclusivity = NORMAL,
+                     Priority priority = REGULAR);
     virtual ~KisStrokeJobData();
 
     bool isBarrier() const;
@@ -46,6 +69,26 @@ public:
     int levelOfDetailOverride() const;
     void setLevelOfDetailOverride(int value);
 
+    Priority priority() const;
+    void setPriority(Priority value);
+
+    /**
+     * The time (in milliseconds since the creation of the job data) the
+     * job is allowed to wait for the more urgent work. When the deadline
+     * has expired, the job is scheduled as if it were INTERACTIVE.
+     * Negative value means the job can wait as long as needed. BACKGROUND
+     * jobs default to defaultBackgroundDeadlineHint.
+     */
+    int deadlineHint() const;
+    void setDeadlineHint(int msec);
+
+    bool isDeadlineExpired() const;
+
+    /**
+     * The time (in milliseconds) passed since the job data has been created
+     */
+    qint64 waitingTime() const;
+
 protected:
     KisStrokeJobData(const KisStrokeJobData &rhs);
 
@@ -54,6 +97,9 @@ private:
     Exclusivity m_exclusivity;
     bool m_isCancellable;
     int m_levelOfDetailOverride;
+    Priority m_priority;
+    int m_deadlineHint;
+    QElapsedTimer m_creationTime;
 };
 
 
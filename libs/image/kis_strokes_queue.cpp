@@ -14,6 +14,7 @@
 #include "kis_stroke_job_strategy.h"
 #include "kis_stroke_strategy.h"
 #include "kis_undo_stores.h"
+#include "kis_update_time_monitor.h"
 #include "kis_post_execution_undo_adapter.h"
 #include "KisCppQuirks.h"
 
@@ -68,6 +69,8 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
           balancingRatioOverride(-1.0),
           currentStrokeLoaded(false),
           lodNNeedsSynchronization(true),
+          lodPyramidsChangeSeqNo(0),
+          lodPyramidsSyncedSeqNo(-1),
           desiredLevelOfDetail(0),
           nextDesiredLevelOfDetail(0),
           lodNStrokesFacade(_q),
@@ -82,6 +85,8 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
     bool currentStrokeLoaded;
 
     bool lodNNeedsSynchronization;
+    int lodPyramidsChangeSeqNo;
+    int lodPyramidsSyncedSeqNo;
     int desiredLevelOfDetail;
     int nextDesiredLevelOfDetail;
     QMutex mutex;
@@ -333,6 +338,15 @@ KisStrokeId KisStrokesQueue::startStroke(KisStrokeStrategy *strokeStrategy)
         m_d->lodNNeedsSynchronization = true;
     }
 
+    /**
+     * Forgettable strokes are not supposed to change the image, so
+     * they don't invalidate the LoD pyramids. Otherwise the background
+     * pyramid sync would invalidate itself.
+     */
+    if (!strokeStrategy->canForgetAboutMe()) {
+        m_d->lodPyramidsChangeSeqNo++;
+    }
+
     return id;
 }
 
@@ -559,6 +573,7 @@ void KisStrokesQueue::Private::tryClearUndoOnStrokeCompletion(KisStrokeSP finish
 void KisStrokesQueue::Private::forceResetLodAndCloseCurrentLodRange()
 {
     lodNNeedsSynchronization = true;
+    lodPyramidsChangeSeqNo++;
 
     if (!strokesQueue.isEmpty() && strokesQueue.last()->type() != KisStroke::LEGACY) {
 
@@ -638,6 +653,16 @@ qint32 KisStrokesQueue::sizeMetric() const
     return qMax(1, m_d->strokesQueue.head()->numJobs()) * m_d->strokesQueue.size();
 }
 
+bool KisStrokesQueue::hasInteractiveJobs() const
+{
+    QMutexLocker locker(&m_d->mutex);
+    if(m_d->strokesQueue.isEmpty()) return false;
+
+    KisStrokeSP stroke = m_d->strokesQueue.head();
+    return stroke->isInteractive() ||
+        stroke->nextJobPriority() == KisStrokeJobData::INTERACTIVE;
+}
+
 void KisStrokesQueue::Private::switchDesiredLevelOfDetail(bool forced)
 {
     if (forced || nextDesiredLevelOfDetail != desiredLevelOfDetail) {
@@ -650,6 +675,10 @@ void KisStrokesQueue::Private::switchDesiredLevelOfDetail(bool forced)
             forced && !lodNNeedsSynchronization &&
             desiredLevelOfDetail == nextDesiredLevelOfDetail;
 
+        if (desiredLevelOfDetail != nextDesiredLevelOfDetail) {
+            lodPyramidsChangeSeqNo++;
+        }
+
         desiredLevelOfDetail = nextDesiredLevelOfDetail;
         lodNNeedsSynchronization |= !forgettable;
 
@@ -665,6 +694,30 @@ void KisStrokesQueue::explicitRegenerateLevelOfDetail()
     m_d->switchDesiredLevelOfDetail(true);
 }
 
+bool KisStrokesQueue::lodNNeedsSynchronization() const
+{
+    QMutexLocker locker(&m_d->mutex);
+    return m_d->lodNNeedsSynchronization;
+}
+
+int KisStrokesQueue::lodPyramidsChangeSeqNo() const
+{
+    QMutexLocker locker(&m_d->mutex);
+    return m_d->lodPyramidsChangeSeqNo;
+}
+
+bool KisStrokesQueue::lodPyramidsNeedSynchronization() const
+{
+    QMutexLocker locker(&m_d->mutex);
+    return m_d->lodPyramidsSyncedSeqNo != m_d->lodPyramidsChangeSeqNo;
+}
+
+void KisStrokesQueue::notifyLodPyramidsSynchronized(int changeSeqNo)
+{
+    QMutexLocker locker(&m_d->mutex);
+    m_d->lodPyramidsSyncedSeqNo = changeSeqNo;
+}
+
 void KisStrokesQueue::notifyUFOChangedImage()
 {
     QMutexLocker locker(&m_d->mutex);
@@ -731,7 +784,9 @@ bool KisStrokesQueue::processOneJob(KisUpdaterContext &updaterContext,
        checkSequentialProperty(snapshot, externalJobsPending)) {
 
         KisStrokeSP stroke = m_d->strokesQueue.head();
-        updaterContext.addStrokeJob(stroke->popOneJob());
+        KisStrokeJob *job = stroke->popOneJob();
+        KisUpdateTimeMonitor::instance()->reportJobDispatched(job->priority(), job->waitingTime());
+        updaterContext.addStrokeJob(job);
         result = true;
     }
 
@@ -47,6 +47,13 @@ public:
     bool isEmpty() const;
 
     qint32 sizeMetric() const;
+
+    /**
+     * Returns true if the current stroke has an INTERACTIVE job waiting
+     * or the user is still feeding INTERACTIVE jobs into it. While this
+     * is true, the scheduler postpones all BACKGROUND work.
+     */
+    bool hasInteractiveJobs() const;
     KUndo2MagicString currentStrokeName() const;
     bool hasOpenedStrokes() const;
 
@@ -56,6 +63,10 @@ public:
     KisLodPreferences lodPreferences() const override;
     void setLodPreferences(const KisLodPreferences &value);
     void explicitRegenerateLevelOfDetail();
+    bool lodNNeedsSynchronization() const;
+    int lodPyramidsChangeSeqNo() const;
+    bool lodPyramidsNeedSynchronization() const;
+    void notifyLodPyramidsSynchronized(int changeSeqNo);
     void setLod0ToNStrokeStrategyFactory(const KisLodSyncStrokeStrategyFactory &factory);
     void setSuspendResumeUpdatesStrokeStrategyFactory(const KisSuspendResumeStrategyPairFactory &factory);
     KisPostExecutionUndoAdapter* lodNPostExecutionUndoAdapter() const;
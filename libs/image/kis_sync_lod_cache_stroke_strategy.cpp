@@ -13,6 +13,8 @@
 #include "kis_pointer_utils.h"
 #include "KisRunnableStrokeJobUtils.h"
 
+#include <QThread>
+
 struct KisSyncLodCacheStrokeStrategy::Private
 {
     KisImageWSP image;
@@ -59,7 +61,11 @@ void KisSyncLodCacheStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &
     using KritaUtils::splitRegionIntoPatches;
     using KritaUtils::optimalPatchSize;
 
-    using SharedData = QHash<KisPaintDeviceSP, QSharedPointer<KisPaintDevice::LodDataStruct>>;
+    struct SharedData {
+        QHash<KisPaintDeviceSP, QSharedPointer<KisPaintDevice::LodDataStruct>> lodData;
+        QVector<std::pair<KisPaintDeviceSP, QRect>> patches;
+        QAtomicInt nextPatch;
+    };
     using SharedDataSP = QSharedPointer<SharedData>;
 
     SharedDataSP sharedData(new SharedData());
@@ -73,27 +79,41 @@ void KisSyncLodCacheStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &
 
     KritaUtils::makeContainerUnique(deviceList);
 
-
+    /**
+     * The dirty region of every device is calculated right when its
+     * struct is created, so nothing written into the device in between
+     * can be missed. The number of patches is not known in advance, so
+     * the concurrent jobs fetch them from the shared queue.
+     */
     KritaUtils::addJobBarrier(jobs, [sharedData, deviceList, levelOfDetail] () mutable {
         Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-            sharedData->insert(device, toQShared(device->createLodDataStruct(levelOfDetail)));
+            KisRegion region;
+            sharedData->lodData.insert(device, toQShared(device->createLodDataStruct(levelOfDetail, &region)));
+
+            Q_FOREACH (const QRect &rc, splitRegionIntoPatches(region, optimalPatchSize())) {
+                sharedData->patches.append(std::make_pair(device, rc));
+            }
         }
     });
 
     KritaUtils::addJobSequential(jobs, [](){});
 
-    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-        KisRegion region = device->regionForLodSyncing();
-        QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
+    const int numWorkers = qMax(1, QThread::idealThreadCount());
 
-        Q_FOREACH (const QRect &rc, rects) {
-            KritaUtils::addJobConcurrent(jobs, [sharedData, device, rc] () mutable {
-                KIS_ASSERT(sharedData->contains(device));
+    for (int i = 0; i < numWorkers; i++) {
+        KritaUtils::addJobConcurrent(jobs, [sharedData] () mutable {
+            int index = 0;
 
-                KisPaintDevice::LodDataStruct *data = sharedData->value(device).data();
+            while ((index = sharedData->nextPatch.fetchAndAddOrdered(1)) < sharedData->patches.size()) {
+                const KisPaintDeviceSP device = sharedData->patches[index].first;
+                const QRect rc = sharedData->patches[index].second;
+
+                KIS_ASSERT(sharedData->lodData.contains(device));
+
+                KisPaintDevice::LodDataStruct *data = sharedData->lodData.value(device).data();
                 device->updateLodDataStruct(data, rc);
-            });
-        }
+            }
+        });
     }
 
     KritaUtils::addJobSequential(jobs, [](){});
@@ -106,8 +126,8 @@ void KisSyncLodCacheStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &
         });
 
     KritaUtils::addJobSequential(jobs, [sharedData] () mutable {
-        auto it = sharedData->begin();
-        auto end = sharedData->end();
+        auto it = sharedData->lodData.begin();
+        auto end = sharedData->lodData.end();
 
         for (; it != end; ++it) {
             KisPaintDeviceSP dev = it.key();
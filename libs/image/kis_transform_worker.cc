@@ -10,10 +10,16 @@
 
 #include "kis_transform_worker.h"
 
+#include <algorithm>
+#include <functional>
+
 #include <qmath.h>
 #include <klocalizedstring.h>
 
 #include <QTransform>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrent>
 
 #include <KoColorSpace.h>
 #include <KoCompositeOpRegistry.h>
@@ -30,6 +36,7 @@
 #include "kis_progress_update_helper.h"
 #include "kis_pixel_selection.h"
 #include "kis_image.h"
+#include "tiles3/kis_tile_data_interface.h"
 
 
 KisTransformWorker::KisTransformWorker(KisPaintDeviceSP dev,
@@ -183,6 +190,18 @@ void updateBounds<KisVLineIteratorSP>(QRect &boundRect, const KisFilterWeightsAp
     boundRect.setHeight(newBounds.size());
 }
 
+template <class iter> int tileGridOrigin(KisPaintDevice *dev);
+
+template <> int tileGridOrigin<KisHLineIteratorSP>(KisPaintDevice *dev)
+{
+    return dev->y();
+}
+
+template <> int tileGridOrigin<KisVLineIteratorSP>(KisPaintDevice *dev)
+{
+    return dev->x();
+}
+
 template <class T>
 void KisTransformWorker::transformPass(KisPaintDevice *src, KisPaintDevice *dst,
                                        double floatscale, double shear, double dx,
@@ -196,18 +215,55 @@ void KisTransformWorker::transformPass(KisPaintDevice *src, KisPaintDevice *dst,
 
     KisProgressUpdateHelper progressHelper(m_progressUpdater, portion, numLines);
     KisFilterWeightsBuffer buf(filterStrategy, qAbs(floatscale));
-    KisFilterWeightsApplicator applicator(src, dst, floatscale, shear, dx, clampToEdge);
+    const qreal support = filterStrategy->support(buf.weightsPositionScale().toFloat());
 
-    KisFilterWeightsApplicator::LinePos dstBounds;
+    /**
+     * Every line is read into a buffer and written back into the same
+     * line of the destination, so the lines are completely independent
+     * from each other. We split them into bands aligned to the tile grid
+     * of the device, so that every band touches its own set of tiles, and
+     * resample the bands in parallel. No intermediate device is needed.
+     */
+    const int bandSize = KisTileData::WIDTH;
+    const int gridOrigin = tileGridOrigin<T>(dst);
 
-    for (int i = firstLine; i < firstLine + numLines; i++) {
-        KisFilterWeightsApplicator::LinePos dstPos;
-        KisFilterWeightsApplicator::LinePos srcPos(srcStart, srcLen);
+    QVector<KisFilterWeightsApplicator::LinePos> bands;
 
-        dstPos = applicator.processLine<T>(srcPos, i, &buf, filterStrategy->support(buf.weightsPositionScale().toFloat()));
-        dstBounds.unite(dstPos);
+    for (int i = firstLine; i < firstLine + numLines;) {
+        const int tileStart = gridOrigin + qFloor(qreal(i - gridOrigin) / bandSize) * bandSize;
+        const int bandEnd = qMin(firstLine + numLines, tileStart + bandSize);
+        bands << KisFilterWeightsApplicator::LinePos(i, bandEnd - i);
+        i = bandEnd;
+    }
 
-        progressHelper.step();
+    QMutex progressMutex;
+    QVector<KisFilterWeightsApplicator::LinePos> dstLines(numLines);
+
+    std::function<void (const KisFilterWeightsApplicator::LinePos &)> processBand =
+        [&] (const KisFilterWeightsApplicator::LinePos &band) {
+            KisFilterWeightsApplicator applicator(src, dst, floatscale, shear, dx, clampToEdge);
+
+            for (int i = band.start(); i < band.end(); i++) {
+                KisFilterWeightsApplicator::LinePos srcPos(srcStart, srcLen);
+                dstLines[i - firstLine] = applicator.processLine<T>(srcPos, i, &buf, support);
+            }
+
+            QMutexLocker l(&progressMutex);
+            for (int i = 0; i < band.size(); i++) {
+                progressHelper.step();
+            }
+        };
+
+    if (m_concurrentPassesEnabled && bands.size() > 1) {
+        QtConcurrent::blockingMap(bands, processBand);
+    } else {
+        std::for_each(bands.begin(), bands.end(), processBand);
+    }
+
+    // unite the bounds in the order of lines to get exactly the same rect as a sequential pass
+    KisFilterWeightsApplicator::LinePos dstBounds;
+    Q_FOREACH (const KisFilterWeightsApplicator::LinePos &dstPos, dstLines) {
+        dstBounds.unite(dstPos);
     }
 
     updateBounds<T>(m_boundRect, dstBounds);
@@ -220,6 +276,11 @@ void swapValues(T *a, T *b) {
     *b = c;
 }
 
+void KisTransformWorker::setConcurrentPassesEnabled(bool value)
+{
+    m_concurrentPassesEnabled = value;
+}
+
 bool KisTransformWorker::run()
 {
     return runPartial(m_dev->exactBounds());
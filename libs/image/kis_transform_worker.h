@@ -106,6 +106,14 @@ public:
      */
     void transformPixelSelectionOutline(KisPixelSelectionSP pixelSelection) const;
 
+    /**
+     * The resampling passes split the device into bands of tiles
+     * and process them on all the available cores. The result is
+     * exactly the same as the one of a sequential pass, so this
+     * switch is used only for testing and benchmarking.
+     */
+    void setConcurrentPassesEnabled(bool value);
+
 private:
     // XXX (BSAR): Why didn't we use the shared-pointer versions of the paint device classes?
     // CBR: because the template functions used within don't work if it's not true pointers
@@ -143,6 +151,7 @@ private:
     KoUpdaterPtr m_progressUpdater;
     KisFilterStrategy *m_filter;
     QRect m_boundRect;
+    bool m_concurrentPassesEnabled = true;
 };
 
 #endif // KIS_TRANSFORM_VISITOR_H_
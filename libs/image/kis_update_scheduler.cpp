@@ -18,6 +18,8 @@
 #include "kis_queues_progress_updater.h"
 #include "KisImageConfigNotifier.h"
 
+#include <QHash>
+#include <QMutex>
 #include <QReadWriteLock>
 #include "kis_lazy_wait_condition.h"
 #include <mutex>
@@ -56,6 +58,9 @@ struct Q_DECL_HIDDEN KisUpdateScheduler::Private {
     QReadWriteLock updatesStartLock;
     KisLazyWaitCondition updatesFinishedCondition;
 
+    QMutex viewportRectsLock;
+    QHash<const void*, QRect> viewportRects;
+
     qreal balancingRatio() const {
         const qreal strokeRatioOverride = strokesQueue.balancingRatioOverride();
         return strokeRatioOverride > 0 ? strokeRatioOverride : defaultBalancingRatio;
@@ -211,6 +216,19 @@ bool KisUpdateScheduler::hasUpdatesRunning() const
     return !m_d->updatesQueue.isEmpty();
 }
 
+void KisUpdateScheduler::setViewportRect(const void *viewId, const QRect &rc)
+{
+    QMutexLocker l(&m_d->viewportRectsLock);
+
+    if (rc.isEmpty()) {
+        m_d->viewportRects.remove(viewId);
+    } else {
+        m_d->viewportRects.insert(viewId, rc);
+    }
+
+    m_d->updatesQueue.setPriorityRects(m_d->viewportRects.values().toVector());
+}
+
 KisStrokeId KisUpdateScheduler::startStroke(KisStrokeStrategy *strokeStrategy)
 {
     KisStrokeId id  = m_d->strokesQueue.startStroke(strokeStrategy);
@@ -277,6 +295,26 @@ void KisUpdateScheduler::explicitRegenerateLevelOfDetail()
     processQueues();
 }
 
+bool KisUpdateScheduler::lodNNeedsSynchronization() const
+{
+    return m_d->strokesQueue.lodNNeedsSynchronization();
+}
+
+int KisUpdateScheduler::lodPyramidsChangeSeqNo() const
+{
+    return m_d->strokesQueue.lodPyramidsChangeSeqNo();
+}
+
+bool KisUpdateScheduler::lodPyramidsNeedSynchronization() const
+{
+    return m_d->strokesQueue.lodPyramidsNeedSynchronization();
+}
+
+void KisUpdateScheduler::notifyLodPyramidsSynchronized(int changeSeqNo)
+{
+    m_d->strokesQueue.notifyLodPyramidsSynchronized(changeSeqNo);
+}
+
 int KisUpdateScheduler::currentLevelOfDetail() const
 {
     int levelOfDetail = m_d->updaterContext.currentLevelOfDetail();
@@ -389,24 +427,32 @@ void KisUpdateScheduler::processQueues()
 
     if(m_d->processingBlocked) return;
 
+    /**
+     * When the user is painting, the jobs of the stroke should be
+     * started before anything else, whatever the balancing ratio says,
+     * and no background work should be started until the stroke ends.
+     */
+    const bool interactiveJobsPending = m_d->strokesQueue.hasInteractiveJobs();
+
     if(m_d->strokesQueue.needsExclusiveAccess()) {
         DEBUG_BALANCING_METRICS("STROKES", "X");
         m_d->strokesQueue.processQueue(m_d->updaterContext,
                                         !m_d->updatesQueue.isEmpty());
 
         if(!m_d->strokesQueue.needsExclusiveAccess()) {
-            tryProcessUpdatesQueue();
+            tryProcessUpdatesQueue(interactiveJobsPending);
         }
     }
-    else if(m_d->balancingRatio() * m_d->strokesQueue.sizeMetric() > m_d->updatesQueue.sizeMetric()) {
-        DEBUG_BALANCING_METRICS("STROKES", "N");
+    else if(interactiveJobsPending ||
+            m_d->balancingRatio() * m_d->strokesQueue.sizeMetric() > m_d->updatesQueue.sizeMetric()) {
+        DEBUG_BALANCING_METRICS("STROKES", interactiveJobsPending ? "I" : "N");
         m_d->strokesQueue.processQueue(m_d->updaterContext,
                                         !m_d->updatesQueue.isEmpty());
-        tryProcessUpdatesQueue();
+        tryProcessUpdatesQueue(interactiveJobsPending);
     }
     else {
         DEBUG_BALANCING_METRICS("UPDATES", "N");
-        tryProcessUpdatesQueue();
+        tryProcessUpdatesQueue(interactiveJobsPending);
         m_d->strokesQueue.processQueue(m_d->updaterContext,
                                         !m_d->updatesQueue.isEmpty());
 
@@ -440,12 +486,12 @@ void KisUpdateScheduler::wakeUpWaitingThreads()
     }
 }
 
-void KisUpdateScheduler::tryProcessUpdatesQueue()
+void KisUpdateScheduler::tryProcessUpdatesQueue(bool interactiveJobsPending)
 {
     QReadLocker locker(&m_d->updatesStartLock);
     if(m_d->updatesLockCounter) return;
 
-    m_d->updatesQueue.processQueue(m_d->updaterContext);
+    m_d->updatesQueue.processQueue(m_d->updaterContext, interactiveJobsPending);
 }
 
 bool KisUpdateScheduler::haveUpdatesRunning()
@@ -135,6 +135,14 @@ public:
 
     bool hasUpdatesRunning() const;
 
+    /**
+     * Tells the scheduler which part of the image (in LoD0 coordinates)
+     * is currently visible in the view \p viewId. The updates of the
+     * visible areas of all the views are started first. Passing an
+     * empty rect removes the view from the list.
+     */
+    void setViewportRect(const void *viewId, const QRect &rc);
+
     KisStrokeId startStroke(KisStrokeStrategy *strokeStrategy) override;
     void addJob(KisStrokeId id, KisStrokeJobData *data) override;
     void endStroke(KisStrokeId id) override;
@@ -160,6 +168,35 @@ public:
      */
     void explicitRegenerateLevelOfDetail();
 
+    /**
+     * Returns true if the image has been changed by a non-LoD stroke
+     * since the last synchronization of the LoD planes
+     */
+    bool lodNNeedsSynchronization() const;
+
+    /**
+     * The sequence number of the last change that invalidated the LoD
+     * pyramids of the devices. It is bumped by every non-forgettable
+     * stroke, by UFO changes and by the change of the desired level
+     * of detail.
+     */
+    int lodPyramidsChangeSeqNo() const;
+
+    /**
+     * Returns true if the image has been changed since the last
+     * successful background synchronization of the LoD pyramids
+     * (\see notifyLodPyramidsSynchronized()). Unlike
+     * lodNNeedsSynchronization() it doesn't account for the LoD
+     * planes, which the background sync never touches.
+     */
+    bool lodPyramidsNeedSynchronization() const;
+
+    /**
+     * Marks the LoD pyramids as synchronized with the state of the
+     * image as of \p changeSeqNo (\see lodPyramidsChangeSeqNo())
+     */
+    void notifyLodPyramidsSynchronized(int changeSeqNo);
+
     /**
      * Install a factory of a stroke strategy, that will be started
      * every time when the scheduler needs to synchronize LOD caches
@@ -215,7 +252,7 @@ protected Q_SLOTS:
 private:
     friend class UpdatesBlockTester;
     bool haveUpdatesRunning();
-    void tryProcessUpdatesQueue();
+    void tryProcessUpdatesQueue(bool interactiveJobsPending);
     void wakeUpWaitingThreads();
 
     void progressUpdate();
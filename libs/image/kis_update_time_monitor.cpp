@@ -65,6 +65,17 @@ private:
     qint64 m_updateTime;
 };
 
+struct DispatchLatency
+{
+    qint64 totalTime = 0;
+    qint64 maxTime = 0;
+    qint32 numJobs = 0;
+
+    qreal averageTime() const {
+        return numJobs ? qreal(totalTime) / numJobs : 0.0;
+    }
+};
+
 struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
 {
     Private()
@@ -92,6 +103,8 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
     QElapsedTimer strokeTime;
     KisPaintOpPresetSP preset;
 
+    DispatchLatency dispatchLatency[KisStrokeJobData::BACKGROUND + 1];
+
     bool loggingEnabled;
 };
 
@@ -132,6 +145,10 @@ void KisUpdateTimeMonitor::startStrokeMeasure()
     m_d->lastMousePos = QPointF();
     m_d->preset = 0;
     m_d->strokeTime.start();
+
+    for (DispatchLatency &latency : m_d->dispatchLatency) {
+        latency = DispatchLatency();
+    }
 }
 
 void KisUpdateTimeMonitor::endStrokeMeasure()
@@ -192,7 +209,13 @@ void KisUpdateTimeMonitor::printValues()
            << i18n("Mouse Speed:") << QString::number( mouseSpeed, 'f', 3 ) << "\t"
            << i18n("Jobs/Update:") << QString::number( jobsPerUpdate, 'f', 3 ) << "\t"
            << i18n("Non Update Time:") << QString::number( nonUpdateTime, 'f', 3 ) << "\t"
-           << i18n("Response Time:") << responseTime << endl; // 'endl' will use the correct OS line ending
+           << i18n("Response Time:") << responseTime << "\t"
+           << i18n("Interactive Latency:") << QString::number(m_d->dispatchLatency[KisStrokeJobData::INTERACTIVE].averageTime(), 'f', 3)
+           << "/" << m_d->dispatchLatency[KisStrokeJobData::INTERACTIVE].maxTime << "\t"
+           << i18n("Regular Latency:") << QString::number(m_d->dispatchLatency[KisStrokeJobData::REGULAR].averageTime(), 'f', 3)
+           << "/" << m_d->dispatchLatency[KisStrokeJobData::REGULAR].maxTime << "\t"
+           << i18n("Background Latency:") << QString::number(m_d->dispatchLatency[KisStrokeJobData::BACKGROUND].averageTime(), 'f', 3)
+           << "/" << m_d->dispatchLatency[KisStrokeJobData::BACKGROUND].maxTime << endl; // 'endl' will use the correct OS line ending
     logFile.close();
 }
 
@@ -245,3 +268,15 @@ void KisUpdateTimeMonitor::reportUpdateFinished(const QRect &rect)
     }
     m_d->numUpdates++;
 }
+
+void KisUpdateTimeMonitor::reportJobDispatched(KisStrokeJobData::Priority priority, qint64 waitingTime)
+{
+    if (!m_d->loggingEnabled) return;
+
+    QMutexLocker locker(&m_d->mutex);
+
+    DispatchLatency &latency = m_d->dispatchLatency[priority];
+    latency.totalTime += waitingTime;
+    latency.maxTime = qMax(latency.maxTime, waitingTime);
+    latency.numJobs++;
+}
@@ -9,6 +9,7 @@
 
 #include "kritaimage_export.h"
 #include "kis_types.h"
+#include "kis_stroke_job_strategy.h"
 
 
 #include <QVector>
@@ -34,6 +35,14 @@ public:
     void reportJobFinished(void *key, const QVector<QRect> &rects);
     void reportUpdateFinished(const QRect &rect);
 
+    /**
+     * Reports that a job of \p priority has been started by the
+     * scheduler \p waitingTime milliseconds after it had been created.
+     * The average and maximum latencies of every priority class are
+     * written into the log together with the other stroke values.
+     */
+    void reportJobDispatched(KisStrokeJobData::Priority priority, qint64 waitingTime);
+
 
 private:
     struct Private;
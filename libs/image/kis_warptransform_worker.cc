@@ -246,8 +246,8 @@ void KisWarpTransformWorker::run(KisPaintDeviceSP srcDev, KisPaintDeviceSP dstDe
 
     FunctionTransformOp functionOp(m_warpMathFunction, m_origPoint, m_transfPoint, m_alpha);
     GridIterationTools::PaintDevicePolygonOp polygonOp(srcDev, dstDev);
-    GridIterationTools::processGrid(polygonOp, functionOp,
-                                    srcBounds, pixelPrecision);
+    GridIterationTools::processGridConcurrently(polygonOp, functionOp,
+                                                srcBounds, pixelPrecision);
 }
 
 #include "krita_utils.h"
@@ -347,7 +347,7 @@ QImage KisWarpTransformWorker::transformQImage(WarpType warpType,
 
     const int pixelPrecision = 32;
     GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage, srcQImageOffset, dstQImageOffset);
-    GridIterationTools::processGrid(polygonOp, functionOp, srcBounds.toAlignedRect(), pixelPrecision);
+    GridIterationTools::processGridConcurrently(polygonOp, functionOp, srcBounds.toAlignedRect(), pixelPrecision);
 
     return dstImage;
 }
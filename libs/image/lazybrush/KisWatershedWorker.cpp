@@ -6,6 +6,12 @@
 
 #include "KisWatershedWorker.h"
 
+#include <functional>
+
+#include <QSet>
+#include <QtConcurrent>
+#include <QtMath>
+
 #include <KoColorSpaceRegistry.h>
 #include <KoColorSpace.h>
 #include <KoColor.h>
@@ -21,6 +27,7 @@
 #include "kis_scanline_fill.h"
 
 #include "kis_random_accessor_ng.h"
+#include "tiles3/kis_tile_data_interface.h"
 
 #include <boost/heap/fibonacci_heap.hpp>
 #include <set>
@@ -152,16 +159,26 @@ void mergeHeightmapOntoStroke(KisPaintDeviceSP stroke, KisPaintDeviceSP heightMa
     }
 }
 
-void parseColorIntoGroups(QVector<FillGroup> &groups,
-                          KisPaintDeviceSP groupMap,
-                          KisPaintDeviceSP heightMap,
-                          int colorIndex,
-                          KisPaintDeviceSP stroke,
-                          const QRect &boundingRect)
+/**
+ * Splits the stroke into contiguous groups of pixels of the same height
+ * and writes their indexes into \p groupMap. The groups are numbered
+ * from 1 in the order of their first pixel in the stroke.
+ *
+ * The function touches \p stroke and \p groupMap only, so different
+ * strokes can be parsed concurrently.
+ *
+ * @return the number of groups found in the stroke
+ */
+int parseColorIntoGroups(KisPaintDeviceSP groupMap,
+                         KisPaintDeviceSP heightMap,
+                         KisPaintDeviceSP stroke,
+                         const QRect &boundingRect)
 {
     const QRect strokeRect = stroke->exactBounds();
     mergeHeightmapOntoStroke(stroke, heightMap, strokeRect);
 
+    int numGroups = 0;
+
     KisSequentialIterator dstIt(stroke, strokeRect);
 
     while (dstIt.nextPixel()) {
@@ -176,16 +193,182 @@ void parseColorIntoGroups(QVector<FillGroup> &groups,
              * the fill strategy. Otherwise the algorithm will not work.
              */
             fill.setThreshold(0);
-            fill.fillContiguousGroup(groupMap, groups.size());
-
-            groups << FillGroup(colorIndex);
+            fill.fillContiguousGroup(groupMap, ++numGroups);
         }
 
     }
+
+    return numGroups;
+}
+
+/**
+ * Splits \p rc into bands covering whole rows of tiles of a device with
+ * the vertical offset \p gridOrigin, so that the bands can be written
+ * in parallel. The bands are returned in top-to-bottom order.
+ */
+QVector<QRect> splitIntoTileBands(const QRect &rc, int gridOrigin)
+{
+    QVector<QRect> bands;
+
+    const int bandSize = KisTileData::HEIGHT;
+
+    for (int y = rc.y(); y <= rc.bottom();) {
+        const int tileStart = gridOrigin + qFloor(qreal(y - gridOrigin) / bandSize) * bandSize;
+        const int bandEnd = qMin(rc.bottom() + 1, tileStart + bandSize);
+        bands << QRect(rc.x(), y, rc.width(), bandEnd - y);
+        y = bandEnd;
+    }
+
+    return bands;
+}
+
+QVector<KoColor> convertColors(const QVector<KoColor> &colors, const KoColorSpace *cs)
+{
+    QVector<KoColor> result;
+    Q_FOREACH (KoColor color, colors) {
+        color.convertTo(cs);
+        result << color;
+    }
+    return result;
 }
 
 using PointsPriorityQueue = boost::heap::fibonacci_heap<TaskPoint, boost::heap::compare<CompareTaskPoints>>;
 
+/**
+ * A tile of the bounding rect flooded by KisWatershedWorker::TiledFlood.
+ * The tile keeps a local copy of the group map and the height map and
+ * a bucket queue: a FIFO of the task points for every height level.
+ * The points are popped from the lowest non-empty bucket, so inside the
+ * tile they are processed in the same order as in the global priority
+ * queue, except that on a plateau the distance grows in the order of
+ * insertion.
+ */
+struct FloodTile
+{
+    static const int numBuckets = 256;
+
+    FloodTile() {}
+    FloodTile(const QRect &_rect)
+        : rect(_rect),
+          groups(_rect.width() * _rect.height()),
+          levels(_rect.width() * _rect.height()),
+          buckets(numBuckets),
+          bucketHeads(numBuckets, 0)
+    {
+    }
+
+    QRect rect;
+    QVector<qint32> groups;
+    QVector<quint8> levels;
+
+    QVector<QVector<TaskPoint>> buckets;
+    QVector<int> bucketHeads;
+    int lowestBucket = numBuckets;
+
+    /**
+     * The points crossing the border of the tile. They have the group,
+     * level and distance of the point they are coming from, the level and
+     * distance of their own are calculated by the receiving tile.
+     */
+    QVector<TaskPoint> outgoingPoints;
+
+    quint64 numFilledPixels = 0;
+
+    inline int index(int x, int y) const {
+        return (y - rect.y()) * rect.width() + (x - rect.x());
+    }
+
+    inline void push(const TaskPoint &pt) {
+        buckets[pt.level].append(pt);
+        lowestBucket = qMin(lowestBucket, int(pt.level));
+    }
+
+    inline void pushNeighbour(int x, int y, quint8 fromDirection, int prevDistance, quint8 prevLevel, qint32 group) {
+        const int idx = index(x, y);
+        if (groups[idx]) return;
+
+        TaskPoint pt;
+        pt.x = x;
+        pt.y = y;
+        pt.group = group;
+        pt.level = levels[idx];
+        pt.distance = pt.level == prevLevel ? prevDistance + 1 : 0;
+        pt.prevDirection = fromDirection;
+
+        push(pt);
+    }
+};
+
+/**
+ * Floods \p tile with all its points lying lower than \p level and with
+ * the points lying at \p level closer than \p maxDistance to the shore.
+ * The rest of the points at \p level is kept for the next wave.
+ */
+void floodTile(FloodTile &tile, int level, int maxDistance, const QRect &boundingRect)
+{
+    QVector<TaskPoint> deferredPoints;
+
+    while (tile.lowestBucket <= level) {
+        const int bucketIndex = tile.lowestBucket;
+        QVector<TaskPoint> &bucket = tile.buckets[bucketIndex];
+        int &head = tile.bucketHeads[bucketIndex];
+
+        if (head >= bucket.size()) {
+            bucket.clear();
+            head = 0;
+
+            int nextBucket = bucketIndex + 1;
+            while (nextBucket < FloodTile::numBuckets &&
+                   tile.bucketHeads[nextBucket] >= tile.buckets[nextBucket].size()) {
+                nextBucket++;
+            }
+            tile.lowestBucket = nextBucket;
+            continue;
+        }
+
+        const TaskPoint pt = bucket[head++];
+
+        if (bucketIndex == level && pt.distance >= maxDistance) {
+            deferredPoints.append(pt);
+            continue;
+        }
+
+        qint32 &groupId = tile.groups[tile.index(pt.x, pt.y)];
+        if (groupId) continue;
+
+        groupId = pt.group;
+        tile.numFilledPixels++;
+
+        const NeighbourStaticOffset *offsets = staticOffsets[pt.prevDirection];
+
+        for (int i = 0; i < 4; i++) {
+            const NeighbourStaticOffset &offset = offsets[i];
+            if (offset.statsOnly) continue;
+
+            const QPoint nextPt = QPoint(pt.x, pt.y) + offset.offset;
+            if (!boundingRect.contains(nextPt)) continue;
+
+            if (tile.rect.contains(nextPt)) {
+                tile.pushNeighbour(nextPt.x(), nextPt.y(), offset.from, pt.distance, pt.level, pt.group);
+            } else {
+                TaskPoint outPt;
+                outPt.x = nextPt.x();
+                outPt.y = nextPt.y();
+                outPt.group = pt.group;
+                outPt.level = pt.level;
+                outPt.distance = pt.distance;
+                outPt.prevDirection = offset.from;
+
+                tile.outgoingPoints.append(outPt);
+            }
+        }
+    }
+
+    Q_FOREACH (const TaskPoint &pt, deferredPoints) {
+        tile.push(pt);
+    }
+}
+
 }
 
 /***********************************************************************/
@@ -204,6 +387,17 @@ struct KisWatershedWorker::Private
 
     QVector<FillGroup> groups;
     KisPaintDeviceSP groupsMap;
+    KisPaintDeviceSP keyStrokeIndexMap;
+
+    FloodMode floodMode = ExactFlood;
+    KisPaintDeviceSP previousKeyStrokeIndexMap;
+    QVector<int> changedKeyStrokes;
+
+    /**
+     * The groups starting from this index keep the basins of the previous
+     * fill that are not refilled (see freezeUnchangedBasins())
+     */
+    qint32 frozenGroupsStart = 0;
 
     CompareTaskPoints pointsComparator;
     PointsPriorityQueue pointsQueue;
@@ -220,13 +414,18 @@ struct KisWatershedWorker::Private
 
     KoUpdater *progressUpdater = 0;
 
+    void parseKeyStrokesIntoGroups();
+    void freezeUnchangedBasins();
     void initializeQueueFromGroupMap(const QRect &rc);
 
     ALWAYS_INLINE void visitNeighbour(const QPoint &currPt, const QPoint &prevPt, quint8 fromDirection, int prevDistance, quint8 prevLevel, qint32 prevGroupId, FillGroup &prevGroup, FillGroup::LevelData &prevLevelData, qint32 prevPrevGroupId, FillGroup &prevPrevGroup, bool statsOnly = false);
     ALWAYS_INLINE void updateGroupLastDistance(FillGroup::LevelData &levelData, int distance);
     void processQueue(qint32 _backgroundGroupId);
+    void processQueueTiled();
     void writeColoring();
 
+    void calculateGroupStatistics();
+
     QVector<TaskPoint> tryRemoveConflictingPlane(qint32 group, quint8 level);
 
     void updateNarrowRegionMetrics();
@@ -298,14 +497,8 @@ void KisWatershedWorker::run(qreal cleanUpAmount)
 {
     if (!m_d->heightMap) return;
 
-    m_d->groups << FillGroup(-1);
-
-    for (int i = 0; i < m_d->keyStrokes.size(); i++) {
-        parseColorIntoGroups(m_d->groups, m_d->groupsMap,
-                             m_d->heightMap,
-                             i, m_d->keyStrokes[i].dev,
-                             m_d->boundingRect);
-    }
+    m_d->parseKeyStrokesIntoGroups();
+    m_d->frozenGroupsStart = m_d->groups.size();
 
 //    m_d->dumpGroupMaps();
 //    m_d->calcNumGroupMaps();
@@ -313,13 +506,30 @@ void KisWatershedWorker::run(qreal cleanUpAmount)
     const QRect initRect =
         m_d->boundingRect & m_d->groupsMap->nonDefaultPixelArea();
 
+    if (m_d->previousKeyStrokeIndexMap) {
+        m_d->freezeUnchangedBasins();
+    }
+
     m_d->initializeQueueFromGroupMap(initRect);
-    m_d->processQueue(0);
+
+    if (m_d->floodMode == TiledFlood) {
+        m_d->processQueueTiled();
+    } else {
+        m_d->processQueue(0);
+    }
 
 //    m_d->dumpGroupMaps();
 //    m_d->calcNumGroupMaps();
 
     if (cleanUpAmount > 0) {
+        /**
+         * The edge statistics are collected by the exact flood only, and
+         * only when it starts from an empty map
+         */
+        if (m_d->floodMode == TiledFlood || m_d->previousKeyStrokeIndexMap) {
+            m_d->calculateGroupStatistics();
+        }
+
         m_d->cleanupForeignEdgeGroups(cleanUpAmount);
     }
 
@@ -329,6 +539,53 @@ void KisWatershedWorker::run(qreal cleanUpAmount)
 
 }
 
+void KisWatershedWorker::setKeyStrokeIndexMap(KisPaintDeviceSP dev)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(dev->pixelSize() == 2);
+    m_d->keyStrokeIndexMap = dev;
+}
+
+void KisWatershedWorker::setFloodMode(FloodMode mode)
+{
+    m_d->floodMode = mode;
+}
+
+void KisWatershedWorker::setPreviousFill(KisPaintDeviceSP previousKeyStrokeIndexMap, const QVector<int> &changedKeyStrokes)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(previousKeyStrokeIndexMap->pixelSize() == 2);
+    m_d->previousKeyStrokeIndexMap = previousKeyStrokeIndexMap;
+    m_d->changedKeyStrokes = changedKeyStrokes;
+}
+
+void KisWatershedWorker::writeColoring(KisPaintDeviceSP keyStrokeIndexMap,
+                                       KisPaintDeviceSP dst,
+                                       const QRect &rc,
+                                       const QVector<KoColor> &_colors)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(keyStrokeIndexMap->pixelSize() == 2);
+
+    const QVector<KoColor> colors = convertColors(_colors, dst->colorSpace());
+    const int colorPixelSize = dst->pixelSize();
+
+    QVector<QRect> bands = splitIntoTileBands(rc, dst->y());
+
+    std::function<void (const QRect &)> processBand =
+        [&] (const QRect &band) {
+            KisSequentialConstIterator srcIt(keyStrokeIndexMap, band);
+            KisSequentialIterator dstIt(dst, band);
+
+            while (srcIt.nextPixel() && dstIt.nextPixel()) {
+                const quint16 index = *reinterpret_cast<const quint16*>(srcIt.rawDataConst());
+
+                if (index > 0 && index <= colors.size()) {
+                    memcpy(dstIt.rawData(), colors[index - 1].data(), colorPixelSize);
+                }
+            }
+        };
+
+    QtConcurrent::blockingMap(bands, processBand);
+}
+
 int KisWatershedWorker::testingGroupPositiveEdge(qint32 group, quint8 level)
 {
     return m_d->groups[group].levels[level].positiveEdgeSize;
@@ -369,30 +626,314 @@ void KisWatershedWorker::testingTryRemoveGroup(qint32 group, quint8 levelIndex)
     m_d->calcNumGroupMaps();
 }
 
-void KisWatershedWorker::Private::initializeQueueFromGroupMap(const QRect &rc)
+void KisWatershedWorker::testingRecalculateGroupStatistics()
 {
-    KisSequentialIterator groupMapIt(groupsMap, rc);
-    KisSequentialConstIterator heightMapIt(heightMap, rc);
+    m_d->calculateGroupStatistics();
+}
 
-    while (groupMapIt.nextPixel() &&
-           heightMapIt.nextPixel()) {
+void KisWatershedWorker::Private::parseKeyStrokesIntoGroups()
+{
+    groups << FillGroup(-1);
 
-        qint32 *groupPtr = reinterpret_cast<qint32*>(groupMapIt.rawData());
-        const quint8 *heightPtr = heightMapIt.rawDataConst();
+    struct StrokeGroups {
+        KisPaintDeviceSP stroke;
+        KisPaintDeviceSP groupMap;
+        int numGroups = 0;
+    };
 
-        if (*groupPtr > 0) {
-            TaskPoint pt;
-            pt.x = groupMapIt.x();
-            pt.y = groupMapIt.y();
-            pt.group = *groupPtr;
-            pt.level = *heightPtr;
+    QVector<StrokeGroups> strokes;
+    Q_FOREACH (const KeyStroke &keyStroke, keyStrokes) {
+        StrokeGroups s;
+        s.stroke = keyStroke.dev;
+        s.groupMap = new KisPaintDevice(groupsMap->colorSpace());
+        strokes << s;
+    }
 
-            pointsQueue.push(pt);
+    /**
+     * The key strokes never intersect (see addKeyStroke()), so every
+     * stroke can be split into groups in a separate thread. Every stroke
+     * gets its own group map with the local group numbering.
+     */
+    std::function<void (StrokeGroups &)> parseStroke =
+        [this] (StrokeGroups &s) {
+            s.numGroups = parseColorIntoGroups(s.groupMap, heightMap, s.stroke, boundingRect);
+        };
+
+    QtConcurrent::blockingMap(strokes, parseStroke);
+
+    /**
+     * Now merge the local maps into the global one. The global index of
+     * a group is the same as if the strokes were parsed one by one.
+     */
+    QVector<qint32> groupOffsets;
+    QRect mapRect;
+
+    for (int i = 0; i < strokes.size(); i++) {
+        groupOffsets << groups.size() - 1;
+        mapRect |= strokes[i].groupMap->extent();
+
+        for (int j = 0; j < strokes[i].numGroups; j++) {
+            groups << FillGroup(i);
+        }
+    }
+
+    QVector<QRect> bands = splitIntoTileBands(mapRect, groupsMap->y());
+
+    std::function<void (const QRect &)> mergeBand =
+        [&] (const QRect &band) {
+            for (int i = 0; i < strokes.size(); i++) {
+                const QRect rc = band & strokes[i].groupMap->extent();
+                if (rc.isEmpty()) continue;
+
+                const qint32 offset = groupOffsets[i];
+
+                KisSequentialConstIterator srcIt(strokes[i].groupMap, rc);
+                KisRandomAccessorSP dstIt = groupsMap->createRandomAccessorNG();
+
+                while (srcIt.nextPixel()) {
+                    const qint32 group = *reinterpret_cast<const qint32*>(srcIt.rawDataConst());
+
+                    if (group > 0) {
+                        dstIt->moveTo(srcIt.x(), srcIt.y());
+                        *reinterpret_cast<qint32*>(dstIt->rawData()) = offset + group;
+                    }
+                }
+            }
+        };
+
+    QtConcurrent::blockingMap(bands, mergeBand);
+}
+
+/**
+ * Keeps the basins of the previous fill that cannot be affected by the
+ * changed key strokes. The basins of the changed key strokes, of the key
+ * strokes they are painted over, and of all their neighbours are flooded
+ * again. The rest of the previous basins are written into the group map
+ * as "frozen" groups, so the flood cannot enter them. The frozen pixels
+ * bordering the refilled area are cleared and pushed into the queue, so
+ * that the frozen basins can compete for the refilled area as well.
+ */
+void KisWatershedWorker::Private::freezeUnchangedBasins()
+{
+    const int numKeyStrokes = keyStrokes.size();
+
+    QVector<bool> isChangedKeyStroke(numKeyStrokes, false);
+    Q_FOREACH (int index, changedKeyStrokes) {
+        KIS_SAFE_ASSERT_RECOVER(index >= 0 && index < numKeyStrokes) { continue; }
+        isChangedKeyStroke[index] = true;
+    }
+
+    struct Band {
+        QRect rect;
+        QSet<quint32> adjacentLabels;
+        QSet<quint16> paintedOverLabels;
+        QVector<TaskPoint> borderPoints;
+    };
+
+    QVector<Band> bands;
+    Q_FOREACH (const QRect &rect, splitIntoTileBands(boundingRect, groupsMap->y())) {
+        Band band;
+        band.rect = rect;
+        bands << band;
+    }
+
+    auto readLabels = [this] (const QRect &rc) {
+        QVector<quint16> labels(rc.width() * rc.height());
+        previousKeyStrokeIndexMap->readBytes(reinterpret_cast<quint8*>(labels.data()), rc);
+        return labels;
+    };
+
+    auto labelPair = [] (quint16 a, quint16 b) {
+        return a < b ? (quint32(a) << 16) | b : (quint32(b) << 16) | a;
+    };
+
+    const QVector<FillGroup> &constGroups = groups;
+
+    std::function<void (Band &)> collectLabels =
+        [&] (Band &band) {
+            const QRect readRect = band.rect.adjusted(0, 0, 0, 1) & boundingRect;
+            const QVector<quint16> labels = readLabels(readRect);
+
+            QVector<qint32> groupIds(band.rect.width() * band.rect.height());
+            groupsMap->readBytes(reinterpret_cast<quint8*>(groupIds.data()), band.rect);
+
+            const int w = readRect.width();
+
+            for (int row = 0; row < band.rect.height(); row++) {
+                for (int col = 0; col < w; col++) {
+                    const int idx = row * w + col;
+                    const quint16 label = labels[idx];
+
+                    if (col + 1 < w && labels[idx + 1] != label) {
+                        band.adjacentLabels.insert(labelPair(label, labels[idx + 1]));
+                    }
+
+                    if (row + 1 < readRect.height() && labels[idx + w] != label) {
+                        band.adjacentLabels.insert(labelPair(label, labels[idx + w]));
+                    }
+
+                    const qint32 group = groupIds[idx];
+                    if (group > 0 && isChangedKeyStroke[constGroups[group].colorIndex]) {
+                        band.paintedOverLabels.insert(label);
+                    }
+                }
+            }
+        };
+
+    QtConcurrent::blockingMap(bands, collectLabels);
+
+    QVector<bool> isRefilledLabel(numKeyStrokes + 1, false);
+
+    for (int i = 0; i < numKeyStrokes; i++) {
+        isRefilledLabel[i + 1] = isChangedKeyStroke[i];
+    }
+
+    Q_FOREACH (const Band &band, bands) {
+        Q_FOREACH (quint16 label, band.paintedOverLabels) {
+            if (label <= numKeyStrokes) {
+                isRefilledLabel[label] = true;
+            }
+        }
+    }
+
+    QVector<bool> isFrozenLabel(numKeyStrokes + 1, false);
 
-            // we must clear the pixel to make sure foreign metric is calculated correctly
-            *groupPtr = 0;
+    for (int i = 1; i <= numKeyStrokes; i++) {
+        isFrozenLabel[i] = !isRefilledLabel[i];
+    }
+
+    Q_FOREACH (const Band &band, bands) {
+        Q_FOREACH (quint32 pair, band.adjacentLabels) {
+            const quint16 a = pair >> 16;
+            const quint16 b = pair & 0xffff;
+
+            if (a > numKeyStrokes || b > numKeyStrokes) continue;
+
+            if (isRefilledLabel[a]) {
+                isFrozenLabel[b] = false;
+            }
+
+            if (isRefilledLabel[b]) {
+                isFrozenLabel[a] = false;
+            }
         }
+    }
 
+    for (int i = 0; i < numKeyStrokes; i++) {
+        groups << FillGroup(i);
+    }
+
+    auto isFrozen = [&isFrozenLabel, numKeyStrokes] (quint16 label) {
+        return label <= numKeyStrokes && isFrozenLabel[label];
+    };
+
+    std::function<void (Band &)> freezeBand =
+        [&] (Band &band) {
+            const QRect readRect = band.rect.adjusted(0, -1, 0, 1) & boundingRect;
+            const QVector<quint16> labels = readLabels(readRect);
+
+            QVector<quint8> levels(band.rect.width() * band.rect.height());
+            heightMap->readBytes(levels.data(), band.rect);
+
+            const int w = readRect.width();
+            int levelIdx = 0;
+
+            KisSequentialIterator groupMapIt(groupsMap, band.rect);
+
+            while (groupMapIt.nextPixel()) {
+                const int x = groupMapIt.x();
+                const int y = groupMapIt.y();
+                const int idx = (y - readRect.y()) * w + (x - readRect.x());
+                const quint16 label = labels[idx];
+                const quint8 level = levels[levelIdx++];
+
+                if (!isFrozen(label)) continue;
+
+                const bool isBorder =
+                    (x > readRect.left() && !isFrozen(labels[idx - 1])) ||
+                    (x < readRect.right() && !isFrozen(labels[idx + 1])) ||
+                    (y > readRect.top() && !isFrozen(labels[idx - w])) ||
+                    (y < readRect.bottom() && !isFrozen(labels[idx + w]));
+
+                const qint32 frozenGroup = frozenGroupsStart + label - 1;
+                qint32 *groupPtr = reinterpret_cast<qint32*>(groupMapIt.rawData());
+
+                if (isBorder) {
+                    TaskPoint pt;
+                    pt.x = x;
+                    pt.y = y;
+                    pt.group = frozenGroup;
+                    pt.level = level;
+
+                    band.borderPoints.append(pt);
+                    *groupPtr = 0;
+                } else {
+                    *groupPtr = frozenGroup;
+                }
+            }
+        };
+
+    QtConcurrent::blockingMap(bands, freezeBand);
+
+    Q_FOREACH (const Band &band, bands) {
+        Q_FOREACH (const TaskPoint &pt, band.borderPoints) {
+            pointsQueue.push(pt);
+        }
+    }
+}
+
+void KisWatershedWorker::Private::initializeQueueFromGroupMap(const QRect &rc)
+{
+    struct Band {
+        QRect rect;
+        QVector<TaskPoint> points;
+    };
+
+    QVector<Band> bands;
+    Q_FOREACH (const QRect &rect, splitIntoTileBands(rc, groupsMap->y())) {
+        Band band;
+        band.rect = rect;
+        bands << band;
+    }
+
+    std::function<void (Band &)> processBand =
+        [this] (Band &band) {
+            KisSequentialIterator groupMapIt(groupsMap, band.rect);
+            KisSequentialConstIterator heightMapIt(heightMap, band.rect);
+
+            while (groupMapIt.nextPixel() &&
+                   heightMapIt.nextPixel()) {
+
+                qint32 *groupPtr = reinterpret_cast<qint32*>(groupMapIt.rawData());
+                const quint8 *heightPtr = heightMapIt.rawDataConst();
+
+                if (*groupPtr > 0 && *groupPtr < frozenGroupsStart) {
+                    TaskPoint pt;
+                    pt.x = groupMapIt.x();
+                    pt.y = groupMapIt.y();
+                    pt.group = *groupPtr;
+                    pt.level = *heightPtr;
+
+                    band.points.append(pt);
+
+                    // we must clear the pixel to make sure foreign metric is calculated correctly
+                    *groupPtr = 0;
+                }
+
+            }
+        };
+
+    QtConcurrent::blockingMap(bands, processBand);
+
+    /**
+     * The order of insertion into the queue defines the order in which
+     * the points of equal priority are popped, so the points are pushed
+     * in the same scanline order as the sequential scan would do.
+     */
+    Q_FOREACH (const Band &band, bands) {
+        Q_FOREACH (const TaskPoint &pt, band.points) {
+            pointsQueue.push(pt);
+        }
     }
 }
 
@@ -704,28 +1245,287 @@ void KisWatershedWorker::Private::processQueue(qint32 _backgroundGroupId)
 //    ENTER_FUNCTION() << ppVar(tt.elapsed());
 }
 
-void KisWatershedWorker::Private::writeColoring()
+void KisWatershedWorker::Private::processQueueTiled()
 {
-    KisSequentialConstIterator srcIt(groupsMap, boundingRect);
-    KisSequentialIterator dstIt(dstDevice, boundingRect);
+    /**
+     * The tiles are flooded level by level. Every level is flooded in
+     * waves: in every wave each tile floods its pixels until the distance
+     * to the shore reaches the limit of the wave, and then the points
+     * crossing the borders of the tiles are passed to their neighbours.
+     */
+    const int waveDistance = 16;
+
+    const int tileWidth = KisTileData::WIDTH;
+    const int tileHeight = KisTileData::HEIGHT;
+
+    const int gridX = groupsMap->x() + qFloor(qreal(boundingRect.x() - groupsMap->x()) / tileWidth) * tileWidth;
+    const int gridY = groupsMap->y() + qFloor(qreal(boundingRect.y() - groupsMap->y()) / tileHeight) * tileHeight;
+    const int numColumns = (boundingRect.right() - gridX) / tileWidth + 1;
+    const int numRows = (boundingRect.bottom() - gridY) / tileHeight + 1;
+
+    QVector<FloodTile> tiles;
+    tiles.reserve(numColumns * numRows);
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numColumns; col++) {
+            const QRect rc(gridX + col * tileWidth, gridY + row * tileHeight, tileWidth, tileHeight);
+            tiles << FloodTile(rc & boundingRect);
+        }
+    }
 
-    QVector<KoColor> colors;
+    auto tileAt = [&] (int x, int y) -> FloodTile& {
+        return tiles[(y - gridY) / tileHeight * numColumns + (x - gridX) / tileWidth];
+    };
+
+    std::function<void (FloodTile &)> readTile =
+        [this] (FloodTile &tile) {
+            groupsMap->readBytes(reinterpret_cast<quint8*>(tile.groups.data()), tile.rect);
+            heightMap->readBytes(tile.levels.data(), tile.rect);
+        };
+
+    QtConcurrent::blockingMap(tiles, readTile);
+
+    while (!pointsQueue.empty()) {
+        const TaskPoint pt = pointsQueue.top();
+        pointsQueue.pop();
+
+        tileAt(pt.x, pt.y).push(pt);
+    }
+
+    totalPixelsToFill = qint64(boundingRect.width()) * boundingRect.height();
+    numFilledPixels = 0;
+
+    auto lowestLevel = [&tiles] () {
+        int level = FloodTile::numBuckets;
+        for (auto it = tiles.constBegin(); it != tiles.constEnd(); ++it) {
+            level = qMin(level, it->lowestBucket);
+        }
+        return level;
+    };
+
+    for (int level = lowestLevel(); level < FloodTile::numBuckets; level = lowestLevel()) {
+        for (int maxDistance = waveDistance; ; maxDistance += waveDistance) {
+            QVector<FloodTile*> activeTiles;
+
+            for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+                if (it->lowestBucket <= level) {
+                    activeTiles << &(*it);
+                }
+            }
+
+            if (activeTiles.isEmpty()) break;
+
+            std::function<void (FloodTile *)> processTile =
+                [this, level, maxDistance] (FloodTile *tile) {
+                    floodTile(*tile, level, maxDistance, boundingRect);
+                };
+
+            QtConcurrent::blockingMap(activeTiles, processTile);
+
+            /**
+             * The points are passed to the neighbours in a fixed order,
+             * so the result does not depend on the thread scheduling.
+             */
+            numFilledPixels = 0;
+
+            for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+                Q_FOREACH (const TaskPoint &pt, it->outgoingPoints) {
+                    tileAt(pt.x, pt.y).pushNeighbour(pt.x, pt.y, pt.prevDirection, pt.distance, pt.level, pt.group);
+                }
+                it->outgoingPoints.clear();
+
+                numFilledPixels += it->numFilledPixels;
+            }
+
+            if (progressUpdater) {
+                const int progressPercent =
+                    qBound(0, qRound(100.0 * numFilledPixels / totalPixelsToFill), 100);
+                progressUpdater->setProgress(progressPercent);
+            }
+        }
+    }
+
+    std::function<void (FloodTile &)> writeTile =
+        [this] (FloodTile &tile) {
+            KisSequentialIterator groupMapIt(groupsMap, tile.rect);
+            int idx = 0;
+
+            while (groupMapIt.nextPixel()) {
+                *reinterpret_cast<qint32*>(groupMapIt.rawData()) = tile.groups[idx++];
+            }
+        };
+
+    QtConcurrent::blockingMap(tiles, writeTile);
+}
+
+void KisWatershedWorker::Private::writeColoring()
+{
+    QVector<KoColor> keyStrokeColors;
     for (auto it = keyStrokes.begin(); it != keyStrokes.end(); ++it) {
-        KoColor color = it->color;
-        color.convertTo(dstDevice->colorSpace());
-        colors << color;
+        keyStrokeColors << it->color;
     }
+
+    const QVector<KoColor> colors = convertColors(keyStrokeColors, dstDevice->colorSpace());
+    const QVector<FillGroup> &constGroups = groups;
     const int colorPixelSize = dstDevice->pixelSize();
 
+    if (keyStrokeIndexMap) {
+        keyStrokeIndexMap->clear();
+    }
 
-    while (srcIt.nextPixel() && dstIt.nextPixel()) {
-        const qint32 *srcPtr = reinterpret_cast<const qint32*>(srcIt.rawDataConst());
+    QVector<QRect> bands = splitIntoTileBands(boundingRect, dstDevice->y());
 
-        const int colorIndex = groups[*srcPtr].colorIndex;
-        if (colorIndex >= 0) {
-            memcpy(dstIt.rawData(), colors[colorIndex].data(), colorPixelSize);
-        }
+    std::function<void (const QRect &)> processBand =
+        [&] (const QRect &band) {
+            KisSequentialConstIterator srcIt(groupsMap, band);
+            KisSequentialIterator dstIt(dstDevice, band);
+            QScopedPointer<KisSequentialIterator> indexIt;
+
+            if (keyStrokeIndexMap) {
+                indexIt.reset(new KisSequentialIterator(keyStrokeIndexMap, band));
+            }
+
+            while (srcIt.nextPixel() && dstIt.nextPixel()) {
+                const qint32 *srcPtr = reinterpret_cast<const qint32*>(srcIt.rawDataConst());
+
+                const int colorIndex = constGroups[*srcPtr].colorIndex;
+                if (colorIndex >= 0) {
+                    memcpy(dstIt.rawData(), colors[colorIndex].data(), colorPixelSize);
+                }
+
+                if (indexIt) {
+                    indexIt->nextPixel();
+                    *reinterpret_cast<quint16*>(indexIt->rawData()) = quint16(colorIndex + 1);
+                }
+            }
+        };
+
+    QtConcurrent::blockingMap(bands, processBand);
+}
+
+/**
+ * Calculates the edge statistics of the groups from the final group map.
+ * The result is the same as the statistics collected by processQueue()
+ * while flooding an empty map: every pair of neighbouring pixels is
+ * accounted once, when the second pixel of the pair is filled.
+ */
+void KisWatershedWorker::Private::calculateGroupStatistics()
+{
+    for (auto it = groups.begin(); it != groups.end(); ++it) {
+        it->levels.clear();
+    }
+
+    struct Band {
+        QRect rect;
+        QMap<quint64, FillGroup::LevelData> levels;
+    };
+
+    QVector<Band> bands;
+    Q_FOREACH (const QRect &rect, splitIntoTileBands(boundingRect, groupsMap->y())) {
+        Band band;
+        band.rect = rect;
+        bands << band;
+    }
+
+    QVector<int> colorIndexes;
+    Q_FOREACH (const FillGroup &group, groups) {
+        colorIndexes << group.colorIndex;
+    }
+
+    std::function<void (Band &)> processBand =
+        [this, &colorIndexes] (Band &band) {
+            const QRect readRect = band.rect.adjusted(0, 0, 0, 1) & boundingRect;
+
+            QVector<qint32> groupIds(readRect.width() * readRect.height());
+            QVector<quint8> levels(readRect.width() * readRect.height());
+            groupsMap->readBytes(reinterpret_cast<quint8*>(groupIds.data()), readRect);
+            heightMap->readBytes(levels.data(), readRect);
+
+            auto levelData = [&band] (qint32 group, quint8 level) -> FillGroup::LevelData& {
+                return band.levels[(quint64(group) << 8) | level];
+            };
+
+            auto visitPair = [&] (qint32 group, quint8 level, FillGroup::LevelData &data,
+                                  const QPoint &pt, int otherIdx, const QPoint &otherPt) {
+
+                const qint32 otherGroup = groupIds[otherIdx];
+                if (!otherGroup) return;
+
+                const quint8 otherLevel = levels[otherIdx];
+
+                if (otherGroup == group) {
+                    if (otherLevel != level) {
+                        incrementLevelEdge(levelData(otherGroup, otherLevel), data,
+                                           otherLevel, level);
+                    }
+                    return;
+                }
+
+                FillGroup::LevelData &otherData = levelData(otherGroup, otherLevel);
+
+                if (colorIndexes[group] != colorIndexes[otherGroup] || level != otherLevel) {
+                    data.foreignEdgeSize++;
+                    otherData.foreignEdgeSize++;
 
+                    if (level == otherLevel) {
+                        data.conflictWithGroup[otherGroup].insert(pt);
+                        otherData.conflictWithGroup[group].insert(otherPt);
+                    }
+                } else {
+                    data.allyEdgeSize++;
+                    otherData.allyEdgeSize++;
+                }
+            };
+
+            const int w = readRect.width();
+
+            for (int y = band.rect.top(); y <= band.rect.bottom(); y++) {
+                for (int x = band.rect.left(); x <= band.rect.right(); x++) {
+                    const int idx = (y - readRect.y()) * w + (x - readRect.x());
+
+                    const qint32 group = groupIds[idx];
+                    if (!group) continue;
+
+                    const quint8 level = levels[idx];
+                    FillGroup::LevelData &data = levelData(group, level);
+
+                    data.numFilledPixels++;
+
+                    // the outside of the bounding rect is considered as +inf height
+                    data.positiveEdgeSize +=
+                        int(x == boundingRect.left()) + int(x == boundingRect.right()) +
+                        int(y == boundingRect.top()) + int(y == boundingRect.bottom());
+
+                    const QPoint pt(x, y);
+
+                    if (x < boundingRect.right()) {
+                        visitPair(group, level, data, pt, idx + 1, QPoint(x + 1, y));
+                    }
+
+                    if (y < boundingRect.bottom()) {
+                        visitPair(group, level, data, pt, idx + w, QPoint(x, y + 1));
+                    }
+                }
+            }
+        };
+
+    QtConcurrent::blockingMap(bands, processBand);
+
+    Q_FOREACH (const Band &band, bands) {
+        for (auto it = band.levels.constBegin(); it != band.levels.constEnd(); ++it) {
+            const FillGroup::LevelData &src = it.value();
+            FillGroup::LevelData &dst = groups[qint32(it.key() >> 8)].levels[int(it.key() & 0xff)];
+
+            dst.positiveEdgeSize += src.positiveEdgeSize;
+            dst.negativeEdgeSize += src.negativeEdgeSize;
+            dst.foreignEdgeSize += src.foreignEdgeSize;
+            dst.allyEdgeSize += src.allyEdgeSize;
+            dst.numFilledPixels += src.numFilledPixels;
+
+            for (auto conflictIt = src.conflictWithGroup.constBegin(); conflictIt != src.conflictWithGroup.constEnd(); ++conflictIt) {
+                dst.conflictWithGroup[conflictIt.key()].insert(conflictIt->begin(), conflictIt->end());
+            }
+        }
     }
 }
 
@@ -775,7 +1575,8 @@ QVector<GroupLevelPair> KisWatershedWorker::Private::calculateConflictingPairs()
     QVector<GroupLevelPair> result;
 
 
-    for (qint32 i = 0; i < groups.size(); i++) {
+    // the basins kept from the previous fill are never removed
+    for (qint32 i = 0; i < frozenGroupsStart; i++) {
         FillGroup &group = groups[i];
 
         for (auto levelIt = group.levels.begin(); levelIt != group.levels.end(); ++levelIt) {
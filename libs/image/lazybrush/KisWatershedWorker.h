@@ -8,6 +8,7 @@
 #define KISWATERSHEDWORKER_H
 
 #include <QScopedPointer>
+#include <QVector>
 
 #include "kis_types.h"
 #include "kritaimage_export.h"
@@ -16,6 +17,28 @@ class KoColor;
 
 class KRITAIMAGE_EXPORT KisWatershedWorker
 {
+public:
+    /**
+     * The algorithm used for flooding the height map
+     */
+    enum FloodMode {
+        /**
+         * All the pixels are flooded from a single priority queue. The
+         * result is exact, but the flooding is sequential.
+         */
+        ExactFlood,
+
+        /**
+         * Every tile of the bounding rect is flooded from its own bucket
+         * queue (a FIFO per height level) in a separate thread. The tiles
+         * are flooded level by level and exchange the points crossing
+         * their borders after every few pixels of the flooding distance,
+         * so the borders of the basins lying on the plateaus may be
+         * shifted by a few pixels in comparison to ExactFlood.
+         */
+        TiledFlood
+    };
+
 public:
     /**
      * Creates an empty watershed worker without any strokes attached. The strokes
@@ -55,6 +78,50 @@ public:
 
     void run(qreal cleanUpAmount = 0.0);
 
+    /**
+     * @brief Sets the device where run() will save the index of the key stroke
+     *        that filled every pixel of the bounding rect
+     *
+     * The map is an alpha16 device, with "0" meaning an unfilled pixel and "i + 1"
+     * meaning the pixel belongs to the i-th key stroke. The result of the fill
+     * depends on the colors of the key strokes only via this map, so the map
+     * can be passed to writeColoring() later to recolor the fill without running
+     * the watershed again.
+     */
+    void setKeyStrokeIndexMap(KisPaintDeviceSP dev);
+
+    /**
+     * Sets the algorithm used for flooding, ExactFlood by default.
+     */
+    void setFloodMode(FloodMode mode);
+
+    /**
+     * @brief Makes run() refill only the basins reachable from the changed key strokes
+     *
+     * @param previousKeyStrokeIndexMap the key stroke index map saved by a previous
+     *        run() (see setKeyStrokeIndexMap()) for the same height map, bounding rect
+     *        and key strokes, except the ones listed in \p changedKeyStrokes. It may be
+     *        the same device as the one passed to setKeyStrokeIndexMap().
+     * @param changedKeyStrokes the indexes of the key strokes whose pixels have changed
+     *
+     * The basins of the changed key strokes, of the key strokes they are painted over,
+     * and of all their neighbours are flooded again. The rest of the previous fill is
+     * kept as it is, and its pixels bordering the refilled area are flooded from anew
+     * to compete for that area.
+     */
+    void setPreviousFill(KisPaintDeviceSP previousKeyStrokeIndexMap, const QVector<int> &changedKeyStrokes);
+
+    /**
+     * @brief writes coloring of \p rc into \p dst using the key stroke index map
+     *        saved by a previous run()
+     * @param colors the colors of the key strokes in the order they were added
+     *               to the worker
+     */
+    static void writeColoring(KisPaintDeviceSP keyStrokeIndexMap,
+                              KisPaintDeviceSP dst,
+                              const QRect &rc,
+                              const QVector<KoColor> &colors);
+
     int testingGroupPositiveEdge(qint32 group, quint8 level);
     int testingGroupNegativeEdge(qint32 group, quint8 level);
     int testingGroupForeignEdge(qint32 group, quint8 level);
@@ -62,6 +129,7 @@ public:
     int testingGroupConflicts(qint32 group, quint8 level, qint32 withGroup);
 
     void testingTryRemoveGroup(qint32 group, quint8 level);
+    void testingRecalculateGroupStatistics();
 
 private:
     struct Private;
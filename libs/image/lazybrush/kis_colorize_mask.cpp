@@ -8,6 +8,8 @@
 #include "kis_colorize_mask.h"
 
 #include <QCoreApplication>
+#include <QQueue>
+#include <QSet>
 #include <QStack>
 
 #include <KoColorSpaceRegistry.h>
@@ -34,6 +36,8 @@
 #include "kis_command_utils.h"
 #include "kis_processing_applicator.h"
 #include "krita_utils.h"
+#include "kis_datamanager.h"
+#include "tiles3/kis_tile.h"
 #include <KisFakeRunnableStrokeJobsExecutor.h>
 #include <KisRunnableStrokeJobData.h>
 #include <KisRunnableStrokeJobUtils.h>
@@ -49,6 +53,7 @@ struct KisColorizeMask::Private
           coloringProjection(new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8())),
           fakePaintDevice(new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8())),
           filteredSource(new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8())),
+          keyStrokeIndexMap(new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha16())),
           needAddCurrentKeyStroke(false),
           showKeyStrokes(true),
           showColoring(true),
@@ -66,6 +71,7 @@ struct KisColorizeMask::Private
         coloringProjection->setDefaultBounds(bounds);
         fakePaintDevice->setDefaultBounds(bounds);
         filteredSource->setDefaultBounds(bounds);
+        keyStrokeIndexMap->setDefaultBounds(bounds);
     }
 
     Private(const Private &rhs, KisColorizeMask *_q)
@@ -73,6 +79,7 @@ struct KisColorizeMask::Private
           coloringProjection(new KisPaintDevice(*rhs.coloringProjection)),
           fakePaintDevice(new KisPaintDevice(*rhs.fakePaintDevice)),
           filteredSource(new KisPaintDevice(*rhs.filteredSource)),
+          keyStrokeIndexMap(new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha16())),
           filteredDeviceBounds(rhs.filteredDeviceBounds),
           needAddCurrentKeyStroke(rhs.needAddCurrentKeyStroke),
           showKeyStrokes(rhs.showKeyStrokes),
@@ -90,6 +97,8 @@ struct KisColorizeMask::Private
         Q_FOREACH (const KeyStroke &stroke, rhs.keyStrokes) {
             keyStrokes << KeyStroke(KisPaintDeviceSP(new KisPaintDevice(*stroke.dev)), stroke.color, stroke.isTransparent);
         }
+
+        keyStrokeIndexMap->setDefaultBounds(filteredSource->defaultBounds());
     }
 
     KisColorizeMask *q = 0;
@@ -98,6 +107,7 @@ struct KisColorizeMask::Private
     KisPaintDeviceSP coloringProjection;
     KisPaintDeviceSP fakePaintDevice;
     KisPaintDeviceSP filteredSource;
+    KisPaintDeviceSP keyStrokeIndexMap;
     QRect filteredDeviceBounds;
 
     KoColor currentColor;
@@ -125,10 +135,31 @@ struct KisColorizeMask::Private
 
     bool limitToDeviceBounds = false;
 
+    /**
+     * The inputs of the fill that generated keyStrokeIndexMap. When none
+     * of them has changed, the fill is only recolored with the new colors
+     * of the key strokes. When only some key strokes have been painted on,
+     * only the basins reachable from them are refilled.
+     */
+    struct FillState {
+        bool isValid = false;
+        QRect fillBounds;
+        qreal cleanUpAmount = 0.0;
+        int writeEpoch = 0;
+        QVector<KisPaintDeviceSP> keyStrokeDevices;
+        QVector<QSet<quint64>> keyStrokeTiles;
+    };
+
+    FillState fillState;
+    QQueue<FillState> pendingFillStates;
+
     bool filteredSourceValid(KisPaintDeviceSP parentDevice) {
         return !filteringDirty && originalSequenceNumber == parentDevice->sequenceNumber();
     }
 
+    FillState captureFillState(const QRect &fillBounds);
+    bool fillStateMatches(const QRect &fillBounds, QVector<int> *changedKeyStrokes) const;
+
     void setNeedsUpdateImpl(bool value, bool requestedByUser);
 
     bool shouldShowFilteredSource() const;
@@ -289,6 +320,55 @@ KUndo2Command *KisColorizeMask::setColorSpace(const KoColorSpace *dstColorSpace,
     return composite;
 }
 
+KisColorizeMask::Private::FillState KisColorizeMask::Private::captureFillState(const QRect &fillBounds)
+{
+    FillState state;
+    state.isValid = true;
+    state.fillBounds = fillBounds;
+    state.cleanUpAmount = filteringOptions.cleanUpAmount;
+    state.writeEpoch = KisTile::advanceWriteEpoch();
+
+    Q_FOREACH (const KeyStroke &stroke, keyStrokes) {
+        QSet<quint64> tiles;
+        QVector<QRect> changedTiles;
+        stroke.dev->dataManager()->collectChangedTiles(state.writeEpoch, &tiles, &changedTiles);
+
+        state.keyStrokeDevices << stroke.dev;
+        state.keyStrokeTiles << tiles;
+    }
+
+    return state;
+}
+
+bool KisColorizeMask::Private::fillStateMatches(const QRect &fillBounds, QVector<int> *changedKeyStrokes) const
+{
+    changedKeyStrokes->clear();
+
+    if (!fillState.isValid ||
+        fillState.fillBounds != fillBounds ||
+        !qFuzzyCompare(fillState.cleanUpAmount, filteringOptions.cleanUpAmount) ||
+        fillState.keyStrokeDevices.size() != keyStrokes.size()) {
+
+        return false;
+    }
+
+    for (int i = 0; i < keyStrokes.size(); i++) {
+        KisPaintDeviceSP dev = keyStrokes[i].dev;
+        if (dev != fillState.keyStrokeDevices[i]) return false;
+
+        // the stroke has been painted on or some of its tiles have been removed
+        QSet<quint64> tiles;
+        QVector<QRect> changedTiles;
+        dev->dataManager()->collectChangedTiles(fillState.writeEpoch, &tiles, &changedTiles);
+
+        if (!changedTiles.isEmpty() || tiles != fillState.keyStrokeTiles[i]) {
+            changedKeyStrokes->append(i);
+        }
+    }
+
+    return true;
+}
+
 bool KisColorizeMask::needsUpdate() const
 {
     return m_d->needsUpdate;
@@ -320,6 +400,10 @@ void KisColorizeMask::slotUpdateRegenerateFilling(bool prefilterOnly)
     m_d->originalSequenceNumber = src->sequenceNumber();
     m_d->filteringDirty = false;
 
+    if (!filteredSourceValid) {
+        m_d->fillState.isValid = false;
+    }
+
     if (!prefilterOnly) {
         m_d->coloringProjection->clear();
     }
@@ -345,6 +429,18 @@ void KisColorizeMask::slotUpdateRegenerateFilling(bool prefilterOnly)
 
         m_d->filteredDeviceBounds = fillBounds;
 
+        Private::FillState newFillState;
+        bool canReuseKeyStrokeIndexMap = false;
+        QVector<int> changedKeyStrokes;
+
+        if (!prefilterOnly) {
+            canReuseKeyStrokeIndexMap = m_d->fillStateMatches(fillBounds, &changedKeyStrokes);
+            newFillState = m_d->captureFillState(fillBounds);
+
+            // the map is going to be overwritten by the stroke
+            m_d->fillState.isValid = false;
+        }
+
         KisColorizeStrokeStrategy *strategy =
             new KisColorizeStrokeStrategy(src,
                                           m_d->coloringProjection,
@@ -355,6 +451,7 @@ void KisColorizeMask::slotUpdateRegenerateFilling(bool prefilterOnly)
                                           prefilterOnly);
 
         strategy->setFilteringOptions(m_d->filteringOptions);
+        strategy->setKeyStrokeIndexMap(m_d->keyStrokeIndexMap, canReuseKeyStrokeIndexMap, changedKeyStrokes);
 
         Q_FOREACH (const KeyStroke &stroke, m_d->keyStrokes) {
             const KoColor color =
@@ -366,6 +463,7 @@ void KisColorizeMask::slotUpdateRegenerateFilling(bool prefilterOnly)
         }
 
         m_d->extentBeforeUpdateStart.push(extent());
+        m_d->pendingFillStates.enqueue(newFillState);
 
         connect(strategy, SIGNAL(sigFinished(bool)), SLOT(slotRegenerationFinished(bool)));
         connect(strategy, SIGNAL(sigCancelled()), SLOT(slotRegenerationCancelled()));
@@ -411,6 +509,17 @@ void KisColorizeMask::slotRegenerationFinished(bool prefilterOnly)
         m_d->setNeedsUpdateImpl(false, false);
     }
 
+    /**
+     * Every started regeneration is either finished or cancelled, and
+     * they are processed in the order they were started.
+     */
+    if (!m_d->pendingFillStates.isEmpty()) {
+        Private::FillState fillState = m_d->pendingFillStates.dequeue();
+        if (!prefilterOnly) {
+            m_d->fillState = fillState;
+        }
+    }
+
     QRect oldExtent;
 
     if (!m_d->extentBeforeUpdateStart.isEmpty()) {
@@ -677,6 +786,7 @@ void KisColorizeMask::setImage(KisImageWSP image)
     m_d->coloringProjection->setDefaultBounds(bounds);
     m_d->fakePaintDevice->setDefaultBounds(bounds);
     m_d->filteredSource->setDefaultBounds(bounds);
+    m_d->keyStrokeIndexMap->setDefaultBounds(bounds);
 }
 
 void KisColorizeMask::setCurrentColor(const KoColor &_color)
@@ -1189,4 +1299,7 @@ void KisColorizeMask::moveAllInternalDevices(const QPoint &diff)
     Q_FOREACH (KisPaintDeviceSP dev, devices) {
         dev->moveTo(dev->offset() + diff);
     }
+
+    // the map is not moved together with the key strokes
+    m_d->fillState.isValid = false;
 }
@@ -43,7 +43,10 @@ struct KisColorizeStrokeStrategy::Private
         , levelOfDetail(_levelOfDetail)
         , keyStrokes(rhs.keyStrokes)
         , filteringOptions(rhs.filteringOptions)
-    {}
+        , useFastFill(rhs.useFastFill)
+    {
+        // the map is generated and reused for the full-resolution image only
+    }
 
     KisNodeSP progressNode;
     KisPaintDeviceSP src;
@@ -61,6 +64,13 @@ struct KisColorizeStrokeStrategy::Private
 
     // default values: disabled
     FilteringOptions filteringOptions;
+
+    KisPaintDeviceSP keyStrokeIndexMap;
+    bool keyStrokeIndexMapValid = false;
+    QVector<int> changedKeyStrokes;
+
+    // opt-in, see KisImageConfig::useFastColorizeMaskFill()
+    bool useFastFill = false;
 };
 
 KisColorizeStrokeStrategy::KisColorizeStrokeStrategy(KisPaintDeviceSP src,
@@ -80,6 +90,7 @@ KisColorizeStrokeStrategy::KisColorizeStrokeStrategy(KisPaintDeviceSP src,
     m_d->boundingRect = boundingRect;
     m_d->filteredSourceValid = filteredSourceValid;
     m_d->prefilterOnly = prefilterOnly;
+    m_d->useFastFill = KisImageConfig(true).useFastColorizeMaskFill();
 
     enableJob(JOB_INIT, true, KisStrokeJobData::SEQUENTIAL, KisStrokeJobData::EXCLUSIVE);
     enableJob(JOB_DOSTROKE, true, KisStrokeJobData::SEQUENTIAL, KisStrokeJobData::EXCLUSIVE);
@@ -120,6 +131,13 @@ void KisColorizeStrokeStrategy::addKeyStroke(KisPaintDeviceSP dev, const KoColor
     m_d->keyStrokes << KeyStroke(dev, convertedColor);
 }
 
+void KisColorizeStrokeStrategy::setKeyStrokeIndexMap(KisPaintDeviceSP dev, bool isValid, const QVector<int> &changedKeyStrokes)
+{
+    m_d->keyStrokeIndexMap = dev;
+    m_d->keyStrokeIndexMapValid = dev && isValid;
+    m_d->changedKeyStrokes = changedKeyStrokes;
+}
+
 void KisColorizeStrokeStrategy::initStrokeCallback()
 {
     using namespace KritaUtils;
@@ -222,7 +240,17 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
         });
     }
 
-    if (!m_d->prefilterOnly) {
+    if (!m_d->prefilterOnly && m_d->keyStrokeIndexMapValid && m_d->changedKeyStrokes.isEmpty()) {
+        addJobSequential(jobs, [this] () {
+            QVector<KoColor> colors;
+            Q_FOREACH (const KeyStroke &stroke, m_d->keyStrokes) {
+                colors << (!stroke.isTransparent ?
+                               stroke.color : KoColor(Qt::transparent, m_d->dst->colorSpace()));
+            }
+
+            KisWatershedWorker::writeColoring(m_d->keyStrokeIndexMap, m_d->dst, m_d->boundingRect, colors);
+        });
+    } else if (!m_d->prefilterOnly) {
         addJobSequential(jobs, [this] () {
             m_d->heightMap = new KisPaintDevice(*m_d->filteredSource);
         });
@@ -240,6 +268,10 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
             KisProcessingVisitor::ProgressHelper helper(m_d->progressNode);
 
             KisWatershedWorker worker(m_d->heightMap, m_d->dst, m_d->boundingRect, helper.updater());
+            if (m_d->useFastFill) {
+                worker.setFloodMode(KisWatershedWorker::TiledFlood);
+            }
+
             Q_FOREACH (const KeyStroke &stroke, m_d->keyStrokes) {
                 KoColor color =
                     !stroke.isTransparent ?
@@ -247,6 +279,15 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
 
                 worker.addKeyStroke(stroke.dev, color);
             }
+
+            if (m_d->keyStrokeIndexMap) {
+                worker.setKeyStrokeIndexMap(m_d->keyStrokeIndexMap);
+
+                if (m_d->useFastFill && m_d->keyStrokeIndexMapValid) {
+                    worker.setPreviousFill(m_d->keyStrokeIndexMap, m_d->changedKeyStrokes);
+                }
+            }
+
             worker.run(m_d->filteringOptions.cleanUpAmount);
         });
     }
@@ -40,6 +40,20 @@ public:
 
     void addKeyStroke(KisPaintDeviceSP dev, const KoColor &color);
 
+    /**
+     * Sets the device where the fill saves the indexes of the key strokes
+     * (\see KisWatershedWorker::setKeyStrokeIndexMap()). If \p isValid is
+     * true, the map is known to be generated from the same filtered source,
+     * bounds and key strokes, except the ones listed in \p changedKeyStrokes.
+     * Without any changed key strokes the stroke skips the watershed fill and
+     * just recolors the map with the current colors of the key strokes.
+     * Otherwise the whole mask is refilled, unless the fast fill is enabled
+     * (\see KisImageConfig::useFastColorizeMaskFill()). In that case only
+     * the basins reachable from the changed key strokes are refilled
+     * (\see KisWatershedWorker::setPreviousFill()).
+     */
+    void setKeyStrokeIndexMap(KisPaintDeviceSP dev, bool isValid, const QVector<int> &changedKeyStrokes = QVector<int>());
+
     void initStrokeCallback() override;
     void cancelStrokeCallback() override;
     // TODO: suspend/resume
@@ -8,6 +8,7 @@
 
 #include "kis_lazy_fill_tools.h"
 
+#include <functional>
 #include <numeric>
 #include <boost/limits.hpp>
 
@@ -25,11 +26,68 @@
 #include "lazybrush/kis_lazy_fill_graph.h"
 #include "lazybrush/kis_lazy_fill_capacity_map.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+#include <KoColorSpaceRegistry.h>
+
 #include "kis_sequential_iterator.h"
 #include <floodfill/kis_scanline_fill.h>
 
 #include "krita_utils.h"
 
+namespace {
+
+/**
+ * The value written into the mask device for the pixels
+ * assigned to the color scribble
+ */
+const quint8 cutMaskValue = 10 + (int(boost::black_color) << 4);
+
+/**
+ * Downscales \p rc of an alpha8 device by \p factor. Every pixel of the
+ * result is either the minimum or the maximum of the corresponding block
+ * of the source pixels. The result is stored in row-major order.
+ */
+QVector<quint8> downscaleAlpha8Device(KisPaintDeviceSP dev, const QRect &rc,
+                                      int factor, const QSize &coarseSize,
+                                      bool useMaximum)
+{
+    QVector<quint8> result(coarseSize.width() * coarseSize.height(), useMaximum ? 0 : 255);
+    QVector<quint8> row(rc.width());
+
+    for (int y = 0; y < rc.height(); y++) {
+        dev->readBytes(row.data(), rc.x(), rc.y() + y, rc.width(), 1);
+        quint8 *dstRow = result.data() + (y / factor) * coarseSize.width();
+
+        for (int x = 0; x < rc.width(); x++) {
+            quint8 &dst = dstRow[x / factor];
+            dst = useMaximum ? qMax(dst, row[x]) : qMin(dst, row[x]);
+        }
+    }
+
+    return result;
+}
+
+KisPaintDeviceSP createAlpha8Device(const QVector<quint8> &data, const QSize &size)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    dev->writeBytes(data.constData(), 0, 0, size.width(), size.height());
+    return dev;
+}
+
+void addGraphToStatistics(KisLazyFillTools::CutStatistics *statistics, qint64 numVertices)
+{
+    if (!statistics) return;
+
+    statistics->numGraphVertices += numVertices;
+    statistics->maxGraphVertices = qMax(statistics->maxGraphVertices, numVertices);
+    statistics->numGraphs++;
+}
+
+}
+
 namespace KisLazyFillTools {
 
 void normalizeAndInvertAlpha8Device(KisPaintDeviceSP dev, const QRect &rect)
@@ -80,7 +138,8 @@ void cutOneWay(const KoColor &color,
                KisPaintDeviceSP backgroundScribble,
                KisPaintDeviceSP resultDevice,
                KisPaintDeviceSP maskDevice,
-               const QRect &boundingRect)
+               const QRect &boundingRect,
+               CutStatistics *statistics)
 {
     using namespace boost;
 
@@ -93,6 +152,8 @@ void cutOneWay(const KoColor &color,
     KisLazyFillCapacityMap capacityMap(src, colorScribble, backgroundScribble, maskDevice, boundingRect);
     KisLazyFillGraph &graph = capacityMap.graph();
 
+    addGraphToStatistics(statistics, num_vertices(graph));
+
     std::vector<default_color_type> groups(num_vertices(graph));
     std::vector<int> residual_capacity(num_edges(graph), 0);
 
@@ -131,9 +192,231 @@ void cutOneWay(const KoColor &color,
 
         if (label == black_color) {
             memcpy(dstIt.rawData(), color.data(), pixelSize);
-            *mskIt.rawData() = 10 + (int(label) << 4);
+            *mskIt.rawData() = cutMaskValue;
+        }
+    }
+}
+
+void cutOneWayCoarseToFine(const KoColor &color,
+                           KisPaintDeviceSP src,
+                           KisPaintDeviceSP colorScribble,
+                           KisPaintDeviceSP backgroundScribble,
+                           KisPaintDeviceSP resultDevice,
+                           KisPaintDeviceSP maskDevice,
+                           const QRect &boundingRect,
+                           int downscaleFactor,
+                           CutStatistics *statistics)
+{
+    const int factor = downscaleFactor;
+    const QRect &rc = boundingRect;
+
+    if (factor <= 1 || rc.width() <= factor || rc.height() <= factor) {
+        cutOneWay(color, src, colorScribble, backgroundScribble,
+                  resultDevice, maskDevice, boundingRect, statistics);
+        return;
+    }
+
+    KIS_ASSERT_RECOVER_RETURN(src->pixelSize() == 1);
+    KIS_ASSERT_RECOVER_RETURN(colorScribble->pixelSize() == 1);
+    KIS_ASSERT_RECOVER_RETURN(backgroundScribble->pixelSize() == 1);
+    KIS_ASSERT_RECOVER_RETURN(maskDevice->pixelSize() == 1);
+    KIS_ASSERT_RECOVER_RETURN(*resultDevice->colorSpace() == *color.colorSpace());
+
+    const KoColor labelColor(Qt::black, KoColorSpaceRegistry::instance()->alpha8());
+
+    /**
+     * 1) Solve the cut on the downscaled devices. The line art has low
+     *    values in the source, so we take the minimum to keep it. The
+     *    scribbles are dilated, and a coarse pixel is masked out only
+     *    when all its pixels are masked.
+     */
+
+    const QSize coarseSize((rc.width() + factor - 1) / factor,
+                           (rc.height() + factor - 1) / factor);
+    const QRect coarseRect(QPoint(), coarseSize);
+
+    const QVector<quint8> coarseA = downscaleAlpha8Device(colorScribble, rc, factor, coarseSize, true);
+    const QVector<quint8> coarseB = downscaleAlpha8Device(backgroundScribble, rc, factor, coarseSize, true);
+    const QVector<quint8> coarseMaskMin = downscaleAlpha8Device(maskDevice, rc, factor, coarseSize, false);
+    const QVector<quint8> coarseMaskMax = downscaleAlpha8Device(maskDevice, rc, factor, coarseSize, true);
+
+    KisPaintDeviceSP coarseLabelsDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+
+    cutOneWay(labelColor,
+              createAlpha8Device(downscaleAlpha8Device(src, rc, factor, coarseSize, false), coarseSize),
+              createAlpha8Device(coarseA, coarseSize),
+              createAlpha8Device(coarseB, coarseSize),
+              coarseLabelsDevice,
+              createAlpha8Device(coarseMaskMin, coarseSize),
+              coarseRect,
+              statistics);
+
+    QVector<quint8> coarseLabels(coarseSize.width() * coarseSize.height());
+    coarseLabelsDevice->readBytes(coarseLabels.data(), coarseRect);
+
+    /**
+     * 2) Find the coarse pixels whose label is not reliable: the ones
+     *    lying on the boundary between the labels, the partially masked
+     *    ones and the ones contradicting the scribbles. Then grow this
+     *    area a bit to give the refinement some space.
+     */
+
+    const int bandRadius = 2;
+
+    QVector<quint8> uncertain(coarseLabels.size(), 0);
+
+    for (int y = 0; y < coarseSize.height(); y++) {
+        for (int x = 0; x < coarseSize.width(); x++) {
+            const int i = y * coarseSize.width() + x;
+            const bool isA = coarseLabels[i];
+
+            bool value =
+                coarseMaskMin[i] != coarseMaskMax[i] ||
+                (isA && coarseB[i]) ||
+                (!isA && coarseA[i]);
+
+            for (int dy = -1; dy <= 1 && !value; dy++) {
+                for (int dx = -1; dx <= 1 && !value; dx++) {
+                    const QPoint pt(x + dx, y + dy);
+                    if (!coarseRect.contains(pt)) continue;
+                    value = bool(coarseLabels[pt.y() * coarseSize.width() + pt.x()]) != isA;
+                }
+            }
+
+            uncertain[i] = value;
+        }
+    }
+
+    for (int i = 0; i < bandRadius; i++) {
+        const QVector<quint8> prev = uncertain;
+
+        for (int y = 0; y < coarseSize.height(); y++) {
+            for (int x = 0; x < coarseSize.width(); x++) {
+                quint8 &value = uncertain[y * coarseSize.width() + x];
+
+                for (int dy = -1; dy <= 1 && !value; dy++) {
+                    for (int dx = -1; dx <= 1 && !value; dx++) {
+                        const QPoint pt(x + dx, y + dy);
+                        if (!coarseRect.contains(pt)) continue;
+                        value = prev[pt.y() * coarseSize.width() + pt.x()];
+                    }
+                }
+            }
         }
     }
+
+    auto coarseIndex = [&] (int x, int y) {
+        return ((y - rc.y()) / factor) * coarseSize.width() + (x - rc.x()) / factor;
+    };
+
+    auto isUncertain = [&] (const QRect &fineRect) {
+        for (int y = (fineRect.top() - rc.y()) / factor; y <= (fineRect.bottom() - rc.y()) / factor; y++) {
+            for (int x = (fineRect.left() - rc.x()) / factor; x <= (fineRect.right() - rc.x()) / factor; x++) {
+                if (uncertain[y * coarseSize.width() + x]) return true;
+            }
+        }
+        return false;
+    };
+
+    /**
+     * 3) Process the image in patches. The patches not touching the
+     *    unreliable area just get the coarse labels upscaled. The rest
+     *    are solved at full resolution, with a margin around them. The
+     *    pixels outside the unreliable area and on the outer border of
+     *    the margin act as scribbles with their coarse labels.
+     */
+
+    const int patchMargin = 4 * factor;
+    const int pixelSize = resultDevice->pixelSize();
+    const QRect boundingInnerRect = rc.adjusted(1, 1, -1, -1);
+
+    // patches read the mask with margins, so they should see its original state
+    KisPaintDeviceSP origMask = new KisPaintDevice(*maskDevice);
+
+    QVector<QRect> patches = KritaUtils::splitRectIntoPatches(rc, QSize(256, 256));
+    QMutex statisticsMutex;
+
+    std::function<void (const QRect &)> processPatch =
+        [&] (const QRect &patchRect) {
+            KisPaintDeviceSP labels;
+
+            if (isUncertain(patchRect)) {
+                const QRect solveRect = patchRect.adjusted(-patchMargin, -patchMargin, patchMargin, patchMargin) & rc;
+                const QRect solveInnerRect = solveRect.adjusted(1, 1, -1, -1);
+
+                KisPaintDeviceSP patchA = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+                KisPaintDeviceSP patchB = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+
+                KisSequentialConstIterator aIt(colorScribble, solveRect);
+                KisSequentialConstIterator bIt(backgroundScribble, solveRect);
+                KisSequentialConstIterator maskIt(origMask, solveRect);
+                KisSequentialIterator patchAIt(patchA, solveRect);
+                KisSequentialIterator patchBIt(patchB, solveRect);
+
+                while (aIt.nextPixel() && bIt.nextPixel() && maskIt.nextPixel() &&
+                       patchAIt.nextPixel() && patchBIt.nextPixel()) {
+
+                    const int x = aIt.x();
+                    const int y = aIt.y();
+                    const int i = coarseIndex(x, y);
+
+                    // the border of the image is not a seed, the border of the margin is
+                    const bool isOnMarginBorder =
+                        !solveInnerRect.contains(x, y) && boundingInnerRect.contains(x, y);
+
+                    const bool isSeed =
+                        !*maskIt.rawDataConst() && (!uncertain[i] || isOnMarginBorder);
+
+                    if (isSeed) {
+                        *patchAIt.rawData() = coarseLabels[i] ? 255 : 0;
+                        *patchBIt.rawData() = coarseLabels[i] ? 0 : 255;
+                    } else {
+                        *patchAIt.rawData() = *aIt.rawDataConst();
+                        *patchBIt.rawData() = *bIt.rawDataConst();
+                    }
+                }
+
+                CutStatistics patchStatistics;
+                labels = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+
+                cutOneWay(labelColor, src, patchA, patchB,
+                          labels, new KisPaintDevice(*origMask),
+                          solveRect, &patchStatistics);
+
+                if (statistics) {
+                    QMutexLocker l(&statisticsMutex);
+                    addGraphToStatistics(statistics, patchStatistics.numGraphVertices);
+                }
+            }
+
+            KisSequentialConstIterator origMaskIt(origMask, patchRect);
+            KisSequentialIterator dstIt(resultDevice, patchRect);
+            KisSequentialIterator mskIt(maskDevice, patchRect);
+            QScopedPointer<KisSequentialConstIterator> labelsIt;
+
+            if (labels) {
+                labelsIt.reset(new KisSequentialConstIterator(labels, patchRect));
+            }
+
+            while (origMaskIt.nextPixel() && dstIt.nextPixel() && mskIt.nextPixel()) {
+                bool isA = false;
+
+                if (labelsIt) {
+                    labelsIt->nextPixel();
+                    isA = *labelsIt->rawDataConst();
+                } else {
+                    isA = !*origMaskIt.rawDataConst() &&
+                        coarseLabels[coarseIndex(dstIt.x(), dstIt.y())];
+                }
+
+                if (isA) {
+                    memcpy(dstIt.rawData(), color.data(), pixelSize);
+                    *mskIt.rawData() = cutMaskValue;
+                }
+            }
+        };
+
+    QtConcurrent::blockingMap(patches, processPatch);
 }
 
 QVector<QPoint> splitIntoConnectedComponents(KisPaintDeviceSP dev,
@@ -25,6 +25,18 @@ namespace KisLazyFillTools
     KRITAIMAGE_EXPORT
     void normalizeAlpha8Device(KisPaintDeviceSP dev, const QRect &rect);
 
+    /**
+     * Sizes of the max-flow graphs built by the cut functions. The
+     * memory used by the solver is proportional to the size of the
+     * graph, so the largest graph defines the peak memory usage.
+     */
+    struct CutStatistics
+    {
+        qint64 numGraphVertices = 0;
+        qint64 maxGraphVertices = 0;
+        int numGraphs = 0;
+    };
+
     /**
      * Uses Boykov-Kolmogorov Max-Flow/Min-Cut algorithm to split the
      * device \p src into two parts. The first part is defined by \p
@@ -44,7 +56,32 @@ namespace KisLazyFillTools
                    KisPaintDeviceSP backgroundScribble,
                    KisPaintDeviceSP resultDevice,
                    KisPaintDeviceSP maskDevice,
-                   const QRect &boundingRect);
+                   const QRect &boundingRect,
+                   CutStatistics *statistics = 0);
+
+    /**
+     * Does the same as cutOneWay(), but solves the cut coarse-to-fine.
+     * First, the cut is calculated on a copy of the devices downscaled
+     * by \p downscaleFactor (line art is preserved by taking the darkest
+     * pixel of every block). Then the cut is refined at full resolution
+     * only in the patches containing the boundary between the coarse
+     * labels. Every such patch is solved separately (and concurrently),
+     * using the coarse labels around the boundary as scribbles.
+     *
+     * The result is an approximation of the full-resolution cut: gaps in
+     * the line art narrower than \p downscaleFactor may be considered
+     * closed. \p downscaleFactor <= 1 falls back to cutOneWay().
+     */
+    KRITAIMAGE_EXPORT
+    void cutOneWayCoarseToFine(const KoColor &color,
+                               KisPaintDeviceSP src,
+                               KisPaintDeviceSP colorScribble,
+                               KisPaintDeviceSP backgroundScribble,
+                               KisPaintDeviceSP resultDevice,
+                               KisPaintDeviceSP maskDevice,
+                               const QRect &boundingRect,
+                               int downscaleFactor,
+                               CutStatistics *statistics = 0);
 
     /**
      * Returns one pixel from each connected component of \p src.
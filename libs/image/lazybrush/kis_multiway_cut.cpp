@@ -29,6 +29,9 @@ struct KisMultiwayCut::Private
 
     QVector<KeyStroke> keyStrokes;
 
+    int coarseToFineFactor = 1;
+    CutStatistics statistics;
+
     static void maskOutKeyStroke(KisPaintDeviceSP keyStrokeDevice, KisPaintDeviceSP mask, const QRect &boundingRect);
 };
 
@@ -53,6 +56,16 @@ void KisMultiwayCut::addKeyStroke(KisPaintDeviceSP dev, const KoColor &color)
 }
 
 
+void KisMultiwayCut::setCoarseToFineFactor(int factor)
+{
+    m_d->coarseToFineFactor = factor;
+}
+
+CutStatistics KisMultiwayCut::statistics() const
+{
+    return m_d->statistics;
+}
+
 void KisMultiwayCut::Private::maskOutKeyStroke(KisPaintDeviceSP keyStrokeDevice, KisPaintDeviceSP mask, const QRect &boundingRect)
 {
     KIS_ASSERT_RECOVER_RETURN(keyStrokeDevice->pixelSize() == 1);
@@ -95,6 +108,8 @@ void KisMultiwayCut::run()
 {
     KisPaintDeviceSP other(new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8()));
 
+    m_d->statistics = CutStatistics();
+
     /**
      * First sort all the key strokes in a way that all the
      * transparent strokes go to the beginning of the list.
@@ -128,13 +143,15 @@ void KisMultiwayCut::run()
             break;
         }
 
-        KisLazyFillTools::cutOneWay(current.color,
-                                    m_d->src,
-                                    current.dev,
-                                    other,
-                                    m_d->dst,
-                                    m_d->mask,
-                                    m_d->boundingRect);
+        KisLazyFillTools::cutOneWayCoarseToFine(current.color,
+                                                m_d->src,
+                                                current.dev,
+                                                other,
+                                                m_d->dst,
+                                                m_d->mask,
+                                                m_d->boundingRect,
+                                                m_d->coarseToFineFactor,
+                                                &m_d->statistics);
 
         other->clear();
     }
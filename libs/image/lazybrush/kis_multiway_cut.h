@@ -14,6 +14,10 @@
 
 class KoColor;
 
+namespace KisLazyFillTools {
+struct CutStatistics;
+}
+
 class KRITAIMAGE_EXPORT KisMultiwayCut
 {
 public:
@@ -24,8 +28,21 @@ public:
 
     void addKeyStroke(KisPaintDeviceSP dev, const KoColor &color);
 
+    /**
+     * Makes the cut use the coarse-to-fine solver with \p factor
+     * as the downscale factor of the coarse level (\see
+     * KisLazyFillTools::cutOneWayCoarseToFine()). The default
+     * value, 1, means the exact full-resolution solver.
+     */
+    void setCoarseToFineFactor(int factor);
+
     void run();
 
+    /**
+     * Sizes of the graphs solved in the last run()
+     */
+    KisLazyFillTools::CutStatistics statistics() const;
+
     KisPaintDeviceSP srcDevice() const;
     KisPaintDeviceSP dstDevice() const;
 
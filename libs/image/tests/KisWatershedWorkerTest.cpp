@@ -12,6 +12,7 @@
 #include "kis_painter.h"
 
 #include "kis_paint_device_debug_utils.h"
+#include "kis_sequential_iterator.h"
 
 #include "kis_gaussian_kernel.h"
 #include "krita_utils.h"
@@ -182,4 +183,231 @@ void KisWatershedWorkerTest::testWorkerSmallWithAllies()
     QCOMPARE(worker.testingGroupConflicts(2, 0, 3), 0);
 }
 
+void KisWatershedWorkerTest::testRecolorFromKeyStrokeIndexMap()
+{
+    KisPaintDeviceSP mainDev = loadTestImage("fill1_main.png", false);
+    KisPaintDeviceSP aLabelDev = loadTestImage("fill1_a_extra.png", true);
+    KisPaintDeviceSP bLabelDev = loadTestImage("fill1_b.png", true);
+
+    KisPaintDeviceSP filteredMainDev = KisPainter::convertToAlphaAsGray(mainDev);
+    const QRect filterRect = filteredMainDev->exactBounds();
+
+    KisGaussianKernel::applyLoG(filteredMainDev,
+                                filterRect,
+                                2,
+                                -1.0,
+                                QBitArray(), 0);
+
+    KisLazyFillTools::normalizeAlpha8Device(filteredMainDev, filterRect);
+
+    const KoColorSpace *cs = mainDev->colorSpace();
+
+    auto runWorker = [&] (const QColor &aColor, const QColor &bColor, KisPaintDeviceSP indexMap) {
+        KisPaintDeviceSP coloring = new KisPaintDevice(cs);
+
+        KisWatershedWorker worker(filteredMainDev, coloring, filterRect);
+        worker.addKeyStroke(aLabelDev, KoColor(aColor, cs));
+        worker.addKeyStroke(bLabelDev, KoColor(bColor, cs));
+        if (indexMap) {
+            worker.setKeyStrokeIndexMap(indexMap);
+        }
+        worker.run(0.7);
+
+        return coloring;
+    };
+
+    KisPaintDeviceSP indexMap = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha16());
+
+    KisPaintDeviceSP redBlue = runWorker(Qt::red, Qt::blue, indexMap);
+    KisPaintDeviceSP greenYellow = runWorker(Qt::green, Qt::yellow, KisPaintDeviceSP());
+
+    QPoint errorPoint;
+
+    KisPaintDeviceSP recolored = new KisPaintDevice(cs);
+    KisWatershedWorker::writeColoring(indexMap, recolored, filterRect,
+                                      {KoColor(Qt::red, cs), KoColor(Qt::blue, cs)});
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, redBlue, recolored));
+
+    recolored = new KisPaintDevice(cs);
+    KisWatershedWorker::writeColoring(indexMap, recolored, filterRect,
+                                      {KoColor(Qt::green, cs), KoColor(Qt::yellow, cs)});
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, greenYellow, recolored));
+}
+
+void KisWatershedWorkerTest::testGroupStatisticsFromGroupMap()
+{
+    KisPaintDeviceSP mainDev = loadTestImage("fill5_main.png", false);
+    KisPaintDeviceSP aLabelDev = loadTestImage("fill5_a_extra.png", true);
+    KisPaintDeviceSP bLabelDev = loadTestImage("fill5_b.png", true);
+    KisPaintDeviceSP resultColoring = new KisPaintDevice(mainDev->colorSpace());
+
+    KisPaintDeviceSP filteredMainDev = KisPainter::convertToAlphaAsGray(mainDev);
+    const QRect filterRect = filteredMainDev->exactBounds();
+
+    KisLazyFillTools::normalizeAndInvertAlpha8Device(filteredMainDev, filterRect);
+
+    KisWatershedWorker worker(filteredMainDev, resultColoring, filterRect);
+    worker.addKeyStroke(aLabelDev, KoColor(Qt::red, mainDev->colorSpace()));
+    worker.addKeyStroke(bLabelDev, KoColor(Qt::blue, mainDev->colorSpace()));
+    worker.run();
+
+    auto collectStatistics = [&worker] () {
+        QVector<int> result;
+
+        for (qint32 group = 1; group <= 3; group++) {
+            for (int level : {0, 255}) {
+                result << worker.testingGroupPositiveEdge(group, level);
+                result << worker.testingGroupNegativeEdge(group, level);
+                result << worker.testingGroupForeignEdge(group, level);
+                result << worker.testingGroupAllyEdge(group, level);
+
+                for (qint32 other = 1; other <= 3; other++) {
+                    result << worker.testingGroupConflicts(group, level, other);
+                }
+            }
+        }
+
+        return result;
+    };
+
+    const QVector<int> floodStatistics = collectStatistics();
+
+    worker.testingRecalculateGroupStatistics();
+
+    QCOMPARE(collectStatistics(), floodStatistics);
+}
+
+namespace {
+
+/**
+ * Creates a flat height map of \p rc split into basins by one pixel wide
+ * vertical walls of the maximum height at \p walls
+ */
+KisPaintDeviceSP createWalledHeightMap(const QRect &rc, const QVector<int> &walls)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
+
+    KisPaintDeviceSP heightMap = new KisPaintDevice(cs);
+    Q_FOREACH (int x, walls) {
+        heightMap->fill(QRect(x, rc.y(), 1, rc.height()), KoColor(Qt::white, cs));
+    }
+
+    return heightMap;
+}
+
+KisPaintDeviceSP createKeyStroke(const QRect &rc)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->fill(rc, KoColor(Qt::white, cs));
+
+    return dev;
+}
+
+bool checkColoring(KisPaintDeviceSP dev, const QRect &rc, const KoColor &color)
+{
+    KisSequentialConstIterator it(dev, rc);
+
+    while (it.nextPixel()) {
+        if (memcmp(it.rawDataConst(), color.data(), dev->pixelSize()) != 0) {
+            qWarning() << "Unexpected color at" << QPoint(it.x(), it.y());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+void KisWatershedWorkerTest::testTiledFlood_data()
+{
+    QTest::addColumn<int>("floodMode");
+
+    QTest::newRow("exact") << int(KisWatershedWorker::ExactFlood);
+    QTest::newRow("tiled") << int(KisWatershedWorker::TiledFlood);
+}
+
+void KisWatershedWorkerTest::testTiledFlood()
+{
+    QFETCH(int, floodMode);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rc(0, 0, 200, 200);
+
+    // the wall and the basins span several tiles of the map
+    KisPaintDeviceSP heightMap = createWalledHeightMap(rc, {100});
+    KisPaintDeviceSP coloring = new KisPaintDevice(cs);
+
+    KisWatershedWorker worker(heightMap, coloring, rc);
+    worker.setFloodMode(KisWatershedWorker::FloodMode(floodMode));
+    worker.addKeyStroke(createKeyStroke(QRect(20, 90, 10, 20)), KoColor(Qt::red, cs));
+    worker.addKeyStroke(createKeyStroke(QRect(170, 10, 10, 20)), KoColor(Qt::blue, cs));
+    worker.run(0.7);
+
+    QVERIFY(checkColoring(coloring, QRect(0, 0, 100, 200), KoColor(Qt::red, cs)));
+    QVERIFY(checkColoring(coloring, QRect(101, 0, 99, 200), KoColor(Qt::blue, cs)));
+}
+
+void KisWatershedWorkerTest::testIncrementalRefill()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rc(0, 0, 200, 130);
+    const QVector<int> walls({50, 100, 150});
+
+    KisPaintDeviceSP heightMap = createWalledHeightMap(rc, walls);
+
+    const QVector<KoColor> colors({KoColor(Qt::red, cs), KoColor(Qt::green, cs),
+                                   KoColor(Qt::blue, cs), KoColor(Qt::yellow, cs)});
+
+    QVector<KisPaintDeviceSP> strokes({createKeyStroke(QRect(10, 10, 10, 10)),
+                                       createKeyStroke(QRect(60, 60, 10, 10)),
+                                       createKeyStroke(QRect(110, 110, 10, 10)),
+                                       createKeyStroke(QRect(160, 10, 10, 10))});
+
+    auto runWorker = [&] (KisPaintDeviceSP indexMap, KisPaintDeviceSP previousIndexMap) {
+        KisPaintDeviceSP coloring = new KisPaintDevice(cs);
+
+        KisWatershedWorker worker(heightMap, coloring, rc);
+        worker.setFloodMode(KisWatershedWorker::TiledFlood);
+
+        for (int i = 0; i < strokes.size(); i++) {
+            worker.addKeyStroke(strokes[i], colors[i]);
+        }
+
+        worker.setKeyStrokeIndexMap(indexMap);
+
+        if (previousIndexMap) {
+            worker.setPreviousFill(previousIndexMap, {3});
+        }
+
+        worker.run();
+
+        return coloring;
+    };
+
+    KisPaintDeviceSP indexMap = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha16());
+    runWorker(indexMap, KisPaintDeviceSP());
+
+    // move the seed of the last basin
+    strokes[3] = createKeyStroke(QRect(180, 100, 10, 10));
+
+    KisPaintDeviceSP fullColoring =
+        runWorker(new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha16()), KisPaintDeviceSP());
+    KisPaintDeviceSP incrementalColoring = runWorker(indexMap, indexMap);
+
+    const QVector<int> basinEnds = walls + QVector<int>({rc.right() + 1});
+    int basinStart = rc.left();
+
+    for (int i = 0; i < basinEnds.size(); i++) {
+        const QRect basinRect(basinStart, rc.top(), basinEnds[i] - basinStart, rc.height());
+
+        QVERIFY(checkColoring(fullColoring, basinRect, colors[i]));
+        QVERIFY(checkColoring(incrementalColoring, basinRect, colors[i]));
+
+        basinStart = basinEnds[i] + 1;
+    }
+}
+
 SIMPLE_TEST_MAIN(KisWatershedWorkerTest)
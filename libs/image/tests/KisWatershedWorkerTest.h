@@ -17,6 +17,13 @@ private Q_SLOTS:
 
     void testWorkerSmall();
     void testWorkerSmallWithAllies();
+
+    void testRecolorFromKeyStrokeIndexMap();
+
+    void testGroupStatisticsFromGroupMap();
+    void testTiledFlood_data();
+    void testTiledFlood();
+    void testIncrementalRefill();
 };
 
 #endif // KISWATERSHEDWORKERTEST_H
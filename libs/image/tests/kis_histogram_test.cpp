@@ -9,9 +9,13 @@
 #include <simpletest.h>
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColor.h>
 #include <KoHistogramProducer.h>
 #include "kis_paint_device.h"
 #include "kis_histogram.h"
+#include "kis_iterator_ng.h"
+#include "KisTileHistogramCache.h"
 #include "kis_paint_layer.h"
 #include "kis_types.h"
 #include "testimage.h"
@@ -34,5 +38,125 @@ void KisHistogramTest::testCreation()
     }
 }
 
+namespace {
+QVector<QVector<quint32>> referenceHistogram(KisPaintDeviceSP dev, const QRect &rect, int step)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+
+    QVector<QVector<quint32>> result(cs->channelCount());
+    for (auto &bins : result) {
+        bins.fill(0, 256);
+    }
+
+    auto positiveMod = [] (int x, int y) {
+        return ((x % y) + y) % y;
+    };
+
+    auto gcd = [] (int a, int b) {
+        while (b) {
+            const int r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    };
+
+    // the phase of the samples is shifted on every row of the tile
+    int phaseFactor = qMax(1, qRound(0.618 * step));
+    while (gcd(phaseFactor, step) != 1) {
+        phaseFactor++;
+    }
+
+    KisSequentialConstIterator it(dev, rect);
+    while (it.nextPixel()) {
+        const int tileX = positiveMod(it.x() - dev->x(), 64);
+        const int tileY = positiveMod(it.y() - dev->y(), 64);
+
+        if (positiveMod(tileX - tileY * phaseFactor, step)) continue;
+
+        for (int ch = 0; ch < result.size(); ch++) {
+            result[ch][cs->scaleToU8(it.rawDataConst(), ch)]++;
+        }
+    }
+
+    return result;
+}
+}
+
+void KisHistogramTest::testTileHistogramCache_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<int>("sampleStep");
+
+    QTest::newRow("u8") << Integer8BitsColorDepthID.id() << 1;
+    QTest::newRow("u8-sampled") << Integer8BitsColorDepthID.id() << 3;
+    QTest::newRow("u8-sampled-grid") << Integer8BitsColorDepthID.id() << 4;
+    QTest::newRow("u16") << Integer16BitsColorDepthID.id() << 1;
+    QTest::newRow("u16-sampled") << Integer16BitsColorDepthID.id() << 7;
+}
+
+void KisHistogramTest::testTileHistogramCache()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(int, sampleStep);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setX(-13);
+    dev->setY(5);
+    dev->setDefaultPixel(KoColor(Qt::white, cs));
+
+    dev->fill(QRect(0, 0, 300, 200), KoColor(Qt::red, cs));
+    dev->fill(QRect(70, 40, 100, 50), KoColor(QColor(10, 200, 30, 128), cs));
+    dev->fill(QRect(250, 150, 70, 90), KoColor(Qt::blue, cs));
+
+    // the rect covers tiles partially and the area without any tiles
+    const QRect rect(-40, -20, 380, 300);
+
+    KisTileHistogramCache cache;
+
+    QCOMPARE(cache.histogram(dev, rect, sampleStep), referenceHistogram(dev, rect, sampleStep));
+
+    // small changes are picked up incrementally
+    dev->fill(QRect(100, 100, 3, 3), KoColor(Qt::green, cs));
+    dev->clear(QRect(0, 0, 64, 64));
+    QCOMPARE(cache.histogram(dev, rect, sampleStep), referenceHistogram(dev, rect, sampleStep));
+
+    // the removed tiles count as default pixels
+    dev->purgeDefaultPixels();
+    dev->setDefaultPixel(KoColor(Qt::black, cs));
+    QCOMPARE(cache.histogram(dev, rect, sampleStep), referenceHistogram(dev, rect, sampleStep));
+
+    // a change of the rect resets the cache
+    const QRect otherRect(10, 10, 100, 100);
+    QCOMPARE(cache.histogram(dev, otherRect, sampleStep), referenceHistogram(dev, otherRect, sampleStep));
+}
+
+void KisHistogramTest::testTileHistogramCacheNoAliasing()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    // every fourth column is white, the period divides the tile size
+    const QRect rect(0, 0, 256, 256);
+    dev->fill(rect, KoColor(Qt::black, cs));
+    for (int x = rect.left(); x <= rect.right(); x += 4) {
+        dev->fill(QRect(x, rect.top(), 1, rect.height()), KoColor(Qt::white, cs));
+    }
+
+    KisTileHistogramCache cache;
+    const QVector<QVector<quint32>> histogram = cache.histogram(dev, rect, 4);
+
+    const quint32 numWhite = histogram[0][255];
+    const quint32 numBlack = histogram[0][0];
+
+    // the samples must not line up with the stripes
+    QCOMPARE(numWhite + numBlack, quint32(rect.width() * rect.height() / 4));
+    QVERIFY(numWhite > (numWhite + numBlack) / 5);
+    QVERIFY(numWhite < (numWhite + numBlack) / 3);
+}
 
 KISTEST_MAIN(KisHistogramTest)
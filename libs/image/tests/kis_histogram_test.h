@@ -15,6 +15,9 @@ class KisHistogramTest : public QObject
 private Q_SLOTS:
 
     void testCreation();
+    void testTileHistogramCache_data();
+    void testTileHistogramCache();
+    void testTileHistogramCacheNoAliasing();
 
 };
 
@@ -1334,6 +1334,87 @@ void KisLazyBrushTest::testEstimateTransparentPixels()
     QCOMPARE(value, 0.0);
 }
 
+void KisLazyBrushTest::testCoarseToFineCut()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *alpha8 = KoColorSpaceRegistry::instance()->alpha8();
+
+    const KoColor fillColor(Qt::black, cs);
+    KisPaintDeviceSP mainDev = new KisPaintDevice(cs);
+
+    QRect mainRect(0,0,512,512);
+
+    QPainterPath path;
+    path.moveTo(100, 100);
+    path.lineTo(400, 100);
+    path.lineTo(400, 400);
+    path.lineTo(100, 400);
+    path.lineTo(100, 120);
+
+    KisFillPainter gc(mainDev);
+    gc.setPaintColor(fillColor);
+    gc.drawPainterPath(path, QPen(Qt::white, 10));
+    gc.fillRect(QRect(250, 100, 15, 120), fillColor);
+    gc.fillRect(QRect(250, 280, 15, 120), fillColor);
+    gc.fillRect(QRect(100, 250, 120, 15), fillColor);
+    gc.fillRect(QRect(280, 250, 120, 15), fillColor);
+
+    KisPaintDeviceSP filteredMainDev = KisPainter::convertToAlphaAsAlpha(mainDev);
+    KisLazyFillTools::normalizeAndInvertAlpha8Device(filteredMainDev, mainRect);
+
+    auto runCut = [&] (int factor, KisLazyFillTools::CutStatistics *statistics) {
+        KisPaintDeviceSP aLabelDev = new KisPaintDevice(alpha8);
+        aLabelDev->fill(QRect(110, 110, 30,30), KoColor(Qt::black, alpha8));
+
+        KisPaintDeviceSP bLabelDev = new KisPaintDevice(alpha8);
+        bLabelDev->fill(QRect(370, 110, 20,20), KoColor(Qt::black, alpha8));
+
+        KisPaintDeviceSP cLabelDev = new KisPaintDevice(alpha8);
+        cLabelDev->fill(QRect(370, 370, 20,20), KoColor(Qt::black, alpha8));
+
+        KisPaintDeviceSP eLabelDev = new KisPaintDevice(alpha8);
+        eLabelDev->fill(QRect(0, 0, 200,20), KoColor(Qt::black, alpha8));
+
+        KisPaintDeviceSP resultColoring = new KisPaintDevice(cs);
+
+        KisMultiwayCut cut(filteredMainDev, resultColoring, mainRect);
+        cut.setCoarseToFineFactor(factor);
+
+        cut.addKeyStroke(aLabelDev, KoColor(Qt::red, cs));
+        cut.addKeyStroke(bLabelDev, KoColor(Qt::green, cs));
+        cut.addKeyStroke(cLabelDev, KoColor(Qt::blue, cs));
+        cut.addKeyStroke(eLabelDev, KoColor(Qt::transparent, cs));
+
+        cut.run();
+        *statistics = cut.statistics();
+
+        return resultColoring;
+    };
+
+    KisLazyFillTools::CutStatistics fullStatistics;
+    KisLazyFillTools::CutStatistics coarseStatistics;
+
+    KisPaintDeviceSP fullResult = runCut(1, &fullStatistics);
+    KisPaintDeviceSP coarseResult = runCut(4, &coarseStatistics);
+
+    QCOMPARE(fullStatistics.maxGraphVertices, fullStatistics.numGraphVertices / fullStatistics.numGraphs);
+    QVERIFY(coarseStatistics.maxGraphVertices < fullStatistics.maxGraphVertices / 2);
+
+    KisSequentialConstIterator fullIt(fullResult, mainRect);
+    KisSequentialConstIterator coarseIt(coarseResult, mainRect);
+
+    int numDifferentPixels = 0;
+
+    while (fullIt.nextPixel() && coarseIt.nextPixel()) {
+        if (memcmp(fullIt.rawDataConst(), coarseIt.rawDataConst(), cs->pixelSize())) {
+            numDifferentPixels++;
+        }
+    }
+
+    // the labels may differ only near the boundaries
+    QVERIFY(numDifferentPixels < mainRect.width() * mainRect.height() / 20);
+}
+
 void KisLazyBrushTest::multiwayCutBenchmark()
 {
     BOOST_CONCEPT_ASSERT(( ReadablePropertyMapConcept<KisLazyFillCapacityMap, KisLazyFillGraph::edge_descriptor> ));
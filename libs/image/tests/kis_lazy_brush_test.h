@@ -27,6 +27,8 @@ private Q_SLOTS:
 
     void testEstimateTransparentPixels();
 
+    void testCoarseToFineCut();
+
     void multiwayCutBenchmark();
 };
 
@@ -148,4 +148,72 @@ void KisLiquifyTransformWorkerTest::testIdentityTransform()
     TestUtil::checkQImage(result, "liquify_transform_test", "liquify_dev", "identity");
 }
 
+void KisLiquifyTransformWorkerTest::testIncrementalUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QImage image(400, 300, QImage::Format_ARGB32);
+    image.fill(Qt::white);
+
+    {
+        QPainter gc(&image);
+        gc.setPen(QPen(Qt::red, 3));
+        for (int i = 0; i < 400; i += 20) {
+            gc.drawLine(i, 0, i, 300);
+        }
+        gc.setPen(QPen(Qt::blue, 3));
+        for (int i = 0; i < 300; i += 20) {
+            gc.drawLine(0, i, 400, i);
+        }
+    }
+
+    KisPaintDeviceSP srcDev = new KisPaintDevice(cs);
+    srcDev->convertFromQImage(image, 0);
+
+    KisLiquifyTransformWorker worker(srcDev->exactBounds(), 0, 8);
+
+    KisPaintDeviceSP incrementalDev = new KisPaintDevice(cs);
+    worker.run(srcDev, incrementalDev);
+
+    const QTransform imageToThumbTransform = QTransform::fromScale(0.5, 0.5);
+    const QImage thumbImage = image.scaled(200, 150);
+
+    QPointF incrementalOffset;
+    QImage incrementalImage =
+        worker.runOnQImage(thumbImage, QPointF(), imageToThumbTransform, &incrementalOffset);
+
+    worker.resetDirtyRect();
+    QVERIFY(worker.dirtyRect().isEmpty());
+
+    // the dabs are far from the borders, so the bounds of the grid don't change
+    worker.translatePoints(QPointF(150, 100), QPointF(20, 10), 15, false, 0.5);
+    worker.rotatePoints(QPointF(250, 200), M_PI / 6, 15, false, 0.5);
+
+    const QRect dirtyRect = worker.dirtyRect();
+    QVERIFY(!worker.isFullyDirty());
+    QVERIFY(!dirtyRect.isEmpty());
+    QVERIFY(QRect(0, 0, 400, 300).contains(dirtyRect));
+
+    worker.run(srcDev, incrementalDev, dirtyRect);
+
+    KisPaintDeviceSP fullDev = new KisPaintDevice(cs);
+    worker.run(srcDev, fullDev);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, fullDev, incrementalDev));
+
+    QVERIFY(worker.updateQImage(thumbImage, QPointF(), imageToThumbTransform,
+                                dirtyRect, &incrementalImage, incrementalOffset));
+
+    QPointF fullOffset;
+    QImage fullImage =
+        worker.runOnQImage(thumbImage, QPointF(), imageToThumbTransform, &fullOffset);
+
+    QCOMPARE(fullOffset, incrementalOffset);
+    QCOMPARE(fullImage, incrementalImage);
+
+    worker.translate(QPointF(10, 10));
+    QVERIFY(worker.isFullyDirty());
+}
+
 SIMPLE_TEST_MAIN(KisLiquifyTransformWorkerTest)
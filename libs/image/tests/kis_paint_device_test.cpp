@@ -11,6 +11,7 @@
 #include <QElapsedTimer>
 
 #include <KoColor.h>
+#include <KoChannelInfo.h>
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoStore.h>
@@ -23,6 +24,9 @@
 #include "kis_paint_layer.h"
 #include "kis_selection.h"
 #include "kis_datamanager.h"
+#include "tiles3/kis_tile.h"
+#include "kis_iterator_ng.h"
+#include "KisChannelStatistics.h"
 #include "kis_global.h"
 #include <testutil.h>
 #include "kis_transaction.h"
@@ -454,6 +458,73 @@ void KisPaintDeviceTest::testCaching()
     QCOMPARE(exactBounds4, QRect(50,50,50,50));
 }
 
+#include "kis_random_accessor_ng.h"
+
+void KisPaintDeviceTest::testThumbnailIncremental()
+{
+    QImage image(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->convertFromQImage(image, 0);
+
+    const QRect extent = dev->extent();
+    const qreal oversample = 3;
+
+    // generated from scratch, without any caching
+    auto referenceThumbnail = [&] (int size) {
+        return dev->createThumbnailDeviceOversampled(size, size, oversample)->
+            convertToQImage(KoColorSpaceRegistry::instance()->rgb8()->profile(), 0, 0, size, size);
+    };
+
+    QImage thumb1 = dev->createThumbnail(100, 100, oversample);
+    QCOMPARE(thumb1, referenceThumbnail(100));
+
+    // change a small area, only a few pixels of the thumbnail are regenerated
+    KoColor black(Qt::black, cs);
+    dev->fill(QRect(100, 100, 30, 30), black);
+
+    QImage thumb2 = dev->createThumbnail(100, 100, oversample);
+    QVERIFY(thumb2 != thumb1);
+    QCOMPARE(thumb2, referenceThumbnail(100));
+
+    // the thumbnails of several sizes and rects are updated incrementally at once
+    dev->createThumbnail(50, 50, oversample);
+    dev->createThumbnail(100, 100, extent, oversample);
+    dev->fill(QRect(300, 100, 30, 30), black);
+
+    QCOMPARE(dev->createThumbnail(50, 50, oversample), referenceThumbnail(50));
+    QCOMPARE(dev->createThumbnail(100, 100, extent, oversample), referenceThumbnail(100));
+
+    thumb2 = dev->createThumbnail(100, 100, oversample);
+    QCOMPARE(thumb2, referenceThumbnail(100));
+
+    // remove a few tiles in the middle of the device
+    dev->clear(QRect(128, 128, 128, 128));
+    QCOMPARE(dev->extent(), extent);
+
+    QImage thumb3 = dev->createThumbnail(100, 100, oversample);
+    QVERIFY(thumb3 != thumb2);
+    QCOMPARE(thumb3, referenceThumbnail(100));
+
+    // moving the device regenerates the thumbnail from scratch
+    dev->moveTo(10, 10);
+    QCOMPARE(dev->createThumbnail(100, 100, oversample), thumb3);
+
+    // point sampling keeps the old behavior
+    KisPaintDeviceSP thumbDev = dev->createThumbnailDevice(64, 44);
+    KisRandomConstAccessorSP srcIt = dev->createRandomConstAccessorNG();
+    KisRandomConstAccessorSP dstIt = thumbDev->createRandomConstAccessorNG();
+    const QRect rc = dev->extent();
+
+    for (int y = 0; y < 44; y++) {
+        for (int x = 0; x < 64; x++) {
+            srcIt->moveTo(rc.x() + x * rc.width() / 64, rc.y() + y * rc.height() / 44);
+            dstIt->moveTo(x, y);
+            QVERIFY(!memcmp(srcIt->rawDataConst(), dstIt->rawDataConst(), cs->pixelSize()));
+        }
+    }
+}
+
 void KisPaintDeviceTest::testRegion()
 {
     const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -827,6 +898,148 @@ void KisPaintDeviceTest::testExactBoundsNonTransparent()
     QCOMPARE(dev->nonDefaultPixelArea(), QRect(-1,-1,1002,1002));
 }
 
+void KisPaintDeviceTest::testExactBoundsIncremental()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect fillRect(100, 100, 1000, 800);
+    dev->fill(fillRect, KoColor(Qt::white, cs));
+
+    QCOMPARE(dev->exactBounds(), fillRect);
+    QCOMPARE(dev->nonDefaultPixelArea(), fillRect);
+
+    // a pixel far away from the filled area extends the bounds
+    dev->setPixel(50, 1200, KoColor(Qt::red, cs));
+    QCOMPARE(dev->exactBounds(), QRect(QPoint(50, 100), QPoint(1099, 1200)));
+
+    // the tile of the erased pixel still exists, but it is empty now
+    dev->setPixel(50, 1200, KoColor(Qt::transparent, cs));
+    QCOMPARE(dev->exactBounds(), fillRect);
+
+    // changes inside the bounds don't affect them
+    dev->clear(QRect(300, 300, 100, 100));
+    QCOMPARE(dev->exactBounds(), fillRect);
+
+    dev->clear(QRect(100, 100, 1000, 10));
+    QCOMPARE(dev->exactBounds(), fillRect.adjusted(0, 10, 0, 0));
+
+    // transparent pixels with non-default color count only as non-default ones
+    const quint8 weirdPixelData[4] = {0, 10, 0, 0};
+    dev->setPixel(1500, 50, KoColor(weirdPixelData, cs));
+    QCOMPARE(dev->exactBounds(), fillRect.adjusted(0, 10, 0, 0));
+    QCOMPARE(dev->nonDefaultPixelArea(), QRect(QPoint(100, 50), QPoint(1500, 899)));
+
+    dev->moveTo(10, 20);
+    QCOMPARE(dev->exactBounds(), fillRect.adjusted(0, 10, 0, 0).translated(10, 20));
+
+    dev->clear();
+    QVERIFY(dev->exactBounds().isEmpty());
+}
+
+void KisPaintDeviceTest::testExactBoundsWriteDuringScan()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    dev->fill(QRect(10, 10, 10, 10), KoColor(Qt::white, cs));
+    QCOMPARE(dev->exactBounds(), QRect(10, 10, 10, 10));
+
+    auto writePixel = [cs] (quint8 *tileData, int x, int y) {
+        memset(tileData + (y * KisTileData::WIDTH + x) * cs->pixelSize(), 255, cs->pixelSize());
+    };
+
+    KisTileSP tile = dev->dataManager()->getTile(0, 0, true);
+    tile->lockForWrite();
+
+    writePixel(tile->data(), 30, 30);
+
+    // the bounds are scanned while the tile is still being written
+    dev->setDirty();
+    QCOMPARE(dev->exactBounds(), QRect(QPoint(10, 10), QPoint(30, 30)));
+
+    writePixel(tile->data(), 50, 5);
+
+    tile->unlockForWrite();
+    tile.clear();
+
+    // the tile is scanned again, since it was finished after the scan
+    dev->setDirty();
+    QCOMPARE(dev->exactBounds(), QRect(QPoint(10, 5), QPoint(50, 30)));
+}
+
+void KisPaintDeviceTest::testChannelStatistics()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    dev->fill(QRect(0, 0, 200, 150), KoColor(Qt::red, cs));
+    dev->fill(QRect(120, 100, 150, 150), KoColor(QColor(10, 200, 30, 128), cs));
+    dev->setPixel(-5, -7, KoColor(Qt::white, cs));
+    dev->moveTo(3, -4);
+
+    const QRect rect(-10, -20, 300, 290);
+
+    KisChannelStatisticsSP stats = dev->channelStatistics(rect);
+    QCOMPARE(stats->channelCount(), int(cs->channelCount()));
+    QCOMPARE(stats->pixelCount(), quint64(rect.width() * rect.height()));
+
+    const QList<KoChannelInfo*> channels = cs->channels();
+
+    for (int ch = 0; ch < channels.size(); ch++) {
+        const int pos = channels[ch]->pos();
+
+        qreal minimum = 255.0;
+        qreal maximum = 0.0;
+        qreal sum = 0.0;
+        qreal sumOfSquares = 0.0;
+        QVector<quint8> values;
+
+        KisSequentialConstIterator it(dev, rect);
+        while (it.nextPixel()) {
+            const qreal value = it.oldRawData()[pos];
+            minimum = qMin(minimum, value);
+            maximum = qMax(maximum, value);
+            sum += value;
+            sumOfSquares += value * value;
+            values << quint8(value);
+        }
+
+        const qreal mean = sum / values.size();
+
+        QCOMPARE(stats->minimum(ch), minimum);
+        QCOMPARE(stats->maximum(ch), maximum);
+        QCOMPARE(stats->mean(ch), mean);
+        QVERIFY(qAbs(stats->variance(ch) - (sumOfSquares / values.size() - mean * mean)) < 1e-6);
+
+        // 8-bit values fall into the bins exactly
+        std::sort(values.begin(), values.end());
+        QCOMPARE(stats->percentile(ch, 0.5), qreal(values[(values.size() - 1) / 2]));
+        QCOMPARE(stats->percentile(ch, 0.0), minimum);
+        QCOMPARE(stats->percentile(ch, 1.0), maximum);
+    }
+
+    // the statistics are kept until the device changes
+    QCOMPARE(dev->channelStatistics(rect), stats);
+    QVERIFY(dev->channelStatistics(rect.adjusted(0, 0, -1, 0)) != stats);
+
+    stats = dev->channelStatistics(rect);
+    dev->setDirty();
+    QVERIFY(dev->channelStatistics(rect) != stats);
+
+    // the pixels are converted into the requested color space
+    const KoColorSpace *cs16 = KoColorSpaceRegistry::instance()->rgb16();
+    KisChannelStatisticsSP stats16 = dev->channelStatistics(rect, cs16);
+    QCOMPARE(stats16->channelCount(), int(cs16->channelCount()));
+    QCOMPARE(stats16->maximum(cs16->channelCount() - 1), 65535.0);
+    QCOMPARE(stats16->minimum(cs16->channelCount() - 1), 0.0);
+
+    // an empty rect has no pixels
+    KisChannelStatisticsSP emptyStats = dev->channelStatistics(QRect());
+    QCOMPARE(emptyStats->pixelCount(), quint64(0));
+    QCOMPARE(emptyStats->mean(0), 0.0);
+}
+
 KisPaintDeviceSP createWrapAroundPaintDevice(const KoColorSpace *cs)
 {
     struct TestingDefaultBounds : public KisDefaultBoundsBase {
@@ -1528,6 +1741,245 @@ void KisPaintDeviceTest::testLodDevice()
                                   "lod", "lod1-offset-6-14"));
 }
 
+void syncLodCacheIncremental(KisPaintDeviceSP dev, int levelOfDetail)
+{
+    KisRegion region;
+    KisPaintDevice::LodDataStruct* s = dev->createLodDataStruct(levelOfDetail, &region);
+
+    Q_FOREACH(QRect rect2, KritaUtils::splitRegionIntoPatches(region, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s, rect2);
+    }
+
+    dev->uploadLodDataStruct(s);
+    delete s;
+}
+
+void KisPaintDeviceTest::testLodPyramidIncremental()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(QRect(0,0,300,300));
+    dev->setDefaultBounds(bounds);
+
+    fillGradientDevice(dev, QRect(10,10,270,270));
+
+    // the first sync covers everything
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), dev->regionForLodSyncing().boundingRect());
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncremental(dev, 1);
+    bounds->testingSetLevelOfDetail(0);
+
+    // nothing has changed
+    QVERIFY(dev->regionForLodSyncing(1).isEmpty());
+
+    // only the modified tile should be resynced
+    dev->fill(QRect(70,70,10,10), KoColor(Qt::blue, cs));
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), QRect(64,64,64,64));
+
+    // removed tiles should be resynced as well
+    dev->clear(QRect(192,192,64,64));
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), QRect(64,64,192,192));
+
+    // other levels are not affected by the sync of level 1
+    QCOMPARE(dev->regionForLodSyncing(2).boundingRect(), dev->regionForLodSyncing().boundingRect());
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncremental(dev, 1);
+    QVERIFY(dev->regionForLodSyncing(1).isEmpty());
+
+    // the incrementally synced plane should be equal to the one generated from scratch
+    KisPaintDeviceSP incrementalLod = new KisPaintDevice(cs);
+    incrementalLod->makeCloneFromRough(dev, dev->extent());
+    bounds->testingSetLevelOfDetail(0);
+
+    KisPaintDeviceSP referenceSource = new KisPaintDevice(*dev);
+    KisPaintDeviceSP referenceLod = new KisPaintDevice(cs);
+    referenceSource->generateLodCloneDevice(referenceLod, referenceSource->extent(), 1);
+
+    QPoint pt;
+    if (!TestUtil::comparePaintDevices(pt, incrementalLod, referenceLod)) {
+        QFAIL(QString("Incremental LoD sync is not pixel perfect, first different pixel: %1,%2 ").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+
+    // moving the device invalidates the pyramid
+    dev->setX(3);
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), dev->regionForLodSyncing().boundingRect());
+}
+
+void KisPaintDeviceTest::testLodPyramidCancelledSync()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(QRect(0,0,300,300));
+    dev->setDefaultBounds(bounds);
+
+    fillGradientDevice(dev, QRect(10,10,270,270));
+
+    const QRect fullRect = dev->regionForLodSyncing().boundingRect();
+
+    // a sync that has never been committed doesn't count
+    {
+        KisRegion region;
+        QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(1, &region));
+        QCOMPARE(region.boundingRect(), fullRect);
+        dev->updateLodDataStruct(s.data(), QRect(0,0,64,64));
+    }
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), fullRect);
+
+    // a fresh plane doesn't belong to the pyramid
+    {
+        QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(1));
+        Q_FOREACH(QRect rect2, KritaUtils::splitRegionIntoPatches(dev->regionForLodSyncing(), KritaUtils::optimalPatchSize())) {
+            dev->updateLodDataStruct(s.data(), rect2);
+        }
+        dev->commitLodDataStruct(s.data());
+    }
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), fullRect);
+
+    // a commit without an upload is enough for the pyramid
+    {
+        KisRegion region;
+        QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(1, &region));
+        Q_FOREACH(QRect rect2, KritaUtils::splitRegionIntoPatches(region, KritaUtils::optimalPatchSize())) {
+            dev->updateLodDataStruct(s.data(), rect2);
+        }
+        dev->commitLodDataStruct(s.data());
+    }
+    QVERIFY(dev->regionForLodSyncing(1).isEmpty());
+
+    // the tiles changed after a cancelled sync are still reported
+    dev->fill(QRect(70,70,10,10), KoColor(Qt::blue, cs));
+    {
+        KisRegion region;
+        QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(1, &region));
+        QCOMPARE(region.boundingRect(), QRect(64,64,64,64));
+    }
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), QRect(64,64,64,64));
+
+    // the result of the residual sync is equal to the full one
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncremental(dev, 1);
+
+    KisPaintDeviceSP residualLod = new KisPaintDevice(cs);
+    residualLod->makeCloneFromRough(dev, dev->extent());
+    bounds->testingSetLevelOfDetail(0);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    dev->generateLodCloneDevice(reference, dev->extent(), 1);
+
+    QPoint pt;
+    if (!TestUtil::comparePaintDevices(pt, residualLod, reference)) {
+        QFAIL(QString("Residual LoD sync is not pixel perfect, first different pixel: %1,%2 ").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
+void KisPaintDeviceTest::testLodFreshPlaneAfterPyramidSync()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(QRect(0,0,300,300));
+    dev->setDefaultBounds(bounds);
+
+    fillGradientDevice(dev, QRect(10,10,270,270));
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncremental(dev, 1);
+    bounds->testingSetLevelOfDetail(0);
+
+    // the same as the onion skins do: clear the device and sync only its new extent
+    dev->clear();
+    dev->fill(QRect(100,100,50,50), KoColor(Qt::blue, cs));
+
+    bounds->testingSetLevelOfDetail(1);
+    {
+        QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(1));
+        dev->updateLodDataStruct(s.data(), dev->extent());
+        dev->uploadLodDataStruct(s.data());
+    }
+
+    KisPaintDeviceSP freshLod = new KisPaintDevice(cs);
+    freshLod->makeCloneFromRough(dev, dev->extent());
+    bounds->testingSetLevelOfDetail(0);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    dev->generateLodCloneDevice(reference, dev->extent(), 1);
+
+    // no ghosts of the previous content should be left
+    QCOMPARE(freshLod->exactBounds(), reference->exactBounds());
+
+    QPoint pt;
+    if (!TestUtil::comparePaintDevices(pt, freshLod, reference)) {
+        QFAIL(QString("Fresh LoD plane is not pixel perfect, first different pixel: %1,%2 ").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
+void KisPaintDeviceTest::testLodPyramidCloneAndRelease()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(QRect(0,0,300,300));
+    dev->setDefaultBounds(bounds);
+
+    fillGradientDevice(dev, QRect(10,10,270,270));
+
+    int lod = -1;
+    QVERIFY(!dev->createLodPyramidClone(2, &lod));
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncremental(dev, 1);
+    bounds->testingSetLevelOfDetail(2);
+    syncLodCacheIncremental(dev, 2);
+    bounds->testingSetLevelOfDetail(0);
+
+    // the coarsest level allowed is preferred
+    KisPaintDeviceSP clone = dev->createLodPyramidClone(2, &lod);
+    QVERIFY(clone);
+    QCOMPARE(lod, 2);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    dev->generateLodCloneDevice(reference, dev->extent(), 2);
+
+    QPoint pt;
+    if (!TestUtil::comparePaintDevices(pt, clone, reference)) {
+        QFAIL(QString("Pyramid clone is not pixel perfect, first different pixel: %1,%2 ").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+
+    clone = dev->createLodPyramidClone(1, &lod);
+    QVERIFY(clone);
+    QCOMPARE(lod, 1);
+
+    // outdated levels are never returned
+    dev->fill(QRect(70,70,10,10), KoColor(Qt::blue, cs));
+    QVERIFY(!dev->createLodPyramidClone(2, &lod));
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCacheIncremental(dev, 1);
+    bounds->testingSetLevelOfDetail(0);
+
+    clone = dev->createLodPyramidClone(2, &lod);
+    QVERIFY(clone);
+    QCOMPARE(lod, 1);
+
+    // the released levels are regenerated from scratch
+    dev->releaseLodPyramid(2);
+    QVERIFY(!dev->createLodPyramidClone(2, &lod));
+    QCOMPARE(dev->regionForLodSyncing(1).boundingRect(), dev->regionForLodSyncing().boundingRect());
+
+    bounds->testingSetLevelOfDetail(2);
+    QVERIFY(!dev->regionForLodSyncing(2).isEmpty());
+    syncLodCacheIncremental(dev, 2);
+    bounds->testingSetLevelOfDetail(0);
+    QVERIFY(dev->createLodPyramidClone(2, &lod));
+
+    dev->releaseLodPyramid();
+    QVERIFY(!dev->createLodPyramidClone(2, &lod));
+}
+
 void KisPaintDeviceTest::benchmarkLod1Generation()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
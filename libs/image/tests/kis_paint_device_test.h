@@ -23,6 +23,7 @@ private Q_SLOTS:
     void testThumbnail();
     void testThumbnailDeviceWithOffset();
     void testCaching();
+    void testThumbnailIncremental();
     void testRegion();
     void testPixel();
     void testRoundtripReadWrite();
@@ -40,6 +41,9 @@ private Q_SLOTS:
     void testAmortizedExactBounds();
     void testNonDefaultPixelArea();
     void testExactBoundsNonTransparent();
+    void testExactBoundsIncremental();
+    void testExactBoundsWriteDuringScan();
+    void testChannelStatistics();
 
     void testReadBytesWrapAround();
     void testWrappedRandomAccessor();
@@ -53,6 +57,10 @@ private Q_SLOTS:
 
     void testLodTransform();
     void testLodDevice();
+    void testLodPyramidIncremental();
+    void testLodPyramidCancelledSync();
+    void testLodFreshPlaneAfterPyramidSync();
+    void testLodPyramidCloneAndRelease();
     void benchmarkLod1Generation();
     void benchmarkLod2Generation();
     void benchmarkLod3Generation();
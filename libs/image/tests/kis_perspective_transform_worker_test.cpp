@@ -13,6 +13,8 @@
 #define USE_DOCUMENT 0
 #include "qimage_based_test.h"
 
+#include <KoColorSpaceRegistry.h>
+
 #include "kis_perspectivetransform_worker.h"
 #include "kis_transaction.h"
 
@@ -60,4 +62,40 @@ void KisPerspectiveTransformWorkerTest::testSimpleTransform()
     t.checkLayer("simple_transform");
 }
 
+void KisPerspectiveTransformWorkerTest::testIntegerTranslation_data()
+{
+    QTest::addColumn<int>("sampleType");
+
+    QTest::newRow("nearest") << int(KisPerspectiveTransformWorker::NearestNeighbour);
+    QTest::newRow("bilinear") << int(KisPerspectiveTransformWorker::Bilinear);
+    QTest::newRow("bicubic") << int(KisPerspectiveTransformWorker::Bicubic);
+    QTest::newRow("lanczos3") << int(KisPerspectiveTransformWorker::Lanczos3);
+}
+
+void KisPerspectiveTransformWorkerTest::testIntegerTranslation()
+{
+    QFETCH(int, sampleType);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    QImage image(TestUtil::fetchDataFileLazy("hakonepa.png"));
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->convertFromQImage(image, 0);
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(*dev);
+    refDev->moveTo(10, 5);
+
+    /**
+     * All the kernels are interpolating ones, so sampling exactly at the
+     * centers of the source pixels should reproduce them unchanged
+     */
+    KisPerspectiveTransformWorker worker(dev, QTransform::fromTranslate(10, 5), false, 0);
+    worker.run(KisPerspectiveTransformWorker::SampleType(sampleType));
+
+    QCOMPARE(dev->exactBounds(), refDev->exactBounds());
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, dev, refDev));
+}
+
 SIMPLE_TEST_MAIN(KisPerspectiveTransformWorkerTest)
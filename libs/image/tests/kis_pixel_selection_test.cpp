@@ -164,6 +164,66 @@ void KisPixelSelectionTest::testIntersectSelection()
     QCOMPARE(sel1->selectedExactRect(), QRect(25, 0, 25, 50));
 }
 
+void KisPixelSelectionTest::testTileWiseSelectionOps_data()
+{
+    QTest::addColumn<int>("action");
+
+    QTest::newRow("add") << int(SELECTION_ADD);
+    QTest::newRow("subtract") << int(SELECTION_SUBTRACT);
+    QTest::newRow("intersect") << int(SELECTION_INTERSECT);
+    QTest::newRow("symmetric-difference") << int(SELECTION_SYMMETRICDIFFERENCE);
+}
+
+void KisPixelSelectionTest::testTileWiseSelectionOps()
+{
+    QFETCH(int, action);
+
+    KisPixelSelectionSP sel1 = new KisPixelSelection();
+    KisPixelSelectionSP sel2 = new KisPixelSelection();
+
+    // uniform tiles, partially covered tiles and semi-transparent areas
+    sel1->select(QRect(0, 0, 320, 192));
+    sel1->select(QRect(100, 30, 50, 70), 100);
+    sel1->clear(QRect(200, 150, 10, 10));
+
+    sel2->select(QRect(-20, 64, 448, 256));
+    sel2->select(QRect(64, 128, 64, 64), 60);
+    sel2->select(QRect(300, 10, 20, 20), 200);
+
+    const QRect rc(-64, -64, 576, 448);
+    const int numPixels = rc.width() * rc.height();
+
+    QVector<quint8> dst(numPixels);
+    QVector<quint8> src(numPixels);
+    sel1->readBytes(dst.data(), rc);
+    sel2->readBytes(src.data(), rc);
+
+    QVector<quint8> expected(numPixels);
+    for (int i = 0; i < numPixels; i++) {
+        switch (action) {
+        case SELECTION_ADD:
+            expected[i] = qMin(dst[i] + src[i], int(MAX_SELECTED));
+            break;
+        case SELECTION_SUBTRACT:
+            expected[i] = qMax(dst[i] - src[i], int(MIN_SELECTED));
+            break;
+        case SELECTION_INTERSECT:
+            expected[i] = qMin(dst[i], src[i]);
+            break;
+        default:
+            expected[i] = qAbs(dst[i] - src[i]);
+            break;
+        }
+    }
+
+    sel1->applySelection(sel2, SelectionAction(action));
+
+    QVector<quint8> result(numPixels);
+    sel1->readBytes(result.data(), rc);
+
+    QCOMPARE(result, expected);
+}
+
 void KisPixelSelectionTest::testTotally()
 {
     KisPixelSelectionSP sel = new KisPixelSelection();
@@ -579,5 +639,53 @@ void KisPixelSelectionTest::testOutlineArtifacts()
                    QPoint(0,0)})}));
 }
 
+#include "kis_outline_generator.h"
+
+QVector<QPolygon> referenceOutline(KisPixelSelectionSP psel)
+{
+    const QRect rc = psel->selectedExactRect();
+
+    QVector<quint8> buffer(rc.width() * rc.height());
+    psel->readBytes(buffer.data(), rc);
+
+    KisOutlineGenerator generator(psel->colorSpace(), MIN_SELECTED);
+    return generator.outline(buffer.data(), rc.x(), rc.y(), rc.width(), rc.height());
+}
+
+void KisPixelSelectionTest::testTiledOutline()
+{
+    KisPixelSelectionSP psel = new KisPixelSelection();
+
+    // a frame with a hole crossing the tile borders
+    psel->select(QRect(30, 30, 200, 150));
+    psel->clear(QRect(50, 60, 100, 50));
+
+    // pixels touching diagonally across a tile corner
+    psel->select(QRect(250, 100, 6, 28));
+    psel->select(QRect(256, 128, 10, 10));
+
+    // an island inside the hole
+    psel->select(QRect(60, 63, 70, 2));
+
+    QCOMPARE(psel->outline(), referenceOutline(psel));
+
+    // the next calls update only the tiles around the changes
+    psel->clear(QRect(120, 40, 5, 5));
+    psel->select(QRect(300, 300, 1, 1));
+    QCOMPARE(psel->outline(), referenceOutline(psel));
+
+    psel->clear(QRect(240, 90, 40, 60));
+    QCOMPARE(psel->outline(), referenceOutline(psel));
+
+    psel->moveTo(QPoint(13, -7));
+    QCOMPARE(psel->outline(), referenceOutline(psel));
+
+    psel->clear();
+    QVERIFY(psel->outline().isEmpty());
+
+    psel->select(QRect(-70, -70, 10, 140));
+    QCOMPARE(psel->outline(), referenceOutline(psel));
+}
+
 KISTEST_MAIN(KisPixelSelectionTest)
 
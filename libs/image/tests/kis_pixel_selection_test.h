@@ -24,6 +24,8 @@ private Q_SLOTS:
     void testAddSelection();
     void testSubtractSelection();
     void testIntersectSelection();
+    void testTileWiseSelectionOps_data();
+    void testTileWiseSelectionOps();
     void testTotally();
     void testUpdateProjection();
     void testExactRectWithImage();
@@ -35,6 +37,8 @@ private Q_SLOTS:
     void testOutlineCacheTransactions();
 
     void testOutlineArtifacts();
+
+    void testTiledOutline();
 };
 
 #endif
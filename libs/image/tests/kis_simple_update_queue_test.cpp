@@ -87,6 +87,41 @@ void KisSimpleUpdateQueueTest::testJobProcessing()
     QVERIFY(checkWalker(walkersList[0], dirtyRect5, 1));
 }
 
+void KisSimpleUpdateQueueTest::testPriorityRects()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->barrierLock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    KisTestableUpdaterContext context(2);
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    queue.addUpdateJob(paintLayer, QRect(0,0,1000,1000), imageRect, 0);
+    QCOMPARE(walkersList.size(), 4);
+
+    queue.setPriorityRects({QRect(600,600,100,100)});
+    queue.processQueue(context);
+
+    QVector<KisUpdateJobItem*> jobs = context.getJobs();
+    QCOMPARE(jobs.size(), 2);
+
+    // the visible patch goes first, the spare thread takes the oldest one
+    QVERIFY(checkWalker(jobs[0]->walker(), QRect(512,512,488,488)));
+    QVERIFY(checkWalker(jobs[1]->walker(), QRect(0,0,512,512)));
+
+    QCOMPARE(walkersList.size(), 2);
+    QVERIFY(checkWalker(walkersList[0], QRect(512,0,488,512)));
+    QVERIFY(checkWalker(walkersList[1], QRect(0,512,512,488)));
+}
+
 void KisSimpleUpdateQueueTest::testSplitUpdate()
 {
     testSplit(false);
@@ -270,5 +305,56 @@ void KisSimpleUpdateQueueTest::testSpontaneousJobsCompression()
     QCOMPARE(jobsList[0], job3);
 }
 
+class KisBackgroundSpontaneousJob : public KisNoopSpontaneousJob
+{
+public:
+    KisBackgroundSpontaneousJob(int deadlineHint = -1)
+    {
+        setExclusive(true);
+        setPriority(KisStrokeJobData::BACKGROUND);
+        setDeadlineHint(deadlineHint);
+    }
+};
+
+void KisSimpleUpdateQueueTest::testBackgroundSpontaneousJobs()
+{
+    KisTestableUpdaterContext context(2);
+    KisTestableSimpleUpdateQueue queue;
+    KisSpontaneousJobsList &jobsList = queue.getSpontaneousJobsList();
+
+    queue.addSpontaneousJob(new KisBackgroundSpontaneousJob());
+
+    // postponed while the user is painting
+    queue.processQueue(context, true);
+    QCOMPARE(jobsList.size(), 1);
+    QVERIFY(!context.getJobs()[0]->isRunning());
+
+    queue.processQueue(context, false);
+    QVERIFY(jobsList.isEmpty());
+    QCOMPARE(context.getJobs()[0]->type(), KisUpdateJobItem::Type::SPONTANEOUS);
+
+    context.clear();
+
+    // the deadline makes sure the job is not postponed forever
+    queue.addSpontaneousJob(new KisBackgroundSpontaneousJob(10));
+
+    queue.processQueue(context, true);
+    QCOMPARE(jobsList.size(), 1);
+
+    QTest::qSleep(20);
+
+    queue.processQueue(context, true);
+    QVERIFY(jobsList.isEmpty());
+    QCOMPARE(context.getJobs()[0]->type(), KisUpdateJobItem::Type::SPONTANEOUS);
+
+    context.clear();
+
+    // regular jobs are never postponed
+    queue.addSpontaneousJob(new KisNoopSpontaneousJob());
+
+    queue.processQueue(context, true);
+    QVERIFY(jobsList.isEmpty());
+}
+
 KISTEST_MAIN(KisSimpleUpdateQueueTest)
 
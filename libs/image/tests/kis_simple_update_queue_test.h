@@ -24,6 +24,8 @@ private Q_SLOTS:
     void testChecksum();
     void testMixingTypes();
     void testSpontaneousJobsCompression();
+    void testPriorityRects();
+    void testBackgroundSpontaneousJobs();
 };
 
 #endif /* KIS_SIMPLE_UPDATE_QUEUE_TEST_H */
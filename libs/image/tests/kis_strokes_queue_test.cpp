@@ -1127,4 +1127,98 @@ void KisStrokesQueueTest::testUniquelyConcurrentJobs()
 }
 
 
+void KisStrokesQueueTest::testInteractiveJobs()
+{
+    KisStrokesQueue queue;
+    QVERIFY(!queue.hasInteractiveJobs());
+
+    KisStrokeId id = queue.startStroke(new KisTestingStrokeStrategy(QLatin1String("tri_"), false));
+    queue.addJob(id, new KisStrokeJobData(KisStrokeJobData::CONCURRENT));
+    QVERIFY(!queue.hasInteractiveJobs());
+
+    queue.addJob(id, new KisStrokeJobData(KisStrokeJobData::CONCURRENT,
+                                          KisStrokeJobData::NORMAL,
+                                          KisStrokeJobData::INTERACTIVE));
+    QVERIFY(queue.hasInteractiveJobs());
+
+    KisTestableUpdaterContext context(2);
+    QVector<KisUpdateJobItem*> jobs;
+
+    queue.processQueue(context, false);
+
+    jobs = context.getJobs();
+    COMPARE_NAME(jobs[0], "tri_init");
+    VERIFY_EMPTY(jobs[1]);
+
+    context.clear();
+    queue.processQueue(context, false);
+
+    jobs = context.getJobs();
+    COMPARE_NAME(jobs[0], "tri_dab");
+    COMPARE_NAME(jobs[1], "tri_dab");
+
+    // the user can still add more dabs into the stroke
+    QVERIFY(queue.hasInteractiveJobs());
+
+    queue.endStroke(id);
+
+    // the finishing job is still pending
+    QVERIFY(queue.hasInteractiveJobs());
+
+    context.clear();
+    queue.processQueue(context, false);
+
+    jobs = context.getJobs();
+    COMPARE_NAME(jobs[0], "tri_finish");
+    VERIFY_EMPTY(jobs[1]);
+
+    QVERIFY(!queue.hasInteractiveJobs());
+}
+
+void KisStrokesQueueTest::testExpiredDeadline()
+{
+    {
+        // background jobs are never postponed forever by default
+        KisStrokeJobData data(KisStrokeJobData::CONCURRENT,
+                              KisStrokeJobData::NORMAL,
+                              KisStrokeJobData::BACKGROUND);
+        QCOMPARE(data.deadlineHint(), int(KisStrokeJobData::defaultBackgroundDeadlineHint));
+
+        KisStrokeJobData data2;
+        QCOMPARE(data2.deadlineHint(), -1);
+
+        data2.setPriority(KisStrokeJobData::BACKGROUND);
+        QCOMPARE(data2.deadlineHint(), int(KisStrokeJobData::defaultBackgroundDeadlineHint));
+    }
+
+    KisStrokesQueue queue;
+
+    KisStrokeId id = queue.startStroke(new KisTestingStrokeStrategy(QLatin1String("tri_"), false, true));
+
+    KisStrokeJobData *data = new KisStrokeJobData(KisStrokeJobData::CONCURRENT,
+                                                  KisStrokeJobData::NORMAL,
+                                                  KisStrokeJobData::BACKGROUND);
+    data->setDeadlineHint(10);
+    QVERIFY(!data->isDeadlineExpired());
+
+    queue.addJob(id, data);
+    queue.endStroke(id);
+
+    QVERIFY(!queue.hasInteractiveJobs());
+
+    QTest::qSleep(20);
+
+    // a job whose deadline has expired is as urgent as an interactive one
+    QVERIFY(queue.hasInteractiveJobs());
+
+    KisTestableUpdaterContext context(2);
+    queue.processQueue(context, false);
+
+    QVector<KisUpdateJobItem*> jobs = context.getJobs();
+    COMPARE_NAME(jobs[0], "tri_dab");
+    VERIFY_EMPTY(jobs[1]);
+
+    QVERIFY(!queue.hasInteractiveJobs());
+}
+
 KISTEST_MAIN(KisStrokesQueueTest)
@@ -35,6 +35,8 @@ private Q_SLOTS:
     void testLodUndoBase2();
     void testMutatedJobs();
     void testUniquelyConcurrentJobs();
+    void testInteractiveJobs();
+    void testExpiredDeadline();
 
 private:
     struct LodStrokesQueueTester;
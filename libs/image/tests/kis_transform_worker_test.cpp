@@ -916,6 +916,29 @@ void KisTransformWorkerTest::benchmarkScaleRotateShear()
     }
 }
 
+void KisTransformWorkerTest::benchmarkScaleRotateShearSequential()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    QImage image(TestUtil::fetchDataFileLazy("hakonepa.png"));
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->convertFromQImage(image, 0);
+
+    QScopedPointer<KisFilterStrategy> filter(new KisBicubicFilterStrategy());
+
+    QBENCHMARK {
+        KisPaintDeviceSP copy = new KisPaintDevice(*dev);
+
+        KisTransformWorker tw(copy, 1.379, 1.379,
+                              0.479, 0.0,
+                              0, 0,
+                              M_PI/6.0,
+                              0, 0,
+                              0, filter.data());
+        tw.setConcurrentPassesEnabled(false);
+        tw.run();
+    }
+}
+
 void KisTransformWorkerTest::generateTestImages()
 {
     QList<KisFilterStrategy*> filters;
@@ -979,6 +1002,41 @@ void KisTransformWorkerTest::testPartialProcessing()
     TestUtil::checkQImage(result, "transform_test", "partial", "single");
 }
 
+void KisTransformWorkerTest::testConcurrentPasses()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    QImage image(TestUtil::fetchDataFileLazy("hakonepa.png"));
+
+    KisPaintDeviceSP dev1 = new KisPaintDevice(cs);
+    dev1->convertFromQImage(image, 0);
+
+    // the bands should be aligned to the tile grid, not to the origin
+    dev1->moveTo(13, 7);
+
+    KisPaintDeviceSP dev2 = new KisPaintDevice(*dev1);
+
+    QScopedPointer<KisFilterStrategy> filter(new KisBicubicFilterStrategy());
+
+    auto runWorker = [&filter] (KisPaintDeviceSP dev, bool concurrent) {
+        KisTransformWorker tw(dev, 1.379, 0.734,
+                              0.479, 0.0,
+                              0, 0,
+                              M_PI/7.0,
+                              10.5, 20.3,
+                              0, filter.data());
+        tw.setConcurrentPassesEnabled(concurrent);
+        tw.run();
+    };
+
+    runWorker(dev1, false);
+    runWorker(dev2, true);
+
+    QCOMPARE(dev2->exactBounds(), dev1->exactBounds());
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, dev1, dev2));
+}
+
 void KisTransformWorkerTest::testXScaleUpPixelAlignment_data()
 {
     QTest::addColumn<int>("newSize");
@@ -49,8 +49,10 @@ private Q_SLOTS:
     void benchmarkRotate1Q();
     void benchmarkShear();
     void benchmarkScaleRotateShear();
+    void benchmarkScaleRotateShearSequential();
 
     void testPartialProcessing();
+    void testConcurrentPasses();
 
     void testXScaleUpPixelAlignment_data();
     void testXScaleUpPixelAlignment();
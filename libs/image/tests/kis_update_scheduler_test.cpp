@@ -9,6 +9,7 @@
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColor.h>
 
 #include "kis_group_layer.h"
 #include "kis_paint_layer.h"
@@ -415,5 +416,48 @@ void KisUpdateSchedulerTest::testLodSync()
     image->waitForDone();
 }
 
+void KisUpdateSchedulerTest::testBackgroundLodSyncNotRepeated()
+{
+    KisImageSP image = buildTestingImage();
+    KisNodeSP rootLayer = image->root();
+    KisNodeSP paintLayer1 = rootLayer->firstChild();
+    KisPaintDeviceSP dev = paintLayer1->paintDevice();
+
+    QCOMPARE(paintLayer1->name(), QString("paint1"));
+
+    const KoColor color(Qt::red, dev->colorSpace());
+
+    image->setLodPreferences(KisLodPreferences(2));
+    image->waitForDone();
+
+    image->requestBackgroundLodSync();
+    image->waitForDone();
+
+    QVERIFY(dev->regionForLodSyncing(2).isEmpty());
+
+    /**
+     * The device is changed behind the back of the strokes queue, so
+     * the pyramids are still considered to be in sync and the next idle
+     * call should not start any sync
+     */
+    dev->fill(QRect(10, 10, 100, 100), color);
+    QVERIFY(!dev->regionForLodSyncing(2).isEmpty());
+
+    image->requestBackgroundLodSync();
+    image->waitForDone();
+
+    QVERIFY(!dev->regionForLodSyncing(2).isEmpty());
+
+    // a non-forgettable stroke invalidates the pyramids again
+    KisStrokeId id = image->startStroke(new KisStrokeStrategy(QLatin1String("test_stroke")));
+    image->endStroke(id);
+    image->waitForDone();
+
+    image->requestBackgroundLodSync();
+    image->waitForDone();
+
+    QVERIFY(dev->regionForLodSyncing(2).isEmpty());
+}
+
 KISTEST_MAIN(KisUpdateSchedulerTest)
 
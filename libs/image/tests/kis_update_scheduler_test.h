@@ -30,6 +30,7 @@ private Q_SLOTS:
     void testTimeMonitor();
 
     void testLodSync();
+    void testBackgroundLodSyncNotRepeated();
 };
 
 #endif /* KIS_UPDATE_SCHEDULER_TEST_H */
@@ -286,6 +286,68 @@ void KisWarpTransformWorkerTest::testGridSize()
     QCOMPARE(GridIterationTools::calcGridDimension(0, 300, 8), 39);
 }
 
+void KisWarpTransformWorkerTest::testConcurrentGrid()
+{
+    WarpTransforWorkerData d;
+
+    // an odd offset makes the bands unaligned to the source grid
+    d.dev->moveTo(13, 7);
+    const QRect srcBounds = d.dev->exactBounds();
+
+    auto functionOp = [&] (const QPointF &pt) {
+        return KisWarpTransformWorker::rigidTransformMath(pt, d.origPoints, d.transfPoints, d.alpha);
+    };
+
+    const int pixelPrecision = 8;
+
+    {
+        KisPaintDeviceSP sequentialDev = new KisPaintDevice(d.dev->colorSpace());
+        KisPaintDeviceSP concurrentDev = new KisPaintDevice(d.dev->colorSpace());
+
+        GridIterationTools::PaintDevicePolygonOp sequentialOp(d.dev, sequentialDev);
+        GridIterationTools::processGrid(sequentialOp, functionOp, srcBounds, pixelPrecision);
+
+        GridIterationTools::PaintDevicePolygonOp concurrentOp(d.dev, concurrentDev);
+        GridIterationTools::processGridConcurrently(concurrentOp, functionOp, srcBounds, pixelPrecision);
+
+        QPoint errorPoint;
+        QVERIFY(TestUtil::comparePaintDevices(errorPoint, sequentialDev, concurrentDev));
+    }
+
+    {
+        const QSize gridSize = GridIterationTools::calcGridSize(srcBounds, pixelPrecision);
+
+        QVector<QPointF> origPoints;
+        QVector<QPointF> transfPoints;
+
+        for (int row = 0; row < gridSize.height(); row++) {
+            for (int col = 0; col < gridSize.width(); col++) {
+                const QPointF pt(srcBounds.x() + col * pixelPrecision,
+                                 srcBounds.y() + row * pixelPrecision);
+
+                origPoints << pt;
+                transfPoints << functionOp(pt);
+            }
+        }
+
+        KisPaintDeviceSP sequentialDev = new KisPaintDevice(d.dev->colorSpace());
+        KisPaintDeviceSP concurrentDev = new KisPaintDevice(d.dev->colorSpace());
+
+        GridIterationTools::RegularGridIndexesOp indexesOp(gridSize);
+
+        GridIterationTools::PaintDevicePolygonOp sequentialOp(d.dev, sequentialDev);
+        GridIterationTools::iterateThroughGrid<GridIterationTools::AlwaysCompletePolygonPolicy>(
+            sequentialOp, indexesOp, gridSize, origPoints, transfPoints);
+
+        GridIterationTools::PaintDevicePolygonOp concurrentOp(d.dev, concurrentDev);
+        GridIterationTools::iterateThroughGridConcurrently<GridIterationTools::AlwaysCompletePolygonPolicy>(
+            concurrentOp, indexesOp, gridSize, origPoints, transfPoints);
+
+        QPoint errorPoint;
+        QVERIFY(TestUtil::comparePaintDevices(errorPoint, sequentialDev, concurrentDev));
+    }
+}
+
 void KisWarpTransformWorkerTest::testBackwardInterpolatorExtrapolation()
 {
     QPolygonF src;
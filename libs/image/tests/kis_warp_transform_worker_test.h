@@ -21,6 +21,7 @@ private Q_SLOTS:
     void testBackwardInterpolatorXYShear();
     void testBackwardInterpolatorRoundTrip();
     void testGridSize();
+    void testConcurrentGrid();
     void testBackwardInterpolatorExtrapolation();
 
     void testNeedChangeRects();
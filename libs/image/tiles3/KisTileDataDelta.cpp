@@ -0,0 +1,96 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTileDataDelta.h"
+
+#include <cstring>
+
+#include "kis_tile_data_interface.h"
+
+
+namespace {
+
+const int spanHeaderSize = 2 * sizeof(quint16);
+
+inline bool pixelsEqual(const quint8 *data, const quint8 *base, int index, int pixelSize)
+{
+    return !memcmp(data + index * pixelSize, base + index * pixelSize, pixelSize);
+}
+
+}
+
+bool KisTileDataDelta::encode(const quint8 *data, const quint8 *base, int pixelSize, int maxSizeFraction)
+{
+    const int numPixels = KisTileData::WIDTH * KisTileData::HEIGHT;
+    const int maxSize = numPixels * pixelSize / maxSizeFraction;
+
+    clear();
+    m_spans.reserve(maxSize);
+
+    int i = 0;
+    while (i < numPixels) {
+        while (i < numPixels && pixelsEqual(data, base, i, pixelSize)) {
+            i++;
+        }
+
+        if (i >= numPixels) break;
+
+        const int start = i;
+        int end = i + 1;
+
+        /**
+         * A few equal pixels in the middle of the span are cheaper
+         * to store than a header of the new span
+         */
+        for (int j = end; j < numPixels; j++) {
+            if (!pixelsEqual(data, base, j, pixelSize)) {
+                end = j + 1;
+            } else if ((j - end + 1) * pixelSize > spanHeaderSize) {
+                break;
+            }
+        }
+
+        const int length = end - start;
+
+        if (m_spans.size() + spanHeaderSize + length * pixelSize > maxSize) {
+            clear();
+            return false;
+        }
+
+        const quint16 header[2] = {quint16(start), quint16(length)};
+        m_spans.append(reinterpret_cast<const char*>(header), spanHeaderSize);
+        m_spans.append(reinterpret_cast<const char*>(data + start * pixelSize), length * pixelSize);
+
+        i = end;
+    }
+
+    m_spans.squeeze();
+    m_pixelSize = pixelSize;
+
+    return true;
+}
+
+void KisTileDataDelta::apply(quint8 *data) const
+{
+    const char *ptr = m_spans.constData();
+    const char *end = ptr + m_spans.size();
+
+    while (ptr < end) {
+        quint16 header[2];
+        memcpy(header, ptr, spanHeaderSize);
+        ptr += spanHeaderSize;
+
+        const int numBytes = header[1] * m_pixelSize;
+        memcpy(data + header[0] * m_pixelSize, ptr, numBytes);
+        ptr += numBytes;
+    }
+}
+
+void KisTileDataDelta::clear()
+{
+    m_spans.clear();
+    m_pixelSize = 0;
+}
@@ -0,0 +1,63 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILEDATADELTA_H
+#define KISTILEDATADELTA_H
+
+#include <QByteArray>
+
+#include "kritaimage_export.h"
+
+/**
+ * KisTileDataDelta stores the content of a tile as a difference
+ * against another (base) tile. Only the spans of pixels that differ
+ * from the base are saved, so a delta of a tile touched by a tiny
+ * brush dab takes a few dozens of bytes instead of the whole tile.
+ *
+ * The spans are stored in one buffer as a sequence of
+ * `quint16 offset, quint16 length, pixels...`, where offset and
+ * length are measured in pixels.
+ */
+class KRITAIMAGE_EXPORT KisTileDataDelta
+{
+public:
+    /**
+     * Encodes \p data as a difference against \p base. Both buffers
+     * should have the size of a tile. Returns false (and leaves the
+     * delta empty) if the difference is too big for the delta to be
+     * worth it, that is, bigger than 1/maxSizeFraction of the tile.
+     */
+    bool encode(const quint8 *data, const quint8 *base, int pixelSize, int maxSizeFraction = 4);
+
+    /**
+     * Writes the stored spans into \p data, which should already
+     * contain the content of the base tile
+     */
+    void apply(quint8 *data) const;
+
+    void clear();
+
+    bool isEmpty() const {
+        return m_pixelSize == 0;
+    }
+
+    int pixelSize() const {
+        return m_pixelSize;
+    }
+
+    /**
+     * The amount of memory occupied by the spans
+     */
+    int size() const {
+        return m_spans.size();
+    }
+
+private:
+    QByteArray m_spans;
+    int m_pixelSize = 0;
+};
+
+#endif // KISTILEDATADELTA_H
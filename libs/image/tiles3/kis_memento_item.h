@@ -7,9 +7,14 @@
 #ifndef KIS_MEMENTO_ITEM_H_
 #define KIS_MEMENTO_ITEM_H_
 
+#include <QMutex>
+#include <QMutexLocker>
+
 #include <kis_shared.h>
 #include <kis_shared_ptr.h>
+#include <kis_assert.h>
 #include "kis_tile.h"
+#include "KisTileDataDelta.h"
 
 
 class KisMementoItem;
@@ -37,6 +42,11 @@ public:
             m_row(rhs.m_row),
             m_next(0),
             m_parent(0) {
+        QMutexLocker l(&rhs.m_deltaLock);
+        m_tileData = rhs.m_tileData;
+        m_delta = rhs.m_delta;
+        m_deltaBase = rhs.m_deltaBase;
+
         if (m_tileData) {
             if (m_committedFlag)
                 m_tileData->acquire();
@@ -72,9 +82,12 @@ public:
      */
     KisMementoItem(const KisMementoItem &rhs, KisMementoManager *mm) {
         Q_UNUSED(mm);
-        m_tileData = rhs.m_tileData;
-        /* Setting counter: m_refCount++ */
-        m_tileData->ref();
+        {
+            QMutexLocker l(&rhs.m_deltaLock);
+            m_tileData = rhs.materializedTileDataImpl();
+            /* Setting counter: m_refCount++ */
+            m_tileData->ref();
+        }
         m_col = rhs.m_col;
         m_row = rhs.m_row;
         m_type = CHANGED;
@@ -103,6 +116,8 @@ public:
     void reset() {
         releaseTileData();
         m_tileData = 0;
+        m_delta.clear();
+        m_deltaBase = 0;
         m_committedFlag = false;
     }
 
@@ -141,9 +156,84 @@ public:
         m_committedFlag = true;
     }
 
+    /**
+     * Replaces the tile data of a committed item with a delta against
+     * the tile data of \p base, which is supposed to be the next
+     * revision of the same tile. It is done only when the difference
+     * is small and the item is the only user of its tile data, that
+     * is, when the tile data is really freed after the conversion.
+     *
+     * The item keeps only a weak link to \p base. The base is newer,
+     * so it stays in the history as long as the item can be rolled
+     * back to, except when the base is undone and dropped from the
+     * redo history. KisMementoManager restores the item in that case,
+     * see materializeIfDeltaOf().
+     *
+     * The tile data is restored lazily when it is requested again
+     * (on rollback), see materializedTileData(). The conversion may
+     * be done in a background thread, so the tile data is acquired
+     * by the users only under the lock of the item.
+     */
+    bool tryConvertToDelta(KisMementoItemSP base) {
+        QMutexLocker l(&m_deltaLock);
+
+        if (!m_committedFlag || m_type != CHANGED ||
+            !m_tileData || m_tileData->numUsers() > 1) {
+
+            return false;
+        }
+
+        /**
+         * NOTE: the lock of the base is taken while holding ours,
+         * so the locks are always taken in older-to-newer order
+         */
+        KisTileData *baseTileData = base->materializedTileData();
+        if (baseTileData->pixelSize() != m_tileData->pixelSize()) return false;
+
+        m_tileData->blockSwapping();
+        baseTileData->blockSwapping();
+
+        const bool result = m_delta.encode(m_tileData->data(), baseTileData->data(), m_tileData->pixelSize());
+
+        baseTileData->unblockSwapping();
+        m_tileData->unblockSwapping();
+
+        if (result) {
+            m_deltaBase = base.data();
+            releaseTileData();
+            m_tileData = 0;
+        }
+
+        return result;
+    }
+
+    /**
+     * Restores the tile data of the item if it is stored as a delta
+     * against \p base. Must be called before \p base leaves the history
+     * while the item stays there.
+     */
+    void materializeIfDeltaOf(KisMementoItemSP base) {
+        QMutexLocker l(&m_deltaLock);
+
+        if (!m_tileData && m_deltaBase == base.data()) {
+            materializedTileDataImpl();
+        }
+    }
+
+    /**
+     * Returns the tile data of the item restoring it
+     * from the delta if needed
+     */
+    KisTileData* materializedTileData() const {
+        QMutexLocker l(&m_deltaLock);
+        return materializedTileDataImpl();
+    }
+
     inline KisTileSP tile(KisMementoManager *mm) {
-        Q_ASSERT(m_tileData);
-        return KisTileSP(new KisTile(m_col, m_row, m_tileData, mm));
+        QMutexLocker l(&m_deltaLock);
+        KisTileData *td = materializedTileDataImpl();
+        Q_ASSERT(td);
+        return KisTileSP(new KisTile(m_col, m_row, td, mm));
     }
 
     inline enumType type() {
@@ -171,7 +261,7 @@ public:
         return m_row;
     }
     inline KisTileData* tileData() const {
-        return m_tileData;
+        return materializedTileData();
     }
 
     void debugPrintInfo() {
@@ -194,6 +284,33 @@ public:
     }
 
 protected:
+    /**
+     * Should be called with m_deltaLock held
+     */
+    KisTileData* materializedTileDataImpl() const {
+        if (!m_tileData && !m_delta.isEmpty()) {
+            KisMementoItemSP base(m_deltaBase);
+            KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(base, 0);
+
+            KisTileData *baseTileData = base->materializedTileData();
+            KisTileData *td = baseTileData->clone();
+
+            td->blockSwapping();
+            m_delta.apply(td->data());
+            td->unblockSwapping();
+
+            // the item is committed, so it owns the data completely
+            td->acquire();
+            td->setMementoed(true);
+
+            m_tileData = td;
+            m_delta.clear();
+            m_deltaBase = 0;
+        }
+
+        return m_tileData;
+    }
+
     void releaseTileData() {
         if (m_tileData) {
             if (m_committedFlag) {
@@ -207,7 +324,7 @@ protected:
     }
 
 protected:
-    KisTileData *m_tileData {0};
+    mutable KisTileData *m_tileData {0};
     bool m_committedFlag {false};
     enumType m_type {CHANGED};
 
@@ -216,6 +333,14 @@ protected:
 
     KisMementoItemSP m_next;
     KisMementoItemSP m_parent;
+
+    /**
+     * When the item is converted into a delta, m_tileData is null,
+     * and the data is stored as a difference against m_deltaBase
+     */
+    mutable KisTileDataDelta m_delta;
+    mutable KisWeakSharedPtr<KisMementoItem> m_deltaBase;
+    mutable QMutex m_deltaLock;
 private:
 };
 
@@ -5,6 +5,9 @@
  */
 
 #include <QtGlobal>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
 #include "kis_memento_manager.h"
 #include "kis_memento.h"
 
@@ -190,6 +193,15 @@ void KisMementoManager::commit()
         mi->commit();
         revisionList.append(mi);
 
+        /**
+         * The parent has just become history. If the change was
+         * small, keep only the difference against the new revision.
+         * The comparison is done later by the swapper thread.
+         */
+        if (!newTile) {
+            queueDeltaConversion(parentMI, mi);
+        }
+
         m_headsHashTable.deleteTile(mi->col(), mi->row());
 
         iter.moveCurrentToHashTable(&m_headsHashTable);
@@ -210,6 +222,51 @@ void KisMementoManager::commit()
     KisTileDataStore::instance()->kickPooler();
 }
 
+namespace {
+struct DeltaConversionQueue
+{
+    QMutex queueLock;
+    QMutex conversionLock;
+    QVector<QPair<KisMementoItemSP, KisMementoItemSP>> items;
+};
+}
+
+Q_GLOBAL_STATIC(DeltaConversionQueue, s_deltaConversionQueue)
+
+void KisMementoManager::queueDeltaConversion(KisMementoItemSP item, KisMementoItemSP base)
+{
+    QMutexLocker l(&s_deltaConversionQueue->queueLock);
+    s_deltaConversionQueue->items.append(qMakePair(item, base));
+}
+
+void KisMementoManager::convertQueuedDeltas()
+{
+    QMutexLocker conversionLocker(&s_deltaConversionQueue->conversionLock);
+
+    QVector<QPair<KisMementoItemSP, KisMementoItemSP>> items;
+
+    {
+        QMutexLocker l(&s_deltaConversionQueue->queueLock);
+        items.swap(s_deltaConversionQueue->items);
+    }
+
+    for (auto it = items.begin(); it != items.end(); ++it) {
+        /**
+         * If the queue holds the only reference to the item,
+         * it has already been dropped from the history. The base
+         * must still be the next revision of the item, otherwise it
+         * has been undone and dropped from the redo history, so the
+         * delta could never be restored.
+         */
+        if (it->first->refCount() > 1 &&
+            it->second->refCount() > 1 &&
+            it->second->parent().data() == it->first.data()) {
+
+            it->first->tryConvertToDelta(it->second);
+        }
+    }
+}
+
 KisTileSP KisMementoManager::getCommitedTile(qint32 col, qint32 row, bool &existingTile)
 {
     /**
@@ -242,7 +299,26 @@ KisMementoSP KisMementoManager::getMemento()
     // KIS_SAFE_ASSERT_RECOVER_NOOP(m_index.isEmpty());
 
     // Clear redo() information
-    m_cancelledRevisions.clear();
+    if (!m_cancelledRevisions.isEmpty()) {
+        /**
+         * The undone items may be the delta bases of the items that
+         * stay in the history, restore them before the bases are
+         * dropped. The conversion lock guarantees that no item is
+         * converted against a base that is being dropped.
+         */
+        QMutexLocker l(&s_deltaConversionQueue->conversionLock);
+
+        Q_FOREACH (const KisHistoryItem &changeList, m_cancelledRevisions) {
+            Q_FOREACH (KisMementoItemSP mi, changeList.itemList) {
+                KisMementoItemSP parentMI = mi->parent();
+                if (parentMI) {
+                    parentMI->materializeIfDeltaOf(mi);
+                }
+            }
+        }
+
+        m_cancelledRevisions.clear();
+    }
 
     commit();
     m_currentMemento = new KisMemento(this);
@@ -113,7 +113,17 @@ public:
      */
     void purgeHistory(KisMementoSP oldestMemento);
 
+    /**
+     * Tries to convert the history items superseded by the recent
+     * commits into deltas (\see KisMementoItem::tryConvertToDelta()).
+     * The comparison of the tiles is expensive, so it is done by the
+     * swapper thread rather than in commit().
+     */
+    static void convertQueuedDeltas();
+
 protected:
+    static void queueDeltaConversion(KisMementoItemSP item, KisMementoItemSP base);
+
     qint32 findRevisionByMemento(KisMementoSP memento) const;
     void resetRevisionHistory(KisMementoItemList list);
 
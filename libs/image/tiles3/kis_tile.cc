@@ -13,12 +13,20 @@
 #include "kis_debug.h"
 
 
+QAtomicInt KisTile::s_currentWriteEpoch(0);
+
+int KisTile::advanceWriteEpoch()
+{
+    return s_currentWriteEpoch.fetchAndAddOrdered(1) + 1;
+}
+
 void KisTile::init(qint32 col, qint32 row,
                    KisTileData *defaultTileData, KisMementoManager* mm)
 {
     m_col = col;
     m_row = row;
     m_lockCounter = 0;
+    m_writeEpoch.store(s_currentWriteEpoch.load());
 
     m_extent = QRect(m_col * KisTileData::WIDTH, m_row * KisTileData::HEIGHT,
                      KisTileData::WIDTH, KisTileData::HEIGHT);
@@ -225,6 +233,8 @@ void KisTile::lockForWrite()
 
     blockSwapping();
 
+    m_writeEpoch.store(s_currentWriteEpoch.load());
+
     /* We are doing COW here */
     if (lazyCopying()) {
         m_COWMutex.lock();
@@ -262,6 +272,13 @@ void KisTile::lockForWrite()
 
 void KisTile::unlockForWrite()
 {
+    /**
+     * Stamp the epoch once again when the write is finished. Someone
+     * might have read the half-written tile and started a new epoch
+     * meanwhile, so the tile must be reported as changed after it.
+     */
+    m_writeEpoch.store(s_currentWriteEpoch.loadAcquire());
+
     unblockSwapping();
     DEBUG_LOG_ACTION("unlock [W]");
 
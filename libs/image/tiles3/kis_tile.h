@@ -119,6 +119,26 @@ public:
         return m_tileData;
     }
 
+    /**
+     * The write epoch of the tile is a coarse modification stamp. Every
+     * time the tile is created, locked for writing or unlocked after
+     * writing it gets the value of the global epoch counter. A tile has
+     * been modified after a checkpoint if its epoch is not less than the
+     * value returned by advanceWriteEpoch() at that checkpoint.
+     *
+     * Stamping on unlock guarantees that a tile read by someone in the
+     * middle of a write is reported as changed after that reader's
+     * checkpoint.
+     */
+    inline int writeEpoch() const {
+        return m_writeEpoch.load();
+    }
+
+    /**
+     * Starts a new global write epoch and returns its value
+     */
+    static int advanceWriteEpoch();
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
@@ -148,6 +168,9 @@ private:
 
     QAtomicPointer<KisMementoManager> m_mementoManager;
 
+    QAtomicInt m_writeEpoch;
+    static QAtomicInt s_currentWriteEpoch;
+
     /**
      * This is a special mutex for guarding copy-on-write
      * operations. We do not use lockless way here as it'll
@@ -99,7 +99,8 @@ public:
     enum EnumTileDataState {
         NORMAL = 0,
         COMPRESSED,
-        SWAPPED
+        SWAPPED,
+        SOLID
     };
 
     /**
@@ -230,12 +231,20 @@ private:
     friend class KisTileDataStoreIterator;
     friend class KisTileDataStoreReverseIterator;
     friend class KisTileDataStoreClockIterator;
+    friend class KisSwappedDataStore;
 
     /**
      * The state of the tile.
      * Filled in by tileDataStore and
      * checked in KisTile::acquireFor*
      * see also: comment for @m_data
+     *
+     * NORMAL - the data is loaded into m_data
+     * COMPRESSED - the data is kept compressed in memory
+     *              by KisSwappedDataStore
+     * SWAPPED - the data is stored in the swap file
+     * SOLID - all the pixels of the tile are equal, only one of
+     *         them is kept by KisSwappedDataStore
      */
     mutable EnumTileDataState m_state;
 
@@ -98,6 +98,9 @@ KisTileDataStore::MemoryStatistics KisTileDataStore::memoryStatistics()
 
     stats.totalMemorySize = memoryMetric() * metricCoeff + stats.poolSize;
 
+    stats.historicalCompressedSize = m_swappedStore.compressedMemorySize();
+    stats.historicalSwapSize = m_swappedStore.historicalMemoryMetric() * metricCoeff;
+
     stats.swapSize = m_swappedStore.totalMemoryMetric() * metricCoeff;
 
     return stats;
@@ -277,6 +280,88 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     return result;
 }
 
+bool KisTileDataStore::tryCompressTileData(KisTileData *td)
+{
+    /**
+     * Compression is much cheaper than swapping, so we don't block
+     * the whole store, the same way unregisterTileData() does.
+     */
+    QReadLocker lock(&m_iteratorLock);
+
+    bool result = false;
+    if (!td->m_swapLock.tryLockForWrite()) return result;
+
+    if (td->data() && td->historical()) {
+        if (m_swappedStore.tryCompressTileData(td)) {
+            unregisterTileDataImp(td);
+            result = true;
+        }
+    }
+    td->m_swapLock.unlock();
+
+    return result;
+}
+
+bool KisTileDataStore::tryCompactSolidTileData(KisTileData *td)
+{
+    // see comment in tryCompressTileData()
+    QReadLocker lock(&m_iteratorLock);
+
+    bool result = false;
+    if (!td->m_swapLock.tryLockForWrite()) return result;
+
+    if (td->data()) {
+        if (m_swappedStore.tryCompactSolidTileData(td)) {
+            unregisterTileDataImp(td);
+            result = true;
+        }
+    }
+    td->m_swapLock.unlock();
+
+    return result;
+}
+
+qint64 KisTileDataStore::spillCompressedTileData(qint64 needToFreeMetric)
+{
+    QReadLocker lock(&m_iteratorLock);
+    return m_swappedStore.spillCompressedTiles(needToFreeMetric);
+}
+
+int KisTileDataStore::collectTileData(int startIndex, int numIndexes,
+                                      std::function<bool(KisTileData*)> filter,
+                                      QVector<KisTileData*> *result)
+{
+    QWriteLocker lock(&m_iteratorLock);
+
+    const int counter = m_counter.loadAcquire();
+    if (startIndex < 1 || startIndex >= counter) {
+        startIndex = 1;
+    }
+
+    const int endIndex = qMin(counter, startIndex + numIndexes);
+
+    for (int i = startIndex; i < endIndex; i++) {
+        KisTileData *td = m_tileDataMap.get(i);
+        if (!td || !filter(td)) continue;
+
+        /**
+         * The last user might have just released the tile data, then
+         * it is waiting for our lock in freeTileData(). Don't resurrect
+         * such objects.
+         */
+        int refCount = 0;
+        do {
+            refCount = td->m_refCount.loadAcquire();
+        } while (refCount > 0 && !td->m_refCount.testAndSetOrdered(refCount, refCount + 1));
+
+        if (refCount > 0) {
+            result->append(td);
+        }
+    }
+
+    return endIndex < counter ? endIndex : 1;
+}
+
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 {
     m_iteratorLock.lockForWrite();
@@ -10,7 +10,10 @@
 
 #include "kritaimage_export.h"
 
+#include <functional>
+
 #include <QReadWriteLock>
+#include <QVector>
 #include "kis_tile_data_interface.h"
 
 #include "kis_tile_data_pooler.h"
@@ -38,6 +41,8 @@ public:
         qint64 totalMemorySize;
         qint64 realMemorySize;
         qint64 historicalMemorySize;
+        qint64 historicalCompressedSize;
+        qint64 historicalSwapSize;
 
         qint64 poolSize;
 
@@ -71,10 +76,13 @@ public:
 
     /**
      * \see m_memoryMetric
+     *
+     * The memory occupied by the tile data objects compressed
+     * in memory is also included into the metric.
      */
     inline qint64 memoryMetric() const
     {
-        return m_memoryMetric.loadAcquire();
+        return m_memoryMetric.loadAcquire() + m_swappedStore.compressedMemoryMetric();
     }
 
     KisTileDataStoreIterator* beginIteration();
@@ -107,6 +115,45 @@ public:
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Try to compress the data of a historical tile data and
+     * keep it in memory. Fails if the tile data is being accessed
+     * at the moment or is not historical anymore.
+     * LOCKING: m_iteratorLock should be *unlocked*
+     */
+    bool tryCompressTileData(KisTileData *td);
+
+    /**
+     * Try to free the memory of a solid tile data, keeping only
+     * one of its pixels. Fails if the tile data is being accessed
+     * at the moment or its pixels are not all equal.
+     * LOCKING: m_iteratorLock should be *unlocked*
+     */
+    bool tryCompactSolidTileData(KisTileData *td);
+
+    /**
+     * Move the tiles compressed by tryCompressTileData() into the
+     * swap file, the oldest ones first, until \p needToFreeMetric
+     * of memory is freed. Returns the metric of the freed memory.
+     */
+    qint64 spillCompressedTileData(qint64 needToFreeMetric);
+
+    /**
+     * Walks through the tile data objects with the tile numbers in
+     * [startIndex, startIndex + numIndexes). The store is locked for
+     * this window only, so the long walks can be split into small
+     * steps. The objects accepted by \p filter are ref'ed and appended
+     * to \p result, the caller should deref() them after use.
+     *
+     * Returns the index to continue the walk from. When the end of the
+     * store is reached, the walk starts from the beginning again.
+     *
+     * LOCKING: m_iteratorLock should be *unlocked*
+     */
+    int collectTileData(int startIndex, int numIndexes,
+                        std::function<bool(KisTileData*)> filter,
+                        QVector<KisTileData*> *result);
+
 
     /**
      * WARN: The following three method are only for usage
@@ -675,6 +675,22 @@ KisRegion KisTiledDataManager::region() const
     return KisRegion(std::move(rects));
 }
 
+void KisTiledDataManager::collectChangedTiles(int writeEpoch, QSet<quint64> *tiles, QVector<QRect> *changedTiles) const
+{
+    KisTileHashTableConstIterator iter(m_hashTable);
+    KisTileSP tile;
+
+    while ((tile = iter.tile())) {
+        tiles->insert(tileKey(tile->col(), tile->row()));
+
+        if (tile->writeEpoch() >= writeEpoch) {
+            *changedTiles << tile->extent();
+        }
+
+        iter.next();
+    }
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
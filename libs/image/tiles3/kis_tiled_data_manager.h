@@ -9,6 +9,7 @@
 
 #include <QtGlobal>
 #include <QVector>
+#include <QSet>
 #include <KisRegion.h>
 
 #include <kis_shared.h>
@@ -216,6 +217,27 @@ public:
 
     KisRegion region() const;
 
+    /**
+     * Walks through all the tiles of the data manager and reports
+     * their positions in \p tiles. The tiles that have been written
+     * to (or created) since \p writeEpoch are additionally reported
+     * in \p changedTiles (\see KisTile::writeEpoch()).
+     *
+     * The position of a tile is encoded with tileKey().
+     */
+    void collectChangedTiles(int writeEpoch, QSet<quint64> *tiles, QVector<QRect> *changedTiles) const;
+
+    static inline quint64 tileKey(qint32 col, qint32 row) {
+        return (quint64(quint32(col)) << 32) | quint32(row);
+    }
+
+    static inline QRect tileRectFromKey(quint64 key) {
+        const qint32 col = qint32(quint32(key >> 32));
+        const qint32 row = qint32(quint32(key & 0xFFFFFFFF));
+        return QRect(col * KisTileData::WIDTH, row * KisTileData::HEIGHT,
+                     KisTileData::WIDTH, KisTileData::HEIGHT);
+    }
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -14,7 +14,11 @@
 //#define COMPRESSOR_VERSION 2
 
 KisSwappedDataStore::KisSwappedDataStore()
-    : m_memoryMetric(0)
+    : m_memoryMetric(0),
+      m_historicalMemoryMetric(0),
+      m_compressedMemorySize(0),
+      m_numCompressedTiles(0),
+      m_numSolidTiles(0)
 {
     KisImageConfig config(true);
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
@@ -40,7 +44,28 @@ quint64 KisSwappedDataStore::numTiles() const
     // We are not acquiring the lock here...
     // Hope QLinkedList will ensure atomic access to it's size...
 
-    return m_allocator->numChunks();
+    return m_allocator->numChunks() +
+        m_numCompressedTiles.loadAcquire() +
+        m_numSolidTiles.loadAcquire();
+}
+
+bool KisSwappedDataStore::writeChunk(KisTileData *td, const quint8 *data, qint32 size)
+{
+    KisChunk chunk = m_allocator->getChunk(size);
+    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
+    if (!ptr) {
+        qWarning() << "swap out of tile failed";
+        m_allocator->freeChunk(chunk);
+        return false;
+    }
+    memcpy(ptr, data, size);
+
+    td->setSwapChunk(chunk);
+    td->m_state = KisTileData::SWAPPED;
+
+    m_memoryMetric += td->pixelSize();
+
+    return true;
 }
 
 bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
@@ -61,22 +86,123 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
     qint32 bytesWritten;
     m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
 
-    KisChunk chunk = m_allocator->getChunk(bytesWritten);
-    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
-    if (!ptr) {
-        qWarning() << "swap out of tile failed";
+    if (!writeChunk(td, (const quint8*) m_buffer.constData(), bytesWritten)) {
         return false;
     }
-    memcpy(ptr, m_buffer.data(), bytesWritten);
+
+    if (td->historical()) {
+        m_historicalTiles.insert(td);
+        m_historicalMemoryMetric += td->pixelSize();
+    }
 
     td->releaseMemory();
-    td->setSwapChunk(chunk);
 
-    m_memoryMetric += td->pixelSize();
+    return true;
+}
+
+bool KisSwappedDataStore::tryCompressTileData(KisTileData *td)
+{
+    Q_ASSERT(td->data());
+    QMutexLocker locker(&m_lock);
+
+    // see comment in trySwapOutTileData()
+
+    const qint32 expectedBufferSize = m_compressor->tileDataBufferSize(td);
+    if(m_buffer.size() < expectedBufferSize)
+        m_buffer.resize(expectedBufferSize);
+
+    qint32 bytesWritten;
+    m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
+
+    CompressedTileData compressedData;
+    compressedData.index = td->m_tileNumber;
+    compressedData.data = QByteArray(m_buffer.constData(), bytesWritten);
+
+    m_compressedTiles.insert(td, compressedData);
+    m_compressedQueue.insert(compressedData.index, td);
+    m_numCompressedTiles.ref();
+    m_compressedMemorySize += bytesWritten;
+
+    td->releaseMemory();
+    td->m_state = KisTileData::COMPRESSED;
 
     return true;
 }
 
+bool KisSwappedDataStore::tryCompactSolidTileData(KisTileData *td)
+{
+    Q_ASSERT(td->data());
+
+    const qint32 pixelSize = td->pixelSize();
+    const qint32 dataSize = KisTileData::WIDTH * KisTileData::HEIGHT * pixelSize;
+    const quint8 *data = td->data();
+
+    /**
+     * If every pixel is equal to the next one, the tile is solid.
+     * For non-solid tiles memcmp() usually stops at the very first
+     * bytes, so the check is cheap enough to be done for every tile.
+     */
+    if (memcmp(data, data + pixelSize, dataSize - pixelSize) != 0) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_lock);
+
+    // see comment in trySwapOutTileData()
+
+    m_solidTiles.insert(td, QByteArray((const char*) data, pixelSize));
+    m_numSolidTiles.ref();
+
+    td->releaseMemory();
+    td->m_state = KisTileData::SOLID;
+
+    return true;
+}
+
+qint64 KisSwappedDataStore::spillCompressedTiles(qint64 needToFreeMetric)
+{
+    QMutexLocker locker(&m_lock);
+
+    const qint64 metricCoeff = qint64(KisTileData::WIDTH) * KisTileData::HEIGHT;
+    const qint64 initialMemorySize = m_compressedMemorySize;
+
+    auto it = m_compressedQueue.begin();
+    while (it != m_compressedQueue.end() &&
+           (initialMemorySize - m_compressedMemorySize) < needToFreeMetric * metricCoeff) {
+
+        KisTileData *td = it.value();
+
+        /**
+         * The tile is being loaded or freed right now,
+         * just skip it.
+         */
+        if (!td->m_swapLock.tryLockForWrite()) {
+            ++it;
+            continue;
+        }
+
+        const CompressedTileData compressedData = m_compressedTiles.value(td);
+        const bool result = writeChunk(td, (const quint8*) compressedData.data.constData(), compressedData.data.size());
+
+        if (result) {
+            m_historicalTiles.insert(td);
+            m_historicalMemoryMetric += td->pixelSize();
+
+            m_compressedTiles.remove(td);
+            m_numCompressedTiles.deref();
+            m_compressedMemorySize -= compressedData.data.size();
+            it = m_compressedQueue.erase(it);
+        }
+
+        td->m_swapLock.unlock();
+
+        // the swap file is full, no reason to continue
+        if (!result) break;
+    }
+
+    return (initialMemorySize - m_compressedMemorySize) / metricCoeff;
+}
+
 void KisSwappedDataStore::swapInTileData(KisTileData *td)
 {
     Q_ASSERT(!td->data());
@@ -84,10 +210,35 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
 
     // see comment in swapOutTileData()
 
+    if (td->m_state == KisTileData::COMPRESSED) {
+        const CompressedTileData compressedData = m_compressedTiles.take(td);
+        m_compressedQueue.remove(compressedData.index);
+        m_numCompressedTiles.deref();
+        m_compressedMemorySize -= compressedData.data.size();
+
+        td->allocateMemory();
+        td->m_state = KisTileData::NORMAL;
+
+        m_compressor->decompressTileData((quint8*) compressedData.data.constData(), compressedData.data.size(), td);
+        return;
+    }
+
+    if (td->m_state == KisTileData::SOLID) {
+        const QByteArray pixel = m_solidTiles.take(td);
+        m_numSolidTiles.deref();
+
+        td->allocateMemory();
+        td->m_state = KisTileData::NORMAL;
+
+        td->fillWithPixel((const quint8*) pixel.constData());
+        return;
+    }
+
     KisChunk chunk = td->swapChunk();
 
     td->allocateMemory();
     td->setSwapChunk(KisChunk());
+    td->m_state = KisTileData::NORMAL;
 
     quint8 *ptr = m_swapSpace->getReadChunkPtr(chunk);
     Q_ASSERT(ptr);
@@ -95,16 +246,43 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
     m_allocator->freeChunk(chunk);
 
     m_memoryMetric -= td->pixelSize();
+
+    if (m_historicalTiles.remove(td)) {
+        m_historicalMemoryMetric -= td->pixelSize();
+    }
 }
 
 void KisSwappedDataStore::forgetTileData(KisTileData *td)
 {
     QMutexLocker locker(&m_lock);
 
+    if (td->m_state == KisTileData::COMPRESSED) {
+        const CompressedTileData compressedData = m_compressedTiles.take(td);
+        m_compressedQueue.remove(compressedData.index);
+        m_numCompressedTiles.deref();
+        m_compressedMemorySize -= compressedData.data.size();
+
+        td->m_state = KisTileData::NORMAL;
+        return;
+    }
+
+    if (td->m_state == KisTileData::SOLID) {
+        m_solidTiles.remove(td);
+        m_numSolidTiles.deref();
+
+        td->m_state = KisTileData::NORMAL;
+        return;
+    }
+
     m_allocator->freeChunk(td->swapChunk());
     td->setSwapChunk(KisChunk());
+    td->m_state = KisTileData::NORMAL;
 
     m_memoryMetric -= td->pixelSize();
+
+    if (m_historicalTiles.remove(td)) {
+        m_historicalMemoryMetric -= td->pixelSize();
+    }
 }
 
 qint64 KisSwappedDataStore::totalMemoryMetric() const
@@ -112,6 +290,22 @@ qint64 KisSwappedDataStore::totalMemoryMetric() const
     return m_memoryMetric;
 }
 
+qint64 KisSwappedDataStore::compressedMemoryMetric() const
+{
+    const qint64 metricCoeff = qint64(KisTileData::WIDTH) * KisTileData::HEIGHT;
+    return (m_compressedMemorySize + metricCoeff - 1) / metricCoeff;
+}
+
+qint64 KisSwappedDataStore::compressedMemorySize() const
+{
+    return m_compressedMemorySize;
+}
+
+qint64 KisSwappedDataStore::historicalMemoryMetric() const
+{
+    return m_historicalMemoryMetric;
+}
+
 void KisSwappedDataStore::debugStatistics()
 {
     m_allocator->sanityCheck();
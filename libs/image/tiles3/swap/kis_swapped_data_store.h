@@ -9,8 +9,12 @@
 
 #include "kritaimage_export.h"
 
+#include <QAtomicInt>
 #include <QMutex>
 #include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QSet>
 
 
 class QMutex;
@@ -26,7 +30,9 @@ public:
     ~KisSwappedDataStore();
 
     /**
-     * Returns number of swapped out tile data objects
+     * Returns number of swapped out tile data objects,
+     * including the ones compressed in memory and the
+     * solid ones
      */
     quint64 numTiles() const;
 
@@ -38,9 +44,40 @@ public:
      */
     bool trySwapOutTileData(KisTileData *td);
 
+    /**
+     * Compress the data stored in the \a td and keep it in memory
+     * (in the COMPRESSED state). The tile data is expected to be a
+     * part of the undo history, so it will be the first candidate
+     * for spilling into the swap file in spillCompressedTiles().
+     * LOCKING: the lock on the tile data should be taken
+     *          by the caller before making a call.
+     */
+    bool tryCompressTileData(KisTileData *td);
+
+    /**
+     * If all the pixels of \a td are equal, free the memory occupied
+     * by td->data() and keep only one pixel (in the SOLID state). The
+     * data is expanded back by swapInTileData() on the next access.
+     * Returns false if the tile data is not solid.
+     * LOCKING: the lock on the tile data should be taken
+     *          by the caller before making a call.
+     */
+    bool tryCompactSolidTileData(KisTileData *td);
+
+    /**
+     * Move the compressed tile data objects into the swap file,
+     * the oldest ones first, until \a needToFreeMetric of memory
+     * is freed. The data is written as is, without recompression.
+     * Returns the metric of the freed memory.
+     * LOCKING: takes the locks of the tile data itself, the tiles
+     *          being accessed at the moment are skipped
+     */
+    qint64 spillCompressedTiles(qint64 needToFreeMetric);
+
     /**
      * Restore the data of a \a td basing on information
-     * stored in the swap file.
+     * stored in the swap file, in the compressed buffer or
+     * in the pixel of a solid tile.
      * LOCKING: the lock on the tile data should be taken
      *          by the caller before making a call.
      */
@@ -59,11 +96,37 @@ public:
      */
     qint64 totalMemoryMetric() const;
 
+    /**
+     * Returns the metric of the memory actually occupied by
+     * the compressed tile data objects
+     */
+    qint64 compressedMemoryMetric() const;
+
+    /**
+     * Returns the size of the compressed tile data objects in bytes
+     */
+    qint64 compressedMemorySize() const;
+
+    /**
+     * Returns the metric of the undo history stored in the
+     * swap file in *uncompressed* form
+     */
+    qint64 historicalMemoryMetric() const;
+
     /**
      * Some debugging output
      */
     void debugStatistics();
 
+private:
+    bool writeChunk(KisTileData *td, const quint8 *data, qint32 size);
+
+private:
+    struct CompressedTileData {
+        int index = -1;
+        QByteArray data;
+    };
+
 private:
     QByteArray m_buffer;
     KisAbstractTileCompressor *m_compressor;
@@ -74,6 +137,29 @@ private:
     QMutex m_lock;
 
     qint64 m_memoryMetric;
+    qint64 m_historicalMemoryMetric;
+    qint64 m_compressedMemorySize;
+
+    /**
+     * The tiles in the COMPRESSED state. The queue is ordered
+     * by the number of the tile data in KisTileDataStore, which
+     * grows monotonically, so the oldest revisions come first.
+     */
+    QHash<KisTileData*, CompressedTileData> m_compressedTiles;
+    QMap<int, KisTileData*> m_compressedQueue;
+    QAtomicInt m_numCompressedTiles;
+
+    /**
+     * The pixels of the tiles in the SOLID state
+     */
+    QHash<KisTileData*, QByteArray> m_solidTiles;
+    QAtomicInt m_numSolidTiles;
+
+    /**
+     * The swapped out tiles that belong to the undo history,
+     * used for statistics only
+     */
+    QSet<KisTileData*> m_historicalTiles;
 };
 
 #endif /* __KIS_SWAPPED_DATA_STORE_H */
@@ -5,12 +5,14 @@
  */
 
 #include <QSemaphore>
+#include <QVector>
 
 #include "tiles3/swap/kis_tile_data_swapper.h"
 #include "tiles3/swap/kis_tile_data_swapper_p.h"
 #include "tiles3/kis_tile_data.h"
 #include "tiles3/kis_tile_data_store.h"
 #include "tiles3/kis_tile_data_store_iterators.h"
+#include "tiles3/kis_memento_manager.h"
 #include "kis_debug.h"
 
 #define SEC 1000
@@ -18,6 +20,19 @@
 const qint32 KisTileDataSwapper::TIMEOUT = -1;
 const qint32 KisTileDataSwapper::DELAY = 0.7 * SEC;
 
+/**
+ * The background passes walk the store in windows of tile numbers,
+ * the store is locked for one window at a time
+ */
+const qint32 KisTileDataSwapper::WALK_WINDOW = 1024;
+const qint32 KisTileDataSwapper::WALK_WINDOWS_PER_JOB = 16;
+
+/**
+ * The number of store walks a tile should stay untouched
+ * for before it is compacted
+ */
+const qint32 KisTileDataSwapper::SOLID_TILE_MIN_AGE = 2;
+
 //#define DEBUG_SWAPPER
 
 #ifdef DEBUG_SWAPPER
@@ -40,6 +55,9 @@ public:
     KisTileDataStore *store;
     KisStoreLimits limits;
     QMutex cycleLock;
+
+    int solidTilesPosition = 1;
+    int historyPosition = 1;
 };
 
 KisTileDataSwapper::KisTileDataSwapper(KisTileDataStore *store)
@@ -113,19 +131,54 @@ void KisTileDataSwapper::doJob()
     DEBUG_VALUE(m_d->limits.softLimitThreshold());
     DEBUG_VALUE(m_d->limits.hardLimitThreshold());
 
+    DEBUG_ACTION("\t history deltas pass");
+    KisMementoManager::convertQueuedDeltas();
+    memoryMetric = m_d->store->memoryMetric();
+    DEBUG_VALUE(memoryMetric);
+
+    if (m_d->limits.compactSolidTiles()) {
+        DEBUG_ACTION("\t solid tiles pass");
+        compactSolidTiles();
+        memoryMetric = m_d->store->memoryMetric();
+        DEBUG_VALUE(memoryMetric);
+    }
 
-    if(memoryMetric > m_d->limits.softLimitThreshold()) {
-        qint32 softFree =  memoryMetric - m_d->limits.softLimit();
-        DEBUG_VALUE(softFree);
-        DEBUG_ACTION("\t pass0");
-        memoryMetric -= pass<SoftSwapStrategy>(softFree);
+    if (m_d->limits.compressHistory()) {
+        DEBUG_ACTION("\t compression pass");
+        compressHistory();
+        memoryMetric = m_d->store->memoryMetric();
         DEBUG_VALUE(memoryMetric);
+    }
+
+    if(memoryMetric > m_d->limits.softLimitThreshold()) {
+        if (m_d->limits.swapHistory()) {
+            qint32 softFree =  memoryMetric - m_d->limits.softLimit();
+            DEBUG_VALUE(softFree);
+            DEBUG_ACTION("\t pass0 (compressed)");
+            const qint64 spilledMetric = m_d->store->spillCompressedTileData(softFree);
+            memoryMetric -= spilledMetric;
+            softFree -= spilledMetric;
+            DEBUG_VALUE(memoryMetric);
+
+            if (softFree > 0) {
+                DEBUG_ACTION("\t pass0");
+                memoryMetric -= pass<SoftSwapStrategy>(softFree);
+                DEBUG_VALUE(memoryMetric);
+            }
+        }
 
         if(memoryMetric > m_d->limits.hardLimitThreshold()) {
             qint32 hardFree =  memoryMetric - m_d->limits.hardLimit();
             DEBUG_VALUE(hardFree);
-            DEBUG_ACTION("\t pass1");
-            memoryMetric -= pass<AggressiveSwapStrategy>(hardFree);
+            DEBUG_ACTION("\t pass1 (compressed)");
+            const qint64 spilledMetric = m_d->store->spillCompressedTileData(hardFree);
+            memoryMetric -= spilledMetric;
+            hardFree -= spilledMetric;
+
+            if (hardFree > 0) {
+                DEBUG_ACTION("\t pass1");
+                memoryMetric -= pass<AggressiveSwapStrategy>(hardFree);
+            }
             DEBUG_VALUE(memoryMetric);
         }
     }
@@ -180,6 +233,78 @@ public:
 };
 
 
+void KisTileDataSwapper::walkStore(int *position,
+                                   std::function<bool(KisTileData*)> filter,
+                                   std::function<void(KisTileData*)> process)
+{
+    /**
+     * The tile data objects are processed outside the store lock,
+     * they are ref'ed to keep them alive meanwhile.
+     */
+    for (int i = 0; i < WALK_WINDOWS_PER_JOB && !m_d->shouldExitFlag; i++) {
+        QVector<KisTileData*> candidates;
+        const int nextPosition = m_d->store->collectTileData(*position, WALK_WINDOW, filter, &candidates);
+
+        Q_FOREACH (KisTileData *item, candidates) {
+            if (!m_d->shouldExitFlag) {
+                process(item);
+            }
+            item->deref();
+        }
+
+        const bool wrappedAround = nextPosition <= *position;
+        *position = nextPosition;
+
+        if (wrappedAround) break;
+    }
+}
+
+void KisTileDataSwapper::compactSolidTiles()
+{
+    /**
+     * Only the history tiles and the tiles that haven't been accessed
+     * for a few walks are compacted. A compacted tile is expanded on
+     * the next access, so compacting the tiles that are actively
+     * painted on (e.g. the ones of the projection) would make them
+     * flip between the two states on every stroke.
+     */
+    walkStore(&m_d->solidTilesPosition,
+        [] (KisTileData *item) {
+            if (item->historical() || item->age() >= SOLID_TILE_MIN_AGE) {
+                return true;
+            }
+
+            item->markOld();
+            return false;
+        },
+        [this] (KisTileData *item) {
+            m_d->store->tryCompactSolidTileData(item);
+        });
+}
+
+void KisTileDataSwapper::compressHistory()
+{
+    /**
+     * The history tiles are compressed when they haven't been
+     * accessed since the previous walk. The walk is split into
+     * steps, so every job checks only a part of the store.
+     */
+    walkStore(&m_d->historyPosition,
+        [] (KisTileData *item) {
+            if (!item->historical()) return false;
+
+            if (item->age() > 0) {
+                return true;
+            }
+
+            item->markOld();
+            return false;
+        },
+        [this] (KisTileData *item) {
+            m_d->store->tryCompressTileData(item);
+        });
+}
+
 template<class strategy>
 qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
 {
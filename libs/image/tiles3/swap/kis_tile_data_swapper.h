@@ -6,6 +6,8 @@
 #ifndef KIS_TILE_DATA_SWAPPER_H_
 #define KIS_TILE_DATA_SWAPPER_H_
 
+#include <functional>
+
 #include <QObject>
 #include <QThread>
 
@@ -35,11 +37,19 @@ private:
     void run() override;
 
     void doJob();
+    void compactSolidTiles();
+    void compressHistory();
+    void walkStore(int *position,
+                   std::function<bool(KisTileData*)> filter,
+                   std::function<void(KisTileData*)> process);
     template<class strategy> qint64 pass(qint64 needToFreeMetric);
 
 private:
     static const qint32 TIMEOUT;
     static const qint32 DELAY;
+    static const qint32 WALK_WINDOW;
+    static const qint32 WALK_WINDOWS_PER_JOB;
+    static const qint32 SOLID_TILE_MIN_AGE;
 
 private:
     struct Private;
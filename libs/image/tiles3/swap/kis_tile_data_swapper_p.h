@@ -32,8 +32,9 @@
   |                        |
   |== softLimitThreshold ==|  <-- the swapper starts swapping
   |........................|      out memento tiles (those, which
-  |........................|      store undo information)
-  |........................|
+  |........................|      store undo information), the
+  |........................|      compressed ones (oldest first) go
+  |........................|      first
   |=====  softLimit  ======|  <-- the swapper stops swapping
   |                        |      out memento tiles
   |                        |
@@ -41,6 +42,12 @@
   |                        |
   +------------------------+  <-- 0 MiB
 
+  Independently of the limits, memento tiles that haven't been
+  accessed for a while are compressed in memory. The compressed
+  data is accounted in the memory metric as well. The memento tiles
+  and the tiles that haven't been accessed for a while are compacted
+  into a single pixel if they are filled with a single color.
+
  */
 
 
@@ -57,6 +64,10 @@ public:
 
         m_softLimitThreshold = qBound(0, MiB_TO_METRIC(config.tilesSoftLimit()), m_hardLimitThreshold);
         m_softLimit = m_softLimitThreshold - m_softLimitThreshold / 8;
+
+        m_compressHistory = config.compressUndoHistory();
+        m_swapHistory = config.swapUndoHistory();
+        m_compactSolidTiles = config.compactSolidTiles();
     }
 
     /**
@@ -83,12 +94,27 @@ public:
         return m_softLimit;
     }
 
+    inline bool compressHistory() {
+        return m_compressHistory;
+    }
+
+    inline bool swapHistory() {
+        return m_swapHistory;
+    }
+
+    inline bool compactSolidTiles() {
+        return m_compactSolidTiles;
+    }
+
 private:
     qint32 m_emergencyThreshold;
     qint32 m_hardLimitThreshold;
     qint32 m_hardLimit;
     qint32 m_softLimitThreshold;
     qint32 m_softLimit;
+    bool m_compressHistory;
+    bool m_swapHistory;
+    bool m_compactSolidTiles;
 };
 
 
@@ -176,5 +176,231 @@ void KisTileDataStoreTest::testSwapping()
     }
 }
 
+void KisTileDataStoreTest::testCompressedHistory()
+{
+    /**
+     * Disable the background compression, we will do it manually
+     */
+    KisImageConfig config(false);
+    config.setCompressUndoHistory(false);
+    config.setSwapUndoHistory(false);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+    store->testingRereadConfig();
+
+    const qint32 pixelSize = 1;
+    const qint32 numTiles = 100;
+    quint8 defaultPixel = 128;
+    KisTiledDataManager dm(pixelSize, &defaultPixel);
+
+    KisMementoSP memento1 = dm.getMemento();
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileSP tile = dm.getTile(col, 0, true);
+        tile->lockForWrite();
+        memset(tile->data(), COLUMN2COLOR(col), TILESIZE);
+        tile->unlockForWrite();
+    }
+    dm.commit();
+
+    QVector<KisTileData*> historicalTiles;
+    for(qint32 col = 0; col < numTiles; col++) {
+        historicalTiles << dm.getTile(col, 0, false)->tileData();
+    }
+
+    KisMementoSP memento2 = dm.getMemento();
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileSP tile = dm.getTile(col, 0, true);
+        tile->lockForWrite();
+        memset(tile->data(), COLUMN2COLOR(col + 1), TILESIZE);
+        tile->unlockForWrite();
+    }
+    dm.commit();
+
+    const qint64 memoryMetric = store->memoryMetric();
+
+    Q_FOREACH (KisTileData *td, historicalTiles) {
+        QVERIFY(td->historical());
+        QVERIFY(store->tryCompressTileData(td));
+        QVERIFY(!td->data());
+    }
+
+    KisTileDataStore::MemoryStatistics stats = store->memoryStatistics();
+    QVERIFY(stats.historicalCompressedSize > 0);
+    QVERIFY(stats.historicalCompressedSize < numTiles * TILESIZE / 4);
+    QCOMPARE(stats.historicalSwapSize, qint64(0));
+    QVERIFY(store->memoryMetric() < memoryMetric);
+
+    store->spillCompressedTileData(memoryMetric);
+
+    stats = store->memoryStatistics();
+    QCOMPARE(stats.historicalCompressedSize, qint64(0));
+    QCOMPARE(stats.historicalSwapSize, qint64(numTiles) * TILESIZE);
+
+    dm.rollback(memento2);
+
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileSP tile = dm.getTile(col, 0, false);
+        tile->lockForRead();
+        QVERIFY(memoryIsFilled(COLUMN2COLOR(col), tile->data(), TILESIZE));
+        tile->unlockForRead();
+    }
+
+    stats = store->memoryStatistics();
+    QCOMPARE(stats.historicalSwapSize, qint64(0));
+
+    config.setCompressUndoHistory(true);
+    config.setSwapUndoHistory(true);
+    store->testingRereadConfig();
+}
+
+void KisTileDataStoreTest::testSolidTiles()
+{
+    /**
+     * Disable the background compaction, we will do it manually
+     */
+    KisImageConfig config(false);
+    config.setCompactSolidTiles(false);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+    store->testingRereadConfig();
+
+    const qint32 pixelSize = 4;
+    const qint32 numTiles = 10;
+    const quint8 defaultPixel[pixelSize] = {0, 0, 0, 0};
+    const quint8 solidPixel[pixelSize] = {1, 2, 3, 4};
+    KisTiledDataManager dm(pixelSize, defaultPixel);
+
+    QVector<KisTileData*> tileDataList;
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileSP tile = dm.getTile(col, 0, true);
+        tile->lockForWrite();
+        quint8 *ptr = tile->data();
+        for (int i = 0; i < TILESIZE; i++, ptr += pixelSize) {
+            memcpy(ptr, solidPixel, pixelSize);
+        }
+
+        // the last tile is not solid
+        if (col == numTiles - 1) {
+            tile->data()[TILESIZE * pixelSize - 1] = 5;
+        }
+        tile->unlockForWrite();
+
+        tileDataList << tile->tileData();
+    }
+
+    const qint32 numTilesTotal = store->numTiles();
+    const qint32 numTilesInMemory = store->numTilesInMemory();
+    const qint64 memoryMetric = store->memoryMetric();
+
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileData *td = tileDataList[col];
+        const bool isSolid = col < numTiles - 1;
+
+        QCOMPARE(store->tryCompactSolidTileData(td), isSolid);
+        QCOMPARE(!td->data(), isSolid);
+    }
+
+    QCOMPARE(store->numTiles(), numTilesTotal);
+    QCOMPARE(store->numTilesInMemory(), numTilesInMemory - (numTiles - 1));
+    QCOMPARE(store->memoryMetric(), memoryMetric - (numTiles - 1) * pixelSize);
+
+    // a locked tile cannot be compacted
+    {
+        KisTileSP tile = dm.getTile(0, 0, false);
+        tile->lockForRead();
+        QVERIFY(!store->tryCompactSolidTileData(tile->tileData()));
+        tile->unlockForRead();
+    }
+
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileSP tile = dm.getTile(col, 0, false);
+        tile->lockForRead();
+
+        const quint8 *ptr = tile->data();
+        for (int i = 0; i < TILESIZE - 1; i++, ptr += pixelSize) {
+            QVERIFY(!memcmp(ptr, solidPixel, pixelSize));
+        }
+        QCOMPARE(ptr[pixelSize - 1], quint8(col < numTiles - 1 ? 4 : 5));
+
+        tile->unlockForRead();
+    }
+
+    QCOMPARE(store->numTiles(), numTilesTotal);
+    QCOMPARE(store->numTilesInMemory(), numTilesInMemory);
+    QCOMPARE(store->memoryMetric(), memoryMetric);
+
+    // the data of a compacted tile can be changed after expansion
+    KisTileData *td = tileDataList[1];
+    QVERIFY(store->tryCompactSolidTileData(td));
+    {
+        KisTileSP tile = dm.getTile(1, 0, true);
+        tile->lockForWrite();
+        tile->data()[0] = 7;
+        tile->unlockForWrite();
+
+        tile->lockForRead();
+        QCOMPARE(tile->data()[0], quint8(7));
+        QVERIFY(!memcmp(tile->data() + pixelSize, solidPixel, pixelSize));
+        tile->unlockForRead();
+    }
+
+    config.setCompactSolidTiles(true);
+    store->testingRereadConfig();
+}
+
+void KisTileDataStoreTest::testCollectTileData()
+{
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+
+    const qint32 pixelSize = 1;
+    quint8 defaultPixel = 128;
+
+    QVector<KisTileData*> tileDataList;
+    for (int i = 0; i < 5; i++) {
+        KisTileData *item = new KisTileData(pixelSize, &defaultPixel, store, false);
+        item->ref();
+        store->registerTileData(item);
+        tileDataList.append(item);
+    }
+
+    auto acceptAll = [] (KisTileData *) { return true; };
+
+    QVector<KisTileData*> result;
+    int position = store->collectTileData(1, 2, acceptAll, &result);
+    QCOMPARE(position, 3);
+    QCOMPARE(result, tileDataList.mid(0, 2));
+
+    position = store->collectTileData(position, 2, acceptAll, &result);
+    QCOMPARE(position, 5);
+    QCOMPARE(result, tileDataList.mid(0, 4));
+
+    // the walk starts from the beginning after the end of the store
+    position = store->collectTileData(position, 2, acceptAll, &result);
+    QCOMPARE(position, 1);
+    QCOMPARE(result, tileDataList);
+
+    // the filter selects the items, the removed ones are skipped
+    QVector<KisTileData*> filteredResult;
+    KisTileData *rejectedItem = tileDataList[1];
+    store->unregisterTileData(tileDataList[3]);
+
+    position = store->collectTileData(1, 10, [rejectedItem] (KisTileData *td) { return td != rejectedItem; }, &filteredResult);
+    QCOMPARE(position, 1);
+    QCOMPARE(filteredResult, QVector<KisTileData*>() << tileDataList[0] << tileDataList[2] << tileDataList[4]);
+
+    store->registerTileData(tileDataList[3]);
+
+    Q_FOREACH (KisTileData *item, result + filteredResult) {
+        item->deref();
+    }
+
+    Q_FOREACH (KisTileData *item, tileDataList) {
+        item->deref();
+    }
+}
+
 SIMPLE_TEST_MAIN(KisTileDataStoreTest)
 
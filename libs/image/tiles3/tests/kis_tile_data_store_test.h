@@ -18,6 +18,9 @@ private Q_SLOTS:
     void testClockIterator();
     void testLeaks();
     void testSwapping();
+    void testCompressedHistory();
+    void testSolidTiles();
+    void testCollectTileData();
 };
 
 #endif /* KIS_TILE_DATA_STORE_TEST_H */
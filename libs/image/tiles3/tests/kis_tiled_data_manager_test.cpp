@@ -8,6 +8,9 @@
 #include <simpletest.h>
 
 #include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "tiles3/KisTileDataDelta.h"
+#include "tiles3/kis_memento_manager.h"
 
 #include "tiles_test_utils.h"
 #include "config-limit-long-tests.h"
@@ -527,6 +530,207 @@ void KisTiledDataManagerTest::testUndoSetDefaultPixel()
     QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
 }
 
+void KisTiledDataManagerTest::testTileDataDelta()
+{
+    const qint32 pixelSize = 4;
+    QByteArray base(TILESIZE * pixelSize, 10);
+    QByteArray data = base;
+
+    // a dab of a few pixels in two rows
+    memset(data.data() + (5 * 64 + 10) * pixelSize, 20, 3 * pixelSize);
+    memset(data.data() + (6 * 64 + 11) * pixelSize, 30, 2 * pixelSize);
+
+    KisTileDataDelta delta;
+    QVERIFY(delta.encode((quint8*)data.constData(), (quint8*)base.constData(), pixelSize));
+    QVERIFY(delta.size() < 64);
+
+    QByteArray result = base;
+    delta.apply((quint8*)result.data());
+    QCOMPARE(result, data);
+
+    // the whole tile has changed, the delta is useless
+    QByteArray otherData(TILESIZE * pixelSize, 11);
+    QVERIFY(!delta.encode((quint8*)otherData.constData(), (quint8*)base.constData(), pixelSize));
+    QVERIFY(delta.isEmpty());
+}
+
+void KisTiledDataManagerTest::testSparseMementos()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    const qint32 numTiles = 10;
+    const QRect rc(0, 0, 64 * numTiles, 64);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    /**
+     * Don't use clear() here, it shares the same tile data
+     * between all the tiles
+     */
+    QByteArray buffer(rc.width() * rc.height(), oddPixel1);
+
+    KisMementoSP memento1 = dm.getMemento();
+    dm.writeBytes((quint8*)buffer.constData(), rc.x(), rc.y(), rc.width(), rc.height());
+    dm.commit();
+
+    const qint32 numTilesBefore = KisTileDataStore::instance()->numTiles();
+
+    KisMementoSP memento2 = dm.getMemento();
+    for (qint32 i = 0; i < numTiles; i++) {
+        dm.writeBytes(&oddPixel2, i * 64 + 7, 7, 1, 1);
+    }
+    dm.commit();
+
+    /**
+     * The conversion is usually done by the swapper thread,
+     * so run it explicitly
+     */
+    KisMementoManager::convertQueuedDeltas();
+
+    /**
+     * The previous revision is stored as deltas now, so
+     * its tile data objects should have been freed
+     */
+    QCOMPARE(KisTileDataStore::instance()->numTiles(), numTilesBefore);
+
+    KisTileSP tile;
+
+    dm.rollback(memento2);
+
+    for (qint32 i = 0; i < numTiles; i++) {
+        tile = dm.getTile(i, 0, false);
+        QVERIFY(memoryIsFilled(oddPixel1, tile->data(), TILESIZE));
+    }
+
+    tile = 0;
+
+    dm.rollforward(memento2);
+
+    for (qint32 i = 0; i < numTiles; i++) {
+        buffer[i * 64 + 7 * rc.width() + 7] = oddPixel2;
+    }
+
+    QByteArray result(buffer.size(), 0);
+    dm.readBytes((quint8*)result.data(), rc.x(), rc.y(), rc.width(), rc.height());
+    QCOMPARE(result, buffer);
+
+    dm.rollback(memento2);
+    dm.rollback(memento1);
+
+    for (qint32 i = 0; i < numTiles; i++) {
+        tile = dm.getTile(i, 0, false);
+        QVERIFY(memoryIsFilled(defaultPixel, tile->data(), TILESIZE));
+    }
+}
+
+void KisTiledDataManagerTest::testSparseMementosAreFreed()
+{
+    const qint32 numTilesBefore = KisTileDataStore::instance()->numTiles();
+
+    {
+        quint8 defaultPixel = 0;
+        KisTiledDataManager dm(1, &defaultPixel);
+
+        const QRect rc(0, 0, 64 * 4, 64);
+        QByteArray buffer(rc.width() * rc.height(), 128);
+
+        KisMementoSP memento1 = dm.getMemento();
+        dm.writeBytes((quint8*)buffer.constData(), rc.x(), rc.y(), rc.width(), rc.height());
+        dm.commit();
+
+        KisMementoSP lastMemento;
+
+        for (int i = 0; i < 3; i++) {
+            lastMemento = dm.getMemento();
+            quint8 pixel = 129 + i;
+            dm.writeBytes(&pixel, 7 + i, 7, 1, 1);
+            dm.commit();
+            KisMementoManager::convertQueuedDeltas();
+        }
+
+        dm.purgeHistory(lastMemento);
+    }
+
+    KisMementoManager::convertQueuedDeltas();
+
+    /**
+     * The delta items link to their base items, which must not keep
+     * the history alive after the device is gone
+     */
+    QCOMPARE(KisTileDataStore::instance()->numTiles(), numTilesBefore);
+}
+
+void KisTiledDataManagerTest::testSparseMementosWithDroppedRedo()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    const qint32 numTiles = 4;
+    const QRect rc(0, 0, 64 * numTiles, 64);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+    quint8 oddPixel3 = 130;
+
+    QByteArray buffer(rc.width() * rc.height(), oddPixel1);
+
+    KisMementoSP memento1 = dm.getMemento();
+    dm.writeBytes((quint8*)buffer.constData(), rc.x(), rc.y(), rc.width(), rc.height());
+    dm.commit();
+
+    KisMementoSP memento2 = dm.getMemento();
+    for (qint32 i = 0; i < numTiles; i++) {
+        dm.writeBytes(&oddPixel2, i * 64 + 7, 7, 1, 1);
+    }
+    dm.commit();
+
+    dm.rollback(memento2);
+
+    /**
+     * The new stroke drops the undone revision from the redo history
+     * before the swapper has a chance to convert the queued deltas
+     */
+    KisMementoSP memento3 = dm.getMemento();
+    for (qint32 i = 0; i < numTiles; i++) {
+        dm.writeBytes(&oddPixel3, i * 64 + 9, 9, 1, 1);
+    }
+    dm.commit();
+
+    memento2 = 0;
+
+    KisMementoManager::convertQueuedDeltas();
+
+    dm.rollback(memento3);
+
+    KisTileSP tile;
+
+    for (qint32 i = 0; i < numTiles; i++) {
+        tile = dm.getTile(i, 0, false);
+        QVERIFY(tile->tileData());
+        QVERIFY(memoryIsFilled(oddPixel1, tile->data(), TILESIZE));
+    }
+
+    dm.rollforward(memento3);
+
+    for (qint32 i = 0; i < numTiles; i++) {
+        buffer[i * 64 + 9 * rc.width() + 9] = oddPixel3;
+    }
+
+    QByteArray result(buffer.size(), 0);
+    dm.readBytes((quint8*)result.data(), rc.x(), rc.y(), rc.width(), rc.height());
+    QCOMPARE(result, buffer);
+
+    dm.rollback(memento3);
+    dm.rollback(memento1);
+
+    for (qint32 i = 0; i < numTiles; i++) {
+        tile = dm.getTile(i, 0, false);
+        QVERIFY(memoryIsFilled(defaultPixel, tile->data(), TILESIZE));
+    }
+}
+
 //#include <valgrind/callgrind.h>
 
 void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
@@ -40,6 +40,10 @@ private Q_SLOTS:
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testTileDataDelta();
+    void testSparseMementos();
+    void testSparseMementosAreFreed();
+    void testSparseMementosWithDroppedRedo();
 
     void benchmarkReadOnlyTileLazy();
     void benchmarkSharedPointers();
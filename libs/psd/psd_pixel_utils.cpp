@@ -7,15 +7,20 @@
 
 #include "psd_pixel_utils.h"
 
+#include <QAtomicPointer>
 #include <QIODevice>
 #include <QMap>
+#include <QtConcurrent>
 #include <QtEndian>
 #include <QtGlobal>
 
+#include <limits>
+
 #include <KoColorSpace.h>
 #include <KoColorSpaceMaths.h>
 #include <KoColorSpaceTraits.h>
 #include <colorspaces/KoAlphaColorSpace.h>
+#include <kis_algebra_2d.h>
 #include <kis_global.h>
 #include <kis_iterator_ng.h>
 
@@ -298,34 +303,201 @@ void readAlphaMaskPixelCommon(int channelSize, const QMap<quint16, QByteArray> &
     }
 }
 
-QMap<quint16, QByteArray> fetchChannelsBytes(QIODevice &io, QVector<ChannelInfo *> channelInfoRecords, int row, int width, int channelSize, bool processMasks)
+/**
+ * Layers are decoded in horizontal bands of 64 rows. The bands are
+ * aligned to the tiles grid, so that no two threads would write into
+ * the same tile, and a band of a single channel always fits into a
+ * QByteArray, even for the widest PSB layers.
+ */
+static const int rowsPerBand = 64;
+
+/**
+ * Approximate amount of band data kept in memory at once, when the
+ * bands are read from the file and passed to the thread pool.
+ */
+static const qint64 bandsBatchMemoryLimit = 64 * 1024 * 1024;
+
+/**
+ * Per-channel data needed for decoding arbitrary bands of the layer
+ */
+struct ChannelLayout {
+    ChannelInfo *info = nullptr;
+    QVector<qint64> rleRowOffsets; // relative to channelDataStart
+    QByteArray plane;              // ZIP channels only
+};
+
+/**
+ * Raw (still compressed) data of a single band, read from the file on
+ * the calling thread, so that the source device is never accessed
+ * concurrently.
+ */
+struct LayerBand {
+    QRect rect;
+    QVector<QByteArray> rawBytes;
+};
+
+/**
+ * Validates the channels and prepares the offsets of the RLE rows. ZIP
+ * streams can only be inflated as a whole, so ZIP channels are decoded
+ * into full planes right here, in parallel.
+ */
+QVector<ChannelLayout> prepareChannels(QIODevice &io, QVector<ChannelInfo *> channelInfoRecords, const QRect &layerRect, int channelSize, bool processMasks)
 {
-    const int uncompressedLength = width * channelSize;
+    const qint64 planeLength = static_cast<qint64>(channelSize) * layerRect.width() * layerRect.height();
 
-    QMap<quint16, QByteArray> channelBytes;
+    QVector<ChannelLayout> channels;
+    QVector<int> zipChannels;
 
     Q_FOREACH (ChannelInfo *channelInfo, channelInfoRecords) {
         // user supplied masks are ignored here
         if (!processMasks && channelInfo->channelId < -1)
             continue;
 
-        io.seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+        ChannelLayout channel;
+        channel.info = channelInfo;
 
         if (channelInfo->compressionType == psd_compression_type::Uncompressed) {
-            channelBytes[channelInfo->channelId] = io.read(uncompressedLength);
-            channelInfo->channelOffset += uncompressedLength;
+            // nothing to prepare
         } else if (channelInfo->compressionType == psd_compression_type::RLE) {
-            int rleLength = channelInfo->rleRowLengths[row];
-            QByteArray compressedBytes = io.read(rleLength);
-            QByteArray uncompressedBytes = Compression::uncompress(uncompressedLength, compressedBytes, channelInfo->compressionType);
-            channelBytes.insert(channelInfo->channelId, uncompressedBytes);
-            channelInfo->channelOffset += rleLength;
+            if (channelInfo->rleRowLengths.size() < layerRect.height()) {
+                QString error = QString("Not enough RLE row lengths for channel: id = %1, rows = %2")
+                                    .arg(channelInfo->channelId)
+                                    .arg(channelInfo->rleRowLengths.size());
+                dbgFile << "ERROR: prepareChannels:" << error;
+                throw KisAslReaderUtils::ASLParseException(error);
+            }
+
+            qint64 totalLength = 0;
+            channel.rleRowOffsets.reserve(layerRect.height() + 1);
+            for (int row = 0; row < layerRect.height(); row++) {
+                channel.rleRowOffsets << totalLength;
+                totalLength += channelInfo->rleRowLengths[row];
+            }
+            channel.rleRowOffsets << totalLength;
+        } else if (channelInfo->compressionType == psd_compression_type::ZIP
+                   || channelInfo->compressionType == psd_compression_type::ZIPWithPrediction) {
+            if (planeLength > std::numeric_limits<int>::max() || channelInfo->channelDataLength > std::numeric_limits<int>::max()) {
+                QString error = QString("ZIP channel is too big: id = %1, size = %2")
+                                    .arg(channelInfo->channelId)
+                                    .arg(planeLength);
+                dbgFile << "ERROR: prepareChannels:" << error;
+                throw KisAslReaderUtils::ASLParseException(error);
+            }
+
+            io.seek(channelInfo->channelDataStart);
+            channel.plane = io.read(channelInfo->channelDataLength);
+            zipChannels << channels.size();
         } else {
             QString error = QString("Unsupported Compression mode: %1")
                                 .arg(static_cast<std::uint16_t>(channelInfo->compressionType));
-            dbgFile << "ERROR: fetchChannelsBytes:" << error;
+            dbgFile << "ERROR: prepareChannels:" << error;
             throw KisAslReaderUtils::ASLParseException(error);
         }
+
+        channels << channel;
+    }
+
+    // exceptions cannot travel across the thread pool, so we just
+    // remember the failed channel and throw afterwards
+    QAtomicPointer<ChannelInfo> failedChannel;
+
+    QtConcurrent::blockingMap(zipChannels, [&](int index) {
+        ChannelLayout &channel = channels[index];
+        channel.plane =
+            Compression::uncompress(static_cast<int>(planeLength), channel.plane, channel.info->compressionType, layerRect.width(), channelSize * 8);
+
+        if (channel.plane.size() != planeLength) {
+            failedChannel.testAndSetOrdered(nullptr, channel.info);
+        }
+    });
+
+    if (ChannelInfo *info = failedChannel.loadAcquire()) {
+        QString error = QString("Failed to unzip channel data: id = %1, compression = %2")
+                            .arg(info->channelId)
+                            .arg(static_cast<std::uint16_t>(info->compressionType));
+        dbgFile << "ERROR:" << error;
+        dbgFile << "      " << ppVar(info->channelId);
+        dbgFile << "      " << ppVar(info->channelDataStart);
+        dbgFile << "      " << ppVar(info->channelDataLength);
+        dbgFile << "      " << ppVar(info->compressionType);
+        throw KisAslReaderUtils::ASLParseException(error);
+    }
+
+    return channels;
+}
+
+void fetchBandRawData(QIODevice &io, const QVector<ChannelLayout> &channels, const QRect &layerRect, int channelSize, LayerBand &band)
+{
+    const qint64 rowLength = static_cast<qint64>(channelSize) * layerRect.width();
+    const int firstRow = band.rect.top() - layerRect.top();
+    const int lastRow = firstRow + band.rect.height();
+
+    band.rawBytes.reserve(channels.size());
+
+    Q_FOREACH (const ChannelLayout &channel, channels) {
+        const ChannelInfo *info = channel.info;
+
+        if (info->compressionType == psd_compression_type::Uncompressed) {
+            io.seek(info->channelDataStart + firstRow * rowLength);
+            band.rawBytes << io.read(band.rect.height() * rowLength);
+        } else if (info->compressionType == psd_compression_type::RLE) {
+            io.seek(info->channelDataStart + channel.rleRowOffsets[firstRow]);
+            band.rawBytes << io.read(channel.rleRowOffsets[lastRow] - channel.rleRowOffsets[firstRow]);
+        } else {
+            band.rawBytes << QByteArray();
+        }
+    }
+}
+
+/**
+ * Decodes the raw data of the band into per-channel planes of the band.
+ * Broken RLE rows and truncated uncompressed data are zero-filled, the
+ * same way as PackBits decoder pads short rows.
+ */
+QMap<quint16, QByteArray> decodeBand(const QVector<ChannelLayout> &channels, const QRect &layerRect, int channelSize, const LayerBand &band)
+{
+    const int rowLength = channelSize * layerRect.width();
+    const int bandLength = rowLength * band.rect.height();
+    const int firstRow = band.rect.top() - layerRect.top();
+
+    QMap<quint16, QByteArray> channelBytes;
+
+    for (int i = 0; i < channels.size(); i++) {
+        const ChannelLayout &channel = channels[i];
+        const ChannelInfo *info = channel.info;
+        const QByteArray &rawBytes = band.rawBytes[i];
+
+        if (info->compressionType == psd_compression_type::Uncompressed) {
+            QByteArray bytes = rawBytes;
+            if (bytes.size() < bandLength) {
+                bytes.append(QByteArray(bandLength - bytes.size(), '\0'));
+            }
+            channelBytes.insert(info->channelId, bytes);
+        } else if (info->compressionType == psd_compression_type::RLE) {
+            QByteArray bytes(bandLength, '\0');
+            const qint64 bandStart = channel.rleRowOffsets[firstRow];
+
+            for (int row = 0; row < band.rect.height(); row++) {
+                const qint64 rowStart = channel.rleRowOffsets[firstRow + row] - bandStart;
+                const qint64 rowEnd = qMin(channel.rleRowOffsets[firstRow + row + 1] - bandStart, static_cast<qint64>(rawBytes.size()));
+
+                if (rowStart >= rowEnd) continue;
+
+                const QByteArray compressedRow = QByteArray::fromRawData(rawBytes.constData() + rowStart, static_cast<int>(rowEnd - rowStart));
+                const QByteArray uncompressedRow = Compression::uncompress(rowLength, compressedRow, info->compressionType);
+
+                if (uncompressedRow.size() == rowLength) {
+                    memcpy(bytes.data() + row * rowLength, uncompressedRow.constData(), rowLength);
+                } else {
+                    dbgFile << "Failed to decode RLE row" << firstRow + row << "of channel" << info->channelId;
+                }
+            }
+
+            channelBytes.insert(info->channelId, bytes);
+        } else {
+            channelBytes.insert(info->channelId,
+                                QByteArray::fromRawData(channel.plane.constData() + static_cast<qint64>(firstRow) * rowLength, bandLength));
+        }
     }
 
     return channelBytes;
@@ -348,53 +520,58 @@ void readCommon(KisPaintDeviceSP dev,
         return;
     }
 
-    if (infoRecords.first()->compressionType == psd_compression_type::ZIP || infoRecords.first()->compressionType == psd_compression_type::ZIPWithPrediction) {
-        const int numPixels = channelSize * layerRect.width() * layerRect.height();
-
-        QMap<quint16, QByteArray> channelBytes;
-
-        Q_FOREACH (ChannelInfo *info, infoRecords) {
-            io.seek(info->channelDataStart);
-            QByteArray compressedBytes = io.read(info->channelDataLength);
-            QByteArray uncompressedBytes;
-
-            uncompressedBytes = Compression::uncompress(numPixels, compressedBytes, infoRecords.first()->compressionType, layerRect.width(), channelSize * 8);
+    const QVector<ChannelLayout> channels = prepareChannels(io, infoRecords, layerRect, channelSize, processMasks);
 
-            if (uncompressedBytes.size() != numPixels) {
-                QString error = QString("Failed to unzip channel data: id = %1, compression = %2")
-                                    .arg(info->channelId)
-                                    .arg(static_cast<std::uint16_t>(info->compressionType));
-                dbgFile << "ERROR:" << error;
-                dbgFile << "      " << ppVar(info->channelId);
-                dbgFile << "      " << ppVar(info->channelDataStart);
-                dbgFile << "      " << ppVar(info->channelDataLength);
-                dbgFile << "      " << ppVar(info->compressionType);
-                throw KisAslReaderUtils::ASLParseException(error);
-            }
-
-            channelBytes.insert(info->channelId, uncompressedBytes);
+    // bands are aligned to the tiles grid, so that no two
+    // threads would write into the same tile
+    QVector<QRect> bandRects;
+    {
+        const int gridOffset = dev->y();
+
+        int y = layerRect.top();
+        while (y <= layerRect.bottom()) {
+            const int nextGridLine = gridOffset + (KisAlgebra2D::divideFloor(y - gridOffset, rowsPerBand) + 1) * rowsPerBand;
+            const int bottom = qMin(nextGridLine - 1, layerRect.bottom());
+            bandRects << QRect(layerRect.left(), y, layerRect.width(), bottom - y + 1);
+            y = bottom + 1;
         }
+    }
 
-        KisSequentialIterator it(dev, layerRect);
-        int col = 0;
-        while (it.nextPixel()) {
-            pixelFunc(channelSize, channelBytes, col, it.rawData());
-            col++;
+    const qint64 bandMemory = static_cast<qint64>(rowsPerBand) * channelSize * layerRect.width() * qMax(1, channels.size());
+    const int bandsPerBatch = static_cast<int>(qBound(qint64(1),
+                                                      bandsBatchMemoryLimit / bandMemory,
+                                                      qint64(2 * qMax(1, QThreadPool::globalInstance()->maxThreadCount()))));
+
+    /**
+     * The file is read sequentially on the calling thread, one batch of
+     * bands at a time, and then decompression and pixel conversion of
+     * the batch are distributed over the global thread pool.
+     */
+    for (int i = 0; i < bandRects.size(); i += bandsPerBatch) {
+        QVector<LayerBand> batch;
+
+        for (int j = i; j < qMin(i + bandsPerBatch, bandRects.size()); j++) {
+            LayerBand band;
+            band.rect = bandRects[j];
+            fetchBandRawData(io, channels, layerRect, channelSize, band);
+            batch << band;
         }
 
-    } else {
-        KisHLineIteratorSP it = dev->createHLineIteratorNG(layerRect.left(), layerRect.top(), layerRect.width());
-        for (int i = 0; i < layerRect.height(); i++) {
-            QMap<quint16, QByteArray> channelBytes;
+        QtConcurrent::blockingMap(batch, [&](const LayerBand &band) {
+            const QMap<quint16, QByteArray> channelBytes = decodeBand(channels, layerRect, channelSize, band);
 
-            channelBytes = fetchChannelsBytes(io, infoRecords, i, layerRect.width(), channelSize, processMasks);
+            KisHLineIteratorSP it = dev->createHLineIteratorNG(band.rect.left(), band.rect.top(), band.rect.width());
 
-            for (int col = 0; col < layerRect.width(); col++) {
-                pixelFunc(channelSize, channelBytes, col, it->rawData());
-                it->nextPixel();
+            int col = 0;
+            for (int row = 0; row < band.rect.height(); row++) {
+                for (int x = 0; x < band.rect.width(); x++) {
+                    pixelFunc(channelSize, channelBytes, col, it->rawData());
+                    it->nextPixel();
+                    col++;
+                }
+                it->nextRow();
             }
-            it->nextRow();
-        }
+        });
     }
 }
 
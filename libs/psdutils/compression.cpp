@@ -11,6 +11,8 @@
 
 #include <QBuffer>
 #include <QtEndian>
+#include <QtGlobal>
+#include <cstring>
 #include <zlib.h>
 
 #include <kis_debug.h>
@@ -94,7 +96,6 @@ int decompress(const QByteArray &input, QByteArray &output, int unpacked_len)
     qint32 n;
     const char *src = input.data();
     char *dst = output.data();
-    char dat;
     int unpack_left = unpacked_len;
     int pack_left = input.size();
     qint32 error_code = 0;
@@ -122,14 +123,11 @@ int decompress(const QByteArray &input, QByteArray &output, int unpacked_len)
                 dbgFile << "Overrun in packbits replicate of" << n - unpack_left << "chars";
                 error_code = 2;
             }
-            dat = *src;
-            for (; n > 0; --n) {
-                if (!unpack_left)
-                    break;
-                *dst = dat;
-                dst++;
-                unpack_left--;
-            }
+            // fill the whole run at once instead of byte-by-byte
+            const int count = qMin(n, unpack_left);
+            memset(dst, *src, static_cast<size_t>(count));
+            dst += count;
+            unpack_left -= count;
             if (unpack_left) {
                 src++;
                 pack_left--;
@@ -137,22 +135,21 @@ int decompress(const QByteArray &input, QByteArray &output, int unpacked_len)
         } else /* copy next n+1 gchars literally */
         {
             n++;
-            for (; n > 0; --n) {
+            const int count = qMin(n, qMin(pack_left, unpack_left));
+            memcpy(dst, src, static_cast<size_t>(count));
+            dst += count;
+            src += count;
+            unpack_left -= count;
+            pack_left -= count;
+
+            if (count < n) {
                 if (!pack_left) {
                     dbgFile << "Input buffer exhausted in copy";
                     error_code = 3;
-                    break;
-                }
-                if (!unpack_left) {
+                } else {
                     dbgFile << "Output buffer exhausted in copy";
                     error_code = 4;
-                    break;
                 }
-                *dst = *src;
-                dst++;
-                unpack_left--;
-                src++;
-                pack_left--;
             }
         }
     }
@@ -298,25 +295,34 @@ QByteArray psd_unzip_with_prediction(const QByteArray &src, int dst_len, int row
     if (dst_buf.size() == 0)
         return dst_buf;
 
+    if (color_depth != 16) {
+        // rows are independent, so keep the running sum in a register
+        // instead of re-reading the previous byte on every step
+        quint8 *buf = reinterpret_cast<quint8 *>(dst_buf.data());
+        const int numRows = row_size > 0 ? dst_buf.size() / row_size : 0;
+
+        for (int row = 0; row < numRows; row++) {
+            quint8 *rowPtr = buf + static_cast<qint64>(row) * row_size;
+            quint8 acc = rowPtr[0];
+            for (int i = 1; i < row_size; i++) {
+                acc += rowPtr[i];
+                rowPtr[i] = acc;
+            }
+        }
+
+        return dst_buf;
+    }
+
     char *buf = dst_buf.data();
     do {
         len = row_size;
-        if (color_depth == 16) {
-            while (--len) {
-                buf[2] += buf[0] + ((buf[1] + buf[3]) >> 8);
-                buf[3] += buf[1];
-                buf += 2;
-            }
+        while (--len) {
+            buf[2] += buf[0] + ((buf[1] + buf[3]) >> 8);
+            buf[3] += buf[1];
             buf += 2;
-            dst_len -= row_size * 2;
-        } else {
-            while (--len) {
-                *(buf + 1) += *buf;
-                buf++;
-            }
-            buf++;
-            dst_len -= row_size;
         }
+        buf += 2;
+        dst_len -= row_size * 2;
     } while (dst_len > 0);
 
     return dst_buf;
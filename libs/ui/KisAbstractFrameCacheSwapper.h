@@ -33,6 +33,13 @@ public:
 
     virtual int frameLevelOfDetail(int frameId) const = 0;
     virtual QRect frameDirtyRect(int frameId) const = 0;
+
+    /**
+     * Returns true if the swapper has exhausted its storage budget. The
+     * already stored frames are still valid, but the cache should not
+     * be populated with new ones.
+     */
+    virtual bool storageLimitReached() const = 0;
 };
 
 #endif // KISABSTRACTFRAMECACHESWAPPER_H
@@ -0,0 +1,227 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAsyncAnimationClonesRegenerator.h"
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QtMath>
+
+#include "kis_image.h"
+#include "kis_image_animation_interface.h"
+#include "kis_image_config.h"
+#include "kis_memory_statistics_server.h"
+#include "kis_signal_auto_connection.h"
+#include "kis_time_span.h"
+
+namespace {
+struct CloneWorker {
+    KisImageSP image;
+    QSharedPointer<KisAsyncAnimationRendererBase> renderer;
+};
+}
+
+struct KisAsyncAnimationClonesRegenerator::Private
+{
+    Private(RendererFactory _factory)
+        : factory(_factory)
+    {
+    }
+
+    RendererFactory factory;
+    int maxClones = 1;
+
+    KisImageWSP sourceImage;
+    KisSignalAutoConnectionsStore sourceImageConnections;
+
+    QVector<CloneWorker> workers;
+    int framesInProgress = 0;
+    bool batchCancelled = false;
+};
+
+KisAsyncAnimationClonesRegenerator::KisAsyncAnimationClonesRegenerator(RendererFactory factory, QObject *parent)
+    : QObject(parent),
+      m_d(new Private(factory))
+{
+}
+
+KisAsyncAnimationClonesRegenerator::~KisAsyncAnimationClonesRegenerator()
+{
+    // the owner is being destroyed, don't notify it about cancellation
+    blockSignals(true);
+    cancel();
+    invalidateClones();
+}
+
+void KisAsyncAnimationClonesRegenerator::setMaxClones(int value)
+{
+    m_d->maxClones = qMax(1, value);
+}
+
+int KisAsyncAnimationClonesRegenerator::maxClones() const
+{
+    return m_d->maxClones;
+}
+
+int KisAsyncAnimationClonesRegenerator::numAllowedClones(KisImageSP image) const
+{
+    return qMin(m_d->maxClones, qMax(1, calculateNumberMemoryAllowedClones(image)));
+}
+
+int KisAsyncAnimationClonesRegenerator::regenerate(KisImageSP image, const QList<int> &frames, RendererInitializer initializer)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!isActive(), 0);
+
+    if (frames.isEmpty()) return 0;
+
+    if (m_d->sourceImage != image) {
+        invalidateClones();
+
+        m_d->sourceImage = image;
+        m_d->sourceImageConnections.clear();
+
+        /**
+         * Any change of the source image makes the clones obsolete.
+         * The frame cache drops the affected frames on the same signal,
+         * so there is no point in finishing the frames of the batch.
+         */
+        m_d->sourceImageConnections.addConnection(
+                    image->animationInterface(), SIGNAL(sigFramesChanged(KisTimeSpan, QRect)),
+                    this, SLOT(slotSourceImageChanged()));
+
+        m_d->sourceImageConnections.addConnection(
+                    image, SIGNAL(sigImageModified()),
+                    this, SLOT(slotSourceImageChanged()));
+    }
+
+    const int numClones = qMin(frames.size(), numAllowedClones(image));
+
+    while (m_d->workers.size() < numClones) {
+        CloneWorker worker;
+        worker.image = image->clone(true);
+        worker.renderer.reset(m_d->factory());
+
+        connect(worker.renderer.data(), SIGNAL(sigFrameCompleted(int)), SLOT(slotFrameCompleted(int)));
+        connect(worker.renderer.data(), SIGNAL(sigFrameCancelled(int, KisAsyncAnimationRendererBase::CancelReason)), SLOT(slotFrameCancelled(int, KisAsyncAnimationRendererBase::CancelReason)));
+
+        m_d->workers.append(worker);
+    }
+
+    const int maxThreads = KisImageConfig(true).maxNumberOfThreads();
+    const int numThreadsPerClone = qMax(1, qCeil(qreal(maxThreads) / numClones));
+
+    m_d->batchCancelled = false;
+    m_d->framesInProgress = numClones;
+
+    for (int i = 0; i < numClones; i++) {
+        CloneWorker &worker = m_d->workers[i];
+        worker.image->setWorkingThreadsLimit(numThreadsPerClone);
+
+        if (initializer) {
+            initializer(worker.renderer.data(), frames[i]);
+        }
+
+        worker.renderer->startFrameRegeneration(worker.image, frames[i], KisAsyncAnimationRendererBase::Cancellable);
+    }
+
+    return numClones;
+}
+
+bool KisAsyncAnimationClonesRegenerator::isActive() const
+{
+    return m_d->framesInProgress > 0;
+}
+
+void KisAsyncAnimationClonesRegenerator::cancel()
+{
+    Q_FOREACH (const CloneWorker &worker, m_d->workers) {
+        if (worker.renderer->isActive()) {
+            worker.renderer->cancelCurrentFrameRendering(KisAsyncAnimationRendererBase::UserCancelled);
+        }
+    }
+}
+
+void KisAsyncAnimationClonesRegenerator::invalidateClones()
+{
+    KIS_SAFE_ASSERT_RECOVER(!isActive()) {
+        cancel();
+    }
+
+    /**
+     * The clones may still be busy with the strokes of cancelled frames,
+     * ask them to stop, so that the destruction of the image didn't wait
+     * for the full regeneration
+     */
+    Q_FOREACH (const CloneWorker &worker, m_d->workers) {
+        worker.image->requestStrokeCancellation();
+    }
+
+    m_d->workers.clear();
+    m_d->sourceImage = 0;
+    m_d->sourceImageConnections.clear();
+}
+
+void KisAsyncAnimationClonesRegenerator::slotFrameCompleted(int frame)
+{
+    emit sigFrameCompleted(frame);
+    finishFrame();
+}
+
+void KisAsyncAnimationClonesRegenerator::slotFrameCancelled(int frame, KisAsyncAnimationRendererBase::CancelReason cancelReason)
+{
+    Q_UNUSED(frame);
+    Q_UNUSED(cancelReason);
+
+    const bool isFirstCancellation = !m_d->batchCancelled;
+    m_d->batchCancelled = true;
+
+    // a single failed frame cancels the entire batch
+    if (isFirstCancellation) {
+        cancel();
+    }
+
+    finishFrame();
+}
+
+void KisAsyncAnimationClonesRegenerator::slotSourceImageChanged()
+{
+    if (isActive()) {
+        cancel();
+    }
+
+    invalidateClones();
+}
+
+void KisAsyncAnimationClonesRegenerator::finishFrame()
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_d->framesInProgress > 0);
+
+    m_d->framesInProgress--;
+
+    if (!m_d->framesInProgress) {
+        if (m_d->batchCancelled) {
+            emit sigBatchCancelled();
+        } else {
+            emit sigBatchCompleted();
+        }
+    }
+}
+
+int KisAsyncAnimationClonesRegenerator::calculateNumberMemoryAllowedClones(KisImageSP image)
+{
+    KisMemoryStatisticsServer::Statistics stats =
+        KisMemoryStatisticsServer::instance()
+        ->fetchMemoryStatistics(image);
+
+    const qint64 allowedMemory = 0.8 * stats.tilesHardLimit - stats.realMemorySize;
+    const qint64 cloneSize = stats.projectionsSize;
+
+    if (cloneSize > 0 && allowedMemory > 0) {
+        return allowedMemory / cloneSize;
+    }
+
+    return 0; // will become 1; either when the cloneSize = 0 or the allowedMemory is 0 or below
+}
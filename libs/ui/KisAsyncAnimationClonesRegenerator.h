@@ -0,0 +1,109 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISASYNCANIMATIONCLONESREGENERATOR_H
+#define KISASYNCANIMATIONCLONESREGENERATOR_H
+
+#include <QObject>
+#include <QScopedPointer>
+
+#include <functional>
+
+#include "kis_types.h"
+#include "kritaui_export.h"
+
+#include <KisAsyncAnimationRendererBase.h>
+
+class KisTimeSpan;
+
+/**
+ * KisAsyncAnimationClonesRegenerator keeps a set of copy-on-write clones
+ * of an image and regenerates several frames at once, one frame per clone.
+ *
+ * The clones are created lazily on the first request and are reused for
+ * the following batches, so the cost of cloning is paid only once after
+ * every change of the source image. As soon as the source image reports
+ * a change, all the clones are dropped and the running batch is cancelled,
+ * because its results would be stale.
+ *
+ * The actual processing of the frames is done by renderers created with
+ * the factory passed to the constructor (e.g. KisAsyncAnimationCacheRenderer
+ * feeding the frame cache).
+ */
+class KRITAUI_EXPORT KisAsyncAnimationClonesRegenerator : public QObject
+{
+    Q_OBJECT
+public:
+    using RendererFactory = std::function<KisAsyncAnimationRendererBase*()>;
+    using RendererInitializer = std::function<void(KisAsyncAnimationRendererBase*, int)>;
+
+public:
+    KisAsyncAnimationClonesRegenerator(RendererFactory factory, QObject *parent = 0);
+    ~KisAsyncAnimationClonesRegenerator() override;
+
+    /**
+     * The maximum number of clones (and, therefore, of frames regenerated
+     * concurrently). The real number can be lower if there is not enough
+     * memory for the clones' projections.
+     */
+    void setMaxClones(int value);
+    int maxClones() const;
+
+    /**
+     * @return the number of clones regenerate() would use for \p image
+     */
+    int numAllowedClones(KisImageSP image) const;
+
+    /**
+     * Starts regeneration of the first numAllowedClones() frames of
+     * \p frames on the clones of \p image. \p initializer is called for
+     * every renderer right before its frame is requested.
+     *
+     * @return the number of frames that have been started
+     */
+    int regenerate(KisImageSP image, const QList<int> &frames, RendererInitializer initializer = RendererInitializer());
+
+    /**
+     * @return true if a batch of frames is in progress
+     */
+    bool isActive() const;
+
+    /**
+     * Cancels the current batch of frames (if any)
+     */
+    void cancel();
+
+    /**
+     * Drops all the clones. They will be recreated from the source
+     * image on the next call to regenerate().
+     */
+    void invalidateClones();
+
+    /**
+     * @return the number of clones that would fit into the memory limit
+     *         in addition to \p image itself
+     */
+    static int calculateNumberMemoryAllowedClones(KisImageSP image);
+
+Q_SIGNALS:
+    void sigFrameCompleted(int frame);
+    void sigBatchCompleted();
+    void sigBatchCancelled();
+
+private Q_SLOTS:
+    void slotFrameCompleted(int frame);
+    void slotFrameCancelled(int frame, KisAsyncAnimationRendererBase::CancelReason cancelReason);
+    void slotSourceImageChanged();
+
+private:
+    void finishFrame();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISASYNCANIMATIONCLONESREGENERATOR_H
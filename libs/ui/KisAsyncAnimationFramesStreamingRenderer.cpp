@@ -0,0 +1,125 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAsyncAnimationFramesStreamingRenderer.h"
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorConversionTransformation.h>
+
+#include "kis_image.h"
+#include "kis_paint_device.h"
+#include "kis_time_span.h"
+#include "animation/KisAnimationFrameStream.h"
+
+
+struct KisAsyncAnimationFramesStreamingRenderer::Private
+{
+    Private(KisImageSP image, const KisTimeSpan &_range, KisAnimationFrameStream *_stream)
+        : range(_range),
+          stream(_stream)
+    {
+        const KoColorSpace *srcColorSpace = image->colorSpace();
+        const KoColorSpace *dstColorSpace = KoColorSpaceRegistry::instance()->rgb8();
+
+        /**
+         * Color converters are not thread-safe, so every renderer
+         * (i.e. every image clone) has its own one.
+         */
+        if (*srcColorSpace != *dstColorSpace) {
+            converter.reset(srcColorSpace->createColorConverter(dstColorSpace,
+                                                                KoColorConversionTransformation::internalRenderingIntent(),
+                                                                KoColorConversionTransformation::internalConversionFlags()));
+        }
+    }
+
+    QByteArray convertFrame(KisPaintDeviceSP projection, const QRect &bounds) const;
+
+    KisTimeSpan range;
+    KisAnimationFrameStream *stream;
+    QScopedPointer<KoColorConversionTransformation> converter;
+};
+
+QByteArray KisAsyncAnimationFramesStreamingRenderer::Private::convertFrame(KisPaintDeviceSP projection, const QRect &bounds) const
+{
+    const int dstPixelSize = KoColorSpaceRegistry::instance()->rgb8()->pixelSize();
+    QByteArray result(bounds.width() * bounds.height() * dstPixelSize, Qt::Uninitialized);
+
+    if (!converter) {
+        projection->readBytes(reinterpret_cast<quint8*>(result.data()), bounds);
+        return result;
+    }
+
+    // convert in stripes to avoid allocating a second full-size buffer
+    const int stripeHeight = 64;
+    const int srcPixelSize = projection->pixelSize();
+    QVector<quint8> buffer(bounds.width() * stripeHeight * srcPixelSize);
+
+    for (int y = bounds.top(); y <= bounds.bottom(); y += stripeHeight) {
+        const QRect stripe(bounds.left(), y, bounds.width(), qMin(stripeHeight, bounds.bottom() - y + 1));
+        const int offset = (y - bounds.top()) * bounds.width() * dstPixelSize;
+
+        projection->readBytes(buffer.data(), stripe);
+        converter->transform(buffer.constData(),
+                             reinterpret_cast<quint8*>(result.data()) + offset,
+                             stripe.width() * stripe.height());
+    }
+
+    return result;
+}
+
+KisAsyncAnimationFramesStreamingRenderer::KisAsyncAnimationFramesStreamingRenderer(KisImageSP image,
+                                                                                   const KisTimeSpan &range,
+                                                                                   KisAnimationFrameStream *stream)
+    : m_d(new Private(image, range, stream))
+{
+    connect(this, SIGNAL(sigCompleteRegenerationInternal(int)), SLOT(notifyFrameCompleted(int)));
+    connect(this, SIGNAL(sigCancelRegenerationInternal(int, KisAsyncAnimationRendererBase::CancelReason)), SLOT(notifyFrameCancelled(int, KisAsyncAnimationRendererBase::CancelReason)));
+}
+
+KisAsyncAnimationFramesStreamingRenderer::~KisAsyncAnimationFramesStreamingRenderer()
+{
+}
+
+void KisAsyncAnimationFramesStreamingRenderer::frameCompletedCallback(int frame, const KisRegion &requestedRegion)
+{
+    KisImageSP image = requestedImage();
+    if (!image) return;
+
+    KIS_SAFE_ASSERT_RECOVER (requestedRegion == image->bounds()) {
+        emit sigCancelRegenerationInternal(frame, KisAsyncAnimationRendererBase::RenderingFailed);
+        return;
+    }
+
+    const QByteArray data = m_d->convertFrame(image->projection(), image->bounds());
+
+    KisTimeSpan identicals = KisTimeSpan::calculateIdenticalFramesRecursive(image->root(), frame);
+    identicals &= m_d->range;
+
+    const int repeatCount = identicals.isValid() ? qMax(1, identicals.end() - frame + 1) : 1;
+
+    /**
+     * This call blocks the image's worker thread while the encoder is
+     * busy with the previous frames, so the amount of frames kept in
+     * memory stays bounded.
+     */
+    if (m_d->stream->pushFrame(frame, data, repeatCount)) {
+        emit sigCompleteRegenerationInternal(frame);
+    } else {
+        emit sigCancelRegenerationInternal(frame, KisAsyncAnimationRendererBase::RenderingFailed);
+    }
+}
+
+void KisAsyncAnimationFramesStreamingRenderer::frameCancelledCallback(int frame, CancelReason cancelReason)
+{
+    /**
+     * Other renderers may be blocked in pushFrame() waiting for the
+     * frame that is being cancelled right now. Wake them up before
+     * the dialog tries to barrier-lock their images.
+     */
+    m_d->stream->cancel();
+    notifyFrameCancelled(frame, cancelReason);
+}
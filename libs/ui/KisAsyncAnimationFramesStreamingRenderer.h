@@ -0,0 +1,45 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
+#define KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
+
+#include <KisAsyncAnimationRendererBase.h>
+
+class KisTimeSpan;
+class KisAnimationFrameStream;
+
+/**
+ * A renderer that converts every regenerated frame into a raw
+ * 8-bit BGRA buffer and pushes it into KisAnimationFrameStream
+ * instead of saving it into a file.
+ *
+ * Frames that are held over several times in the range are converted
+ * only once and pushed into the stream with a repeat count.
+ */
+class KisAsyncAnimationFramesStreamingRenderer : public KisAsyncAnimationRendererBase
+{
+    Q_OBJECT
+public:
+    KisAsyncAnimationFramesStreamingRenderer(KisImageSP image,
+                                             const KisTimeSpan &range,
+                                             KisAnimationFrameStream *stream);
+    ~KisAsyncAnimationFramesStreamingRenderer();
+
+protected:
+    void frameCompletedCallback(int frame, const KisRegion &requestedRegion) override;
+    void frameCancelledCallback(int frame, CancelReason cancelReason) override;
+
+Q_SIGNALS:
+    void sigCompleteRegenerationInternal(int frame);
+    void sigCancelRegenerationInternal(int frame, KisAsyncAnimationRendererBase::CancelReason cancelReason);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
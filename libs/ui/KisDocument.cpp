@@ -1436,7 +1436,13 @@ void KisDocument::slotInitiateAsyncAutosaving(KisDocument *clonedDocument)
 
 void KisDocument::slotPerformIdleRoutines()
 {
-    d->image->explicitRegenerateLevelOfDetail();
+    KisConfig cfg(true);
+
+    if (cfg.backgroundLevelOfDetailSync()) {
+        d->image->requestBackgroundLodSync();
+    } else {
+        d->image->explicitRegenerateLevelOfDetail();
+    }
 
 
     /// TODO: automatic purging is disabled for now: it modifies
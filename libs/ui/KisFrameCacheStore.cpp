@@ -148,6 +148,21 @@ KisFrameCacheStore::~KisFrameCacheStore()
 {
 }
 
+void KisFrameCacheStore::setMemoryLimit(qint64 bytes)
+{
+    m_d->serializer.setMemoryLimit(bytes);
+}
+
+qint64 KisFrameCacheStore::memoryUsage() const
+{
+    return m_d->serializer.memoryUsage();
+}
+
+qint64 KisFrameCacheStore::diskUsage() const
+{
+    return m_d->serializer.diskUsage();
+}
+
 void KisFrameCacheStore::saveFrame(int frameId, KisOpenGLUpdateInfoSP info, const QRect &imageBounds)
 {
     int pixelSize = 0;
@@ -43,6 +43,14 @@ public:
 
     ~KisFrameCacheStore();
 
+    /**
+     * \see KisFrameDataSerializer::setMemoryLimit()
+     */
+    void setMemoryLimit(qint64 bytes);
+
+    qint64 memoryUsage() const;
+    qint64 diskUsage() const;
+
     // WARNING: after transferring \p info to saveFrame() the object becomes invalid
     void saveFrame(int frameId, KisOpenGLUpdateInfoSP info, const QRect &imageBounds);
     KisOpenGLUpdateInfoSP loadFrame(int frameId, const KisOpenGLUpdateInfoBuilder &builder);
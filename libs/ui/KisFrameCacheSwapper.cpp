@@ -20,6 +20,7 @@ struct KisFrameCacheSwapper::Private
 
     KisFrameCacheStore frameStore;
     const KisOpenGLUpdateInfoBuilder &builder;
+    qint64 diskLimit = 0;
 };
 
 KisFrameCacheSwapper::KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder)
@@ -36,6 +37,12 @@ KisFrameCacheSwapper::~KisFrameCacheSwapper()
 {
 }
 
+void KisFrameCacheSwapper::setStorageLimits(qint64 memoryLimit, qint64 diskLimit)
+{
+    m_d->frameStore.setMemoryLimit(memoryLimit);
+    m_d->diskLimit = diskLimit;
+}
+
 void KisFrameCacheSwapper::saveFrame(int frameId, KisOpenGLUpdateInfoSP info, const QRect &imageBounds)
 {
     m_d->frameStore.saveFrame(frameId, info, imageBounds);
@@ -70,3 +77,8 @@ QRect KisFrameCacheSwapper::frameDirtyRect(int frameId) const
 {
     return m_d->frameStore.frameDirtyRect(frameId);
 }
+
+bool KisFrameCacheSwapper::storageLimitReached() const
+{
+    return m_d->diskLimit > 0 && m_d->frameStore.diskUsage() >= m_d->diskLimit;
+}
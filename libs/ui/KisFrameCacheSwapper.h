@@ -32,6 +32,15 @@ public:
     KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder, const QString &frameCachePath);
     ~KisFrameCacheSwapper();
 
+    /**
+     * Sets the storage budget of the swapper. Compressed frames are kept
+     * in RAM until \p memoryLimit bytes are used, then they are spilled
+     * to disk. When \p diskLimit is positive and the frames occupy more
+     * than that on disk, storageLimitReached() starts returning true and
+     * KisAnimationFrameCache evicts the frames until it fits again.
+     */
+    void setStorageLimits(qint64 memoryLimit, qint64 diskLimit);
+
     // WARNING: after transferring \p info to saveFrame() the object becomes invalid
     void saveFrame(int frameId, KisOpenGLUpdateInfoSP info, const QRect &imageBounds) override;
     KisOpenGLUpdateInfoSP loadFrame(int frameId) override;
@@ -45,6 +54,8 @@ public:
 
     QRect frameDirtyRect(int frameId) const override;
 
+    bool storageLimitReached() const override;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
@@ -8,9 +8,11 @@
 #include <cstring>
 
 #include <QTemporaryDir>
-#include <QElapsedTimer>
+#include <QDataStream>
+#include <QHash>
 
 #include "tiles3/swap/kis_lzf_compression.h"
+#include "kis_memory_statistics_server.h"
 
 struct KRITAUI_NO_EXPORT KisFrameDataSerializer::Private
 {
@@ -54,52 +56,54 @@ struct KRITAUI_NO_EXPORT KisFrameDataSerializer::Private
         return reinterpret_cast<quint8*>(compressionBuffer.data());
     }
 
+    void writeFrame(QDataStream &stream, int frameId, const Frame &frame);
+    Frame readFrame(QDataStream &stream, int frameId, KisTextureTileInfoPoolSP pool);
+
     QTemporaryDir framesDir;
     QDir framesDirObject;
     int nextFrameId = 0;
 
     QByteArray compressionBuffer;
-};
 
-KisFrameDataSerializer::KisFrameDataSerializer()
-    : KisFrameDataSerializer(QString())
-{
-}
-
-KisFrameDataSerializer::KisFrameDataSerializer(const QString &frameCachePath)
-    : m_d(new Private(frameCachePath))
-{
-}
+    /**
+     * Serialized frames are kept in memory until the limit is reached,
+     * all the following frames go to disk
+     */
+    qint64 memoryLimit = 0;
+    qint64 memoryUsage = 0;
+    qint64 diskUsage = 0;
+    QHash<int, QByteArray> inMemoryFrames;
+    QHash<int, qint64> onDiskFrameSizes;
+};
 
-KisFrameDataSerializer::~KisFrameDataSerializer()
-{
-}
+namespace {
+enum TileStorageType : quint8 {
+    TileRaw = 0,
+    TileCompressed,
+    TileZero
+};
 
-int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame)
+bool isZeroData(const quint8 *data, int numBytes)
 {
-    KisLzfCompression compression;
+    const int numQWords = numBytes / 8;
+    const quint64 *qwordPtr = reinterpret_cast<const quint64*>(data);
 
-    const int frameId = m_d->generateFrameId();
-
-    const QString frameSubfolder = m_d->subfolderNameForFrame(frameId);
-
-    if (!m_d->framesDirObject.exists(frameSubfolder)) {
-        m_d->framesDirObject.mkpath(frameSubfolder);
+    for (int i = 0; i < numQWords; i++) {
+        if (qwordPtr[i]) return false;
     }
 
-    const QString frameRelativePath = frameSubfolder + '/' + m_d->fileNameForFrame(frameId);
-
-    if (m_d->framesDirObject.exists(frameRelativePath)) {
-        qWarning() << "WARNING: overwriting existing frame file!" << frameRelativePath;
-        forgetFrame(frameId);
+    for (int i = numQWords * 8; i < numBytes; i++) {
+        if (data[i]) return false;
     }
 
-    const QString frameFilePath = m_d->framesDirObject.filePath(frameRelativePath);
+    return true;
+}
+}
 
-    QFile file(frameFilePath);
-    file.open(QFile::WriteOnly);
+void KisFrameDataSerializer::Private::writeFrame(QDataStream &stream, int frameId, const Frame &frame)
+{
+    KisLzfCompression compression;
 
-    QDataStream stream(&file);
     stream << frameId;
     stream << frame.pixelSize;
 
@@ -113,8 +117,18 @@ int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame
         stream << tile.rect;
 
         const int frameByteSize = frame.pixelSize * tile.rect.width() * tile.rect.height();
+
+        /**
+         * Tiles that haven't changed since the keyframe are all zeros
+         * in a difference frame, there is no need to store them at all
+         */
+        if (isZeroData(tile.data.data(), frameByteSize)) {
+            stream << quint8(TileZero);
+            continue;
+        }
+
         const int maxBufferSize = compression.outputBufferSize(frameByteSize);
-        quint8 *buffer = m_d->getCompressionBuffer(maxBufferSize);
+        quint8 *buffer = getCompressionBuffer(maxBufferSize);
 
         const int compressedSize =
             compression.compress(tile.data.data(), frameByteSize, buffer, maxBufferSize);
@@ -122,7 +136,7 @@ int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame
         //ENTER_FUNCTION() << ppVar(compressedSize) << ppVar(frameByteSize);
 
         const bool isCompressed = compressedSize < frameByteSize;
-        stream << isCompressed;
+        stream << quint8(isCompressed ? TileCompressed : TileRaw);
 
         if (isCompressed) {
             stream << compressedSize;
@@ -132,32 +146,15 @@ int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame
             stream.writeRawData((char*)tile.data.data(), frameByteSize);
         }
     }
-
-    file.close();
-
-    return frameId;
 }
 
-KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, KisTextureTileInfoPoolSP pool)
+KisFrameDataSerializer::Frame KisFrameDataSerializer::Private::readFrame(QDataStream &stream, int frameId, KisTextureTileInfoPoolSP pool)
 {
     KisLzfCompression compression;
 
-    QElapsedTimer loadingTime;
-    loadingTime.start();
-
     int loadedFrameId = -1;
     KisFrameDataSerializer::Frame frame;
 
-    qint64 compressionTime = 0;
-
-    const QString framePath = m_d->filePathForFrame(frameId);
-
-    QFile file(framePath);
-    KIS_SAFE_ASSERT_RECOVER_NOOP(file.exists());
-    if (!file.open(QFile::ReadOnly)) return frame;
-
-    QDataStream stream(&file);
-
     int numTiles = 0;
 
     stream >> loadedFrameId;
@@ -177,27 +174,30 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
         KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize <= pool->chunkSize(frame.pixelSize),
                                              KisFrameDataSerializer::Frame());
 
-        bool isCompressed = false;
-        int inputSize = -1;
+        quint8 storageType = TileRaw;
+        stream >> storageType;
+
+        if (storageType == TileZero) {
+            tile.data.allocate(frame.pixelSize);
+            memset(tile.data.data(), 0, frameByteSize);
+
+            frame.frameTiles.push_back(std::move(tile));
+            continue;
+        }
 
-        stream >> isCompressed;
+        int inputSize = -1;
         stream >> inputSize;
 
-        if (isCompressed) {
+        if (storageType == TileCompressed) {
             const int maxBufferSize = compression.outputBufferSize(inputSize);
-            quint8 *buffer = m_d->getCompressionBuffer(maxBufferSize);
+            quint8 *buffer = getCompressionBuffer(maxBufferSize);
             stream.readRawData((char*)buffer, inputSize);
 
             tile.data.allocate(frame.pixelSize);
 
-            QElapsedTimer compTime;
-            compTime.start();
-
             const int decompressedSize =
                 compression.decompress(buffer, inputSize, tile.data.data(), frameByteSize);
 
-            compressionTime += compTime.nsecsElapsed();
-
             KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize == decompressedSize,
                                                  KisFrameDataSerializer::Frame());
 
@@ -212,6 +212,105 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
         frame.frameTiles.push_back(std::move(tile));
     }
 
+    return frame;
+}
+
+KisFrameDataSerializer::KisFrameDataSerializer()
+    : KisFrameDataSerializer(QString())
+{
+}
+
+KisFrameDataSerializer::KisFrameDataSerializer(const QString &frameCachePath)
+    : m_d(new Private(frameCachePath))
+{
+}
+
+KisFrameDataSerializer::~KisFrameDataSerializer()
+{
+    KisMemoryStatisticsServer::instance()->addAnimationCacheMemory(-m_d->memoryUsage);
+}
+
+void KisFrameDataSerializer::setMemoryLimit(qint64 bytes)
+{
+    m_d->memoryLimit = bytes;
+}
+
+qint64 KisFrameDataSerializer::memoryLimit() const
+{
+    return m_d->memoryLimit;
+}
+
+qint64 KisFrameDataSerializer::memoryUsage() const
+{
+    return m_d->memoryUsage;
+}
+
+qint64 KisFrameDataSerializer::diskUsage() const
+{
+    return m_d->diskUsage;
+}
+
+int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame)
+{
+    const int frameId = m_d->generateFrameId();
+
+    QByteArray frameData;
+
+    {
+        QDataStream stream(&frameData, QIODevice::WriteOnly);
+        m_d->writeFrame(stream, frameId, frame);
+    }
+
+    if (m_d->memoryUsage + frameData.size() <= m_d->memoryLimit) {
+        m_d->memoryUsage += frameData.size();
+        m_d->inMemoryFrames.insert(frameId, frameData);
+        KisMemoryStatisticsServer::instance()->addAnimationCacheMemory(frameData.size());
+        return frameId;
+    }
+
+    const QString frameSubfolder = m_d->subfolderNameForFrame(frameId);
+
+    if (!m_d->framesDirObject.exists(frameSubfolder)) {
+        m_d->framesDirObject.mkpath(frameSubfolder);
+    }
+
+    const QString frameRelativePath = frameSubfolder + '/' + m_d->fileNameForFrame(frameId);
+
+    if (m_d->framesDirObject.exists(frameRelativePath)) {
+        qWarning() << "WARNING: overwriting existing frame file!" << frameRelativePath;
+        forgetFrame(frameId);
+    }
+
+    const QString frameFilePath = m_d->framesDirObject.filePath(frameRelativePath);
+
+    QFile file(frameFilePath);
+    file.open(QFile::WriteOnly);
+    file.write(frameData);
+    file.close();
+
+    m_d->diskUsage += frameData.size();
+    m_d->onDiskFrameSizes.insert(frameId, frameData.size());
+
+    return frameId;
+}
+
+KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, KisTextureTileInfoPoolSP pool)
+{
+    auto it = m_d->inMemoryFrames.constFind(frameId);
+    if (it != m_d->inMemoryFrames.constEnd()) {
+        QDataStream stream(*it);
+        return m_d->readFrame(stream, frameId, pool);
+    }
+
+    const QString framePath = m_d->filePathForFrame(frameId);
+
+    QFile file(framePath);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(file.exists());
+    if (!file.open(QFile::ReadOnly)) return KisFrameDataSerializer::Frame();
+
+    QDataStream stream(&file);
+    KisFrameDataSerializer::Frame frame = m_d->readFrame(stream, frameId, pool);
+
     file.close();
 
     return frame;
@@ -219,27 +318,48 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
 
 void KisFrameDataSerializer::moveFrame(int srcFrameId, int dstFrameId)
 {
+    if (m_d->inMemoryFrames.contains(srcFrameId)) {
+        KIS_SAFE_ASSERT_RECOVER(!hasFrame(dstFrameId)) {
+            forgetFrame(dstFrameId);
+        }
+
+        m_d->inMemoryFrames.insert(dstFrameId, m_d->inMemoryFrames.take(srcFrameId));
+        return;
+    }
+
     const QString srcFramePath = m_d->filePathForFrame(srcFrameId);
     const QString dstFramePath = m_d->filePathForFrame(dstFrameId);
     KIS_SAFE_ASSERT_RECOVER_RETURN(QFileInfo(srcFramePath).exists());
 
-    KIS_SAFE_ASSERT_RECOVER(!QFileInfo(dstFramePath).exists()) {
-        QFile::remove(dstFramePath);
+    KIS_SAFE_ASSERT_RECOVER(!hasFrame(dstFrameId)) {
+        forgetFrame(dstFrameId);
     }
 
     QFile::rename(srcFramePath, dstFramePath);
+    m_d->onDiskFrameSizes.insert(dstFrameId, m_d->onDiskFrameSizes.take(srcFrameId));
 }
 
 bool KisFrameDataSerializer::hasFrame(int frameId) const
 {
+    if (m_d->inMemoryFrames.contains(frameId)) return true;
+
     const QString framePath = m_d->filePathForFrame(frameId);
     return QFileInfo(framePath).exists();
 }
 
 void KisFrameDataSerializer::forgetFrame(int frameId)
 {
+    auto it = m_d->inMemoryFrames.find(frameId);
+    if (it != m_d->inMemoryFrames.end()) {
+        m_d->memoryUsage -= it->size();
+        KisMemoryStatisticsServer::instance()->addAnimationCacheMemory(-it->size());
+        m_d->inMemoryFrames.erase(it);
+        return;
+    }
+
     const QString framePath = m_d->filePathForFrame(frameId);
     QFile::remove(framePath);
+    m_d->diskUsage -= m_d->onDiskFrameSizes.take(frameId);
 }
 
 boost::optional<qreal> KisFrameDataSerializer::estimateFrameUniqueness(const KisFrameDataSerializer::Frame &lhs, const KisFrameDataSerializer::Frame &rhs, qreal portion)
@@ -28,6 +28,13 @@ class QString;
  *    but a preprocessed pixel differences)
  *
  * 2) Compress this data and save it on disk
+ *
+ * Tiles consisting of zeros only (which is the case for all the unchanged
+ * tiles of a difference frame) are not stored at all, so a difference
+ * frame costs only as much as the area that actually changed.
+ *
+ * The serialized frames are first kept in RAM until memoryLimit() is
+ * reached, all the following frames are spilled to disk.
  */
 
 class KRITAUI_EXPORT KisFrameDataSerializer
@@ -99,6 +106,24 @@ public:
     KisFrameDataSerializer(const QString &frameCachePath);
     ~KisFrameDataSerializer();
 
+    /**
+     * Sets the amount of memory (in bytes) that can be used for keeping
+     * the compressed frames in RAM. Zero means that all the frames are
+     * stored on disk.
+     */
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+
+    /**
+     * The number of bytes of serialized frame data kept in RAM
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * The number of bytes of serialized frame data kept on disk
+     */
+    qint64 diskUsage() const;
+
     int saveFrame(const Frame &frame);
     Frame loadFrame(int frameId, KisTextureTileInfoPoolSP pool);
 
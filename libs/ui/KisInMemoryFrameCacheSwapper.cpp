@@ -70,3 +70,9 @@ QRect KisInMemoryFrameCacheSwapper::frameDirtyRect(int frameId) const
     KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!m_d->framesMap[frameId].isNull(), QRect());
     return m_d->framesMap[frameId]->dirtyImageRect();
 }
+
+bool KisInMemoryFrameCacheSwapper::storageLimitReached() const
+{
+    // the user has explicitly disabled swapping, so we are not limited
+    return false;
+}
@@ -2064,7 +2064,7 @@ void KisMainWindow::renderAnimation()
     dlgAnimationRenderer.setCaption(i18n("Render Animation"));
     if (dlgAnimationRenderer.exec() == QDialog::Accepted) {
         KisAnimationRenderingOptions encoderOptions = dlgAnimationRenderer.getEncoderOptions();
-        KisAnimationRender::render(doc, viewManager(), encoderOptions);
+        KisAnimationRender::render(doc, viewManager(), encoderOptions, doc->fileBatchMode());
     }
 }
 
@@ -2086,7 +2086,7 @@ void KisMainWindow::renderAnimationAgain()
     KisAnimationRenderingOptions encoderOptions;
     encoderOptions.fromProperties(settings);
 
-    KisAnimationRender::render(doc, viewManager(), encoderOptions);
+    KisAnimationRender::render(doc, viewManager(), encoderOptions, doc->fileBatchMode());
 }
 
 void KisMainWindow::slotConfigureToolbars()
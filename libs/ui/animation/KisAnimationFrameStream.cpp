@@ -0,0 +1,318 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAnimationFrameStream.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <kis_debug.h>
+
+namespace {
+
+struct QueuedFrame {
+    QByteArray data;
+    int repeatCount = 1;
+};
+
+/**
+ * The process lives in the writer thread, so it cannot be killed from
+ * cancel() directly. Instead, the writer never blocks on the process
+ * for longer than this interval and checks the cancellation flag in
+ * between.
+ */
+const int processPollInterval = 100;
+
+}
+
+struct KisAnimationFrameStream::Private
+{
+    Private(const QString &_processPath, const QStringList &_args, int firstFrame, int _maxInFlightFrames)
+        : processPath(_processPath),
+          args(_args),
+          maxInFlightFrames(qMax(1, _maxInFlightFrames)),
+          nextFrame(firstFrame)
+    {
+    }
+
+    void runWriter();
+    bool writeFrame(QProcess &process, const QueuedFrame &frame);
+    bool waitForProcess(QProcess &process, bool waitForFinished);
+    bool isCancelled();
+
+    QString processPath;
+    QStringList args;
+    QString logPath;
+    const int maxInFlightFrames;
+
+    QMutex mutex;
+    QWaitCondition queueChanged;
+    QMap<int, QueuedFrame> pendingFrames;
+    int nextFrame;
+    bool finishing = false;
+    bool cancelled = false;
+    bool failed = false;
+    bool processStarted = false;
+
+    QScopedPointer<QThread> writer;
+};
+
+bool KisAnimationFrameStream::Private::writeFrame(QProcess &process, const QueuedFrame &frame)
+{
+    for (int i = 0; i < frame.repeatCount; i++) {
+        if (process.write(frame.data) != frame.data.size()) {
+            return false;
+        }
+
+        /**
+         * QProcess buffers everything we write, so we should wait
+         * until the pipe is drained, otherwise the bound of the
+         * queue would be meaningless.
+         */
+        while (process.bytesToWrite() > 0) {
+            if (!waitForProcess(process, false)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool KisAnimationFrameStream::Private::waitForProcess(QProcess &process, bool waitForFinished)
+{
+    while (true) {
+        const bool result = waitForFinished ?
+            process.waitForFinished(processPollInterval) :
+            process.waitForBytesWritten(processPollInterval);
+
+        if (result) return true;
+
+        if (process.error() != QProcess::Timedout ||
+            process.state() == QProcess::NotRunning) {
+
+            return false;
+        }
+
+        if (isCancelled()) return false;
+    }
+}
+
+bool KisAnimationFrameStream::Private::isCancelled()
+{
+    QMutexLocker l(&mutex);
+    return cancelled;
+}
+
+void KisAnimationFrameStream::Private::runWriter()
+{
+    QProcess process;
+    process.setStandardOutputFile(QProcess::nullDevice());
+
+    if (!logPath.isEmpty()) {
+        QDir().mkpath(QFileInfo(logPath).dir().path());
+        process.setStandardErrorFile(logPath);
+    } else {
+        process.setStandardErrorFile(QProcess::nullDevice());
+    }
+
+    dbgFile << "starting streaming encoder:" << qUtf8Printable(processPath) << args;
+
+    process.start(processPath, args, QIODevice::WriteOnly);
+
+    if (!process.waitForStarted(-1)) {
+        warnFile << "Failed to start the streaming encoder:" << process.errorString();
+
+        QMutexLocker l(&mutex);
+        failed = true;
+        queueChanged.wakeAll();
+        return;
+    }
+
+    {
+        QMutexLocker l(&mutex);
+        processStarted = true;
+        queueChanged.wakeAll();
+    }
+
+    bool killProcess = false;
+
+    while (true) {
+        QueuedFrame frame;
+
+        {
+            QMutexLocker l(&mutex);
+
+            while (!cancelled &&
+                   !pendingFrames.contains(nextFrame) &&
+                   !finishing) {
+
+                queueChanged.wait(&mutex);
+            }
+
+            if (cancelled) {
+                killProcess = true;
+                break;
+            }
+
+            if (!pendingFrames.contains(nextFrame)) {
+                // finishing: either everything is written or some frame never arrived
+                if (!pendingFrames.isEmpty()) {
+                    warnFile << "Streaming encoder didn't receive frame" << nextFrame;
+                    failed = true;
+                }
+                break;
+            }
+
+            frame = pendingFrames.take(nextFrame);
+            queueChanged.wakeAll();
+        }
+
+        const bool result = writeFrame(process, frame);
+
+        QMutexLocker l(&mutex);
+
+        if (!result) {
+            if (!cancelled) {
+                warnFile << "Failed to write frame" << nextFrame << "into the streaming encoder:" << process.errorString();
+                failed = true;
+            }
+            pendingFrames.clear();
+            queueChanged.wakeAll();
+            killProcess = true;
+            break;
+        }
+
+        nextFrame += frame.repeatCount;
+        queueChanged.wakeAll();
+    }
+
+    if (killProcess) {
+        process.kill();
+        process.waitForFinished(-1);
+        return;
+    }
+
+    process.closeWriteChannel();
+
+    if (!waitForProcess(process, true) && isCancelled()) {
+        process.kill();
+        process.waitForFinished(-1);
+        return;
+    }
+
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        warnFile << "Streaming encoder exited with code" << process.exitCode();
+
+        QMutexLocker l(&mutex);
+        failed = true;
+    }
+}
+
+KisAnimationFrameStream::KisAnimationFrameStream(const QString &processPath, const QStringList &args, int firstFrame, int maxInFlightFrames)
+    : m_d(new Private(processPath, args, firstFrame, maxInFlightFrames))
+{
+}
+
+KisAnimationFrameStream::~KisAnimationFrameStream()
+{
+    if (m_d->writer) {
+        cancel();
+    }
+}
+
+void KisAnimationFrameStream::setLogFile(const QString &path)
+{
+    m_d->logPath = path;
+}
+
+bool KisAnimationFrameStream::start()
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!m_d->writer, false);
+
+    m_d->writer.reset(QThread::create([this] () { m_d->runWriter(); }));
+    m_d->writer->start();
+
+    /**
+     * Wait until the process is either started or failed, so the
+     * caller doesn't have to render any frames for a broken encoder.
+     */
+    QMutexLocker l(&m_d->mutex);
+    while (!m_d->processStarted && !m_d->failed) {
+        m_d->queueChanged.wait(&m_d->mutex);
+    }
+
+    return !m_d->failed;
+}
+
+bool KisAnimationFrameStream::pushFrame(int frame, const QByteArray &data, int repeatCount)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(repeatCount > 0, false);
+
+    QMutexLocker l(&m_d->mutex);
+
+    while (!m_d->cancelled && !m_d->failed &&
+           frame != m_d->nextFrame &&
+           m_d->pendingFrames.size() >= m_d->maxInFlightFrames) {
+
+        m_d->queueChanged.wait(&m_d->mutex);
+    }
+
+    if (m_d->cancelled || m_d->failed) {
+        return false;
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_NOOP(!m_d->pendingFrames.contains(frame));
+
+    QueuedFrame queuedFrame;
+    queuedFrame.data = data;
+    queuedFrame.repeatCount = repeatCount;
+    m_d->pendingFrames.insert(frame, queuedFrame);
+    m_d->queueChanged.wakeAll();
+
+    return true;
+}
+
+KisImportExportErrorCode KisAnimationFrameStream::finish()
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->writer, ImportExportCodes::InternalError);
+
+    {
+        QMutexLocker l(&m_d->mutex);
+        m_d->finishing = true;
+        m_d->queueChanged.wakeAll();
+    }
+
+    m_d->writer->wait();
+    m_d->writer.reset();
+
+    return m_d->failed ? ImportExportCodes::ErrorWhileWriting : ImportExportCodes::OK;
+}
+
+void KisAnimationFrameStream::cancel()
+{
+    {
+        QMutexLocker l(&m_d->mutex);
+        m_d->cancelled = true;
+        m_d->pendingFrames.clear();
+        m_d->queueChanged.wakeAll();
+    }
+
+    if (m_d->writer) {
+        m_d->writer->wait();
+        m_d->writer.reset();
+    }
+}
+
+int KisAnimationFrameStream::maxInFlightFrames() const
+{
+    return m_d->maxInFlightFrames;
+}
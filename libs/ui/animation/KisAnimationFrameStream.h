@@ -0,0 +1,84 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISANIMATIONFRAMESTREAM_H
+#define KISANIMATIONFRAMESTREAM_H
+
+#include <QScopedPointer>
+#include <QStringList>
+
+#include <KisImportExportErrorCode.h>
+
+#include "kritaui_export.h"
+
+/**
+ * KisAnimationFrameStream feeds raw frame buffers into the standard
+ * input of an encoder process (usually ffmpeg with "-f rawvideo -i -").
+ *
+ * Frames may be pushed from any thread and in any order. The stream
+ * writes them to the process strictly in frame order from its own
+ * writer thread. The number of frames waiting in the queue is bounded
+ * by maxInFlightFrames: pushFrame() blocks the calling thread until
+ * the encoder has consumed enough data, unless the pushed frame is the
+ * one the encoder is waiting for. This gives the renderers backpressure
+ * without any chance of a deadlock.
+ *
+ * Usage:
+ *   - start() the process
+ *   - pushFrame() every frame of the range exactly once (held frames
+ *     can be pushed once with a repeat count)
+ *   - finish() to close the input channel and wait for the encoder,
+ *     or cancel() to kill it
+ */
+class KRITAUI_EXPORT KisAnimationFrameStream
+{
+public:
+    KisAnimationFrameStream(const QString &processPath,
+                            const QStringList &args,
+                            int firstFrame,
+                            int maxInFlightFrames = 4);
+    ~KisAnimationFrameStream();
+
+    /**
+     * Redirects stderr of the encoder into \p path. By default the
+     * output of the process is discarded.
+     */
+    void setLogFile(const QString &path);
+
+    /**
+     * Starts the encoder process and the writer thread. Returns false
+     * if the process could not be started.
+     */
+    bool start();
+
+    /**
+     * Queues \p data for \p frame. The buffer is written to the encoder
+     * \p repeatCount times, the next expected frame is then advanced by
+     * the same amount.
+     *
+     * @return false if the stream has been cancelled or the encoder failed
+     */
+    bool pushFrame(int frame, const QByteArray &data, int repeatCount = 1);
+
+    /**
+     * Waits until all queued frames are written, closes the input of the
+     * encoder and waits for it to exit.
+     */
+    KisImportExportErrorCode finish();
+
+    /**
+     * Drops all queued frames and kills the encoder process
+     */
+    void cancel();
+
+    int maxInFlightFrames() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISANIMATIONFRAMESTREAM_H
@@ -17,6 +17,9 @@
 #include "KisAnimationRenderingOptions.h"
 #include "KisMimeDatabase.h"
 #include "dialogs/KisAsyncAnimationFramesSaveDialog.h"
+#include "dialogs/KisAsyncAnimationFramesStreamDialog.h"
+#include "KisAnimationFrameStream.h"
+#include "kis_image_config.h"
 #include "kis_time_span.h"
 #include "KisMainWindow.h"
 
@@ -24,7 +27,7 @@
 
 #include "KisVideoSaver.h"
 
-void KisAnimationRender::render(KisDocument *doc, KisViewManager *viewManager, KisAnimationRenderingOptions encoderOptions) {
+void KisAnimationRender::render(KisDocument *doc, KisViewManager *viewManager, KisAnimationRenderingOptions encoderOptions, bool batchMode) {
     const QString frameMimeType = encoderOptions.frameMimeType;
     const QString framesDirectory = encoderOptions.resolveAbsoluteFramesDirectory();
     const QString extension = KisMimeDatabase::suffixesForMimeType(frameMimeType).first();
@@ -49,7 +52,11 @@ void KisAnimationRender::render(KisDocument *doc, KisViewManager *viewManager, K
         }
     }
 
-    const bool batchMode = false; // TODO: fetch correctly!
+    if (canStreamFrames(encoderOptions)) {
+        renderStreaming(doc, viewManager, encoderOptions, batchMode);
+        return;
+    }
+
     KisAsyncAnimationFramesSaveDialog exporter(doc->image(),
                                                KisTimeSpan::fromTimeToTime(encoderOptions.firstFrame,
                                                                       encoderOptions.lastFrame),
@@ -139,6 +146,57 @@ void KisAnimationRender::render(KisDocument *doc, KisViewManager *viewManager, K
     }
 }
 
+void KisAnimationRender::renderStreaming(KisDocument *doc, KisViewManager *viewManager, const KisAnimationRenderingOptions &encoderOptions, bool batchMode)
+{
+    const QString resultFile = encoderOptions.resolveAbsoluteVideoFilePath();
+    KIS_SAFE_ASSERT_RECOVER_NOOP(QFileInfo(resultFile).isAbsolute());
+
+    {
+        const QFileInfo info(resultFile);
+        QDir dir(info.absolutePath());
+
+        if (!dir.exists()) {
+            dir.mkpath(info.absolutePath());
+        }
+        KIS_SAFE_ASSERT_RECOVER_NOOP(dir.exists());
+    }
+
+    const KisTimeSpan range = KisTimeSpan::fromTimeToTime(encoderOptions.firstFrame, encoderOptions.lastFrame);
+
+    KisAnimationVideoSaver videoSaver(doc, batchMode);
+
+    // let every rendering clone have one frame waiting for the encoder
+    const int maxInFlightFrames = qMax(2, KisImageConfig(true).frameRenderingClones());
+
+    KisAnimationFrameStream stream(encoderOptions.ffmpegPath,
+                                   videoSaver.streamingArgs(encoderOptions),
+                                   range.start(),
+                                   maxInFlightFrames);
+    const QString logPath = QDir::tempPath() + QDir::separator() + "krita" + QDir::separator() + "ffmpeg.log";
+    stream.setLogFile(logPath);
+
+    KisAsyncAnimationFramesStreamDialog exporter(doc->image(), range, &stream);
+    exporter.setBatchMode(batchMode);
+
+    KisAsyncAnimationFramesStreamDialog::Result result =
+        exporter.regenerateRange(viewManager->mainWindow()->viewManager());
+
+    if (result == KisAsyncAnimationFramesStreamDialog::RenderTimedOut) {
+        QMessageBox::critical(qApp->activeWindow(), i18nc("@title:window", "Rendering error"), "Animation frame rendering has timed out. Output files are incomplete.\nTry to increase \"Frame Rendering Timeout\" or reduce \"Frame Rendering Clones Limit\" in Krita settings");
+    } else if (result == KisAsyncAnimationFramesStreamDialog::RenderFailed) {
+        QMessageBox::critical(qApp->activeWindow(), i18nc("@title:window", "Rendering error"), i18n("Failed to encode animation frames! Check ffmpeg log for details:\n%1", logPath));
+    }
+}
+
+bool KisAnimationRender::canStreamFrames(const KisAnimationRenderingOptions &encoderOptions)
+{
+    return encoderOptions.shouldEncodeVideo &&
+        encoderOptions.shouldDeleteSequence &&
+        !encoderOptions.wantsOnlyUniqueFrameSequence &&
+        QFileInfo(encoderOptions.ffmpegPath).exists() &&
+        KisAnimationVideoSaver::supportsStreaming(encoderOptions);
+}
+
 QString KisAnimationRender::getNameForFrame(const QString &basename, const QString &extension, int sequenceStart, int frame)
 {
     QString frameNumberText = QString("%1").arg(frame + sequenceStart, 4, 10, QChar('0'));
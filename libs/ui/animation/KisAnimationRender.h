@@ -16,7 +16,20 @@ class KisViewManager;
 
 namespace KisAnimationRender {
 
-    KRITAUI_EXPORT void render(KisDocument *doc, KisViewManager* viewManager, KisAnimationRenderingOptions encoderOptions);
+    /**
+     * Renders the animation of \p doc. In \p batchMode no dialogs are
+     * shown while saving and encoding.
+     */
+    KRITAUI_EXPORT void render(KisDocument *doc, KisViewManager* viewManager, KisAnimationRenderingOptions encoderOptions, bool batchMode);
+
+    /**
+     * Renders the frames straight into the ffmpeg process without saving
+     * the intermediate image sequence. Only possible when the user doesn't
+     * want to keep the frames, see canStreamFrames().
+     */
+    void renderStreaming(KisDocument *doc, KisViewManager* viewManager, const KisAnimationRenderingOptions &encoderOptions, bool batchMode);
+
+    bool canStreamFrames(const KisAnimationRenderingOptions &encoderOptions);
 
     QString getNameForFrame(const QString &basename, const QString &extension, int sequenceStart, int frame);
 
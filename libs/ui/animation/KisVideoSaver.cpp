@@ -55,21 +55,11 @@ KisImportExportErrorCode KisAnimationVideoSaver::encode(const QString &savedFile
 
     KisImportExportErrorCode resultOuter = ImportExportCodes::OK;
 
-    KisImageAnimationInterface *animation = m_image->animationInterface();
-
     const int sequenceNumberingOffset = options.sequenceStart;
     const KisTimeSpan clipRange = KisTimeSpan::fromTimeToTime(sequenceNumberingOffset + options.firstFrame,
                                                         sequenceNumberingOffset + options.lastFrame);
 
-     // export dimensions could be off a little bit, so the last force option tweaks the pixels for the export to work
-    const QString exportDimensions =
-        QString("scale=w=")
-            .append(QString::number(options.width))
-            .append(":h=")
-            .append(QString::number(options.height))
-            .append(":flags=")
-            .append(options.scaleFilter);
-            //.append(":force_original_aspect_ratio=decrease"); HOTFIX for even:odd dimension images.
+    const QString exportDimensions = scaleFilterArgs(options);
 
     const QString resultFile = options.resolveAbsoluteVideoFilePath();
     const QFileInfo resultFileInfo(resultFile);  
@@ -84,7 +74,6 @@ KisImportExportErrorCode KisAnimationVideoSaver::encode(const QString &savedFile
     {
         
         QStringList paletteArgs;
-        QStringList simpleFilterArgs;
         QStringList complexFilterArgs;
         QStringList args;
         
@@ -153,33 +142,7 @@ KisImportExportErrorCode KisAnimationVideoSaver::encode(const QString &savedFile
             ffmpegWrapper->reset();
         }
         
-        QFileInfo audioFileInfo = animation->audioChannelFileName();
-        if (options.includeAudio && audioFileInfo.exists()) {
-            const int msecStart = clipRange.start() * 1000 / animation->framerate();
-            const int msecDuration = clipRange.duration() * 1000 / animation->framerate();
-
-            const QTime startTime = QTime::fromMSecsSinceStartOfDay(msecStart);
-            const QTime durationTime = QTime::fromMSecsSinceStartOfDay(msecDuration);
-            const QString ffmpegTimeFormat = QStringLiteral("H:m:s.zzz");
-
-            args << "-ss" << QLocale::c().toString(startTime, ffmpegTimeFormat);
-            args << "-t" << QLocale::c().toString(durationTime, ffmpegTimeFormat);
-            args << "-i" << audioFileInfo.absoluteFilePath();
-        }
-      
-        // if we are exporting out at a different image size, we apply scaling filter
-        // export options HAVE to go after input options, so make sure this is after the audio import
-        if (m_image->width() != options.width || m_image->height() != options.height) {
-            simpleFilterArgs << exportDimensions;
-        }
-
-        if ( !complexFilterArgs.isEmpty() ) { 
-            args << "-lavfi" << (!simpleFilterArgs.isEmpty() ? simpleFilterArgs.join(",").append("[0:v];"):"") + complexFilterArgs.join(";");
-        } else if ( !simpleFilterArgs.isEmpty() ) {
-            args << "-vf" << simpleFilterArgs.join(",");
-        }
-        
-        args << additionalOptionsList;
+        appendOutputArgs(args, options, clipRange, complexFilterArgs, additionalOptionsList);
 
         dbgFile << "savedFilesMask" << savedFilesMask 
                 << "start" << QString::number(clipRange.start()) 
@@ -202,6 +165,95 @@ KisImportExportErrorCode KisAnimationVideoSaver::encode(const QString &savedFile
     return resultOuter;
 }
 
+bool KisAnimationVideoSaver::supportsStreaming(const KisAnimationRenderingOptions &options)
+{
+    // gif needs two passes over the frames: one for palettegen and one for paletteuse
+    const QString suffix = QFileInfo(options.resolveAbsoluteVideoFilePath()).suffix().toLower();
+    return suffix != "gif";
+}
+
+QStringList KisAnimationVideoSaver::streamingArgs(const KisAnimationRenderingOptions &options) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(supportsStreaming(options), QStringList());
+
+    const KisTimeSpan clipRange = KisTimeSpan::fromTimeToTime(options.sequenceStart + options.firstFrame,
+                                                              options.sequenceStart + options.lastFrame);
+
+    QStringList additionalOptionsList = options.customFFMpegOptions.split(' ', QString::SkipEmptyParts);
+    QStringList complexFilterArgs;
+
+    const int lavfiOptionsIndex = additionalOptionsList.indexOf("-lavfi");
+    if (lavfiOptionsIndex != -1) {
+        complexFilterArgs << additionalOptionsList.takeAt(lavfiOptionsIndex + 1);
+        additionalOptionsList.removeAt(lavfiOptionsIndex);
+    }
+
+    // the frames are fed by KisAsyncAnimationFramesStreamingRenderer as 8-bit BGRA
+    QStringList args;
+    args << "-hide_banner" << "-y"
+         << "-f" << "rawvideo"
+         << "-pix_fmt" << "bgra"
+         << "-s" << QString("%1x%2").arg(m_image->width()).arg(m_image->height())
+         << "-r" << QString::number(options.frameRate)
+         << "-i" << "-";
+
+    appendOutputArgs(args, options, clipRange, complexFilterArgs, additionalOptionsList);
+
+    args << options.resolveAbsoluteVideoFilePath();
+
+    return args;
+}
+
+QString KisAnimationVideoSaver::scaleFilterArgs(const KisAnimationRenderingOptions &options)
+{
+     // export dimensions could be off a little bit, so the last force option tweaks the pixels for the export to work
+    return QString("scale=w=")
+            .append(QString::number(options.width))
+            .append(":h=")
+            .append(QString::number(options.height))
+            .append(":flags=")
+            .append(options.scaleFilter);
+            //.append(":force_original_aspect_ratio=decrease"); HOTFIX for even:odd dimension images.
+}
+
+void KisAnimationVideoSaver::appendOutputArgs(QStringList &args,
+                                              const KisAnimationRenderingOptions &options,
+                                              const KisTimeSpan &clipRange,
+                                              const QStringList &complexFilterArgs,
+                                              const QStringList &additionalOptionsList) const
+{
+    KisImageAnimationInterface *animation = m_image->animationInterface();
+    QStringList simpleFilterArgs;
+
+    QFileInfo audioFileInfo = animation->audioChannelFileName();
+    if (options.includeAudio && audioFileInfo.exists()) {
+        const int msecStart = clipRange.start() * 1000 / animation->framerate();
+        const int msecDuration = clipRange.duration() * 1000 / animation->framerate();
+
+        const QTime startTime = QTime::fromMSecsSinceStartOfDay(msecStart);
+        const QTime durationTime = QTime::fromMSecsSinceStartOfDay(msecDuration);
+        const QString ffmpegTimeFormat = QStringLiteral("H:m:s.zzz");
+
+        args << "-ss" << QLocale::c().toString(startTime, ffmpegTimeFormat);
+        args << "-t" << QLocale::c().toString(durationTime, ffmpegTimeFormat);
+        args << "-i" << audioFileInfo.absoluteFilePath();
+    }
+
+    // if we are exporting out at a different image size, we apply scaling filter
+    // export options HAVE to go after input options, so make sure this is after the audio import
+    if (m_image->width() != options.width || m_image->height() != options.height) {
+        simpleFilterArgs << scaleFilterArgs(options);
+    }
+
+    if ( !complexFilterArgs.isEmpty() ) {
+        args << "-lavfi" << (!simpleFilterArgs.isEmpty() ? simpleFilterArgs.join(",").append("[0:v];"):"") + complexFilterArgs.join(";");
+    } else if ( !simpleFilterArgs.isEmpty() ) {
+        args << "-vf" << simpleFilterArgs.join(",");
+    }
+
+    args << additionalOptionsList;
+}
+
 KisImportExportErrorCode KisAnimationVideoSaver::convert(KisDocument *document, const QString &savedFilesMask, const KisAnimationRenderingOptions &options, bool batchMode)
 {
     KisAnimationVideoSaver videoSaver(document, batchMode);
@@ -15,6 +15,7 @@
 
 class KisDocument;
 class KisAnimationRenderingOptions;
+class KisTimeSpan;
 
 #include "kritaui_export.h"
 
@@ -49,6 +50,30 @@ public:
 
     static KisImportExportErrorCode convert(KisDocument *document, const QString &savedFilesMask, const KisAnimationRenderingOptions &options, bool batchMode);
 
+    /**
+     * @brief supportsStreaming
+     * @return whether the video can be encoded in a single pass from raw
+     * frames piped into ffmpeg (see KisAnimationFrameStream).
+     */
+    static bool supportsStreaming(const KisAnimationRenderingOptions &options);
+
+    /**
+     * @brief streamingArgs
+     * @return the full list of ffmpeg arguments for encoding 8-bit BGRA
+     * frames of the image size read from stdin into the video file
+     * of \p options.
+     */
+    QStringList streamingArgs(const KisAnimationRenderingOptions &options) const;
+
+private:
+    static QString scaleFilterArgs(const KisAnimationRenderingOptions &options);
+
+    void appendOutputArgs(QStringList &args,
+                          const KisAnimationRenderingOptions &options,
+                          const KisTimeSpan &clipRange,
+                          const QStringList &complexFilterArgs,
+                          const QStringList &additionalOptionsList) const;
+
 private:
     KisImageSP m_image;
     KisDocument* m_doc;
@@ -617,6 +617,8 @@ void KisCanvas2::initializeImage()
 
     connectCurrentCanvas();
     fetchProofingOptions();
+
+    m_d->regionOfInterestUpdateCompressor.start();
 }
 
 void KisCanvas2::disconnectImage()
@@ -633,6 +635,8 @@ void KisCanvas2::disconnectImage()
     image->immediateLockForReadOnly();
     disconnect(image.data(), 0, this, 0);
     image->unlock();
+
+    image->setCanvasViewportRect(this, QRect());
 }
 
 void KisCanvas2::connectCurrentCanvas()
@@ -1103,6 +1107,17 @@ void KisCanvas2::slotUpdateRegionOfInterest()
     if (m_d->regionOfInterest != oldRegionOfInterest) {
         emit sigRegionOfInterestChanged(m_d->regionOfInterest);
     }
+
+    /**
+     * The scheduler should prioritize the updates of the area the user
+     * actually sees, so we pass it without the margin
+     */
+    KisImageSP image = this->image();
+    if (image) {
+        const QRect viewportRect =
+            m_d->coordinatesConverter->widgetRectInImagePixels().toAlignedRect() & imageRect;
+        image->setCanvasViewportRect(this, viewportRect);
+    }
 }
 
 void KisCanvas2::slotReferenceImagesChanged()
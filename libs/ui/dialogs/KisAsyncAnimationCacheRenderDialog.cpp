@@ -86,6 +86,53 @@ int KisAsyncAnimationCacheRenderDialog::calcFirstDirtyFrame(KisAnimationFrameCac
 }
 
 
+QList<int> KisAsyncAnimationCacheRenderDialog::calcDirtyFramesBatch(KisAnimationFrameCacheSP cache, const KisTimeSpan &playbackRange, const KisTimeSpan &skipRange, int maxFrames)
+{
+    QList<int> result;
+
+    KisImageSP image = cache->image();
+    if (!image) return result;
+
+    KisImageAnimationInterface *animation = image->animationInterface();
+    if (!animation->hasAnimation()) return result;
+
+    if (playbackRange.isValid()) {
+        KIS_ASSERT_RECOVER_RETURN_VALUE(!playbackRange.isInfinite(), result);
+
+        for (int frame = playbackRange.start(); frame <= playbackRange.end() && result.size() < maxFrames; frame++) {
+            if (skipRange.contains(frame)) {
+                if (skipRange.isInfinite()) {
+                    break;
+                } else {
+                    frame = skipRange.end();
+                    continue;
+                }
+            }
+
+            const KisTimeSpan stillFrameRange =
+                KisTimeSpan::calculateIdenticalFramesRecursive(image->root(), frame);
+
+            KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(stillFrameRange.isValid(), result);
+
+            if (cache->frameStatus(stillFrameRange.start()) == KisAnimationFrameCache::Uncached &&
+                !skipRange.contains(stillFrameRange.start()) &&
+                !result.contains(stillFrameRange.start())) {
+
+                result.append(stillFrameRange.start());
+            }
+
+            if (stillFrameRange.isInfinite()) {
+                break;
+            } else {
+                frame = qMax(frame, stillFrameRange.end());
+            }
+        }
+    }
+
+    return result;
+}
+
+
 struct KisAsyncAnimationCacheRenderDialog::Private
 {
     Private(KisAnimationFrameCacheSP _cache, const KisTimeSpan &_range)
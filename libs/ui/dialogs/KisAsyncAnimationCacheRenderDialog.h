@@ -19,6 +19,12 @@ public:
 
     static int calcFirstDirtyFrame(KisAnimationFrameCacheSP cache, const KisTimeSpan &playbackRange, const KisTimeSpan &skipRange);
 
+    /**
+     * @return up to \p maxFrames uncached frames of \p playbackRange that
+     *         don't belong to \p skipRange. Held frames are returned once.
+     */
+    static QList<int> calcDirtyFramesBatch(KisAnimationFrameCacheSP cache, const KisTimeSpan &playbackRange, const KisTimeSpan &skipRange, int maxFrames);
+
 protected:
     QList<int> calcDirtyFrames() const override;
     KisAsyncAnimationRendererBase* createRenderer(KisImageSP image) override;
@@ -0,0 +1,88 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAsyncAnimationFramesStreamDialog.h"
+
+#include <kis_image.h>
+#include <kis_time_span.h>
+#include <klocalizedstring.h>
+
+#include <KisAsyncAnimationFramesStreamingRenderer.h>
+#include "animation/KisAnimationFrameStream.h"
+
+
+struct KisAsyncAnimationFramesStreamDialog::Private {
+    Private(KisImageSP _image, const KisTimeSpan &_range, KisAnimationFrameStream *_stream)
+        : originalImage(_image),
+          range(_range),
+          stream(_stream)
+    {
+    }
+
+    KisImageSP originalImage;
+    KisTimeSpan range;
+    KisAnimationFrameStream *stream;
+};
+
+KisAsyncAnimationFramesStreamDialog::KisAsyncAnimationFramesStreamDialog(KisImageSP originalImage,
+                                                                         const KisTimeSpan &range,
+                                                                         KisAnimationFrameStream *stream)
+    : KisAsyncAnimationRenderDialogBase(i18n("Encoding frames..."), originalImage, 0),
+      m_d(new Private(originalImage, range, stream))
+{
+}
+
+KisAsyncAnimationFramesStreamDialog::~KisAsyncAnimationFramesStreamDialog()
+{
+}
+
+KisAsyncAnimationRenderDialogBase::Result KisAsyncAnimationFramesStreamDialog::regenerateRange(KisViewManager *viewManager)
+{
+    if (!m_d->stream->start()) {
+        return RenderFailed;
+    }
+
+    Result result = KisAsyncAnimationRenderDialogBase::regenerateRange(viewManager);
+
+    if (result == RenderComplete) {
+        if (!m_d->stream->finish().isOk()) {
+            result = RenderFailed;
+        }
+    } else {
+        m_d->stream->cancel();
+    }
+
+    return result;
+}
+
+QList<int> KisAsyncAnimationFramesStreamDialog::calcDirtyFrames() const
+{
+    QList<int> result;
+    for (int frame = m_d->range.start(); frame <= m_d->range.end(); frame++) {
+        KisTimeSpan heldFrameTimeRange = KisTimeSpan::calculateIdenticalFramesRecursive(m_d->originalImage->root(), frame);
+
+        // every frame of the range should reach the encoder
+        heldFrameTimeRange &= m_d->range;
+
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(heldFrameTimeRange.isValid(), result);
+
+        result.append(heldFrameTimeRange.start());
+        frame = heldFrameTimeRange.end();
+    }
+    return result;
+}
+
+KisAsyncAnimationRendererBase *KisAsyncAnimationFramesStreamDialog::createRenderer(KisImageSP image)
+{
+    return new KisAsyncAnimationFramesStreamingRenderer(image, m_d->range, m_d->stream);
+}
+
+void KisAsyncAnimationFramesStreamDialog::initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer, KisImageSP image, int frame)
+{
+    Q_UNUSED(renderer);
+    Q_UNUSED(image);
+    Q_UNUSED(frame);
+}
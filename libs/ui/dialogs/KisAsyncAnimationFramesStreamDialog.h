@@ -0,0 +1,47 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISASYNCANIMATIONFRAMESSTREAMDIALOG_H
+#define KISASYNCANIMATIONFRAMESSTREAMDIALOG_H
+
+#include "KisAsyncAnimationRenderDialogBase.h"
+#include "kis_types.h"
+
+class KisAnimationFrameStream;
+
+/**
+ * Renders a range of frames and pipes them into an encoder process
+ * via KisAnimationFrameStream, without saving intermediate files.
+ * Encoding of the already rendered frames overlaps with regeneration
+ * of the next ones.
+ *
+ * The stream must be created for the first frame of \p range. The
+ * dialog starts it in regenerateRange() and finishes (or cancels) it
+ * before returning.
+ */
+class KRITAUI_EXPORT KisAsyncAnimationFramesStreamDialog : public KisAsyncAnimationRenderDialogBase
+{
+public:
+    KisAsyncAnimationFramesStreamDialog(KisImageSP image,
+                                        const KisTimeSpan &range,
+                                        KisAnimationFrameStream *stream);
+
+    ~KisAsyncAnimationFramesStreamDialog();
+
+    Result regenerateRange(KisViewManager *viewManager) override;
+
+protected:
+    QList<int> calcDirtyFrames() const override;
+    KisAsyncAnimationRendererBase* createRenderer(KisImageSP image) override;
+    void initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer,
+                                    KisImageSP image, int frame) override;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISASYNCANIMATIONFRAMESSTREAMDIALOG_H
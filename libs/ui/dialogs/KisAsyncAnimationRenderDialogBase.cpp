@@ -19,10 +19,10 @@
 
 #include "KisViewManager.h"
 #include "KisAsyncAnimationRendererBase.h"
+#include "KisAsyncAnimationClonesRegenerator.h"
 #include "kis_time_span.h"
 #include "kis_image.h"
 #include "kis_image_config.h"
-#include "kis_memory_statistics_server.h"
 #include "kis_signal_compressor.h"
 #include <boost/optional.hpp>
 
@@ -47,22 +47,6 @@ struct RendererPair {
     }
 };
 
-int calculateNumberMemoryAllowedClones(KisImageSP image)
-{
-    KisMemoryStatisticsServer::Statistics stats =
-        KisMemoryStatisticsServer::instance()
-        ->fetchMemoryStatistics(image);
-
-    const qint64 allowedMemory = 0.8 * stats.tilesHardLimit - stats.realMemorySize;
-    const qint64 cloneSize = stats.projectionsSize;
-
-    if (cloneSize > 0 && allowedMemory > 0) {
-        return allowedMemory / cloneSize;
-    }
-
-    return 0; // will become 1; either when the cloneSize = 0 or the allowedMemory is 0 or below
-}
-
 }
 
 
@@ -166,7 +150,7 @@ KisAsyncAnimationRenderDialogBase::regenerateRange(KisViewManager *viewManager)
     KisImageConfig cfg(true);
 
     const int maxThreads = cfg.maxNumberOfThreads();
-    const int numAllowedWorker = 1 + calculateNumberMemoryAllowedClones(m_d->image);
+    const int numAllowedWorker = 1 + KisAsyncAnimationClonesRegenerator::calculateNumberMemoryAllowedClones(m_d->image);
     const int proposedNumWorkers = qMin(m_d->dirtyFramesCount, cfg.frameRenderingClones());
     const int numWorkers = qMin(proposedNumWorkers, numAllowedWorker);
     const int numThreadsPerWorker = qMax(1, qCeil(qreal(maxThreads) / numWorkers));
@@ -30,6 +30,8 @@
 #include "KisMainWindow.h"
 
 #include "KisAsyncAnimationCacheRenderer.h"
+#include "KisAsyncAnimationClonesRegenerator.h"
+#include "kis_image_config.h"
 #include "dialogs/KisAsyncAnimationCacheRenderDialog.h"
 
 
@@ -59,6 +61,12 @@ struct KisAnimationCachePopulator::Private
     KisAsyncAnimationCacheRenderer regenerator;
     bool calculateAnimationCacheInBackground = true;
 
+    /**
+     * Regenerates several frames at once on the clones of the image.
+     * Used when the user allowed more than one frame rendering clone.
+     */
+    KisAsyncAnimationClonesRegenerator clonesRegenerator;
+
 
 
     enum State {
@@ -75,6 +83,7 @@ struct KisAnimationCachePopulator::Private
           idleCounter(0),
           priorityFrames(),
           requestedFrame(-1),
+          clonesRegenerator([] () { return new KisAsyncAnimationCacheRenderer(); }),
           state(WaitingForIdle)
     {
         timer.setSingleShot(true);
@@ -179,9 +188,22 @@ struct KisAnimationCachePopulator::Private
         KisImageSP image = cache->image();
         if (!image) return false;
 
+        // the frames explicitly requested by the user are still generated
+        if (priorityFrame < 0 && cache->storageLimitReached()) return false;
+
         KisImageAnimationInterface *animation = image->animationInterface();
         KisTimeSpan currentRange = animation->fullClipRange();
 
+        if (priorityFrame < 0 && clonesRegenerator.maxClones() > 1) {
+            const QList<int> frames =
+                KisAsyncAnimationCacheRenderDialog::calcDirtyFramesBatch(cache, currentRange, skipRange,
+                                                                         clonesRegenerator.numAllowedClones(image));
+
+            if (frames.size() > 1) {
+                return regenerateBatch(cache, frames);
+            }
+        }
+
         const int frame = priorityFrame >= 0 ? priorityFrame : KisAsyncAnimationCacheRenderDialog::calcFirstDirtyFrame(cache, currentRange, skipRange);
 
         if (frame >= 0) {
@@ -214,6 +236,35 @@ struct KisAnimationCachePopulator::Private
         return true;
     }
 
+    bool regenerateBatch(KisAnimationFrameCacheSP cache, const QList<int> &frames)
+    {
+        if (state == WaitingForFrame) {
+            // Already busy, deny request
+            return false;
+        }
+
+        enterState(WaitingForFrame);
+
+        auto initializer = [cache] (KisAsyncAnimationRendererBase *renderer, int frame) {
+            Q_UNUSED(frame);
+
+            KisAsyncAnimationCacheRenderer *cacheRenderer =
+                dynamic_cast<KisAsyncAnimationCacheRenderer*>(renderer);
+            KIS_SAFE_ASSERT_RECOVER_RETURN(cacheRenderer);
+
+            cacheRenderer->setFrameCache(cache);
+        };
+
+        const int numStartedFrames = clonesRegenerator.regenerate(cache->image(), frames, initializer);
+
+        if (!numStartedFrames) {
+            enterState(NotWaitingForAnything);
+            return false;
+        }
+
+        return true;
+    }
+
     QString debugStateToString(State newState) {
         QString str = "<unknown>";
 
@@ -276,6 +327,9 @@ KisAnimationCachePopulator::KisAnimationCachePopulator(KisPart *part)
     connect(&m_d->regenerator, SIGNAL(sigFrameCancelled(int, KisAsyncAnimationRendererBase::CancelReason)), SLOT(slotRegeneratorFrameCancelled()));
     connect(&m_d->regenerator, SIGNAL(sigFrameCompleted(int)), SLOT(slotRegeneratorFrameReady()));
 
+    connect(&m_d->clonesRegenerator, SIGNAL(sigBatchCancelled()), SLOT(slotRegeneratorFrameCancelled()));
+    connect(&m_d->clonesRegenerator, SIGNAL(sigBatchCompleted()), SLOT(slotRegeneratorFrameReady()));
+
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(slotConfigChanged()));
     slotConfigChanged();
 }
@@ -330,5 +384,12 @@ void KisAnimationCachePopulator::slotConfigChanged()
 {
     KisConfig cfg(true);
     m_d->calculateAnimationCacheInBackground = cfg.calculateAnimationCacheInBackground();
+
+    KisImageConfig imageCfg(true);
+    m_d->clonesRegenerator.setMaxClones(imageCfg.frameRenderingClones());
+
+    if (!m_d->calculateAnimationCacheInBackground && !m_d->clonesRegenerator.isActive()) {
+        m_d->clonesRegenerator.invalidateClones();
+    }
     QTimer::singleShot(1000, this, SLOT(slotRequestRegeneration()));
 }
@@ -27,6 +27,7 @@
 
 #include <kis_algebra_2d.h>
 #include <cmath>
+#include <iterator>
 
 
 struct KisAnimationFrameCache::Private
@@ -46,6 +47,7 @@ struct KisAnimationFrameCache::Private
 
     QScopedPointer<KisAbstractFrameCacheSwapper> swapper;
     int frameSizeLimit = 777;
+    bool framesEvicted = false;
 
     KisOpenGLUpdateInfoSP fetchFrameDataImpl(KisImageSP image, const QRect &requestedRect, int lod);
 
@@ -106,6 +108,32 @@ struct KisAnimationFrameCache::Private
         const int length = range.isInfinite() ? -1 : range.end() - range.start() + 1;
         newFrames.insert(range.start(), length);
         swapper->saveFrame(range.start(), info, image->bounds());
+
+        evictFramesOverLimit(image->animationInterface()->currentUITime());
+    }
+
+    /**
+     * Drops the cached frames farthest from \p time until the swapper
+     * fits into its storage budget again. The frame showing \p time
+     * is never dropped.
+     */
+    void evictFramesOverLimit(int time)
+    {
+        const int currentFrameId = getFrameIdAtTime(time);
+
+        while (swapper->storageLimitReached() && newFrames.size() > 1) {
+            auto first = newFrames.begin();
+            auto last = std::prev(newFrames.end());
+
+            auto victim = qAbs(time - first.key()) > qAbs(last.key() - time) ? first : last;
+            if (victim.key() == currentFrameId) {
+                victim = victim == first ? last : first;
+            }
+
+            swapper->forgetFrame(victim.key());
+            newFrames.erase(victim);
+            framesEvicted = true;
+        }
     }
 
     /**
@@ -159,6 +187,11 @@ struct KisAnimationFrameCache::Private
             it++;
         }
 
+        if (cacheChanged) {
+            // let the populator regenerate the frames around the new changes
+            framesEvicted = false;
+        }
+
         return cacheChanged;
     }
 
@@ -276,11 +309,15 @@ void KisAnimationFrameCache::framesChanged(const KisTimeSpan &range, const QRect
 void KisAnimationFrameCache::slotConfigChanged()
 {
     m_d->newFrames.clear();
+    m_d->framesEvicted = false;
 
     KisImageConfig cfg(true);
 
     if (cfg.useOnDiskAnimationCacheSwapping()) {
-        m_d->swapper.reset(new KisFrameCacheSwapper(m_d->textures->updateInfoBuilder(), cfg.swapDir()));
+        KisFrameCacheSwapper *swapper = new KisFrameCacheSwapper(m_d->textures->updateInfoBuilder(), cfg.swapDir());
+        swapper->setStorageLimits(qint64(cfg.animationCacheMemoryLimit()) * 1024 * 1024,
+                                  qint64(cfg.animationCacheDiskLimit()) * 1024 * 1024);
+        m_d->swapper.reset(swapper);
     } else {
         m_d->swapper.reset(new KisInMemoryFrameCacheSwapper());
     }
@@ -372,6 +409,11 @@ void KisAnimationFrameCache::dropLowQualityFrames(const KisTimeSpan &range, cons
     }
 }
 
+bool KisAnimationFrameCache::storageLimitReached() const
+{
+    return m_d->framesEvicted || m_d->swapper->storageLimitReached();
+}
+
 bool KisAnimationFrameCache::framesHaveValidRoi(const KisTimeSpan &range, const QRect &regionOfInterest)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!range.isInfinite(), false);
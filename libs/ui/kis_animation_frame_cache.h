@@ -63,6 +63,15 @@ public:
 
     bool framesHaveValidRoi(const KisTimeSpan &range, const QRect &regionOfInterest);
 
+    /**
+     * Returns true if the cache has used up its storage budget and no
+     * new frames should be generated in background. It stays true after
+     * some frames have been evicted to fit into the budget, until the
+     * image is changed, so that the populator doesn't regenerate the
+     * evicted frames in a loop.
+     */
+    bool storageLimitReached() const;
+
 Q_SIGNALS:
     void changed();
 
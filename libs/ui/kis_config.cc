@@ -1604,6 +1604,16 @@ void KisConfig::setLevelOfDetailEnabled(bool value)
     m_cfg.writeEntry("levelOfDetailEnabled", value);
 }
 
+bool KisConfig::backgroundLevelOfDetailSync(bool defaultValue) const
+{
+    return (defaultValue ? true : m_cfg.readEntry("backgroundLevelOfDetailSync", true));
+}
+
+void KisConfig::setBackgroundLevelOfDetailSync(bool value)
+{
+    m_cfg.writeEntry("backgroundLevelOfDetailSync", value);
+}
+
 KisOcioConfiguration KisConfig::ocioConfiguration(bool defaultValue) const
 {
     KisOcioConfiguration cfg;
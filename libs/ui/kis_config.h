@@ -412,6 +412,14 @@ public:
     bool levelOfDetailEnabled(bool defaultValue = false) const;
     void setLevelOfDetailEnabled(bool value);
 
+    /**
+     * When enabled, the idle time is used for updating the LoD
+     * pyramids of the image in a cancellable background stroke
+     * instead of a blocking regeneration of the LoD planes
+     */
+    bool backgroundLevelOfDetailSync(bool defaultValue = false) const;
+    void setBackgroundLevelOfDetailSync(bool value);
+
     KisOcioConfiguration ocioConfiguration(bool defaultValue = false) const;
     void setOcioConfiguration(const KisOcioConfiguration &cfg);
 
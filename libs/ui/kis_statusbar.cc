@@ -303,7 +303,24 @@ void KisStatusBar::updateMemoryStatus()
                   format.formatByteSize(stats.historicalMemorySize),
                   format.formatByteSize(stats.swapSize));
 
-    QString longStats = imageStatsMsg + "\n" + memoryStatsMsg;
+    const QString undoStatsMsg =
+            i18nc("tooltip on statusbar memory reporting button (undo stats)",
+                  "Undo data:\n"
+                  "  uncompressed:\t %1\n"
+                  "  compressed:\t %2\n"
+                  "  in swap:\t %3",
+                  format.formatByteSize(stats.historicalMemorySize),
+                  format.formatByteSize(stats.historicalCompressedSize),
+                  format.formatByteSize(stats.historicalSwapSize));
+
+    QString longStats = imageStatsMsg + "\n" + memoryStatsMsg + "\n\n" + undoStatsMsg;
+
+    if (stats.animationCacheSize > 0) {
+        longStats += "\n\n" +
+            i18nc("tooltip on statusbar memory reporting button (animation cache stats)",
+                  "Animation cache in memory:\t %1",
+                  format.formatByteSize(stats.animationCacheSize));
+    }
 
     QString shortStats = format.formatByteSize(stats.imageSize);
     QIcon icon;
@@ -11,9 +11,34 @@
 
 #include "KisProofingConfiguration.h"
 
+#include <functional>
+
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
+#include <QtConcurrent>
+
+#include <KoColorModelStandardIds.h>
+#include <KoOptimizedPixelDataScalerU8ToU16Factory.h>
+
+namespace {
+
+/**
+ * A 16-bit RGB image shown on a display with the same profile
+ * (e.g. sRGB on an uncalibrated monitor) needs only its depth
+ * to be reduced. We can do that with SIMD instead of LCMS.
+ */
+bool canConvertWithScaler(const KoColorSpace *srcCS, const KoColorSpace *dstCS)
+{
+    return srcCS->colorModelId() == RGBAColorModelID &&
+        dstCS->colorModelId() == RGBAColorModelID &&
+        srcCS->colorDepthId() == Integer16BitsColorDepthID &&
+        dstCS->colorDepthId() == Integer8BitsColorDepthID &&
+        srcCS->profile() && dstCS->profile() &&
+        *srcCS->profile() == *dstCS->profile();
+}
+
+}
 
 
 struct KRITAUI_NO_EXPORT KisOpenGLUpdateInfoBuilder::Private
@@ -32,12 +57,22 @@ struct KRITAUI_NO_EXPORT KisOpenGLUpdateInfoBuilder::Private
 
     KisTextureTileInfoPoolSP pool;
     QReadWriteLock lock;
+
+    QScopedPointer<KoOptimizedPixelDataScalerU8ToU16Base> rgbaScaler;
+    bool concurrentBuildEnabled = true;
+
+    /**
+     * Splitting smaller updates into jobs costs more than
+     * the conversion itself
+     */
+    static const int minTilesForConcurrentBuild = 4;
 };
 
 
 KisOpenGLUpdateInfoBuilder::KisOpenGLUpdateInfoBuilder()
     : m_d(new Private)
 {
+    m_d->rgbaScaler.reset(KoOptimizedPixelDataScalerU8ToU16Factory::createRgbaScaler());
 }
 
 KisOpenGLUpdateInfoBuilder::~KisOpenGLUpdateInfoBuilder()
@@ -139,16 +174,6 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
                                                      m_d->pool));
             // Don't update empty tiles
             if (tileInfo->valid()) {
-                tileInfo->retrieveData(projection, channelFlags, m_d->onlyOneChannelSelected, m_d->selectedChannelIndex);
-
-                if (convertColorSpace) {
-                    if (m_d->proofingTransform) {
-                        tileInfo->proofTo(m_d->conversionOptions.m_destinationColorSpace, m_d->proofingConfig->conversionFlags, m_d->proofingTransform.data());
-                    } else {
-                        tileInfo->convertTo(m_d->conversionOptions.m_destinationColorSpace, m_d->conversionOptions.m_renderingIntent, m_d->conversionOptions.m_conversionFlags);
-                    }
-                }
-
                 info->tileList.append(tileInfo);
             }
             else {
@@ -157,6 +182,43 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
         }
     }
 
+    const KoColorSpace *dstColorSpace = m_d->conversionOptions.m_destinationColorSpace;
+    const bool useScaler =
+        convertColorSpace && !m_d->proofingTransform &&
+        channelFlags.isEmpty() &&
+        canConvertWithScaler(projection->colorSpace(), dstColorSpace);
+
+    std::function<void(KisTextureTileUpdateInfoSP)> processTile =
+        [&] (KisTextureTileUpdateInfoSP tileInfo) {
+            tileInfo->retrieveData(projection, channelFlags, m_d->onlyOneChannelSelected, m_d->selectedChannelIndex);
+
+            if (convertColorSpace) {
+                if (useScaler) {
+                    tileInfo->scaleTo(dstColorSpace, m_d->rgbaScaler.data());
+                } else if (m_d->proofingTransform) {
+                    tileInfo->proofTo(dstColorSpace, m_d->proofingConfig->conversionFlags, m_d->proofingTransform.data());
+                } else {
+                    tileInfo->convertTo(dstColorSpace, m_d->conversionOptions.m_renderingIntent, m_d->conversionOptions.m_conversionFlags);
+                }
+            }
+        };
+
+    /**
+     * The tiles are independent from each other, so big updates (e.g.
+     * after applying a filter or undo) are split into per-tile jobs
+     * and processed by the global thread pool. The calling thread
+     * participates in the processing and waits for the rest.
+     */
+    if (m_d->concurrentBuildEnabled &&
+        info->tileList.size() >= Private::minTilesForConcurrentBuild) {
+
+        QtConcurrent::blockingMap(info->tileList, processTile);
+    } else {
+        Q_FOREACH (KisTextureTileUpdateInfoSP tileInfo, info->tileList) {
+            processTile(tileInfo);
+        }
+    }
+
     info->assignDirtyImageRect(rect);
     info->assignLevelOfDetail(levelOfDetail);
     return info;
@@ -219,6 +281,20 @@ void KisOpenGLUpdateInfoBuilder::setChannelFlags(const QBitArray &channelFrags,
     m_d->selectedChannelIndex = selectedChannelIndex;
 }
 
+void KisOpenGLUpdateInfoBuilder::setConcurrentBuildEnabled(bool value)
+{
+    QWriteLocker lock(&m_d->lock);
+
+    m_d->concurrentBuildEnabled = value;
+}
+
+bool KisOpenGLUpdateInfoBuilder::concurrentBuildEnabled() const
+{
+    QReadLocker lock(&m_d->lock);
+
+    return m_d->concurrentBuildEnabled;
+}
+
 void KisOpenGLUpdateInfoBuilder::setTextureBorder(int value)
 {
     QWriteLocker lock(&m_d->lock);
@@ -51,6 +51,15 @@ public:
     void setConversionOptions(const ConversionOptions &options);
     void setChannelFlags(const QBitArray &channelFrags, bool onlyOneChannelSelected, int selectedChannelIndex);
 
+    /**
+     * When enabled (default), big updates are split into per-tile
+     * jobs that read and convert the projection concurrently. The
+     * builder doesn't need an OpenGL context, so update infos can be
+     * built (and tested) headlessly.
+     */
+    void setConcurrentBuildEnabled(bool value);
+    bool concurrentBuildEnabled() const;
+
     void setTextureBorder(int value);
     void setEffectiveTextureSize(const QSize &size);
 
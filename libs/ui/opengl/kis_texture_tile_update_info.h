@@ -18,6 +18,7 @@
 #include <KoColorConversionTransformation.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColorSpace.h>
+#include <KoOptimizedPixelDataScalerU8ToU16Base.h>
 #include <kis_lod_transform.h>
 
 class KisTextureTileUpdateInfo;
@@ -199,6 +200,29 @@ public:
         }
     }
 
+    /**
+     * Converts the patch from a 16-bit integer color space into its
+     * 8-bit integer counterpart with the same profile. \p scaler does
+     * the depth conversion with SIMD instructions, which is much faster
+     * than a generic conversion going through LCMS.
+     */
+    void scaleTo(const KoColorSpace* dstCS,
+                 const KoOptimizedPixelDataScalerU8ToU16Base *scaler)
+    {
+        if (m_patchRect.isValid()) {
+            const int srcRowStride = m_patchRect.width() * m_patchColorSpace->pixelSize();
+            const int dstRowStride = m_patchRect.width() * dstCS->pixelSize();
+            DataBuffer conversionCache(dstCS->pixelSize(), m_pool);
+
+            scaler->convertU16ToU8(m_patchPixels.data(), srcRowStride,
+                                   conversionCache.data(), dstRowStride,
+                                   m_patchRect.height(), m_patchRect.width());
+
+            m_patchColorSpace = dstCS;
+            conversionCache.swap(m_patchPixels);
+        }
+    }
+
     void proofTo(const KoColorSpace* dstCS,
                    KoColorConversionTransformation::ConversionFlags conversionFlags,
                    KoColorConversionTransformation *proofingTransform)
@@ -207,4 +207,66 @@ void KisFrameSerializerTest::testFrameArithmetics()
     }
 }
 
+void KisFrameSerializerTest::testMemoryLimitAndZeroTiles()
+{
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    KisFrameDataSerializer serializer;
+
+    KisFrameDataSerializer::Frame testFrame1 = generateTestFrame(2, pool);
+    KisFrameDataSerializer::Frame testFrame2 = generateTestFrame(3, pool);
+
+    // measure the size of the first frame
+    int testFrameId1 = serializer.saveFrame(testFrame1);
+    const qint64 frameSize1 = serializer.diskUsage();
+    QVERIFY(frameSize1 > 0);
+    QCOMPARE(serializer.memoryUsage(), qint64(0));
+    serializer.forgetFrame(testFrameId1);
+    QCOMPARE(serializer.diskUsage(), qint64(0));
+
+    // only the first frame fits into memory, the second one is spilled to disk
+    serializer.setMemoryLimit(frameSize1);
+
+    testFrameId1 = serializer.saveFrame(testFrame1);
+    QCOMPARE(serializer.memoryUsage(), frameSize1);
+    QCOMPARE(serializer.diskUsage(), qint64(0));
+
+    int testFrameId2 = serializer.saveFrame(testFrame2);
+    QCOMPARE(serializer.memoryUsage(), frameSize1);
+    QVERIFY(serializer.diskUsage() > 0);
+
+    QVERIFY(serializer.hasFrame(testFrameId1));
+    QVERIFY(serializer.hasFrame(testFrameId2));
+    QVERIFY(verifyTestFrame(2, serializer.loadFrame(testFrameId1, pool)));
+    QVERIFY(verifyTestFrame(3, serializer.loadFrame(testFrameId2, pool)));
+
+    // moving in-memory frames keeps them in memory
+    const int movedFrameId1 = testFrameId2 + 100;
+    serializer.moveFrame(testFrameId1, movedFrameId1);
+    QVERIFY(!serializer.hasFrame(testFrameId1));
+    QVERIFY(serializer.hasFrame(movedFrameId1));
+    QCOMPARE(serializer.memoryUsage(), frameSize1);
+    QVERIFY(verifyTestFrame(2, serializer.loadFrame(movedFrameId1, pool)));
+
+    serializer.forgetFrame(movedFrameId1);
+    serializer.forgetFrame(testFrameId2);
+    QCOMPARE(serializer.memoryUsage(), qint64(0));
+    QCOMPARE(serializer.diskUsage(), qint64(0));
+
+    // a difference between equal frames consists of zero tiles only,
+    // which should take almost no space
+    KisFrameDataSerializer::Frame diffFrame = generateTestFrame(2, pool);
+    QVERIFY(KisFrameDataSerializer::subtractFrames(diffFrame, testFrame1));
+
+    const int diffFrameId = serializer.saveFrame(diffFrame);
+    const qint64 diffFrameSize = serializer.memoryUsage();
+    QVERIFY(diffFrameSize > 0);
+    QVERIFY(diffFrameSize < frameSize1 / 2);
+
+    KisFrameDataSerializer::Frame loadedFrame = serializer.loadFrame(diffFrameId, pool);
+    KisFrameDataSerializer::addFrames(loadedFrame, testFrame1);
+    QVERIFY(verifyTestFrame(2, loadedFrame));
+}
+
 SIMPLE_TEST_MAIN(KisFrameSerializerTest)
@@ -17,6 +17,7 @@ private Q_SLOTS:
     void testFrameDataSerialization();
     void testFrameUniquenessEstimation();
     void testFrameArithmetics();
+    void testMemoryLimitAndZeroTiles();
 
 };
 
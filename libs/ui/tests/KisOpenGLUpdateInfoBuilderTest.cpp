@@ -0,0 +1,125 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisOpenGLUpdateInfoBuilderTest.h"
+
+#include <simpletest.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceMaths.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+#include "opengl/kis_texture_tile_update_info.h"
+
+// TODO: conversion options into a separate file!
+#include "kis_update_info.h"
+
+namespace {
+
+const int textureSize = 256;
+const int textureBorder = 8;
+
+struct BuilderEnvironment
+{
+    BuilderEnvironment(const KoColorSpace *dstColorSpace)
+        : pool(poolRegistry.getPool(textureSize, textureSize))
+    {
+        builder.setTextureInfoPool(pool);
+        builder.setConversionOptions(
+            ConversionOptions(dstColorSpace,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags()));
+        builder.setTextureBorder(textureBorder);
+        builder.setEffectiveTextureSize(QSize(textureSize - 2 * textureBorder, textureSize - 2 * textureBorder));
+    }
+
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool;
+    KisOpenGLUpdateInfoBuilder builder;
+};
+
+KisPaintDeviceSP createTestDevice(const KoColorSpace *cs, const QRect &bounds)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    for (int i = 0; i < 16; i++) {
+        const QRect rc(bounds.x() + i * bounds.width() / 16, bounds.y() + i * 37 % bounds.height(),
+                       bounds.width() / 8, bounds.height() / 3);
+        dev->fill(rc & bounds, KoColor(QColor::fromHsv(i * 22, 200, 55 + i * 12, 100 + i * 9), cs));
+    }
+
+    return dev;
+}
+
+int realPatchBytes(KisTextureTileUpdateInfoSP tile)
+{
+    return tile->realPatchRect().width() * tile->realPatchRect().height() * tile->pixelSize();
+}
+
+}
+
+void KisOpenGLUpdateInfoBuilderTest::testConcurrentBuild()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    const QRect bounds(0, 0, 1500, 1100);
+    KisPaintDeviceSP dev = createTestDevice(cs, bounds);
+
+    BuilderEnvironment env(KoColorSpaceRegistry::instance()->rgb8());
+
+    env.builder.setConcurrentBuildEnabled(false);
+    KisOpenGLUpdateInfoSP sequentialInfo = env.builder.buildUpdateInfo(bounds, dev, bounds, 0, true);
+
+    env.builder.setConcurrentBuildEnabled(true);
+    KisOpenGLUpdateInfoSP concurrentInfo = env.builder.buildUpdateInfo(bounds, dev, bounds, 0, true);
+
+    QVERIFY(sequentialInfo->tileList.size() > 4);
+    QCOMPARE(concurrentInfo->tileList.size(), sequentialInfo->tileList.size());
+
+    for (int i = 0; i < sequentialInfo->tileList.size(); i++) {
+        KisTextureTileUpdateInfoSP tile1 = sequentialInfo->tileList[i];
+        KisTextureTileUpdateInfoSP tile2 = concurrentInfo->tileList[i];
+
+        QCOMPARE(tile2->tileCol(), tile1->tileCol());
+        QCOMPARE(tile2->tileRow(), tile1->tileRow());
+        QCOMPARE(tile2->realPatchRect(), tile1->realPatchRect());
+        QCOMPARE(tile2->pixelSize(), tile1->pixelSize());
+        QVERIFY(!memcmp(tile1->data(), tile2->data(), realPatchBytes(tile1)));
+    }
+}
+
+void KisOpenGLUpdateInfoBuilderTest::testScaledConversion()
+{
+    const KoColorSpace *srcCS = KoColorSpaceRegistry::instance()->rgb16();
+    const KoColorSpace *dstCS = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect bounds(0, 0, 700, 500);
+    KisPaintDeviceSP dev = createTestDevice(srcCS, bounds);
+
+    BuilderEnvironment env(dstCS);
+
+    KisOpenGLUpdateInfoSP info = env.builder.buildUpdateInfo(bounds, dev, bounds, 0, true);
+    QVERIFY(!info->tileList.isEmpty());
+
+    Q_FOREACH (KisTextureTileUpdateInfoSP tile, info->tileList) {
+        QCOMPARE(tile->pixelSize(), int(dstCS->pixelSize()));
+
+        const QRect rc = tile->realPatchRect();
+        QVector<quint8> srcData(rc.width() * rc.height() * srcCS->pixelSize());
+        dev->readBytes(srcData.data(), rc);
+
+        const quint16 *srcPtr = reinterpret_cast<const quint16*>(srcData.constData());
+        const quint8 *dstPtr = tile->data();
+        const int numChannels = rc.width() * rc.height() * dstCS->channelCount();
+
+        for (int i = 0; i < numChannels; i++) {
+            QCOMPARE(dstPtr[i], KoColorSpaceMaths<quint16, quint8>::scaleToA(srcPtr[i]));
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisOpenGLUpdateInfoBuilderTest)
@@ -47,7 +47,9 @@ public:
 
         Data(int _strokeInfoId,
              const KisPaintInformation &_pi)
-            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT),
+            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT,
+                               KisStrokeJobData::NORMAL,
+                               KisStrokeJobData::INTERACTIVE),
               strokeInfoId(_strokeInfoId),
               type(POINT), pi1(_pi)
         {}
@@ -55,7 +57,9 @@ public:
         Data(int _strokeInfoId,
              const KisPaintInformation &_pi1,
              const KisPaintInformation &_pi2)
-            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT),
+            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT,
+                               KisStrokeJobData::NORMAL,
+                               KisStrokeJobData::INTERACTIVE),
               strokeInfoId(_strokeInfoId),
               type(LINE), pi1(_pi1), pi2(_pi2)
         {}
@@ -65,7 +69,9 @@ public:
              const QPointF &_control1,
              const QPointF &_control2,
              const KisPaintInformation &_pi2)
-            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT),
+            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT,
+                               KisStrokeJobData::NORMAL,
+                               KisStrokeJobData::INTERACTIVE),
               strokeInfoId(_strokeInfoId),
               type(CURVE), pi1(_pi1), pi2(_pi2),
               control1(_control1), control2(_control2)
@@ -74,7 +80,9 @@ public:
         Data(int _strokeInfoId,
              DabType _type,
              const vQPointF &_points)
-            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT),
+            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT,
+                               KisStrokeJobData::NORMAL,
+                               KisStrokeJobData::INTERACTIVE),
               strokeInfoId(_strokeInfoId),
             type(_type), points(_points)
         {}
@@ -82,7 +90,9 @@ public:
         Data(int _strokeInfoId,
              DabType _type,
              const QRectF &_rect)
-            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT),
+            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT,
+                               KisStrokeJobData::NORMAL,
+                               KisStrokeJobData::INTERACTIVE),
               strokeInfoId(_strokeInfoId),
             type(_type), rect(_rect)
         {}
@@ -90,7 +100,9 @@ public:
         Data(int _strokeInfoId,
              DabType _type,
              const QPainterPath &_path)
-            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT),
+            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT,
+                               KisStrokeJobData::NORMAL,
+                               KisStrokeJobData::INTERACTIVE),
               strokeInfoId(_strokeInfoId),
             type(_type), path(_path)
         {}
@@ -99,7 +111,9 @@ public:
              DabType _type,
              const QPainterPath &_path,
              const QPen &_pen, const KoColor &_customColor)
-            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT),
+            : KisStrokeJobData(KisStrokeJobData::UNIQUELY_CONCURRENT,
+                               KisStrokeJobData::NORMAL,
+                               KisStrokeJobData::INTERACTIVE),
               strokeInfoId(_strokeInfoId),
             type(_type), path(_path),
             pen(_pen), customColor(_customColor)
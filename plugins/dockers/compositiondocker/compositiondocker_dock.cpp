@@ -355,7 +355,8 @@ void CompositionDockerDock::exportAnimationClicked()
             exportOptions.directory = QString("%1/%2").arg(path, composition->name());
             exportOptions.wantsOnlyUniqueFrameSequence = true;
 
-            KisAnimationRender::render(m_canvas->viewManager()->document(), m_canvas->viewManager(), exportOptions);
+            KisDocument *document = m_canvas->viewManager()->document();
+            KisAnimationRender::render(document, m_canvas->viewManager(), exportOptions, document->fileBatchMode());
         }
 
         currentComposition->apply();
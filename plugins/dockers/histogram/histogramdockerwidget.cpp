@@ -18,9 +18,8 @@
 #include "KoChannelInfo.h"
 #include "kis_paint_device.h"
 #include "KoColorSpace.h"
-#include "kis_iterator_ng.h"
-#include "krita_utils.h"
 #include "kis_canvas2.h"
+#include "KisTileHistogramCache.h"
 
 struct HistogramComputationStrokeStrategy::Private {
 
@@ -39,9 +38,10 @@ struct HistogramComputationStrokeStrategy::Private {
 };
 
 
-HistogramComputationStrokeStrategy::HistogramComputationStrokeStrategy(KisImageWSP image)
+HistogramComputationStrokeStrategy::HistogramComputationStrokeStrategy(KisImageWSP image, QSharedPointer<KisTileHistogramCache> histogramCache)
     : KisSimpleStrokeStrategy(QLatin1String("ComputeHistogram")),
-      m_image(image)
+      m_image(image),
+      m_histogramCache(histogramCache)
 {
     enableJob(KisSimpleStrokeStrategy::JOB_INIT, true, KisStrokeJobData::BARRIER, KisStrokeJobData::EXCLUSIVE);
     enableJob(KisSimpleStrokeStrategy::JOB_DOSTROKE);
@@ -60,15 +60,12 @@ HistogramComputationStrokeStrategy::~HistogramComputationStrokeStrategy()
 
 void HistogramComputationStrokeStrategy::initStrokeCallback()
 {
-    QVector<KisStrokeJobData*> jobsData;
-    int i = 0;
-    QVector<QRect> tileRects = KritaUtils::splitRectIntoPatches(m_image->bounds(), KritaUtils::optimalPatchSize());
-    m_results.resize(tileRects.size());
-    Q_FOREACH (const QRect &tileRectangle, tileRects) {
-        jobsData << new HistogramComputationStrokeStrategy::Private::ProcessData(tileRectangle, i);
-        i++;
-    }
-    addMutatedJobs(jobsData);
+    /**
+     * The histogram cache splits the work into tiles and processes
+     * them concurrently itself, so a single job is enough
+     */
+    m_results.resize(1);
+    addMutatedJob(new HistogramComputationStrokeStrategy::Private::ProcessData(m_image->bounds(), 0));
 }
 
 void HistogramComputationStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
@@ -80,36 +77,18 @@ void HistogramComputationStrokeStrategy::doStrokeCallback(KisStrokeJobData *data
     KisPaintDeviceSP m_dev = m_image->projection();
     QRect imageBounds = m_image->bounds();
 
-    const KoColorSpace *cs = m_dev->colorSpace();
-    quint32 channelCount = m_dev->channelCount();
-    quint32 pixelSize = m_dev->pixelSize();
-
     quint32 imageSize = imageBounds.width() * imageBounds.height();
     quint32 nSkip = 1 + (imageSize >> 20); //for speed use about 1M pixels for computing histograms
 
     if (calculate.isEmpty())
         return;
 
-    initiateVector(m_results[d_pd->jobId], cs);
-
-    quint32 toSkip = nSkip;
+    const QVector<QVector<quint32>> bins = m_histogramCache->histogram(m_dev, calculate, nSkip);
 
-    KisSequentialConstIterator it(m_dev, calculate);
-
-    int numConseqPixels = it.nConseqPixels();
-    while (it.nextPixels(numConseqPixels)) {
-
-        numConseqPixels = it.nConseqPixels();
-        const quint8* pixel = it.rawDataConst();
-        for (int k = 0; k < numConseqPixels; ++k) {
-            if (--toSkip == 0) {
-                for (int chan = 0; chan < (int)channelCount; ++chan) {
-                    m_results[d_pd->jobId][chan][cs->scaleToU8(pixel, chan)]++;
-                }
-                toSkip = nSkip;
-            }
-            pixel += pixelSize;
-        }
+    HistVector &result = m_results[d_pd->jobId];
+    result.resize(bins.size());
+    for (int chan = 0; chan < bins.size(); chan++) {
+        result[chan].assign(bins[chan].constBegin(), bins[chan].constEnd());
     }
 }
 
@@ -168,6 +147,8 @@ HistogramDockerWidget::HistogramDockerWidget(QWidget *parent, const char *name,
     setObjectName(name);
     qRegisterMetaType<HistogramData>();
 
+    m_histogramCache.reset(new KisTileHistogramCache());
+
 }
 
 HistogramDockerWidget::~HistogramDockerWidget()
@@ -179,17 +160,12 @@ void HistogramDockerWidget::updateHistogram(KisCanvas2* canvas)
 {
     if (canvas) {
         KisPaintDeviceSP paintDevice = canvas->image()->projection();
-        QRect bounds = canvas->image()->bounds();
 
         // remember to save the color space to paint the histogram data!
         m_colorSpace = paintDevice->colorSpace();
 
-        KisPaintDeviceSP m_devClone = new KisPaintDevice(paintDevice->colorSpace());
-
-        m_devClone->makeCloneFrom(paintDevice, bounds);
-
         HistogramComputationStrokeStrategy* stroke;
-        stroke = new HistogramComputationStrokeStrategy(canvas->image());
+        stroke = new HistogramComputationStrokeStrategy(canvas->image(), m_histogramCache);
 
         connect(stroke, SIGNAL(computationResultReady(HistogramData)), this, SLOT(receiveNewHistogram(HistogramData)));
 
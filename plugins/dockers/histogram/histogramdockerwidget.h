@@ -12,12 +12,14 @@
 #include <QWidget>
 #include <QLabel>
 #include <QThread>
+#include <QSharedPointer>
 #include "kis_types.h"
 #include <vector>
 #include <kis_simple_stroke_strategy.h>
 
 class KisCanvas2;
 class KoColorSpace;
+class KisTileHistogramCache;
 
 
 using HistVector = std::vector<std::vector<quint32> >; //Don't use QVector here - it's too slow for this purpose
@@ -37,7 +39,7 @@ class HistogramComputationStrokeStrategy : public QObject, public KisSimpleStrok
 {
     Q_OBJECT
 public:
-    HistogramComputationStrokeStrategy(KisImageWSP image);
+    HistogramComputationStrokeStrategy(KisImageWSP image, QSharedPointer<KisTileHistogramCache> histogramCache);
     ~HistogramComputationStrokeStrategy() override;
 
 
@@ -58,6 +60,7 @@ private:
     struct Private;
     const QScopedPointer<Private> m_d;
     KisImageSP m_image;
+    QSharedPointer<KisTileHistogramCache> m_histogramCache;
     std::vector<HistVector> m_results;
 };
 
@@ -88,6 +91,12 @@ public Q_SLOTS:
 private:
     HistVector m_histogramData;
     const KoColorSpace* m_colorSpace {0};
+
+    /**
+     * The tile histograms of the projection are kept between the
+     * updates, so that only the changed tiles are binned again
+     */
+    QSharedPointer<KisTileHistogramCache> m_histogramCache;
     bool m_smoothHistogram {false};
 };
 
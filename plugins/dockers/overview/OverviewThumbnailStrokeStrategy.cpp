@@ -12,11 +12,13 @@
 #include "krita_utils.h"
 #include "kis_transform_worker.h"
 #include "kis_filter_strategy.h"
+#include <kis_lod_transform.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoUpdater.h>
 
 const qreal oversample = 2.;
 const int thumbnailTileDim = 128;
+const int maxPyramidLod = 8;
 
 
 class OverviewThumbnailStrokeStrategy::ProcessData : public KisStrokeJobData
@@ -87,6 +89,28 @@ void OverviewThumbnailStrokeStrategy::initStrokeCallback()
         m_thumbnailOversampledSize.scale(imageRect.size(), Qt::KeepAspectRatio);
     }
 
+    m_sourceDevice = m_device;
+    m_sourceRect = imageRect;
+
+    /**
+     * If the LoD pyramid of the device is in sync, downscale its
+     * coarsest level that is still not smaller than the thumbnail.
+     * Pixel art is always sampled from the original pixels.
+     */
+    if (!m_isPixelArt) {
+        const qreal scale = qMin(qreal(m_thumbnailOversampledSize.width()) / imageRect.width(),
+                                 qreal(m_thumbnailOversampledSize.height()) / imageRect.height());
+        const int maxLod = KisLodTransform::scaleToLod(scale, maxPyramidLod);
+
+        int lod = 0;
+        KisPaintDeviceSP levelDevice = maxLod > 0 ? m_device->createLodPyramidClone(maxLod, &lod) : 0;
+
+        if (levelDevice) {
+            m_sourceDevice = levelDevice;
+            m_sourceRect = KisLodTransform::scaledRect(KisLodTransform::alignedRect(imageRect, lod), lod);
+        }
+    }
+
     m_thumbnailDevice = new KisPaintDevice(m_device->colorSpace());
 
     QVector<KisStrokeJobData*> jobsData;
@@ -105,7 +129,7 @@ void OverviewThumbnailStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
     if (d_pd) {
         //we aren't going to use oversample capability of createThumbnailDevice because it recomputes exact bounds for each small patch, which is
         //slow. We'll handle scaling separately.
-        KisPaintDeviceSP thumbnailTile = m_device->createThumbnailDeviceOversampled(m_thumbnailOversampledSize.width(), m_thumbnailOversampledSize.height(), 1, m_device->defaultBounds()->bounds(), d_pd->tileRect);
+        KisPaintDeviceSP thumbnailTile = m_sourceDevice->createThumbnailDeviceOversampled(m_thumbnailOversampledSize.width(), m_thumbnailOversampledSize.height(), 1, m_sourceRect, d_pd->tileRect);
         KisPainter::copyAreaOptimized(d_pd->tileRect.topLeft(), thumbnailTile, m_thumbnailDevice, d_pd->tileRect);
     }
 }
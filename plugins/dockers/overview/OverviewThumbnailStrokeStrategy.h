@@ -50,6 +50,8 @@ private:
     class ProcessData;
 
     KisPaintDeviceSP m_device;
+    KisPaintDeviceSP m_sourceDevice;
+    QRect m_sourceRect;
     QRect m_rect;
     QSize m_thumbnailSize;
     QSize m_thumbnailOversampledSize;
@@ -15,11 +15,13 @@
 #include <kundo2command.h>
 
 #include <KoColorSpaceRegistry.h>
+#include <KoProgressUpdater.h>
 #include <KoUpdater.h>
 
 #include <filter/kis_filter_registry.h>
 #include <kis_image.h>
 #include <kis_paint_device.h>
+#include <KisChannelStatistics.h>
 #include <kis_selection.h>
 #include <filter/kis_filter_category_ids.h>
 #include <filter/kis_filter_configuration.h>
@@ -28,7 +30,6 @@
 #include "kis_wdg_fastcolortransfer.h"
 #include "ui_wdgfastcolortransfer.h"
 #include <KisSequentialIteratorProgress.h>
-#include <KoProgressUpdater.h>
 
 
 K_PLUGIN_FACTORY_WITH_JSON(KritaFastColorTransferFactory, "kritafastcolortransfer.json", registerPlugin<FastColorTransferPlugin>();)
@@ -76,6 +77,18 @@ void KisFilterFastColorTransfer::processImpl(KisPaintDeviceSP device,
 {
     Q_ASSERT(device != 0);
 
+    QPointer<KoUpdater> statisticsUpdater = 0;
+    QPointer<KoUpdater> transferUpdater = 0;
+    QScopedPointer<KoProgressUpdater> updater;
+
+    if (progressUpdater) {
+        updater.reset(new KoProgressUpdater(progressUpdater));
+        updater->start(100, i18n("Color Transfer"));
+        // Two sub-sub tasks that each go from 0 to 100.
+        statisticsUpdater = updater->startSubtask();
+        transferUpdater = updater->startSubtask();
+    }
+
     dbgPlugins << "Start transferring color";
 
     // Convert ref and src to LAB
@@ -91,41 +104,21 @@ void KisFilterFastColorTransfer::processImpl(KisPaintDeviceSP device,
     dbgPlugins << "srcLab : " << srcLAB->extent();
     srcLAB->convertTo(labCS, KoColorConversionTransformation::internalRenderingIntent(), KoColorConversionTransformation::internalConversionFlags());
 
-    KoProgressUpdater compositeUpdater(progressUpdater, KoProgressUpdater::Unthreaded);
-    KoUpdater *updaterStats = compositeUpdater.startSubtask(1);
-    KoUpdater *updaterMap = compositeUpdater.startSubtask(2);
-
     // Compute the means and sigmas of src
     dbgPlugins << "Compute the means and sigmas of src";
-    double meanL_src = 0., meanA_src = 0., meanB_src = 0.;
-    double sigmaL_src = 0., sigmaA_src = 0., sigmaB_src = 0.;
+    KisChannelStatisticsSP srcStats = srcLAB->channelStatistics(applyRect, 0, statisticsUpdater);
+
+    double meanL_src = srcStats->mean(0);
+    double meanA_src = srcStats->mean(1);
+    double meanB_src = srcStats->mean(2);
+
+    // the sigmas are kept as the means of the squares, like the ones of ref
+    double sigmaL_src = srcStats->variance(0) + meanL_src * meanL_src;
+    double sigmaA_src = srcStats->variance(1) + meanA_src * meanA_src;
+    double sigmaB_src = srcStats->variance(2) + meanB_src * meanB_src;
+
+    dbgPlugins << srcStats->pixelCount() << "" << meanL_src << "" << meanA_src << "" << meanB_src << "" << sigmaL_src << "" << sigmaA_src << "" << sigmaB_src;
 
-    {
-        KisSequentialConstIteratorProgress srcIt(srcLAB, applyRect, updaterStats);
-        while (srcIt.nextPixel()) {
-            const quint16* data = reinterpret_cast<const quint16*>(srcIt.oldRawData());
-            quint32 L = data[0];
-            quint32 A = data[1];
-            quint32 B = data[2];
-            meanL_src += L;
-            meanA_src += A;
-            meanB_src += B;
-            sigmaL_src += L * L;
-            sigmaA_src += A * A;
-            sigmaB_src += B * B;
-        }
-    }
-    
-    double totalSize = 1. / (applyRect.width() * applyRect.height());
-    meanL_src *= totalSize;
-    meanA_src *= totalSize;
-    meanB_src *= totalSize;
-    sigmaL_src *= totalSize;
-    sigmaA_src *= totalSize;
-    sigmaB_src *= totalSize;
-    
-    dbgPlugins << totalSize << "" << meanL_src << "" << meanA_src << "" << meanB_src << "" << sigmaL_src << "" << sigmaA_src << "" << sigmaB_src;
-    
     double meanL_ref = config->getDouble("meanL");
     double meanA_ref = config->getDouble("meanA");
     double meanB_ref = config->getDouble("meanB");
@@ -142,7 +135,7 @@ void KisFilterFastColorTransfer::processImpl(KisPaintDeviceSP device,
 
         quint16 labPixel[4];
 
-        KisSequentialConstIteratorProgress srcLabIt(srcLAB, applyRect, updaterMap);
+        KisSequentialConstIteratorProgress srcLabIt(srcLAB, applyRect, transferUpdater);
         KisSequentialIterator dstIt(device, applyRect);
         while (srcLabIt.nextPixel() && dstIt.nextPixel()) {
             const quint16* data = reinterpret_cast<const quint16*>(srcLabIt.oldRawData());
@@ -17,7 +17,7 @@
 #include <KisDocument.h>
 #include <KisPart.h>
 #include <kis_image.h>
-#include <kis_iterator_ng.h>
+#include <KisChannelStatistics.h>
 #include <kis_paint_device.h>
 #include <kundo2command.h>
 #include <KoColorSpaceRegistry.h>
@@ -75,7 +75,6 @@ KisPropertiesConfigurationSP KisWdgFastColorTransfer::configuration() const
         return config;
     }
 
-    // Convert ref to LAB
     const KoColorSpace* labCS = KoColorSpaceRegistry::instance()->lab16();
     if (!labCS) {
         dbgPlugins << "The LAB colorspace is not available.";
@@ -83,41 +82,19 @@ KisPropertiesConfigurationSP KisWdgFastColorTransfer::configuration() const
         return config;
     }
 
-    dbgPlugins << "convert ref to lab";
-    ref->convertTo(labCS, KoColorConversionTransformation::internalRenderingIntent(), KoColorConversionTransformation::internalConversionFlags());
+    // Compute the means and sigmas of ref in LAB
+    KisChannelStatisticsSP refStats = ref->channelStatistics(importedImage->bounds(), labCS);
 
-    // Compute the means and sigmas of ref
-    double meanL_ref = 0., meanA_ref = 0., meanB_ref = 0.;
-    double sigmaL_ref = 0., sigmaA_ref = 0., sigmaB_ref = 0.;
+    double meanL_ref = refStats->mean(0);
+    double meanA_ref = refStats->mean(1);
+    double meanB_ref = refStats->mean(2);
 
-    KisSequentialConstIterator refIt(ref, importedImage->bounds());
-    while (refIt.nextPixel()) {
-        const quint16* data = reinterpret_cast<const quint16*>(refIt.oldRawData());
+    // the sigmas are stored as the means of the squares
+    double sigmaL_ref = refStats->variance(0) + meanL_ref * meanL_ref;
+    double sigmaA_ref = refStats->variance(1) + meanA_ref * meanA_ref;
+    double sigmaB_ref = refStats->variance(2) + meanB_ref * meanB_ref;
 
-        quint32 L = data[0];
-        quint32 A = data[1];
-        quint32 B = data[2];
-
-        meanL_ref += L;
-        meanA_ref += A;
-        meanB_ref += B;
-
-        sigmaL_ref += L * L;
-        sigmaA_ref += A * A;
-        sigmaB_ref += B * B;
-
-    }
-
-    double totalSize = 1. / (importedImage->width() * importedImage->height());
-
-    meanL_ref *= totalSize;
-    meanA_ref *= totalSize;
-    meanB_ref *= totalSize;
-    sigmaL_ref *= totalSize;
-    sigmaA_ref *= totalSize;
-    sigmaB_ref *= totalSize;
-
-    dbgPlugins << totalSize << "" << meanL_ref << "" << meanA_ref << "" << meanB_ref << "" << sigmaL_ref << "" << sigmaA_ref << "" << sigmaB_ref;
+    dbgPlugins << refStats->pixelCount() << "" << meanL_ref << "" << meanA_ref << "" << meanB_ref << "" << sigmaL_ref << "" << sigmaA_ref << "" << sigmaB_ref;
 
     config->setProperty("filename", fileName);
     config->setProperty("meanL", meanL_ref);
@@ -7,6 +7,10 @@
 
 #include "exr_converter.h"
 
+#include <atomic>
+#include <numeric>
+
+
 #include <half.h>
 
 #include <ImfAttribute.h>
@@ -23,6 +27,7 @@
 #include <QMessageBox>
 #include <QDomDocument>
 #include <QThread>
+#include <QtConcurrent>
 
 #include <QFileInfo>
 
@@ -40,6 +45,7 @@
 #include <kis_paint_layer.h>
 #include <kis_transaction.h>
 #include "kis_iterator_ng.h"
+#include <kis_algebra_2d.h>
 #include <kis_exr_layers_sorter.h>
 
 #include <kis_meta_data_entry.h>
@@ -133,7 +139,7 @@ struct EXRConverter::Private {
     KisImageSP image;
     KisDocument *doc;
 
-    bool alphaWasModified;
+    std::atomic<bool> alphaWasModified;
     bool showNotifications;
 
     QString errorMessage;
@@ -361,6 +367,29 @@ void multiplyAlpha(Pixel *pixel)
     }
 }
 
+/**
+ * Runs \p func for horizontal stripes of \p rc on the global thread
+ * pool. The stripes are aligned to the tiles of the paint device, so
+ * the threads never write into the same tile.
+ */
+template <typename Func>
+void processStripesConcurrently(const QRect &rc, Func func)
+{
+    const int stripeHeight = 64;
+
+    QVector<QRect> stripes;
+
+    int y = rc.top();
+    while (y <= rc.bottom()) {
+        const int nextGridLine = (KisAlgebra2D::divideFloor(y, stripeHeight) + 1) * stripeHeight;
+        const int bottom = qMin(nextGridLine - 1, rc.bottom());
+        stripes << QRect(rc.left(), y, rc.width(), bottom - y + 1);
+        y = bottom + 1;
+    }
+
+    QtConcurrent::blockingMap(stripes, func);
+}
+
 template<typename _T_>
 void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
 {
@@ -393,28 +422,31 @@ void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo&
 
     file.setFrameBuffer(frameBuffer);
     file.readPixels(ystart, height + ystart - 1);
-    Rgba *rgba = pixels.data();
 
     QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
-        if (hasAlpha) {
-            unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
-        }
+    processStripesConcurrently(paintRegion, [&](const QRect &stripe) {
+        Rgba *rgba = pixels.data() + (stripe.top() - ystart) * width;
 
-        typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it.rawData());
+        KisSequentialIterator it(layer->paintDevice(), stripe);
+        while (it.nextPixel()) {
+            if (hasAlpha) {
+                unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
+            }
 
-        dst->red = rgba->r;
-        dst->green = rgba->g;
-        dst->blue = rgba->b;
-        if (hasAlpha) {
-            dst->alpha = rgba->a;
-        } else {
-            dst->alpha = 1.0;
-        }
+            typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it.rawData());
 
-        ++rgba;
-    }
+            dst->red = rgba->r;
+            dst->green = rgba->g;
+            dst->blue = rgba->b;
+            if (hasAlpha) {
+                dst->alpha = rgba->a;
+            } else {
+                dst->alpha = 1.0;
+            }
+
+            ++rgba;
+        }
+    });
 }
 
 template<typename _T_>
@@ -452,22 +484,24 @@ void EXRConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo&
     file.setFrameBuffer(frameBuffer);
     file.readPixels(ystart, height + ystart - 1);
 
-    pixel_type *srcPtr = pixels.data();
-
     QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
-        if (hasAlpha) {
-            unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
-        }
+    processStripesConcurrently(paintRegion, [&](const QRect &stripe) {
+        pixel_type *srcPtr = pixels.data() + (stripe.top() - ystart) * width;
 
-        pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it.rawData());
+        KisSequentialIterator it(layer->paintDevice(), stripe);
+        while (it.nextPixel()) {
+            if (hasAlpha) {
+                unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
+            }
 
-        dstPtr->gray = srcPtr->gray;
-        dstPtr->alpha = hasAlpha ? srcPtr->alpha : channel_type(1.0);
+            pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it.rawData());
 
-        ++srcPtr;
-    } ;
+            dstPtr->gray = srcPtr->gray;
+            dstPtr->alpha = hasAlpha ? srcPtr->alpha : channel_type(1.0);
+
+            ++srcPtr;
+        }
+    });
 }
 
 bool recCheckGroup(const ExrGroupLayerInfo& group, QStringList list, int idx1, int idx2)
@@ -942,7 +976,16 @@ class Encoder
 {
 public:
     virtual ~Encoder() {}
+    /**
+     * Attaches the encoder's buffer to \p frameBuffer, so that it
+     * would hold a band of lines starting at \p line
+     */
     virtual void prepareFrameBuffer(Imf::FrameBuffer*, int line) = 0;
+
+    /**
+     * Fills the \p line of the current band. Different lines can be
+     * encoded concurrently.
+     */
     virtual void encodeData(int line) = 0;
 
 };
@@ -951,7 +994,7 @@ template<typename _T_, int size, int alphaPos>
 class EncoderImpl : public Encoder
 {
 public:
-    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), pixels(width), m_width(width) {}
+    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width, int linesPerBand) : file(_file), info(_info), pixels(width * linesPerBand), m_width(width) {}
     ~EncoderImpl() override {}
     void prepareFrameBuffer(Imf::FrameBuffer*, int line) override;
     void encodeData(int line) override;
@@ -961,6 +1004,7 @@ private:
     const ExrPaintLayerSaveInfo* info;
     QVector<ExrPixel> pixels;
     int m_width;
+    int m_bandStart {0};
 };
 
 template<typename _T_, int size, int alphaPos>
@@ -968,6 +1012,7 @@ void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* fram
 {
     int xstart = 0;
     int ystart = 0;
+    m_bandStart = line;
     ExrPixel* frameBufferData = (pixels.data()) - xstart - (ystart + line) * m_width;
     for (int k = 0; k < size; ++k) {
         frameBuffer->insert(info->channels[k].toUtf8(),
@@ -980,7 +1025,7 @@ void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* fram
 template<typename _T_, int size, int alphaPos>
 void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
 {
-    ExrPixel *rgba = pixels.data();
+    ExrPixel *rgba = pixels.data() + (line - m_bandStart) * m_width;
     KisHLineConstIteratorSP it = info->layerDevice->createHLineConstIteratorNG(0, line, m_width);
     do {
         const _T_* dst = reinterpret_cast < const _T_* >(it->oldRawData());
@@ -997,37 +1042,37 @@ void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
     } while (it->nextPixel());
 }
 
-Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int width)
+Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int width, int linesPerBand)
 {
     dbgFile << "Create encoder for" << info.name << info.channels << info.layerDevice->colorSpace()->channelCount();
     switch (info.layerDevice->colorSpace()->channelCount()) {
     case 1: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl < half, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < half, 1, -1 > (&file, &info, width, linesPerBand);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl < float, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < float, 1, -1 > (&file, &info, width, linesPerBand);
         }
         break;
     }
     case 2: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 2, 1>(&file, &info, width);
+            return new EncoderImpl<half, 2, 1>(&file, &info, width, linesPerBand);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 2, 1>(&file, &info, width);
+            return new EncoderImpl<float, 2, 1>(&file, &info, width, linesPerBand);
         }
         break;
     }
     case 4: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 4, 3>(&file, &info, width);
+            return new EncoderImpl<half, 4, 3>(&file, &info, width, linesPerBand);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 4, 3>(&file, &info, width);
+            return new EncoderImpl<float, 4, 3>(&file, &info, width, linesPerBand);
         }
         break;
     }
@@ -1039,21 +1084,40 @@ Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int w
 
 void encodeData(Imf::OutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
 {
+    /**
+     * OpenEXR compresses line blocks on its own thread pool, but only
+     * when several blocks are passed to writePixels() at once. So we
+     * fill a band of lines concurrently and then pass the whole band.
+     */
+    const int linesPerBand = qBound(1, 16 * QThread::idealThreadCount(), height);
+
     QList<Encoder*> encoders;
     Q_FOREACH (const ExrPaintLayerSaveInfo& info, informationObjects) {
-        encoders.push_back(encoder(file, info, width));
+        encoders.push_back(encoder(file, info, width, linesPerBand));
     }
 
-    for (int y = 0; y < height; ++y) {
+    const QList<Encoder*> &constEncoders = encoders;
+    QVector<int> lines;
+
+    for (int bandStart = 0; bandStart < height; bandStart += linesPerBand) {
+        const int numLines = qMin(linesPerBand, height - bandStart);
+
         Imf::FrameBuffer frameBuffer;
         Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->prepareFrameBuffer(&frameBuffer, y);
+            encoder->prepareFrameBuffer(&frameBuffer, bandStart);
         }
         file.setFrameBuffer(frameBuffer);
-        Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->encodeData(y);
-        }
-        file.writePixels(1);
+
+        lines.resize(numLines);
+        std::iota(lines.begin(), lines.end(), bandStart);
+
+        QtConcurrent::blockingMap(lines, [&constEncoders](int line) {
+            for (Encoder *encoder : constEncoders) {
+                encoder->encodeData(line);
+            }
+        });
+
+        file.writePixels(numLines);
     }
     qDeleteAll(encoders);
 }
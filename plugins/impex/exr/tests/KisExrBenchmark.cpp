@@ -0,0 +1,111 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisExrBenchmark.h"
+
+#include <QDir>
+
+#include <half.h>
+#include <simpletest.h>
+#include <sdk/tests/testui.h>
+
+#include <KisDocument.h>
+#include <KisImportExportManager.h>
+#include <KisPart.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceRegistry.h>
+#include <kis_image.h>
+#include <kis_iterator_ng.h>
+#include <kis_paint_layer.h>
+
+namespace {
+
+const QString ExrMimetype = "application/x-extension-exr";
+
+const QSize imageSize(8000, 8000);
+const int numLayers = 4;
+
+QString sourceFileName()
+{
+    return QDir::currentPath() + '/' + "exr_benchmark_source.exr";
+}
+
+QString exportFileName()
+{
+    return QDir::currentPath() + '/' + "exr_benchmark_export.exr";
+}
+
+KisImageSP createBenchmarkImage()
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float16BitsColorDepthID.id(), 0);
+
+    KisImageSP image = new KisImage(0, imageSize.width(), imageSize.height(), cs, "exr benchmark");
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8);
+
+        KisSequentialIterator it(layer->paintDevice(), image->bounds());
+        while (it.nextPixel()) {
+            half *pixel = reinterpret_cast<half *>(it.rawData());
+            pixel[0] = half(float(it.x()) / imageSize.width());
+            pixel[1] = half(float(it.y()) / imageSize.height());
+            pixel[2] = half(float(i) / numLayers);
+            pixel[3] = half(0.5f + 0.5f * float((it.x() + it.y()) & 0xff) / 255.0f);
+        }
+
+        image->addNode(layer, image->root());
+    }
+
+    image->initialRefreshGraph();
+    image->waitForDone();
+
+    return image;
+}
+
+}
+
+void KisExrBenchmark::initTestCase()
+{
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setFileBatchMode(true);
+    doc->setCurrentImage(createBenchmarkImage());
+
+    QVERIFY(doc->exportDocumentSync(sourceFileName(), ExrMimetype.toLatin1()));
+}
+
+void KisExrBenchmark::cleanupTestCase()
+{
+    QFile::remove(sourceFileName());
+    QFile::remove(exportFileName());
+}
+
+void KisExrBenchmark::benchmarkImport()
+{
+    QBENCHMARK_ONCE {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        KisImportExportManager manager(doc.data());
+        doc->setFileBatchMode(true);
+
+        KisImportExportErrorCode status = manager.importDocument(sourceFileName(), QString());
+        QVERIFY(status.isOk());
+        QVERIFY(doc->image());
+    }
+}
+
+void KisExrBenchmark::benchmarkExport()
+{
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setFileBatchMode(true);
+    doc->setCurrentImage(createBenchmarkImage());
+
+    QBENCHMARK_ONCE {
+        QVERIFY(doc->exportDocumentSync(exportFileName(), ExrMimetype.toLatin1()));
+    }
+}
+
+KISTEST_MAIN(KisExrBenchmark)
@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISEXRBENCHMARK_H
+#define KISEXRBENCHMARK_H
+
+#include <simpletest.h>
+
+class KisExrBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkImport();
+    void benchmarkExport();
+};
+
+#endif // KISEXRBENCHMARK_H
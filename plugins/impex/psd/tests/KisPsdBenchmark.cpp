@@ -0,0 +1,130 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPsdBenchmark.h"
+
+#include <QDir>
+#include <QThreadPool>
+
+#include <simpletest.h>
+#include <sdk/tests/testui.h>
+
+#include <KisDocument.h>
+#include <KisImportExportManager.h>
+#include <KisPart.h>
+#include <KoColorSpaceRegistry.h>
+#include <kis_image.h>
+#include <kis_iterator_ng.h>
+#include <kis_paint_device.h>
+#include <kis_paint_layer.h>
+#include <kis_random_generator.h>
+
+namespace {
+
+const QString PSDMimetype = "image/vnd.adobe.photoshop";
+
+const int numLayers = 200;
+const QSize imageSize(2000, 2000);
+
+QString benchmarkFileName()
+{
+    return QDir::currentPath() + '/' + "psd_benchmark_200_layers.psd";
+}
+
+/**
+ * Fills the device with a mixture of flat areas (which compress very
+ * well with PackBits) and noisy areas (which end up mostly in literal
+ * runs), so that both RLE decoding paths are exercised.
+ */
+void fillSyntheticLayer(KisPaintDeviceSP dev, int seed)
+{
+    KisRandomGenerator random(seed);
+
+    const QRect layerRect(seed % 400, (seed * 7) % 400, 1600, 1600);
+    const int noiseTop = layerRect.top() + layerRect.height() / 2;
+
+    KisSequentialIterator it(dev, layerRect);
+    while (it.nextPixel()) {
+        quint8 *pixel = it.rawData();
+
+        if (it.y() < noiseTop) {
+            const quint8 value = quint8((it.x() / 64 + it.y() / 64 + seed) & 0xff);
+            pixel[0] = value;
+            pixel[1] = 255 - value;
+            pixel[2] = quint8(seed);
+        } else {
+            pixel[0] = random.randomAt(it.x(), it.y()) & 0xff;
+            pixel[1] = (random.randomAt(it.x(), it.y()) >> 8) & 0xff;
+            pixel[2] = (random.randomAt(it.x(), it.y()) >> 16) & 0xff;
+        }
+        pixel[3] = 255;
+    }
+}
+
+QSharedPointer<KisDocument> loadBenchmarkFile()
+{
+    QSharedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    KisImportExportManager manager(doc.data());
+    doc->setFileBatchMode(true);
+
+    KisImportExportErrorCode status = manager.importDocument(benchmarkFileName(), QString());
+    KIS_ASSERT(status.isOk());
+
+    return doc;
+}
+
+}
+
+void KisPsdBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    KisImageSP image = new KisImage(0, imageSize.width(), imageSize.height(), cs, "psd benchmark");
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8);
+        fillSyntheticLayer(layer->paintDevice(), i);
+        image->addNode(layer, image->root());
+    }
+
+    image->initialRefreshGraph();
+    image->waitForDone();
+
+    doc->setFileBatchMode(true);
+    doc->setCurrentImage(image);
+
+    QVERIFY(doc->exportDocumentSync(benchmarkFileName(), PSDMimetype.toLatin1()));
+}
+
+void KisPsdBenchmark::cleanupTestCase()
+{
+    QFile::remove(benchmarkFileName());
+}
+
+void KisPsdBenchmark::benchmarkLoadMultilayered()
+{
+    QBENCHMARK_ONCE {
+        QSharedPointer<KisDocument> doc = loadBenchmarkFile();
+        QVERIFY(doc->image());
+    }
+}
+
+void KisPsdBenchmark::benchmarkLoadMultilayeredSingleThread()
+{
+    const int oldMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(1);
+
+    QBENCHMARK_ONCE {
+        QSharedPointer<KisDocument> doc = loadBenchmarkFile();
+        QVERIFY(doc->image());
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(oldMaxThreadCount);
+}
+
+KISTEST_MAIN(KisPsdBenchmark)
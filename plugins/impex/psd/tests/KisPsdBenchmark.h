@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPSDBENCHMARK_H
+#define KISPSDBENCHMARK_H
+
+#include <simpletest.h>
+
+class KisPsdBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkLoadMultilayered();
+    void benchmarkLoadMultilayeredSingleThread();
+};
+
+#endif // KISPSDBENCHMARK_H
@@ -19,6 +19,8 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QStack>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <KisDocument.h>
 #include <KisImportExportAdditionalChecks.h>
@@ -337,6 +339,143 @@ void KisTIFFOptions::fromProperties(KisPropertiesConfigurationSP cfg)
     saveProfile = cfg->getBool("saveProfile", true);
 }
 
+namespace
+{
+/**
+ * Layout of the strips (or tiles) of the current TIFF directory,
+ * needed to decode a band of them with a private TIFF handle.
+ */
+struct KisTiffChunksLayout {
+    bool isTiled = false;
+    uint16_t planarconfig = PLANARCONFIG_CONTIG;
+    uint16_t depth = 8;
+    uint16_t nbchannels = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t chunkWidth = 0;
+    uint32_t chunkHeight = 0;
+};
+
+KisBufferStreamBase *createContigBufferStream(uint8_t *buf, uint16_t depth, tsize_t lineSize)
+{
+    if (depth < 16) {
+        return new KisBufferStreamContigBelow16(buf, depth, lineSize);
+    } else if (depth < 32) {
+        return new KisBufferStreamContigBelow32(buf, depth, lineSize);
+    } else {
+        return new KisBufferStreamContigAbove32(buf, depth, lineSize);
+    }
+}
+
+/**
+ * Decodes the rows [firstRow, lastRow) of the current directory of
+ * \p fileName into the reader's device. libtiff handles are not
+ * thread-safe, so every band opens the file on its own and several
+ * bands can be decoded concurrently.
+ */
+bool readTiffBand(const QByteArray &fileName, tdir_t directory, const KisTiffChunksLayout &layout, uint32_t firstRow, uint32_t lastRow, KisTIFFReaderBase *tiffReader)
+{
+    TIFF *image = TIFFOpen(fileName.constData(), "r");
+    if (!image) {
+        return false;
+    }
+
+    if (!TIFFSetDirectory(image, directory)) {
+        TIFFClose(image);
+        return false;
+    }
+
+    const bool isContig = layout.planarconfig == PLANARCONFIG_CONTIG;
+    const tmsize_t chunkSize = layout.isTiled ? TIFFTileSize(image) : TIFFStripSize(image);
+
+    QVector<tdata_t> buffers(isContig ? 1 : layout.nbchannels);
+    for (int i = 0; i < buffers.size(); i++) {
+        buffers[i] = _TIFFmalloc(chunkSize);
+    }
+
+    QScopedPointer<KisBufferStreamBase> tiffstream;
+    if (isContig) {
+        const tsize_t lineSize = layout.isTiled ? (layout.chunkWidth * layout.depth * layout.nbchannels) / 8 : chunkSize / layout.chunkHeight;
+        tiffstream.reset(createContigBufferStream(reinterpret_cast<uint8_t *>(buffers[0]), layout.depth, lineSize));
+    } else {
+        QVector<tsize_t> lineSizes(layout.nbchannels, layout.isTiled ? tsize_t(layout.chunkWidth) : chunkSize / layout.chunkHeight);
+        tiffstream.reset(new KisBufferStreamSeparate(reinterpret_cast<uint8_t **>(buffers.data()), layout.nbchannels, layout.depth, lineSizes.data()));
+    }
+
+    bool result = true;
+
+    for (uint32_t y = firstRow; y < lastRow && result; y += layout.chunkHeight) {
+        for (uint32_t x = 0; x < layout.width; x += layout.chunkWidth) {
+            for (int i = 0; i < buffers.size(); i++) {
+                const tsample_t sample = isContig ? tsample_t(-1) : tsample_t(i);
+                const tmsize_t bytesRead = layout.isTiled
+                    ? TIFFReadTile(image, buffers[i], x, y, 0, sample)
+                    : TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, isContig ? 0 : sample), buffers[i], tmsize_t(-1));
+
+                if (bytesRead < 0) {
+                    result = false;
+                }
+            }
+
+            const uint32_t realChunkWidth = qMin(layout.chunkWidth, layout.width - x);
+            const uint32_t rowsInChunk = qMin(layout.chunkHeight, layout.height - y);
+
+            for (uint32_t yInChunk = 0; yInChunk < rowsInChunk;) {
+                yInChunk += tiffReader->copyDataToChannels(x, y + yInChunk, realChunkWidth, tiffstream.data());
+                tiffstream->moveToLine(yInChunk);
+            }
+            tiffstream->restart();
+        }
+    }
+
+    tiffstream.reset();
+
+    for (int i = 0; i < buffers.size(); i++) {
+        _TIFFfree(buffers[i]);
+    }
+
+    TIFFClose(image);
+
+    return result;
+}
+
+/**
+ * Splits the strips or tiles of the image into bands of rows and
+ * decodes them on the global thread pool. The bands are made a bit
+ * finer than the number of threads for better load balancing.
+ */
+bool readTiffConcurrently(TIFF *image, const KisTiffChunksLayout &layout, KisTIFFReaderBase *tiffReader)
+{
+    const QByteArray fileName(TIFFFileName(image));
+    const tdir_t directory = TIFFCurrentDirectory(image);
+
+    const uint32_t numChunkRows = (layout.height + layout.chunkHeight - 1) / layout.chunkHeight;
+    const uint32_t numBands = qMin(numChunkRows, uint32_t(4 * QThread::idealThreadCount()));
+    const uint32_t chunkRowsPerBand = (numChunkRows + numBands - 1) / numBands;
+
+    QVector<QPair<uint32_t, uint32_t>> bands;
+    for (uint32_t chunkRow = 0; chunkRow < numChunkRows; chunkRow += chunkRowsPerBand) {
+        const uint32_t firstRow = chunkRow * layout.chunkHeight;
+        const uint32_t lastRow = qMin(layout.height, (chunkRow + chunkRowsPerBand) * layout.chunkHeight);
+        bands << qMakePair(firstRow, lastRow);
+    }
+
+    QAtomicInt numFailedBands(0);
+
+    QtConcurrent::blockingMap(bands, [&](const QPair<uint32_t, uint32_t> &band) {
+        if (!readTiffBand(fileName, directory, layout, band.first, band.second, tiffReader)) {
+            numFailedBands.ref();
+        }
+    });
+
+    if (numFailedBands.loadAcquire()) {
+        dbgFile << "Failed to read" << numFailedBands.loadAcquire() << "bands of" << fileName;
+    }
+
+    return !numFailedBands.loadAcquire();
+}
+} // namespace
+
 KisTIFFConverter::KisTIFFConverter(KisDocument *doc)
     : m_doc(doc)
     , m_stop(false)
@@ -765,7 +904,7 @@ KisImportExportErrorCode KisTIFFConverter::readImageFromTiff(TIFF *image, KisTif
     KisPaintLayer *layer = new KisPaintLayer(m_image.data(), m_image->nextLayerName(), quint8_MAX, cs);
     tdata_t buf = 0;
     tdata_t *ps_buf = 0; // used only for planar configuration separated
-    KisBufferStreamBase *tiffstream;
+    KisBufferStreamBase *tiffstream = nullptr;
 
     KisTIFFReaderBase *tiffReader = 0;
 
@@ -946,7 +1085,37 @@ KisImportExportErrorCode KisTIFFConverter::readImageFromTiff(TIFF *image, KisTif
         return ImportExportCodes::FileFormatIncorrect;
     }
 
-    if (TIFFIsTiled(image)) {
+    const bool isTiled = TIFFIsTiled(image);
+
+    KisTiffChunksLayout chunksLayout;
+    chunksLayout.isTiled = isTiled;
+    chunksLayout.planarconfig = planarconfig;
+    chunksLayout.depth = depth;
+    chunksLayout.nbchannels = nbchannels;
+    chunksLayout.width = width;
+    chunksLayout.height = height;
+
+    if (isTiled) {
+        TIFFGetField(image, TIFFTAG_TILEWIDTH, &chunksLayout.chunkWidth);
+        TIFFGetField(image, TIFFTAG_TILELENGTH, &chunksLayout.chunkHeight);
+    } else {
+        chunksLayout.chunkWidth = width;
+        TIFFGetFieldDefaulted(image, TIFFTAG_ROWSPERSTRIP, &chunksLayout.chunkHeight);
+        chunksLayout.chunkHeight = qMin(chunksLayout.chunkHeight, height);
+    }
+
+    const bool readConcurrently = tiffReader->canReadConcurrently()
+        && chunksLayout.chunkWidth > 0
+        && chunksLayout.chunkHeight > 0
+        && chunksLayout.chunkHeight < height
+        && QThread::idealThreadCount() > 1;
+
+    if (readConcurrently) {
+        dbgFile << "reading" << (isTiled ? "tiled" : "striped") << "image concurrently";
+        if (!readTiffConcurrently(image, chunksLayout, tiffReader)) {
+            dbgFile << "Some of the strips or tiles could not be decoded";
+        }
+    } else if (isTiled) {
         dbgFile << "tiled image";
         uint32_t tileWidth, tileHeight;
         uint32_t x, y;
@@ -1049,7 +1218,7 @@ KisImportExportErrorCode KisTIFFConverter::readImageFromTiff(TIFF *image, KisTif
     delete tiffstream;
     if (planarconfig == PLANARCONFIG_CONTIG) {
         _TIFFfree(buf);
-    } else {
+    } else if (ps_buf) {
         for (uint32_t i = 0; i < nbchannels; i++) {
             _TIFFfree(ps_buf[i]);
         }
@@ -178,6 +178,16 @@ public:
     virtual void finalize()
     {
     }
+    /**
+     * Returns true if copyDataToChannels() may be called for different
+     * lines of the image from several threads at the same time. The
+     * color transformation keeps an internal cache, so the readers using
+     * it can only be used sequentially.
+     */
+    virtual bool canReadConcurrently() const
+    {
+        return !m_transformProfile;
+    }
 
 protected:
     inline KisPaintDeviceSP paintDevice()
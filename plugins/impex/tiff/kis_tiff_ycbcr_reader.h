@@ -76,6 +76,12 @@ public:
         return finalizeImpl();
     }
 
+    bool canReadConcurrently() const override
+    {
+        // the subsampled chroma planes are accumulated in finalize()
+        return false;
+    }
+
 private:
     template<typename U = T, typename std::enable_if<!std::numeric_limits<U>::is_integer, void>::type * = nullptr> uint32_t copyDataToChannelsImpl(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase *tiffstream)
     {
@@ -0,0 +1,121 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTiffBenchmark.h"
+
+#include <QDir>
+
+#include <simpletest.h>
+#include <sdk/tests/testui.h>
+
+#include <KisDocument.h>
+#include <KisImportExportManager.h>
+#include <KisPart.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceRegistry.h>
+#include <kis_image.h>
+#include <kis_iterator_ng.h>
+#include <kis_paint_layer.h>
+#include <kis_properties_configuration.h>
+
+namespace {
+
+const QString TiffMimetype = "image/tiff";
+
+/**
+ * A 16-bit scan of 8000x8000 px is big enough to show the difference
+ * between sequential and concurrent strip decoding, but still fits
+ * into the memory of a CI machine.
+ */
+const QSize imageSize(8000, 8000);
+
+QString sourceFileName()
+{
+    return QDir::currentPath() + '/' + "tiff_benchmark_source.tif";
+}
+
+QString exportFileName()
+{
+    return QDir::currentPath() + '/' + "tiff_benchmark_export.tif";
+}
+
+KisPropertiesConfigurationSP deflateConfiguration()
+{
+    KisPropertiesConfigurationSP cfg = new KisPropertiesConfiguration();
+    cfg->setProperty("compressiontype", 2); // deflate
+    cfg->setProperty("predictor", 1); // horizontal differencing
+    cfg->setProperty("alpha", true);
+    cfg->setProperty("flatten", true);
+    return cfg;
+}
+
+KisImageSP createBenchmarkImage()
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Integer16BitsColorDepthID.id(), 0);
+
+    KisImageSP image = new KisImage(0, imageSize.width(), imageSize.height(), cs, "tiff benchmark");
+    KisPaintLayerSP layer = new KisPaintLayer(image, "scan", OPACITY_OPAQUE_U8);
+
+    KisSequentialIterator it(layer->paintDevice(), image->bounds());
+    while (it.nextPixel()) {
+        quint16 *pixel = reinterpret_cast<quint16 *>(it.rawData());
+        pixel[0] = quint16(it.x() * 8);
+        pixel[1] = quint16(it.y() * 8);
+        pixel[2] = quint16((it.x() ^ it.y()) * 16);
+        pixel[3] = 0xffff;
+    }
+
+    image->addNode(layer, image->root());
+    image->initialRefreshGraph();
+    image->waitForDone();
+
+    return image;
+}
+
+}
+
+void KisTiffBenchmark::initTestCase()
+{
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setFileBatchMode(true);
+    doc->setCurrentImage(createBenchmarkImage());
+
+    QVERIFY(doc->exportDocumentSync(sourceFileName(), TiffMimetype.toLatin1(), deflateConfiguration()));
+}
+
+void KisTiffBenchmark::cleanupTestCase()
+{
+    QFile::remove(sourceFileName());
+    QFile::remove(exportFileName());
+}
+
+void KisTiffBenchmark::benchmarkImport()
+{
+    QBENCHMARK_ONCE {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        KisImportExportManager manager(doc.data());
+        doc->setFileBatchMode(true);
+
+        KisImportExportErrorCode status = manager.importDocument(sourceFileName(), QString());
+        QVERIFY(status.isOk());
+        QVERIFY(doc->image());
+    }
+}
+
+void KisTiffBenchmark::benchmarkExport()
+{
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setFileBatchMode(true);
+    doc->setCurrentImage(createBenchmarkImage());
+
+    QBENCHMARK_ONCE {
+        QVERIFY(doc->exportDocumentSync(exportFileName(), TiffMimetype.toLatin1(), deflateConfiguration()));
+    }
+}
+
+KISTEST_MAIN(KisTiffBenchmark)
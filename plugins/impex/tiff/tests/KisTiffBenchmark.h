@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTIFFBENCHMARK_H
+#define KISTIFFBENCHMARK_H
+
+#include <simpletest.h>
+
+class KisTiffBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkImport();
+    void benchmarkExport();
+};
+
+#endif // KISTIFFBENCHMARK_H
@@ -65,6 +65,21 @@ struct KisLiquifyTransformStrategy::Private
 
     QImage transformedImage;
 
+    /**
+     * The state the preview has been rendered with. While it doesn't
+     * change, the preview is updated only in the area touched by the
+     * liquify dabs.
+     */
+    QImage scaledOriginalImage;
+    qint64 scaledOriginalImageKey = 0;
+    QTransform scaledOriginalImageTransform;
+
+    const KisLiquifyTransformWorker *previewWorker = 0;
+    qint64 previewSourceImageKey = 0;
+    QTransform previewImageToThumbTransform;
+    QPointF previewSourceOffset;
+    QPointF previewOffset;
+
     // size-gesture-related
     QPointF lastMouseWidgetPos;
     QPointF startResizeImagePos;
@@ -74,7 +89,7 @@ struct KisLiquifyTransformStrategy::Private
 
     bool recalculateOnNextRedraw;
 
-    void recalculateTransformations();
+    void recalculateTransformations(bool allowIncrementalUpdate = false);
     inline QPointF imageToThumb(const QPointF &pt, bool useFlakeOptimization);
 };
 
@@ -113,7 +128,7 @@ void KisLiquifyTransformStrategy::paint(QPainter &gc)
     // Draw preview image
 
     if (m_d->recalculateOnNextRedraw) {
-        m_d->recalculateTransformations();
+        m_d->recalculateTransformations(true);
         m_d->recalculateOnNextRedraw = false;
     }
 
@@ -159,7 +174,7 @@ void KisLiquifyTransformStrategy::continuePrimaryAction(KoPointerEvent *event)
 bool KisLiquifyTransformStrategy::endPrimaryAction(KoPointerEvent *event)
 {
     if (m_d->helper.endPaint(event)) {
-        m_d->recalculateTransformations();
+        m_d->recalculateTransformations(true);
         emit requestCanvasUpdate();
     }
 
@@ -257,9 +272,10 @@ inline QPointF KisLiquifyTransformStrategy::Private::imageToThumb(const QPointF
     return useFlakeOptimization ? converter->imageToDocument(converter->documentToFlake((pt))) : q->thumbToImageTransform().inverted().map(pt);
 }
 
-void KisLiquifyTransformStrategy::Private::recalculateTransformations()
+void KisLiquifyTransformStrategy::Private::recalculateTransformations(bool allowIncrementalUpdate)
 {
-    KIS_ASSERT_RECOVER_RETURN(currentArgs.liquifyWorker());
+    KisLiquifyTransformWorker *worker = currentArgs.liquifyWorker();
+    KIS_ASSERT_RECOVER_RETURN(worker);
 
     QTransform scaleTransform = KisTransformUtils::imageToFlakeTransform(converter);
 
@@ -268,13 +284,24 @@ void KisLiquifyTransformStrategy::Private::recalculateTransformations()
     bool useFlakeOptimization = scale < 1.0 &&
         !KisTransformUtils::thumbnailTooSmall(resultThumbTransform, q->originalImage().rect());
 
-    paintingOffset = transaction.originalTopLeft();
     if (!q->originalImage().isNull()) {
+        QImage srcImage;
+
         if (useFlakeOptimization) {
-            transformedImage = q->originalImage().transformed(resultThumbTransform);
+            // rescaling the original is expensive, so do it only when the zoom changes
+            if (scaledOriginalImage.isNull() ||
+                scaledOriginalImageKey != q->originalImage().cacheKey() ||
+                scaledOriginalImageTransform != resultThumbTransform) {
+
+                scaledOriginalImage = q->originalImage().transformed(resultThumbTransform);
+                scaledOriginalImageKey = q->originalImage().cacheKey();
+                scaledOriginalImageTransform = resultThumbTransform;
+            }
+
+            srcImage = scaledOriginalImage;
             paintingTransform = QTransform();
         } else {
-            transformedImage = q->originalImage();
+            srcImage = q->originalImage();
             paintingTransform = resultThumbTransform;
         }
 
@@ -286,18 +313,51 @@ void KisLiquifyTransformStrategy::Private::recalculateTransformations()
         QPointF origTLInFlake =
             imageToRealThumbTransform.map(transaction.originalTopLeft());
 
-        transformedImage =
-            currentArgs.liquifyWorker()->runOnQImage(transformedImage,
-                                                     origTLInFlake,
-                                                     imageToRealThumbTransform,
-                                                     &paintingOffset);
+        /**
+         * While painting, only the dabs change the grid, so we re-render
+         * only the area of the preview they touched
+         */
+        const bool canUpdateIncrementally =
+            allowIncrementalUpdate &&
+            !transformedImage.isNull() &&
+            previewWorker == worker &&
+            !worker->isFullyDirty() &&
+            previewSourceImageKey == srcImage.cacheKey() &&
+            previewImageToThumbTransform == imageToRealThumbTransform &&
+            previewSourceOffset == origTLInFlake;
+
+        if (!canUpdateIncrementally ||
+            !worker->updateQImage(srcImage,
+                                  origTLInFlake,
+                                  imageToRealThumbTransform,
+                                  worker->dirtyRect(),
+                                  &transformedImage,
+                                  previewOffset)) {
+
+            transformedImage =
+                worker->runOnQImage(srcImage,
+                                    origTLInFlake,
+                                    imageToRealThumbTransform,
+                                    &previewOffset);
+        }
+
+        paintingOffset = previewOffset;
+
+        previewWorker = worker;
+        previewSourceImageKey = srcImage.cacheKey();
+        previewImageToThumbTransform = imageToRealThumbTransform;
+        previewSourceOffset = origTLInFlake;
     } else {
         transformedImage = q->originalImage();
         paintingOffset = imageToThumb(transaction.originalTopLeft(), false);
         paintingTransform = resultThumbTransform;
+        previewWorker = 0;
     }
 
     handlesTransform = scaleTransform;
+
+    // the tool fetches and resets the dirty rect of the worker
+    // when passing the update to the in-stack preview
     emit q->requestImageRecalculation();
 }
 
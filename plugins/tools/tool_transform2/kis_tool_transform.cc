@@ -63,6 +63,7 @@
 #include "widgets/kis_progress_widget.h"
 
 #include "kis_transform_utils.h"
+#include "kis_liquify_transform_worker.h"
 #include "kis_warp_transform_strategy.h"
 #include "kis_cage_transform_strategy.h"
 #include "kis_liquify_transform_strategy.h"
@@ -801,12 +802,37 @@ void KisToolTransform::requestStrokeCancellation()
 
 void KisToolTransform::requestImageRecalculation()
 {
+    /**
+     * The liquify worker accumulates the area changed by the dabs. If the
+     * in-stack preview has been rendered with the same worker, only that
+     * area has to be re-rendered.
+     */
+    boost::optional<QRect> dirtyRect;
+    KisLiquifyTransformWorker *liquifyWorker =
+        m_currentArgs.mode() == ToolTransformArgs::LIQUIFY ? m_currentArgs.liquifyWorker() : 0;
+
     if (!m_currentlyUsingOverlayPreviewStyle && m_strokeId && m_transaction.rootNode()) {
+        if (liquifyWorker &&
+            liquifyWorker == m_lastRecalculatedLiquifyWorker &&
+            !liquifyWorker->isFullyDirty()) {
+
+            dirtyRect = liquifyWorker->dirtyRect();
+        }
+
         image()->addJob(
             m_strokeId,
             new InplaceTransformStrokeStrategy::UpdateTransformData(
                 m_currentArgs,
-                InplaceTransformStrokeStrategy::UpdateTransformData::PAINT_DEVICE));
+                InplaceTransformStrokeStrategy::UpdateTransformData::PAINT_DEVICE,
+                dirtyRect));
+
+        m_lastRecalculatedLiquifyWorker = liquifyWorker;
+    } else {
+        m_lastRecalculatedLiquifyWorker = 0;
+    }
+
+    if (liquifyWorker) {
+        liquifyWorker->resetDirtyRect();
     }
 }
 
@@ -51,6 +51,7 @@ class KisLiquifyTransformStrategy;
 class KisFreeTransformStrategy;
 class KisPerspectiveTransformStrategy;
 class KisMeshTransformStrategy;
+class KisLiquifyTransformWorker;
 
 
 /**
@@ -265,6 +266,9 @@ private:
     KisStrokeId m_strokeId;
     void *m_strokeStrategyCookie {0};
     bool m_currentlyUsingOverlayPreviewStyle {false};
+
+    // the liquify worker the in-stack preview has been last updated with
+    const KisLiquifyTransformWorker *m_lastRecalculatedLiquifyWorker {0};
     bool m_preferOverlayPreviewStyle {false};
     bool m_forceLodMode {false};
 
@@ -335,10 +335,16 @@ void transformDeviceImpl(const ToolTransformArgs &config,
         transformWorker.run();
 
         KisPerspectiveTransformWorker::SampleType sampleType =
-            config.filterId() == "NearestNeighbor" ?
-            KisPerspectiveTransformWorker::NearestNeighbour :
             KisPerspectiveTransformWorker::Bilinear;
 
+        if (config.filterId() == "NearestNeighbor") {
+            sampleType = KisPerspectiveTransformWorker::NearestNeighbour;
+        } else if (config.filterId() == "Bicubic") {
+            sampleType = KisPerspectiveTransformWorker::Bicubic;
+        } else if (config.filterId() == "Lanczos3") {
+            sampleType = KisPerspectiveTransformWorker::Lanczos3;
+        }
+
         if (config.mode() == ToolTransformArgs::FREE_TRANSFORM) {
             KisPerspectiveTransformWorker perspectiveWorker(dstDevice,
                                                             config.transformedCenter(),
@@ -588,6 +594,38 @@ void KisTransformUtils::transformAndMergeDevice(const ToolTransformArgs &config,
     painter.end();
 }
 
+void KisTransformUtils::transformAndMergeDeviceIncrementally(const ToolTransformArgs &config,
+                                                             KisPaintDeviceSP src,
+                                                             KisPaintDeviceSP dst,
+                                                             KisPaintDeviceSP *transformedCache,
+                                                             const boost::optional<QRect> &dirtyRect,
+                                                             KisProcessingVisitor::ProgressHelper *helper)
+{
+    if (config.mode() != ToolTransformArgs::LIQUIFY || !config.liquifyWorker()) {
+        transformAndMergeDevice(config, src, dst, helper);
+        return;
+    }
+
+    KoUpdaterPtr mergeUpdater = helper->updater();
+
+    KisPaintDeviceSP &tmp = *transformedCache;
+
+    if (tmp && dirtyRect) {
+        config.liquifyWorker()->run(src, tmp, *dirtyRect);
+    } else {
+        tmp = new KisPaintDevice(src->colorSpace());
+        tmp->prepareClone(src);
+
+        KisTransformUtils::transformDevice(config, src, tmp, helper);
+    }
+
+    QRect mergeRect = tmp->extent();
+    KisPainter painter(dst);
+    painter.setProgress(mergeUpdater);
+    painter.bitBlt(mergeRect.topLeft(), tmp, mergeRect);
+    painter.end();
+}
+
 struct TransformExtraData : public KUndo2CommandExtraData
 {
     ToolTransformArgs savedTransformArgs;
@@ -15,6 +15,7 @@
 #include <QMatrix4x4>
 #include <kis_processing_visitor.h>
 #include <limits>
+#include <boost/optional.hpp>
 
 // for kisSquareDistance only
 #include "kis_global.h"
@@ -174,6 +175,19 @@ public:
                                         KisPaintDeviceSP dst,
                                         KisProcessingVisitor::ProgressHelper *helper);
 
+    /**
+     * Same as transformAndMergeDevice(), but in liquify mode keeps the
+     * transformed device in \p transformedCache between the calls. If
+     * \p dirtyRect is set and the cache exists, only that area of the
+     * cache is re-rendered, otherwise the whole grid is.
+     */
+    static void transformAndMergeDeviceIncrementally(const ToolTransformArgs &config,
+                                                     KisPaintDeviceSP src,
+                                                     KisPaintDeviceSP dst,
+                                                     KisPaintDeviceSP *transformedCache,
+                                                     const boost::optional<QRect> &dirtyRect,
+                                                     KisProcessingVisitor::ProgressHelper *helper);
+
     static void postProcessToplevelCommand(KUndo2Command *command,
                                            const ToolTransformArgs &args,
                                            KisNodeSP rootNode,
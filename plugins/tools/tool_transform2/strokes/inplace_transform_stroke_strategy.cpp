@@ -89,6 +89,13 @@ struct InplaceTransformStrokeStrategy::Private
     QHash<KisPaintDevice*, KisPaintDeviceSP> devicesCacheHash;
     QHash<KisTransformMask*, KisPaintDeviceSP> transformMaskCacheHash;
 
+    /**
+     * Liquified devices rendered for the preview, per device and level
+     * of detail, so that the next update could re-render only the area
+     * changed by the dabs
+     */
+    QHash<QPair<KisPaintDevice*, int>, KisPaintDeviceSP> liquifyCacheHash;
+
     QMutex dirtyRectsMutex;
     KisBatchNodeUpdate dirtyRects;
     KisBatchNodeUpdate prevDirtyRects;
@@ -106,6 +113,7 @@ struct InplaceTransformStrokeStrategy::Private
 
     // data for asynchronous updates
     boost::optional<ToolTransformArgs> pendingUpdateArgs;
+    boost::optional<QRect> pendingUpdateDirtyRect;
     QElapsedTimer updateTimer;
     const int updateInterval = 30;
 
@@ -168,6 +176,15 @@ void InplaceTransformStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 {
     if (UpdateTransformData *upd = dynamic_cast<UpdateTransformData*>(data)) {
         if (upd->destination == UpdateTransformData::PAINT_DEVICE) {
+            // the dirty rects of the coalesced updates are accumulated
+            if (!m_d->pendingUpdateArgs) {
+                m_d->pendingUpdateDirtyRect = upd->dirtyRect;
+            } else if (m_d->pendingUpdateDirtyRect && upd->dirtyRect) {
+                *m_d->pendingUpdateDirtyRect |= *upd->dirtyRect;
+            } else {
+                m_d->pendingUpdateDirtyRect = boost::none;
+            }
+
             m_d->pendingUpdateArgs = upd->args;
             tryPostUpdateJob(false);
         } else if (m_d->selection) {
@@ -226,9 +243,11 @@ void InplaceTransformStrokeStrategy::doCanvasUpdate(bool forceUpdate)
     QVector<KisStrokeJobData *> jobs;
 
     ToolTransformArgs args = *m_d->pendingUpdateArgs;
+    boost::optional<QRect> dirtyRect = m_d->pendingUpdateDirtyRect;
     m_d->pendingUpdateArgs = boost::none;
+    m_d->pendingUpdateDirtyRect = boost::none;
 
-    reapplyTransform(args, jobs, m_d->previewLevelOfDetail, false);
+    reapplyTransform(args, jobs, m_d->previewLevelOfDetail, false, dirtyRect);
 
     KritaUtils::addJobBarrier(jobs, [this, args]() {
         m_d->currentTransformArgs = args;
@@ -617,7 +636,7 @@ void InplaceTransformStrokeStrategy::fetchAllUpdateRequests(int levelOfDetail, K
     dirtyRects.swap(prevDirtyRects);
 }
 
-void InplaceTransformStrokeStrategy::transformNode(KisNodeSP node, const ToolTransformArgs &config, int levelOfDetail)
+void InplaceTransformStrokeStrategy::transformNode(KisNodeSP node, const ToolTransformArgs &config, int levelOfDetail, const boost::optional<QRect> &dirtyRect)
 {
     KisPaintDeviceSP device = node->paintDevice();
 
@@ -684,8 +703,28 @@ void InplaceTransformStrokeStrategy::transformNode(KisNodeSP node, const ToolTra
         KisTransaction transaction(device);
 
         KisProcessingVisitor::ProgressHelper helper(node);
-        KisTransformUtils::transformAndMergeDevice(config, cachedPortion,
-                                                   device, &helper);
+
+        if (config.mode() == ToolTransformArgs::LIQUIFY) {
+            const QPair<KisPaintDevice*, int> cacheKey(device.data(), levelOfDetail);
+            KisPaintDeviceSP liquifyCache;
+
+            {
+                QMutexLocker l(&m_d->devicesCacheMutex);
+                liquifyCache = m_d->liquifyCacheHash.value(cacheKey);
+            }
+
+            KisTransformUtils::transformAndMergeDeviceIncrementally(config, cachedPortion,
+                                                                    device, &liquifyCache,
+                                                                    dirtyRect, &helper);
+
+            {
+                QMutexLocker l(&m_d->devicesCacheMutex);
+                m_d->liquifyCacheHash.insert(cacheKey, liquifyCache);
+            }
+        } else {
+            KisTransformUtils::transformAndMergeDevice(config, cachedPortion,
+                                                       device, &helper);
+        }
 
         executeAndAddCommand(transaction.endAndTake(), commandGroup, KisStrokeJobData::CONCURRENT);
         addDirtyRect(node, cachedPortion->extent() | node->projectionPlane()->tightUserVisibleBounds(), levelOfDetail);
@@ -820,10 +859,16 @@ void InplaceTransformStrokeStrategy::createCacheAndClearNode(KisNodeSP node)
 void InplaceTransformStrokeStrategy::reapplyTransform(ToolTransformArgs args,
                                                       QVector<KisStrokeJobData *> &mutatedJobs,
                                                       int levelOfDetail,
-                                                      bool useHoldUI)
+                                                      bool useHoldUI,
+                                                      boost::optional<QRect> dirtyRect)
 {
     if (levelOfDetail > 0) {
         args.scale3dSrcAndDst(KisLodTransform::lodToScale(levelOfDetail));
+
+        if (dirtyRect) {
+            KisLodTransform t(levelOfDetail);
+            dirtyRect = kisGrowRect(t.map(*dirtyRect), 1);
+        }
     }
 
     KisBatchNodeUpdateSP updateData(new KisBatchNodeUpdate());
@@ -846,8 +891,8 @@ void InplaceTransformStrokeStrategy::reapplyTransform(ToolTransformArgs args,
 
     Q_FOREACH (KisNodeSP node, m_d->processedNodes) {
         KritaUtils::addJobConcurrent(mutatedJobs, levelOfDetail,
-                                     [this, node, args, levelOfDetail]() {
-            transformNode(node, args, levelOfDetail);
+                                     [this, node, args, levelOfDetail, dirtyRect]() {
+            transformNode(node, args, levelOfDetail, dirtyRect);
         });
     }
 
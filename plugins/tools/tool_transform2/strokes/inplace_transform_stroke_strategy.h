@@ -20,6 +20,7 @@
 
 #include "KisAsyncronousStrokeUpdateHelper.h"
 #include <commands_new/KisUpdateCommandEx.h>
+#include <boost/optional.hpp>
 
 class KisPostExecutionUndoAdapter;
 class TransformTransactionProperties;
@@ -39,10 +40,17 @@ public:
         };
 
     public:
-        UpdateTransformData(ToolTransformArgs _args, Destination _dest)
+        /**
+         * \p _dirtyRect is the area of the image changed since the
+         * previous update. Only liquify mode can report it; when it
+         * is not set, the whole transformation is recalculated.
+         */
+        UpdateTransformData(ToolTransformArgs _args, Destination _dest,
+                            boost::optional<QRect> _dirtyRect = boost::none)
             : KisStrokeJobData(SEQUENTIAL, NORMAL),
               args(_args),
-              destination(_dest)
+              destination(_dest),
+              dirtyRect(_dirtyRect)
         {}
 
         KisStrokeJobData* createLodClone(int levelOfDetail) override {
@@ -53,7 +61,8 @@ public:
         UpdateTransformData(const UpdateTransformData &rhs, int levelOfDetail)
             : KisStrokeJobData(rhs),
               args(rhs.args),
-              destination(rhs.destination)
+              destination(rhs.destination),
+              dirtyRect(rhs.dirtyRect)
         {
             Q_UNUSED(levelOfDetail);
         }
@@ -61,6 +70,7 @@ public:
     public:
         ToolTransformArgs args;
         Destination destination;
+        boost::optional<QRect> dirtyRect;
     };
 
 private:
@@ -157,9 +167,9 @@ private:
 
     void fetchAllUpdateRequests(int levelOfDetail, KisBatchNodeUpdateSP updateData);
 
-    void transformNode(KisNodeSP node, const ToolTransformArgs &config, int levelOfDetail);
+    void transformNode(KisNodeSP node, const ToolTransformArgs &config, int levelOfDetail, const boost::optional<QRect> &dirtyRect = boost::none);
     void createCacheAndClearNode(KisNodeSP node);
-    void reapplyTransform(ToolTransformArgs args, QVector<KisStrokeJobData *> &mutatedJobs, int levelOfDetail, bool useHoldUI);
+    void reapplyTransform(ToolTransformArgs args, QVector<KisStrokeJobData *> &mutatedJobs, int levelOfDetail, bool useHoldUI, boost::optional<QRect> dirtyRect = boost::none);
     void finalizeStrokeImpl(QVector<KisStrokeJobData *> &mutatedJobs, bool saveCommands);
 
     void finishAction(QVector<KisStrokeJobData *> &mutatedJobs);